@@ -0,0 +1,121 @@
+/*
+	Bech32 of BIP173 only for the addresses that keyhunt can find: human readable part "bc",
+	witness version 0 and a program of 20 bytes. 1 version value + 32 values of 5 bits + 6 of checksum
+*/
+
+#include <string.h>
+
+#include "bech32.h"
+
+#define BECH32_HRP "bc"
+#define BECH32_VALUES 39		/* Version + program + checksum */
+
+static const char bech32_charset[] = "qpzry9x8gf2tvdw0s3jn54khce6mua7l";
+
+static const int8_t bech32_charset_rev[128] = {
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+	15, -1, 10, 17, 21, 20, 26, 30,  7,  5, -1, -1, -1, -1, -1, -1,
+	-1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+	 1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1,
+	-1, 29, -1, 24, 13, 25,  9,  8, 23, -1, 18, 22, 31, 27, 19, -1,
+	 1,  0,  3, 16, 11, 28, 12, 14,  6,  4,  2, -1, -1, -1, -1, -1
+};
+
+static uint32_t bech32_polymod_step(uint32_t pre)	{
+	uint8_t b = pre >> 25;
+	return ((pre & 0x1FFFFFF) << 5) ^
+		(-((b >> 0) & 1) & 0x3b6a57b2UL) ^
+		(-((b >> 1) & 1) & 0x26508e6dUL) ^
+		(-((b >> 2) & 1) & 0x1ea119faUL) ^
+		(-((b >> 3) & 1) & 0x3d4233ddUL) ^
+		(-((b >> 4) & 1) & 0x2a1462b3UL);
+}
+
+/*
+	Checksum state after the expanded human readable part
+*/
+static uint32_t bech32_polymod_hrp()	{
+	uint32_t chk = 1;
+	int i;
+	for(i = 0; BECH32_HRP[i] != '\0'; i++)	{
+		chk = bech32_polymod_step(chk) ^ (BECH32_HRP[i] >> 5);
+	}
+	chk = bech32_polymod_step(chk);
+	for(i = 0; BECH32_HRP[i] != '\0'; i++)	{
+		chk = bech32_polymod_step(chk) ^ (BECH32_HRP[i] & 0x1f);
+	}
+	return chk;
+}
+
+int bech32_decode_p2wpkh(uint8_t *hash160,const char *address)	{
+	uint8_t values[BECH32_VALUES];
+	uint32_t chk,acc = 0;
+	int i,bits = 0,lower = 0,upper = 0,length = 0;
+	char c;
+	if(strlen(address) != BECH32_P2WPKH_LENGTH)
+		return 0;
+	for(i = 0; i < BECH32_P2WPKH_LENGTH; i++)	{
+		c = address[i];
+		if(c >= 'a' && c <= 'z')
+			lower = 1;
+		if(c >= 'A' && c <= 'Z')
+			upper = 1;
+	}
+	if(lower && upper)
+		return 0;
+	if((address[0] | 0x20) != BECH32_HRP[0] || (address[1] | 0x20) != BECH32_HRP[1] || address[2] != '1')
+		return 0;
+	chk = bech32_polymod_hrp();
+	for(i = 0; i < BECH32_VALUES; i++)	{
+		c = address[3 + i];
+		if(c < 0 || bech32_charset_rev[(int)c] == -1)
+			return 0;
+		values[i] = bech32_charset_rev[(int)c];
+		chk = bech32_polymod_step(chk) ^ values[i];
+	}
+	if(chk != 1 || values[0] != 0)
+		return 0;
+	/* 32 values of 5 bits are exactly the 160 bits of the program, no padding */
+	for(i = 1; i < 33; i++)	{
+		acc = (acc << 5) | values[i];
+		bits += 5;
+		if(bits >= 8)	{
+			bits -= 8;
+			hash160[length++] = (acc >> bits) & 0xff;
+		}
+	}
+	return 1;
+}
+
+void bech32_encode_p2wpkh(char *address,const uint8_t *hash160)	{
+	uint8_t values[BECH32_VALUES];
+	uint32_t chk,acc = 0;
+	int i,bits = 0,length = 1;
+	values[0] = 0;
+	for(i = 0; i < 20; i++)	{
+		acc = (acc << 8) | hash160[i];
+		bits += 8;
+		while(bits >= 5)	{
+			bits -= 5;
+			values[length++] = (acc >> bits) & 0x1f;
+		}
+	}
+	chk = bech32_polymod_hrp();
+	for(i = 0; i < 33; i++)	{
+		chk = bech32_polymod_step(chk) ^ values[i];
+	}
+	for(i = 0; i < 6; i++)	{
+		chk = bech32_polymod_step(chk);
+	}
+	chk ^= 1;
+	for(i = 0; i < 6; i++)	{
+		values[33 + i] = (chk >> (5 * (5 - i))) & 0x1f;
+	}
+	memcpy(address,BECH32_HRP "1",3);
+	for(i = 0; i < BECH32_VALUES; i++)	{
+		address[3 + i] = bech32_charset[values[i]];
+	}
+	address[BECH32_P2WPKH_LENGTH] = '\0';
+}
@@ -0,0 +1,30 @@
+#ifndef BECH32_H
+#define BECH32_H
+
+/*
+	Bech32 (BIP173) of the native segwit P2WPKH addresses: bc1q + 20 bytes hash160, only the witness version 0
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BECH32_P2WPKH_LENGTH 42		/* Characters of a bc1q address without the '\0' */
+
+/*
+	1 and the hash160 of the witness program if the address is valid, lowercase or uppercase but not mixed
+*/
+int bech32_decode_p2wpkh(uint8_t *hash160,const char *address);
+
+/*
+	address needs BECH32_P2WPKH_LENGTH + 1 bytes
+*/
+void bech32_encode_p2wpkh(char *address,const uint8_t *hash160);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
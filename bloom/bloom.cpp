@@ -155,6 +155,18 @@ int bloom_check(struct bloom * bloom, const void * buffer, int len)
   return 0;
 }
 
+void bloom_prefetch(struct bloom * bloom, const void * buffer, int len)
+{
+  if (bloom->ready == 0) {
+    return;
+  }
+  uint64_t a = XXH64(buffer, len, 0x59f2815b16f81798);
+  uint64_t b = XXH64(buffer, len, a);
+  // Most of the elements are not present and bloom_check stops in the 1st or 2nd bit
+  __builtin_prefetch(bloom->bf + ((a % bloom->bits) >> 3), 0, 1);
+  __builtin_prefetch(bloom->bf + (((a + b) % bloom->bits) >> 3), 0, 1);
+}
+
 
 int bloom_add(struct bloom * bloom, const void * buffer, int len)
 {
@@ -111,6 +111,22 @@ int bloom_init(struct bloom * bloom, uint64_t entries, long double error);
 int bloom_check(struct bloom * bloom, const void * buffer, int len);
 
 
+/** ***************************************************************************
+ * Prefetch the bytes of the first two bits that bloom_check will test for
+ * the element, so a group of checks can wait for memory at the same time.
+ *
+ * Parameters:
+ * -----------
+ *     bloom  - Pointer to an allocated struct bloom (see above).
+ *     buffer - Pointer to buffer containing element to check later.
+ *     len    - Size of 'buffer'.
+ *
+ * Return: none
+ *
+ */
+void bloom_prefetch(struct bloom * bloom, const void * buffer, int len);
+
+
 /** ***************************************************************************
  * Add the given element to the bloom filter.
  * The return code indicates if the element (or a collision) was already in,
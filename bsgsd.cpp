@@ -10,6 +10,8 @@ email: albertobsd@gmail.com
 #include <math.h>
 #include <time.h>
 #include <vector>
+#include <string>
+#include <algorithm>
 #include <inttypes.h>
 #include "base58/libbase58.h"
 #include "rmd160/rmd160.h"
@@ -17,6 +19,7 @@ email: albertobsd@gmail.com
 #include "bloom/bloom.h"
 #include "sha3/sha3.h"
 #include "util.h"
+#include "numa.h"
 
 #include "secp256k1/SECP256k1.h"
 #include "secp256k1/Point.h"
@@ -26,6 +29,7 @@ email: albertobsd@gmail.com
 
 #include "hash/sha256.h"
 #include "hash/ripemd160.h"
+#include "bsgsd_shm.h"
 
 #include <unistd.h>
 #include <pthread.h>
@@ -35,15 +39,52 @@ email: albertobsd@gmail.com
 #endif
 
 #include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <sys/mman.h>
 #include <netinet/in.h>
 #include <arpa/inet.h> // for inet_addr()
+#include <signal.h>
+#include <fcntl.h>
+#include <errno.h>
 #include <pthread.h>   // for pthread functions
+#if defined(__linux__)
+#include <sys/epoll.h>
+#define IO_READ EPOLLIN
+#define IO_WRITE EPOLLOUT
+#define IO_ERROR (EPOLLERR | EPOLLHUP)
+#else
+#include <poll.h>
+#define IO_READ POLLIN
+#define IO_WRITE POLLOUT
+#define IO_ERROR (POLLERR | POLLHUP)
+#endif
 #ifdef __APPLE__
 #include <sys/qos.h>
 #endif
 
 #define PORT 8080
 #define BUFFER_SIZE 1024
+#define LINE_SIZE 65536
+#define TAG_SIZE 64
+#define PATH_SIZE 1024
+
+#define PROTOCOL_VERSION "BSGSD/1"
+
+#define IO_EVENTS 64
+#define IO_TIMEOUT 1000
+
+#define CONNECTION_NEW 0
+#define CONNECTION_SINGLE 1
+#define CONNECTION_PIPELINED 2
+#define CONNECTION_METRICS 3
+
+#define METRICS_BUCKETS 8
+
+#define REQUEST_RUNNING 0
+#define REQUEST_TIMEOUT 408
+#define REQUEST_CANCELLED 499
 
 
 
@@ -68,6 +109,117 @@ struct tothread {
 	char *rpt;  //rng per thread
 };
 
+/*
+	One generation of BSGS tables. The requests keep the generation that they started with, so a RELOAD
+	never change the tables under a running search, the old generation is released after its last request
+*/
+/*
+	Counters of one worker thread, only the owner writes them so the giant step loop don't pay any lock.
+	One cache line each one, the metrics listener adds all of them
+*/
+struct alignas(64) bsgs_metrics	{
+	uint64_t keys;			/* Keys of the finished blocks */
+	uint64_t giant_steps;	/* Level 1 bloom checks */
+	uint64_t secondcheck;	/* Level 1 hits */
+	uint64_t thirdcheck;	/* Level 2 hits */
+	uint64_t bptable;		/* Level 3 hits, binary searches in the bP table */
+	uint64_t found;
+};
+
+#define METRIC_ADD(counter,value) __atomic_store_n(&(counter),(counter) + (value),__ATOMIC_RELAXED)
+
+struct bsgs_tables	{
+	int id;
+	int kfactor;
+	int requests;			/* Active requests using it, protected by mutex_scheduler */
+	uint64_t bytes;
+	double load_seconds;
+	Int N;
+	Int M;
+	Int M_double;
+	Int M2_double;
+	Int M3;
+	Int M3_double;
+	uint64_t m3;
+	uint64_t aux;
+	std::vector<Point> GSn;
+	Point _2GSn;
+	std::vector<Point> AMP2;
+	std::vector<Point> AMP3;
+	struct bloom *bloom_bP;
+	struct bloom *bloom_bPx2nd;
+	struct bloom *bloom_bPx3rd;
+	struct checksumsha256 *bloom_bP_checksums;
+	struct checksumsha256 *bloom_bPx2nd_checksums;
+	struct checksumsha256 *bloom_bPx3rd_checksums;
+	pthread_mutex_t *bloom_bP_mutex;
+	pthread_mutex_t *bloom_bPx2nd_mutex;
+	pthread_mutex_t *bloom_bPx3rd_mutex;
+	struct bsgs_xvalue *bPtable;
+	struct bloom **bloom_bP_node;	/* -A replicate, copy of bloom_bP in each NUMA node, NULL otherwise */
+	int nodes;
+};
+
+/*
+	One client query, the bloom filters and the bP table are shared by all of them
+	Every worker thread scans blocks of 2*BSGS_N keys from request->current for all the targets
+*/
+struct bsgs_request	{
+	uint64_t id;
+	char tag[TAG_SIZE];		/* Query id given by the client in pipelined mode */
+	int status;				/* 200 or 400 for a bad query */
+	int targets_count;
+	int found_count;		/* Atomic, the workers write it with write_keys and the scheduler read it */
+	Point *targets;
+	bool *targets_compressed;
+	Int *keysfound;
+	int *found;				/* Atomic, a worker stop its target as soon as other one found it */
+	Int range_start;
+	Int range_end;
+	Int current;			/* Next block to scan, protected by mutex_scheduler */
+	Int chunk;				/* Keys per block, 2*N or less for the short ranges */
+	uint32_t cycles;		/* Groups of CPU_GRP_SIZE giant steps per block */
+	int workers;			/* Threads scanning a block of this request right now */
+	int done;
+	int cancelled;			/* REQUEST_TIMEOUT or REQUEST_CANCELLED, the workers leave the block at the next group, atomic */
+	time_t deadline;		/* 0 without deadline */
+	int progress;			/* Seconds between PROGRESS frames, 0 without streaming */
+	int priority;			/* Higher priorities leave the admission queue first */
+	time_t started;
+	double created;			/* metrics_now() when the query arrived */
+	char *job;				/* Spool file name without .job, NULL for the clients */
+	int slot;				/* Shared memory slot, -1 for the others */
+	time_t progress_last;
+	Int scanned;			/* Keys of the finished blocks, protected by mutex_scheduler */
+	Int scanned_last;		/* scanned in the last PROGRESS frame */
+	std::vector<Int> blocks;	/* Start of the blocks taken by the workers and not finished */
+	struct bsgs_tables *tables;			/* Set when the request leaves the admission queue */
+	struct bsgs_connection *connection;	/* NULL for the spool jobs and shared memory slots */
+	struct bsgs_request *next;
+};
+
+/*
+	Client connection, all the sockets are owned by the I/O thread (io_loop)
+	The struct lives until the socket is closed and all its requests are replied or cancelled
+*/
+struct bsgs_connection	{
+	int fd;
+	int port;
+	char ip[INET_ADDRSTRLEN];
+	int mode;				/* CONNECTION_NEW, CONNECTION_SINGLE or CONNECTION_PIPELINED */
+	int events;				/* Events watched right now */
+	char *input;			/* LINE_SIZE bytes, the unfinished line */
+	int input_length;
+	char *output;			/* Replies not sent yet because the socket was full */
+	int output_length;
+	int output_size;
+	int outstanding;		/* Requests enqueued and not replied yet */
+	int read_closed;
+	int dead;				/* Socket closed, waiting for the outstanding requests */
+	int admin;				/* Accepted in the admin socket, it can send RELOAD */
+	struct bsgs_connection *next;
+};
+
 struct bPload	{
 	uint32_t threadid;
 	uint64_t from;
@@ -98,7 +250,6 @@ Point _2GSn;
 void menu();
 void init_generator();
 
-int sendstr(int client_fd,const char *str);
 
 void sleep_ms(int milliseconds);
 
@@ -111,19 +262,74 @@ void bsgs_heapify(struct bsgs_xvalue *arr, int64_t n, int64_t i);
 int64_t bsgs_partition(struct bsgs_xvalue *arr, int64_t n);
 
 int bsgs_searchbinary(struct bsgs_xvalue *arr,char *data,int64_t array_length,uint64_t *r_value);
-int bsgs_secondcheck(Int *start_range,uint32_t a,Int *privatekey);
-int bsgs_thirdcheck(Int *start_range,uint32_t a,Int *privatekey);
+int bsgs_secondcheck(struct bsgs_tables *tables,Int *start_range,uint32_t a,Point *target,Int *privatekey);
+int bsgs_thirdcheck(struct bsgs_tables *tables,Int *start_range,uint32_t a,Point *target,Int *privatekey);
+struct bsgs_tables *bsgs_tables_load();
+struct bsgs_tables *bsgs_tables_discard(FILE *fd);
+void bsgs_tables_free(struct bsgs_tables *tables);
+void bsgs_tables_replicate(struct bsgs_tables *tables,uint64_t bloom_bytes);
+int bsgs_tables_valid(const char *str,int kfactor);
+void *thread_tables_load(void *vargp);
+void tables_switch();
 
 
 void writekey(bool compressed,Int *key);
 void checkpointer(void *ptr,const char *file,const char *function,const  char *name,int line);
-
-void* client_handler(void* arg);
-
-
-void calcualteindex(int i,Int *key);
+int checkpointer_load(void *ptr,const char *file,const char *function,const  char *name,int line);
+
+void io_loop(int server_fd);
+void io_event(void *owner,int events,int *server_fd);
+void io_update(struct bsgs_connection *connection);
+void io_expire(time_t now);
+void io_heartbeat();
+void connection_accept(int server_fd,int mode,int admin);
+void connection_read(struct bsgs_connection *connection);
+void connection_lines(struct bsgs_connection *connection,int eof);
+void connection_line(struct bsgs_connection *connection,char *line);
+void connection_single(struct bsgs_connection *connection,char *line);
+void connection_query(struct bsgs_connection *connection,char *line);
+void connection_reload(struct bsgs_connection *connection,char *n,char *k);
+void connection_send(struct bsgs_connection *connection,const char *str);
+void connection_write(struct bsgs_connection *connection);
+void connection_check(struct bsgs_connection *connection);
+void connection_hangup(struct bsgs_connection *connection);
+void connection_close(struct bsgs_connection *connection);
+void connection_reap();
+void requests_replies();
+int request_options(Tokenizer *t,time_t *deadline,int *progress,int *priority);
+int request_reply(struct bsgs_request *request,char *reply,int size);
+void spool_init();
+void spool_scan();
+void spool_claim(const char *name);
+void spool_done(struct bsgs_request *request);
+void shm_init();
+void *thread_shm(void *vargp);
+void shm_take(int index);
+void shm_done(struct bsgs_request *request);
+double metrics_now();
+int request_code(struct bsgs_request *request);
+void metrics_request(struct bsgs_request *request);
+void metrics_reply(struct bsgs_connection *connection);
+void io_progress(time_t now);
+
+
+void calcualteindex(struct bsgs_tables *tables,int i,Int *key);
 
 void *thread_process_bsgs(void *vargp);
+void bsgs_process_block(struct bsgs_request *request,Int *base_key,IntGroup *grp,Int *dx,Point *pts);
+struct bsgs_request *bsgs_request_next_block(Int *base_key);
+int bsgs_request_exhausted(struct bsgs_request *request);
+void bsgs_request_chunk(struct bsgs_request *request);
+struct bsgs_request *bsgs_request_new(int targets_count);
+void bsgs_request_free(struct bsgs_request *request);
+int bsgs_request_parse(struct bsgs_request *request,char **tokens,int n);
+void bsgs_request_enqueue(struct bsgs_request *request);
+void bsgs_request_promote();
+void bsgs_request_retire(struct bsgs_request *request);
+void bsgs_request_complete(struct bsgs_request *request);
+void bsgs_request_cancel(struct bsgs_request *request,int reason);
+void bsgs_request_scanned_to(struct bsgs_request *request,Int *to);
+int bsgs_requests_cancel(struct bsgs_connection *connection,const char *tag,int reason);
 void *thread_bPload(void *vargp);
 void *thread_bPload_2blooms(void *vargp);
 
@@ -144,7 +350,8 @@ const char *bsgs_modes[5] = {"secuential","backward","both","random","dance"};
 pthread_t *tid = NULL;
 pthread_mutex_t write_keys;
 pthread_mutex_t write_random;
-pthread_mutex_t mutex_bsgs_thread;
+pthread_mutex_t mutex_scheduler;
+pthread_cond_t cond_scheduler;
 pthread_mutex_t *bPload_mutex;
 
 uint64_t FINISHED_THREADS_COUNTER = 0;
@@ -167,14 +374,13 @@ uint64_t DEBUGCOUNT = 0x400;
 uint64_t u64range;
 
 
-Int BSGSkeyfound;
-
 int FLAGSKIPCHECKSUM = 0;
 int FLAGBSGSMODE = 0;
 int FLAGDEBUG = 0;
 int KFACTOR = 1;
 int MAXLENGTHADDRESS = 20;
 int NTHREADS = 1;
+int MAXACTIVE = 0;
 
 int FLAGSAVEREADFILE = 1;
 int FLAGREADEDFILE1 = 0;
@@ -203,9 +409,56 @@ uint64_t BSGS_BUFFERREGISTERLENGTH = 36;
 /*
 BSGS Variables
 */
-int bsgs_found;
-Point OriginalPointsBSGS;
-bool OriginalPointsBSGScompressed;
+
+/*
+	Admission queue: requests wait in pending until there is a free slot in active,
+	up to MAXACTIVE requests share the NTHREADS workers
+*/
+struct bsgs_request *requests_pending_head = NULL;
+struct bsgs_request *requests_pending_tail = NULL;
+struct bsgs_request **requests_active;
+int requests_active_count = 0;
+int requests_turn = 0;		/* First active request looked by bsgs_request_next_block, the ones with the same workers take turns */
+uint64_t requests_counter = 0;
+
+pthread_mutex_t mutex_completed;
+struct bsgs_request *requests_completed_head = NULL;
+struct bsgs_request *requests_completed_tail = NULL;
+struct bsgs_connection *connections = NULL;
+struct bsgs_tables *tables_current = NULL;
+struct bsgs_tables *tables_loaded = NULL;		/* Ready to replace tables_current, protected by mutex_scheduler */
+struct bsgs_connection *tables_loading = NULL;	/* Connection that sent the RELOAD, only used by the I/O thread */
+int tables_counter = 0;
+char tables_str_N[128];
+char reload_str_N[128];			/* N and K of the RELOAD in progress, the globals of the loader change only if it works */
+int reload_kfactor;
+int tables_load_failed = 0;		/* The RELOAD in progress failed, protected by mutex_scheduler */
+char *ADMIN_PATH = NULL;
+int admin_fd = -1;
+char *SPOOL_DIR = NULL;
+char *UNIX_PATH = NULL;
+char *SHM_NAME = NULL;
+struct bsgsd_shm *shm = NULL;
+
+int METRICS_PORT = 0;
+int metrics_fd = -1;
+struct bsgs_metrics *metrics_threads = NULL;
+thread_local struct bsgs_metrics *metrics_thread = NULL;
+
+int NUMA_MODE = NUMA_NONE;
+thread_local int numa_thread_node = 0;
+/* Only used by the I/O thread */
+const int metrics_codes[5] = {200,400,404,408,499};
+const double metrics_bounds[METRICS_BUCKETS] = {0.01,0.1,1,10,60,600,3600,86400};
+uint64_t metrics_requests[5];
+uint64_t metrics_buckets[METRICS_BUCKETS];
+uint64_t metrics_count = 0;
+double metrics_sum = 0;
+uint64_t metrics_connections = 0;
+int wakeup_pipe[2];
+#if defined(__linux__)
+int io_fd;
+#endif
 
 uint64_t bytes;
 char checksum[32],checksum_backup[32];
@@ -246,7 +499,6 @@ Int int_limits[7];
 
 
 Int BSGS_GROUP_SIZE;
-Int BSGS_CURRENT;
 Int BSGS_R;
 Int BSGS_AUX;
 Int BSGS_N;
@@ -288,39 +540,21 @@ Int n_range_aux;
 Secp256K1 *secp;
 
 int main(int argc, char **argv)	{
-	// File pointers
-	FILE *fd_aux1, *fd_aux2, *fd_aux3;
-
-	// Strings
-	char *hextemp = NULL;
-	char *bf_ptr = NULL;
-	char *bPload_threads_available;
-
-	// Buffers
-	char rawvalue[32];
-
-	// 64-bit integers
-	uint64_t BASE, PERTHREAD_R, itemsbloom, itemsbloom2, itemsbloom3;
-
 	// 32-bit integers
-	uint32_t finished;
-	int readed, c, salir,i,s;
+	int c,i,s;
 
 	// Custom integers
 	Int total, pretotal, debugcount_mpz, seconds, div_pretotal, int_aux, int_r, int_q, int58;
 
-	// Pointers
-	struct bPload *bPload_temp_ptr;
-
-	// Sizes
-	size_t rsize;
-
 	
 	pthread_mutex_init(&write_keys,NULL);
 	pthread_mutex_init(&write_random,NULL);
-	pthread_mutex_init(&mutex_bsgs_thread,NULL);
+	pthread_mutex_init(&mutex_scheduler,NULL);
+	pthread_mutex_init(&mutex_completed,NULL);
+	pthread_cond_init(&cond_scheduler,NULL);
 
 	srand(time(NULL));
+	signal(SIGPIPE,SIG_IGN);	/* A client that close the connection before its reply must not kill the server */
 
 	secp = new Secp256K1();
 	secp->Init();
@@ -358,12 +592,28 @@ int main(int argc, char **argv)	{
 	
 	printf("[+] Version %s, developed by AlbertoBSD\n",version);
 
-	while ((c = getopt(argc, argv, "6hk:n:t:p:i:")) != -1) {
+	while ((c = getopt(argc, argv, "6a:A:d:hk:M:n:t:p:i:r:s:u:")) != -1) {
 		switch(c) {
 			case '6':
 				FLAGSKIPCHECKSUM = 1;
 				fprintf(stderr,"[W] Skipping checksums on files\n");
 			break;
+			case 'a':
+				MAXACTIVE = strtol(optarg,NULL,10);
+				if(MAXACTIVE <= 0)	{
+					MAXACTIVE = 0;
+				}
+			break;
+			case 'A':
+				NUMA_MODE = numa_mode_parse(optarg);
+				if(NUMA_MODE < 0)	{
+					fprintf(stderr,"[E] Unknow NUMA mode %s, use interleave, replicate or none\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+			break;
+			case 'd':
+				SPOOL_DIR = optarg;
+			break;
 			case 'h':
 				// Show help menu
 				menu();
@@ -376,6 +626,13 @@ int main(int argc, char **argv)	{
 				}
 				printf("[+] K factor %i\n",KFACTOR);
 			break;
+			case 'M':
+				METRICS_PORT = (int) strtol(optarg,NULL,10);
+				if(METRICS_PORT <= 0  || METRICS_PORT > 65535 )	{
+					fprintf(stderr,"[E] Invalid metrics port %s\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+			break;
 			case 'n':
 				// Set FLAG_N and str_N
 				FLAG_N = 1;
@@ -398,6 +655,15 @@ int main(int argc, char **argv)	{
 			case 'i':
 				IP = optarg;
 			break;
+			case 'r':
+				ADMIN_PATH = optarg;
+			break;
+			case 's':
+				SHM_NAME = optarg;
+			break;
+			case 'u':
+				UNIX_PATH = optarg;
+			break;
 			default:
 				// Handle unknown options
 				fprintf(stderr,"[E] Unknow opcion -%c\n",c);
@@ -409,6 +675,17 @@ int main(int argc, char **argv)	{
 	
 
 
+	if(MAXACTIVE == 0)	{
+		MAXACTIVE = NTHREADS;
+	}
+	printf("[+] Max active requests : %i\n",MAXACTIVE);
+	requests_active = (struct bsgs_request **) calloc(MAXACTIVE,sizeof(struct bsgs_request *));
+	checkpointer((void *)requests_active,__FILE__,"calloc","requests_active" ,__LINE__ -1 );
+
+	if(NUMA_MODE != NUMA_NONE)	{
+		printf("[+] NUMA nodes : %i, %s\n",numa_nodes_init(),(NUMA_MODE == NUMA_INTERLEAVE) ? "interleave" : "replicate");
+	}
+
 	stride.Set(&ONE);
 	init_generator();
 	
@@ -418,966 +695,1368 @@ int main(int argc, char **argv)	{
 	
 	
 	if(FLAGMODE == MODE_BSGS )	{
+		tables_current = bsgs_tables_load();
+		if(tables_current == NULL)	{
+			exit(EXIT_FAILURE);
+		}
+	}
+	/* 
+		Here we already finish the BSGS setup
+		- Baby table and bloom filters are alrady setup
 		
-		BSGS_N.SetInt32(0);
-		BSGS_M.SetInt32(0);
-		
+	*/
+	
+	/*
+		The workers live as long as the server, they wait in cond_scheduler until there is some active request
+	*/
+	tid = (pthread_t *) calloc(NTHREADS,sizeof(pthread_t));
+	checkpointer((void *)tid,__FILE__,"calloc","tid" ,__LINE__ -1 );
+	metrics_threads = new bsgs_metrics[NTHREADS]();
+	for(i = 0; i < NTHREADS; i++)	{
+		s = pthread_create(&tid[i],NULL,thread_process_bsgs,&metrics_threads[i]);
+		if(s != 0)	{
+			fprintf(stderr,"[E] pthread_create thread_process_bsgs\n");
+			exit(EXIT_FAILURE);
+		}
+		pthread_detach(tid[i]);
+	}
+	
+    int server_fd = -1;
+    struct sockaddr_in address;
+	struct sockaddr_un address_unix;
 
-		BSGS_M.SetInt64(bsgs_m);
+	if(UNIX_PATH != NULL)	{
+		/* Local clients only, same protocols without the TCP stack */
+		if(strlen(UNIX_PATH) >= sizeof(address_unix.sun_path))	{
+			fprintf(stderr,"[E] Unix socket path too long %s\n",UNIX_PATH);
+			exit(EXIT_FAILURE);
+		}
+		if ((server_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+			perror("socket failed");
+			exit(EXIT_FAILURE);
+		}
+		memset(&address_unix,0,sizeof(address_unix));
+		address_unix.sun_family = AF_UNIX;
+		strcpy(address_unix.sun_path,UNIX_PATH);
+		unlink(UNIX_PATH);
+		if (bind(server_fd, (struct sockaddr *)&address_unix, sizeof(address_unix)) < 0) {
+			perror("bind failed");
+			exit(EXIT_FAILURE);
+		}
+		printf("[+] Listening in %s\n",UNIX_PATH);
+	}
+	else if(SPOOL_DIR == NULL)	{
+		// Creating socket file descriptor
+		if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+			perror("socket failed");
+			exit(EXIT_FAILURE);
+		}
 
+		// Setting socket options
+		int opt = 1;
+		if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
+			perror("setsockopt SO_REUSEADDR failed");
+			exit(EXIT_FAILURE);
+		}
+#ifdef SO_REUSEPORT
+		if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt))) {
+			perror("setsockopt SO_REUSEPORT failed");
+			exit(EXIT_FAILURE);
+		}
+#endif
 
-		if(FLAG_N)	{	//Custom N by the -n param
-						
-			/* Here we need to validate if the given string is a valid hexadecimal number or a base 10 number*/
-			
-			/* Now the conversion*/
-			if(str_N[0] == '0' && (str_N[1] == 'x' || str_N[1] == 'X'))	{	/*We expected a hexadecimal value after 0x  -> str_N +2 */
-				BSGS_N.SetBase16((char*)(str_N+2));
-			}
-			else	{
-				BSGS_N.SetBase10(str_N);
-			}
-			
+		// Setting address parameters
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = inet_addr(IP);
+		address.sin_port = htons(port);
+		// Binding socket to address
+		if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
+			perror("bind failed");
+			exit(EXIT_FAILURE);
+		}
+		printf("[+] Listening in %s:%i\n",IP,port);
+	}
+	if(server_fd >= 0)	{
+		// Listening for incoming connections
+		if (listen(server_fd, SOMAXCONN) < 0) {
+			perror("listen failed");
+			exit(EXIT_FAILURE);
+		}
+		fcntl(server_fd,F_SETFL,fcntl(server_fd,F_GETFL,0) | O_NONBLOCK);
+	}
+	if(ADMIN_PATH != NULL)	{
+		/* Same protocols with RELOAD, the file mode is the access control */
+		if(strlen(ADMIN_PATH) >= sizeof(address_unix.sun_path))	{
+			fprintf(stderr,"[E] Unix socket path too long %s\n",ADMIN_PATH);
+			exit(EXIT_FAILURE);
+		}
+		if ((admin_fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+			perror("socket failed");
+			exit(EXIT_FAILURE);
+		}
+		memset(&address_unix,0,sizeof(address_unix));
+		address_unix.sun_family = AF_UNIX;
+		strcpy(address_unix.sun_path,ADMIN_PATH);
+		unlink(ADMIN_PATH);
+		if (bind(admin_fd, (struct sockaddr *)&address_unix, sizeof(address_unix)) < 0 || chmod(ADMIN_PATH,0600) != 0 || listen(admin_fd, SOMAXCONN) < 0) {
+			perror("admin bind failed");
+			exit(EXIT_FAILURE);
+		}
+		fcntl(admin_fd,F_SETFL,fcntl(admin_fd,F_GETFL,0) | O_NONBLOCK);
+		printf("[+] Admin socket in %s\n",ADMIN_PATH);
+	}
+	if(METRICS_PORT != 0)	{
+		/* Prometheus text format, any path of this port gets the same page */
+		if ((metrics_fd = socket(AF_INET, SOCK_STREAM, 0)) < 0) {
+			perror("socket failed");
+			exit(EXIT_FAILURE);
+		}
+		int opt = 1;
+		if (setsockopt(metrics_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
+			perror("setsockopt SO_REUSEADDR failed");
+			exit(EXIT_FAILURE);
 		}
-		else	{	//Default N
-			BSGS_N.SetInt64((uint64_t)0x100000000000);
+		address.sin_family = AF_INET;
+		address.sin_addr.s_addr = inet_addr(IP);
+		address.sin_port = htons(METRICS_PORT);
+		if (bind(metrics_fd, (struct sockaddr *)&address, sizeof(address)) < 0 || listen(metrics_fd, SOMAXCONN) < 0) {
+			perror("metrics bind failed");
+			exit(EXIT_FAILURE);
 		}
+		fcntl(metrics_fd,F_SETFL,fcntl(metrics_fd,F_GETFL,0) | O_NONBLOCK);
+		printf("[+] Metrics in http://%s:%i/metrics\n",IP,METRICS_PORT);
+	}
+
+	/*
+		The workers write one byte in wakeup_pipe when some request ends, so the I/O thread send its reply
+	*/
+	if(pipe(wakeup_pipe) != 0)	{
+		perror("pipe failed");
+		exit(EXIT_FAILURE);
+	}
+	fcntl(wakeup_pipe[0],F_SETFL,fcntl(wakeup_pipe[0],F_GETFL,0) | O_NONBLOCK);
+	fcntl(wakeup_pipe[1],F_SETFL,fcntl(wakeup_pipe[1],F_GETFL,0) | O_NONBLOCK);
+
+	if(SPOOL_DIR != NULL)	{
+		spool_init();
+	}
+	if(SHM_NAME != NULL)	{
+		shm_init();
+	}
+	io_loop(server_fd);
+	close(server_fd);
+}
+
+/*
+	Make or read the BSGS tables for KFACTOR and str_N, the same files of keyhunt.
+	The loader works in the globals (bloom_bP, bPtable, BSGS_M ...) with the bPload threads and at the end
+	copy them to a new generation, the workers only use the generation of their request.
+	Only one load at time
+*/
+struct bsgs_tables *bsgs_tables_load()	{
+	FILE *fd_aux1, *fd_aux2, *fd_aux3;
+	char *hextemp = NULL;
+	char *bf_ptr = NULL;
+	char *bPload_threads_available;
+	char rawvalue[32];
+	uint64_t BASE, PERTHREAD_R, itemsbloom, itemsbloom2, itemsbloom3;
+	uint32_t finished;
+	int readed, salir,i,s;
+	struct bPload *bPload_temp_ptr;
+	pthread_t *tid;
+	size_t rsize;
+	struct bsgs_tables *tables;
+	double load_start = metrics_now();
+
+	/* The arrays of the previous load belong to its generation, bsgs_tables_discard only frees the new ones */
+	bloom_bP = NULL;
+	bloom_bPx2nd = NULL;
+	bloom_bPx3rd = NULL;
+	bloom_bP_checksums = NULL;
+	bloom_bPx2nd_checksums = NULL;
+	bloom_bPx3rd_checksums = NULL;
+	bloom_bP_mutex = NULL;
+	bloom_bPx2nd_mutex = NULL;
+	bloom_bPx3rd_mutex = NULL;
+	bPtable = NULL;
+
+	FLAGREADEDFILE1 = 0;
+	FLAGREADEDFILE2 = 0;
+	FLAGREADEDFILE3 = 0;
+	FLAGREADEDFILE4 = 0;
+	FLAGUPDATEFILE1 = 0;
+	
+	BSGS_N.SetInt32(0);
+	BSGS_M.SetInt32(0);
 		
-		if(BSGS_N.HasSqrt())	{	//If the root is exact
-			BSGS_M.Set(&BSGS_N);
-			BSGS_M.ModSqrt();
+
+	BSGS_M.SetInt64(bsgs_m);
+
+
+	if(FLAG_N)	{	//Custom N by the -n param
+						
+		/* Here we need to validate if the given string is a valid hexadecimal number or a base 10 number*/
+			
+		/* Now the conversion*/
+		if(str_N[0] == '0' && (str_N[1] == 'x' || str_N[1] == 'X'))	{	/*We expected a hexadecimal value after 0x  -> str_N +2 */
+			BSGS_N.SetBase16((char*)(str_N+2));
 		}
 		else	{
-			fprintf(stderr,"[E] -n param doesn't have exact square root\n");
-			exit(0);
+			BSGS_N.SetBase10(str_N);
 		}
+		
+	}
+	else	{	//Default N
+		BSGS_N.SetInt64((uint64_t)0x100000000000);
+	}
 
-		BSGS_AUX.Set(&BSGS_M);
-		BSGS_AUX.Mod(&BSGS_GROUP_SIZE);	
+	if(BSGS_N.HasSqrt())	{	//If the root is exact
+		BSGS_M.Set(&BSGS_N);
+		BSGS_M.ModSqrt();
+	}
+	else	{
+		fprintf(stderr,"[E] -n param doesn't have exact square root\n");
+		return bsgs_tables_discard(NULL);
+	}
 		
-		if(!BSGS_AUX.IsZero()){ //If M is not divisible by  BSGS_GROUP_SIZE (1024) 
-			hextemp = BSGS_GROUP_SIZE.GetBase10();
-			fprintf(stderr,"[E] M value is not divisible by %s\n",hextemp);
-			exit(0);
-		}
+	BSGS_AUX.Set(&BSGS_M);
+	BSGS_AUX.Mod(&BSGS_GROUP_SIZE);	
 	
-		/*
-	M	2199023255552
-		109951162777.6
-	M2	109951162778
-		5497558138.9
-	M3	5497558139
-		*/
+	if(!BSGS_AUX.IsZero()){ //If M is not divisible by  BSGS_GROUP_SIZE (1024) 
+		hextemp = BSGS_GROUP_SIZE.GetBase10();
+		fprintf(stderr,"[E] M value is not divisible by %s\n",hextemp);
+		return bsgs_tables_discard(NULL);
+	}
 
-		BSGS_M.Mult((uint64_t)KFACTOR);
-		BSGS_AUX.SetInt32(32);
-		BSGS_R.Set(&BSGS_M);
-		BSGS_R.Mod(&BSGS_AUX);
-		BSGS_M2.Set(&BSGS_M);
-		BSGS_M2.Div(&BSGS_AUX);
+	/*
+M	2199023255552
+	109951162777.6
+M2	109951162778
+	5497558138.9
+M3	5497558139
+	*/
 
-		if(!BSGS_R.IsZero())	{ /* If BSGS_M modulo 32 is not 0*/
-			BSGS_M2.AddOne();
-		}
+	BSGS_M.Mult((uint64_t)KFACTOR);
+	BSGS_AUX.SetInt32(32);
+	BSGS_R.Set(&BSGS_M);
+	BSGS_R.Mod(&BSGS_AUX);
+	BSGS_M2.Set(&BSGS_M);
+	BSGS_M2.Div(&BSGS_AUX);
 		
-		BSGS_M_double.SetInt32(2);
-		BSGS_M_double.Mult(&BSGS_M);
+	if(!BSGS_R.IsZero())	{ /* If BSGS_M modulo 32 is not 0*/
+		BSGS_M2.AddOne();
+	}
+	
+	BSGS_M_double.SetInt32(2);
+	BSGS_M_double.Mult(&BSGS_M);
 		
 		
-		BSGS_M2_double.SetInt32(2);
-		BSGS_M2_double.Mult(&BSGS_M2);
+	BSGS_M2_double.SetInt32(2);
+	BSGS_M2_double.Mult(&BSGS_M2);
 		
-		BSGS_R.Set(&BSGS_M2);
-		BSGS_R.Mod(&BSGS_AUX);
+	BSGS_R.Set(&BSGS_M2);
+	BSGS_R.Mod(&BSGS_AUX);
 		
 		
 		
-		BSGS_M3.Set(&BSGS_M2);
-		BSGS_M3.Div(&BSGS_AUX);
+	BSGS_M3.Set(&BSGS_M2);
+	BSGS_M3.Div(&BSGS_AUX);
 		
-		if(!BSGS_R.IsZero())	{ /* If BSGS_M2 modulo 32 is not 0*/
-			BSGS_M3.AddOne();
-		}
+	if(!BSGS_R.IsZero())	{ /* If BSGS_M2 modulo 32 is not 0*/
+		BSGS_M3.AddOne();
+	}
 		
-		BSGS_M3_double.SetInt32(2);
-		BSGS_M3_double.Mult(&BSGS_M3);
+	BSGS_M3_double.SetInt32(2);
+	BSGS_M3_double.Mult(&BSGS_M3);
 		
-		bsgs_m2 =  BSGS_M2.GetInt64();
-		bsgs_m3 =  BSGS_M3.GetInt64();
+	bsgs_m2 =  BSGS_M2.GetInt64();
+	bsgs_m3 =  BSGS_M3.GetInt64();
 		
-		BSGS_AUX.Set(&BSGS_N);
-		BSGS_AUX.Div(&BSGS_M);
+	BSGS_AUX.Set(&BSGS_N);
+	BSGS_AUX.Div(&BSGS_M);
 		
-		BSGS_R.Set(&BSGS_N);
-		BSGS_R.Mod(&BSGS_M);
+	BSGS_R.Set(&BSGS_N);
+	BSGS_R.Mod(&BSGS_M);
 
-		if(!BSGS_R.IsZero())	{ /* if BSGS_N modulo BSGS_M is not 0*/
-			BSGS_N.Set(&BSGS_M);
-			BSGS_N.Mult(&BSGS_AUX);
-		}
+	if(!BSGS_R.IsZero())	{ /* if BSGS_N modulo BSGS_M is not 0*/
+		BSGS_N.Set(&BSGS_M);
+		BSGS_N.Mult(&BSGS_AUX);
+	}
 
-		bsgs_m = BSGS_M.GetInt64();
-		bsgs_aux = BSGS_AUX.GetInt64();
+	bsgs_m = BSGS_M.GetInt64();
+	bsgs_aux = BSGS_AUX.GetInt64();
 		
 		
-		hextemp = BSGS_N.GetBase16();
-		printf("[+] N = 0x%s\n",hextemp);
-		bsgs_m = BSGS_M.GetInt64();
-		free(hextemp);
+	hextemp = BSGS_N.GetBase16();
+	printf("[+] N = 0x%s\n",hextemp);
+	bsgs_m = BSGS_M.GetInt64();
+	free(hextemp);
 
 
 		
-		if(((uint64_t)(bsgs_m/256)) > 10000)	{
-			itemsbloom = (uint64_t)(bsgs_m / 256);
-			if(bsgs_m % 256 != 0 )	{
-				itemsbloom++;
-			}
-		}
-		else{
-			itemsbloom = 1000;
-		}
-		
-		if(((uint64_t)(bsgs_m2/256)) > 1000)	{
-			itemsbloom2 = (uint64_t)(bsgs_m2 / 256);
-			if(bsgs_m2 % 256 != 0)	{
-				itemsbloom2++;
-			}
+	if(((uint64_t)(bsgs_m/256)) > 10000)	{
+		itemsbloom = (uint64_t)(bsgs_m / 256);
+		if(bsgs_m % 256 != 0 )	{
+			itemsbloom++;
 		}
-		else	{
-			itemsbloom2 = 1000;
+	}
+	else{
+		itemsbloom = 1000;
+	}
+	
+	if(((uint64_t)(bsgs_m2/256)) > 1000)	{
+		itemsbloom2 = (uint64_t)(bsgs_m2 / 256);
+		if(bsgs_m2 % 256 != 0)	{
+			itemsbloom2++;
 		}
+	}
+	else	{
+		itemsbloom2 = 1000;
+	}
 		
-		if(((uint64_t)(bsgs_m3/256)) > 1000)	{
-			itemsbloom3 = (uint64_t)(bsgs_m3/256);
-			if(bsgs_m3 % 256 != 0 )	{
-				itemsbloom3++;
-			}
-		}
-		else	{
-			itemsbloom3 = 1000;
+	if(((uint64_t)(bsgs_m3/256)) > 1000)	{
+		itemsbloom3 = (uint64_t)(bsgs_m3/256);
+		if(bsgs_m3 % 256 != 0 )	{
+			itemsbloom3++;
 		}
+	}
+	else	{
+		itemsbloom3 = 1000;
+	}
 		
-		printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m);
-		bloom_bP = (struct bloom*)calloc(256,sizeof(struct bloom));
-		checkpointer((void *)bloom_bP,__FILE__,"calloc","bloom_bP" ,__LINE__ -1 );
-		bloom_bP_checksums = (struct checksumsha256*)calloc(256,sizeof(struct checksumsha256));
-		checkpointer((void *)bloom_bP_checksums,__FILE__,"calloc","bloom_bP_checksums" ,__LINE__ -1 );
+	printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m);
+	bloom_bP = (struct bloom*)calloc(256,sizeof(struct bloom));
+	if(!checkpointer_load((void *)bloom_bP,__FILE__,"calloc","bloom_bP" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bP_checksums = (struct checksumsha256*)calloc(256,sizeof(struct checksumsha256));
+	if(!checkpointer_load((void *)bloom_bP_checksums,__FILE__,"calloc","bloom_bP_checksums" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
 		
-		bloom_bP_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
-		checkpointer((void *)bloom_bP_mutex,__FILE__,"calloc","bloom_bP_mutex" ,__LINE__ -1 );
+	bloom_bP_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
+	if(!checkpointer_load((void *)bloom_bP_mutex,__FILE__,"calloc","bloom_bP_mutex" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
 		
 
-		fflush(stdout);
-		bloom_bP_totalbytes = 0;
-		for(i=0; i< 256; i++)	{
-			pthread_mutex_init(&bloom_bP_mutex[i],NULL);
-			if(bloom_init2(&bloom_bP[i],itemsbloom,0.000001)	== 1){
-				fprintf(stderr,"[E] error bloom_init _ %i\n",i);
-				exit(0);
-			}
-			bloom_bP_totalbytes += bloom_bP[i].bytes;
+	fflush(stdout);
+	bloom_bP_totalbytes = 0;
+	for(i=0; i< 256; i++)	{
+		pthread_mutex_init(&bloom_bP_mutex[i],NULL);
+		if(bloom_init2(&bloom_bP[i],itemsbloom,0.000001)	== 1){
+			fprintf(stderr,"[E] error bloom_init _ %i\n",i);
+			return bsgs_tables_discard(NULL);
+		}
+		if(NUMA_MODE != NUMA_NONE)	{
+			numa_interleave_range(bloom_bP[i].bf,bloom_bP[i].bytes);
 		}
-		printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP_totalbytes/(float)(uint64_t)1048576));
+		bloom_bP_totalbytes += bloom_bP[i].bytes;
+	}
+	printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP_totalbytes/(float)(uint64_t)1048576));
 
 
-		printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m2);
+	printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m2);
 		
-		bloom_bPx2nd_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
-		checkpointer((void *)bloom_bPx2nd_mutex,__FILE__,"calloc","bloom_bPx2nd_mutex" ,__LINE__ -1 );
-		bloom_bPx2nd = (struct bloom*)calloc(256,sizeof(struct bloom));
-		checkpointer((void *)bloom_bPx2nd,__FILE__,"calloc","bloom_bPx2nd" ,__LINE__ -1 );
-		bloom_bPx2nd_checksums = (struct checksumsha256*) calloc(256,sizeof(struct checksumsha256));
-		checkpointer((void *)bloom_bPx2nd_checksums,__FILE__,"calloc","bloom_bPx2nd_checksums" ,__LINE__ -1 );
-		bloom_bP2_totalbytes = 0;
-		for(i=0; i< 256; i++)	{
-			pthread_mutex_init(&bloom_bPx2nd_mutex[i],NULL);
-			if(bloom_init2(&bloom_bPx2nd[i],itemsbloom2,0.000001)	== 1){
-				fprintf(stderr,"[E] error bloom_init _ %i\n",i);
-				exit(0);
-			}
-			bloom_bP2_totalbytes += bloom_bPx2nd[i].bytes;
+	bloom_bPx2nd_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
+	if(!checkpointer_load((void *)bloom_bPx2nd_mutex,__FILE__,"calloc","bloom_bPx2nd_mutex" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bPx2nd = (struct bloom*)calloc(256,sizeof(struct bloom));
+	if(!checkpointer_load((void *)bloom_bPx2nd,__FILE__,"calloc","bloom_bPx2nd" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bPx2nd_checksums = (struct checksumsha256*) calloc(256,sizeof(struct checksumsha256));
+	if(!checkpointer_load((void *)bloom_bPx2nd_checksums,__FILE__,"calloc","bloom_bPx2nd_checksums" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bP2_totalbytes = 0;
+	for(i=0; i< 256; i++)	{
+		pthread_mutex_init(&bloom_bPx2nd_mutex[i],NULL);
+		if(bloom_init2(&bloom_bPx2nd[i],itemsbloom2,0.000001)	== 1){
+			fprintf(stderr,"[E] error bloom_init _ %i\n",i);
+			return bsgs_tables_discard(NULL);
 		}
-		printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP2_totalbytes/(float)(uint64_t)1048576));
+		if(NUMA_MODE != NUMA_NONE)	{
+			numa_interleave_range(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes);
+		}
+		bloom_bP2_totalbytes += bloom_bPx2nd[i].bytes;
+	}
+	printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP2_totalbytes/(float)(uint64_t)1048576));
 		
 
-		bloom_bPx3rd_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
-		checkpointer((void *)bloom_bPx3rd_mutex,__FILE__,"calloc","bloom_bPx3rd_mutex" ,__LINE__ -1 );
-		bloom_bPx3rd = (struct bloom*)calloc(256,sizeof(struct bloom));
-		checkpointer((void *)bloom_bPx3rd,__FILE__,"calloc","bloom_bPx3rd" ,__LINE__ -1 );
-		bloom_bPx3rd_checksums = (struct checksumsha256*) calloc(256,sizeof(struct checksumsha256));
-		checkpointer((void *)bloom_bPx3rd_checksums,__FILE__,"calloc","bloom_bPx3rd_checksums" ,__LINE__ -1 );
+	bloom_bPx3rd_mutex = (pthread_mutex_t*) calloc(256,sizeof(pthread_mutex_t));
+	if(!checkpointer_load((void *)bloom_bPx3rd_mutex,__FILE__,"calloc","bloom_bPx3rd_mutex" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bPx3rd = (struct bloom*)calloc(256,sizeof(struct bloom));
+	if(!checkpointer_load((void *)bloom_bPx3rd,__FILE__,"calloc","bloom_bPx3rd" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	bloom_bPx3rd_checksums = (struct checksumsha256*) calloc(256,sizeof(struct checksumsha256));
+	if(!checkpointer_load((void *)bloom_bPx3rd_checksums,__FILE__,"calloc","bloom_bPx3rd_checksums" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
 		
-		printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m3);
-		bloom_bP3_totalbytes = 0;
-		for(i=0; i< 256; i++)	{
-			pthread_mutex_init(&bloom_bPx3rd_mutex[i],NULL);
-			if(bloom_init2(&bloom_bPx3rd[i],itemsbloom3,0.000001)	== 1){
-				fprintf(stderr,"[E] error bloom_init %i\n",i);
-				exit(0);
-			}
-			bloom_bP3_totalbytes += bloom_bPx3rd[i].bytes;
+	printf("[+] Bloom filter for %" PRIu64 " elements ",bsgs_m3);
+	bloom_bP3_totalbytes = 0;
+	for(i=0; i< 256; i++)	{
+		pthread_mutex_init(&bloom_bPx3rd_mutex[i],NULL);
+		if(bloom_init2(&bloom_bPx3rd[i],itemsbloom3,0.000001)	== 1){
+			fprintf(stderr,"[E] error bloom_init %i\n",i);
+			return bsgs_tables_discard(NULL);
+		}
+		if(NUMA_MODE != NUMA_NONE)	{
+			numa_interleave_range(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes);
 		}
-		printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP3_totalbytes/(float)(uint64_t)1048576));
+		bloom_bP3_totalbytes += bloom_bPx3rd[i].bytes;
+	}
+	printf(": %.2f MB\n",(float)((float)(uint64_t)bloom_bP3_totalbytes/(float)(uint64_t)1048576));
 
 
 
 
 
-		BSGS_MP = secp->ComputePublicKey(&BSGS_M);
-		BSGS_MP_double = secp->ComputePublicKey(&BSGS_M_double);
-		BSGS_MP2 = secp->ComputePublicKey(&BSGS_M2);
-		BSGS_MP2_double = secp->ComputePublicKey(&BSGS_M2_double);
-		BSGS_MP3 = secp->ComputePublicKey(&BSGS_M3);
-		BSGS_MP3_double = secp->ComputePublicKey(&BSGS_M3_double);
+	BSGS_MP = secp->ComputePublicKey(&BSGS_M);
+	BSGS_MP_double = secp->ComputePublicKey(&BSGS_M_double);
+	BSGS_MP2 = secp->ComputePublicKey(&BSGS_M2);
+	BSGS_MP2_double = secp->ComputePublicKey(&BSGS_M2_double);
+	BSGS_MP3 = secp->ComputePublicKey(&BSGS_M3);
+	BSGS_MP3_double = secp->ComputePublicKey(&BSGS_M3_double);
 		
-		BSGS_AMP2.reserve(32);
-		BSGS_AMP3.reserve(32);
+	BSGS_AMP2.resize(32);
+	BSGS_AMP3.resize(32);
 		
-		GSn.reserve(CPU_GRP_SIZE/2);
+	GSn.resize(CPU_GRP_SIZE/2);
 
-		i= 0;
+	i= 0;
 
 
-		/* New aMP table just to keep the same code of JLP */
-		/* Auxiliar Points to speed up calculations for the main bloom filter check */
+	/* New aMP table just to keep the same code of JLP */
+	/* Auxiliar Points to speed up calculations for the main bloom filter check */
 		
-		Point bsP = secp->Negation(BSGS_MP_double);
-		Point g = bsP;
-		GSn[0] = g;
+	Point bsP = secp->Negation(BSGS_MP_double);
+	Point g = bsP;
+	GSn[0] = g;
 		
 
-		g = secp->DoubleDirect(g);
-		GSn[1] = g;
-		
+	g = secp->DoubleDirect(g);
+	GSn[1] = g;
 		
-		for(int i = 2; i < CPU_GRP_SIZE / 2; i++) {
-			g = secp->AddDirect(g,bsP);
-			GSn[i] = g;
-		}
 		
-		/* For next center point */
-		_2GSn = secp->DoubleDirect(GSn[CPU_GRP_SIZE / 2 - 1]);
+	for(int i = 2; i < CPU_GRP_SIZE / 2; i++) {
+		g = secp->AddDirect(g,bsP);
+		GSn[i] = g;
+	}
 		
+	/* For next center point */
+	_2GSn = secp->DoubleDirect(GSn[CPU_GRP_SIZE / 2 - 1]);
 		
-		i = 0;
-		point_temp.Set(BSGS_MP2);
-		BSGS_AMP2[0] = secp->Negation(point_temp);
-		BSGS_AMP2[0].Reduce();
-		point_temp.Set(BSGS_MP2_double);
-		point_temp = secp->Negation(point_temp);
 		
+	i = 0;
+	point_temp.Set(BSGS_MP2);
+	BSGS_AMP2[0] = secp->Negation(point_temp);
+	BSGS_AMP2[0].Reduce();
+	point_temp.Set(BSGS_MP2_double);
+	point_temp = secp->Negation(point_temp);
 		
-		for(i = 1; i < 32; i++)	{
-			BSGS_AMP2[i] = secp->AddDirect(BSGS_AMP2[i-1],point_temp);
-			BSGS_AMP2[i].Reduce();
-		}
 		
-		i  = 0;
-		point_temp.Set(BSGS_MP3);
-		BSGS_AMP3[0] = secp->Negation(point_temp);
-		BSGS_AMP3[0].Reduce();
-		point_temp.Set(BSGS_MP3_double);
-		point_temp = secp->Negation(point_temp);
-
-		for(i = 1; i < 32; i++)	{
-			BSGS_AMP3[i] = secp->AddDirect(BSGS_AMP3[i-1],point_temp);
-			BSGS_AMP3[i].Reduce();
-		}
+	for(i = 1; i < 32; i++)	{
+		BSGS_AMP2[i] = secp->AddDirect(BSGS_AMP2[i-1],point_temp);
+		BSGS_AMP2[i].Reduce();
+	}
+	
+	i  = 0;
+	point_temp.Set(BSGS_MP3);
+	BSGS_AMP3[0] = secp->Negation(point_temp);
+	BSGS_AMP3[0].Reduce();
+	point_temp.Set(BSGS_MP3_double);
+	point_temp = secp->Negation(point_temp);
+
+	for(i = 1; i < 32; i++)	{
+		BSGS_AMP3[i] = secp->AddDirect(BSGS_AMP3[i-1],point_temp);
+		BSGS_AMP3[i].Reduce();
+	}
 
-		bytes = (uint64_t)bsgs_m3 * (uint64_t) sizeof(struct bsgs_xvalue);
-		printf("[+] Allocating %.2f MB for %" PRIu64  " bP Points\n",(double)(bytes/1048576),bsgs_m3);
-		
-		bPtable = (struct bsgs_xvalue*) malloc(bytes);
-		checkpointer((void *)bPtable,__FILE__,"malloc","bPtable" ,__LINE__ -1 );
-		memset(bPtable,0,bytes);
-		
-		if(FLAGSAVEREADFILE)	{
-			/*Reading file for 1st bloom filter */
+	bytes = (uint64_t)bsgs_m3 * (uint64_t) sizeof(struct bsgs_xvalue);
+	printf("[+] Allocating %.2f MB for %" PRIu64  " bP Points\n",(double)(bytes/1048576),bsgs_m3);
+	
+	bPtable = (struct bsgs_xvalue*) malloc(bytes);
+	if(!checkpointer_load((void *)bPtable,__FILE__,"malloc","bPtable" ,__LINE__ -1 ))	{
+		return bsgs_tables_discard(NULL);
+	}
+	if(NUMA_MODE != NUMA_NONE)	{
+		/* Before the first touch, so the threads of bPload don't put all the pages in its own node */
+		numa_interleave_range(bPtable,bytes);
+	}
+	memset(bPtable,0,bytes);
+	
+	if(FLAGSAVEREADFILE)	{
+		/*Reading file for 1st bloom filter */
 
-			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_4_%" PRIu64 ".blm",bsgs_m);
+		snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_4_%" PRIu64 ".blm",bsgs_m);
+		fd_aux1 = fopen(buffer_bloom_file,"rb");
+		if(fd_aux1 != NULL)	{
+			printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
+			fflush(stdout);
+			for(i = 0; i < 256;i++)	{
+				bf_ptr = (char*) bloom_bP[i].bf;	/*We need to save the current bf pointer*/
+				readed = fread(&bloom_bP[i],sizeof(struct bloom),1,fd_aux1);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					bloom_bP[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+					return bsgs_tables_discard(fd_aux1);
+				}
+				bloom_bP[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+				readed = fread(bloom_bP[i].bf,bloom_bP[i].bytes,1,fd_aux1);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux1);
+				}
+				readed = fread(&bloom_bP_checksums[i],sizeof(struct checksumsha256),1,fd_aux1);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux1);
+				}
+				memset(rawvalue,0,32);
+				if(FLAGSKIPCHECKSUM == 0)	{
+					sha256((uint8_t*)bloom_bP[i].bf,bloom_bP[i].bytes,(uint8_t*)rawvalue);
+					if(memcmp(bloom_bP_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bP_checksums[i].backup,rawvalue,32) != 0 )	{	/* Verification */
+						fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux1);
+					}
+				}
+				if(i % 64 == 0 )	{
+					printf(".");
+					fflush(stdout);
+				}
+			}
+			printf(" Done!\n");
+			fclose(fd_aux1);
+			memset(buffer_bloom_file,0,1024);
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_3_%" PRIu64 ".blm",bsgs_m);
+			fd_aux1 = fopen(buffer_bloom_file,"rb");
+			if(fd_aux1 != NULL)	{
+				printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
+				fclose(fd_aux1);
+			}
+			FLAGREADEDFILE1 = 1;
+		}
+		else	{	/*Checking for old file    keyhunt_bsgs_3_   */
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_3_%" PRIu64 ".blm",bsgs_m);
 			fd_aux1 = fopen(buffer_bloom_file,"rb");
 			if(fd_aux1 != NULL)	{
 				printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
 				fflush(stdout);
 				for(i = 0; i < 256;i++)	{
 					bf_ptr = (char*) bloom_bP[i].bf;	/*We need to save the current bf pointer*/
-					readed = fread(&bloom_bP[i],sizeof(struct bloom),1,fd_aux1);
+					readed = fread(&oldbloom_bP,sizeof(struct oldbloom),1,fd_aux1);
+					
+					
 					if(readed != 1)	{
 						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
+						return bsgs_tables_discard(fd_aux1);
 					}
+					memcpy(&bloom_bP[i],&oldbloom_bP,sizeof(struct bloom));//We only need to copy the part data to the new bloom size, not from the old size
 					bloom_bP[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+					
 					readed = fread(bloom_bP[i].bf,bloom_bP[i].bytes,1,fd_aux1);
 					if(readed != 1)	{
 						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					readed = fread(&bloom_bP_checksums[i],sizeof(struct checksumsha256),1,fd_aux1);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
+						return bsgs_tables_discard(fd_aux1);
 					}
+					memcpy(bloom_bP_checksums[i].data,oldbloom_bP.checksum,32);
+					memcpy(bloom_bP_checksums[i].backup,oldbloom_bP.checksum_backup,32);
 					memset(rawvalue,0,32);
 					if(FLAGSKIPCHECKSUM == 0)	{
 						sha256((uint8_t*)bloom_bP[i].bf,bloom_bP[i].bytes,(uint8_t*)rawvalue);
 						if(memcmp(bloom_bP_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bP_checksums[i].backup,rawvalue,32) != 0 )	{	/* Verification */
 							fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
-							exit(0);
+							return bsgs_tables_discard(fd_aux1);
 						}
 					}
-					if(i % 64 == 0 )	{
+					if(i % 32 == 0 )	{
 						printf(".");
 						fflush(stdout);
 					}
 				}
 				printf(" Done!\n");
 				fclose(fd_aux1);
-				memset(buffer_bloom_file,0,1024);
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_3_%" PRIu64 ".blm",bsgs_m);
-				fd_aux1 = fopen(buffer_bloom_file,"rb");
-				if(fd_aux1 != NULL)	{
-					printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
-					fclose(fd_aux1);
-				}
+				FLAGUPDATEFILE1 = 1;	/* Flag to migrate the data to the new File keyhunt_bsgs_4_ */
 				FLAGREADEDFILE1 = 1;
+				
 			}
-			else	{	/*Checking for old file    keyhunt_bsgs_3_   */
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_3_%" PRIu64 ".blm",bsgs_m);
-				fd_aux1 = fopen(buffer_bloom_file,"rb");
-				if(fd_aux1 != NULL)	{
-					printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
-					fflush(stdout);
-					for(i = 0; i < 256;i++)	{
-						bf_ptr = (char*) bloom_bP[i].bf;	/*We need to save the current bf pointer*/
-						readed = fread(&oldbloom_bP,sizeof(struct oldbloom),1,fd_aux1);
-						
-						
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						memcpy(&bloom_bP[i],&oldbloom_bP,sizeof(struct bloom));//We only need to copy the part data to the new bloom size, not from the old size
-						bloom_bP[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
-						
-						readed = fread(bloom_bP[i].bf,bloom_bP[i].bytes,1,fd_aux1);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						memcpy(bloom_bP_checksums[i].data,oldbloom_bP.checksum,32);
-						memcpy(bloom_bP_checksums[i].backup,oldbloom_bP.checksum_backup,32);
-						memset(rawvalue,0,32);
-						if(FLAGSKIPCHECKSUM == 0)	{
-							sha256((uint8_t*)bloom_bP[i].bf,bloom_bP[i].bytes,(uint8_t*)rawvalue);
-							if(memcmp(bloom_bP_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bP_checksums[i].backup,rawvalue,32) != 0 )	{	/* Verification */
-								fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
-								exit(0);
-							}
-						}
-						if(i % 32 == 0 )	{
-							printf(".");
-							fflush(stdout);
-						}
-					}
-					printf(" Done!\n");
-					fclose(fd_aux1);
-					FLAGUPDATEFILE1 = 1;	/* Flag to migrate the data to the new File keyhunt_bsgs_4_ */
-					FLAGREADEDFILE1 = 1;
-					
-				}
-				else	{
-					FLAGREADEDFILE1 = 0;
-					//Flag to make the new file
-				}
+			else	{
+				FLAGREADEDFILE1 = 0;
+				//Flag to make the new file
 			}
-			
-			/*Reading file for 2nd bloom filter */
-			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_6_%" PRIu64 ".blm",bsgs_m2);
-			fd_aux2 = fopen(buffer_bloom_file,"rb");
-			if(fd_aux2 != NULL)	{
-				printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
-				fflush(stdout);
-				for(i = 0; i < 256;i++)	{
-					bf_ptr = (char*) bloom_bPx2nd[i].bf;	/*We need to save the current bf pointer*/
-					readed = fread(&bloom_bPx2nd[i],sizeof(struct bloom),1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
+		}
+		
+		/*Reading file for 2nd bloom filter */
+		snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_6_%" PRIu64 ".blm",bsgs_m2);
+		fd_aux2 = fopen(buffer_bloom_file,"rb");
+		if(fd_aux2 != NULL)	{
+			printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
+			fflush(stdout);
+			for(i = 0; i < 256;i++)	{
+				bf_ptr = (char*) bloom_bPx2nd[i].bf;	/*We need to save the current bf pointer*/
+				readed = fread(&bloom_bPx2nd[i],sizeof(struct bloom),1,fd_aux2);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
 					bloom_bPx2nd[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
-					readed = fread(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					readed = fread(&bloom_bPx2nd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					memset(rawvalue,0,32);
-					if(FLAGSKIPCHECKSUM == 0)	{
-						sha256((uint8_t*)bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,(uint8_t*)rawvalue);
-						if(memcmp(bloom_bPx2nd_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bPx2nd_checksums[i].backup,rawvalue,32) != 0 )	{		/* Verification */
-							fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
-							exit(0);
-						}
-					}
-					if(i % 64 == 0)	{
-						printf(".");
-						fflush(stdout);
-					}
-				}
-				fclose(fd_aux2);
-				printf(" Done!\n");
-				memset(buffer_bloom_file,0,1024);
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_5_%" PRIu64 ".blm",bsgs_m2);
-				fd_aux2 = fopen(buffer_bloom_file,"rb");
-				if(fd_aux2 != NULL)	{
-					printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
-					fclose(fd_aux2);
+					return bsgs_tables_discard(fd_aux2);
 				}
-				memset(buffer_bloom_file,0,1024);
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_1_%" PRIu64 ".blm",bsgs_m2);
-				fd_aux2 = fopen(buffer_bloom_file,"rb");
-				if(fd_aux2 != NULL)	{
-					printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
-					fclose(fd_aux2);
+				bloom_bPx2nd[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+				readed = fread(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,1,fd_aux2);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux2);
 				}
-				FLAGREADEDFILE2 = 1;
-			}
-			else	{	
-				FLAGREADEDFILE2 = 0;
-			}
-			
-			/*Reading file for bPtable */
-			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_2_%" PRIu64 ".tbl",bsgs_m3);
-			fd_aux3 = fopen(buffer_bloom_file,"rb");
-			if(fd_aux3 != NULL)	{
-				printf("[+] Reading bP Table from file %s .",buffer_bloom_file);
-				fflush(stdout);
-				rsize = fread(bPtable,bytes,1,fd_aux3);
-				if(rsize != 1)	{
+				readed = fread(&bloom_bPx2nd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
+				if(readed != 1)	{
 					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-					exit(0);
+					return bsgs_tables_discard(fd_aux2);
 				}
-				rsize = fread(checksum,32,1,fd_aux3);
+				memset(rawvalue,0,32);
 				if(FLAGSKIPCHECKSUM == 0)	{
-					sha256((uint8_t*)bPtable,bytes,(uint8_t*)checksum_backup);
-					if(memcmp(checksum,checksum_backup,32) != 0)	{
+					sha256((uint8_t*)bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,(uint8_t*)rawvalue);
+					if(memcmp(bloom_bPx2nd_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bPx2nd_checksums[i].backup,rawvalue,32) != 0 )	{		/* Verification */
 						fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
-						exit(0);
+						return bsgs_tables_discard(fd_aux2);
 					}
 				}
-				printf("... Done!\n");
-				fclose(fd_aux3);
-				FLAGREADEDFILE3 = 1;
+				if(i % 64 == 0)	{
+					printf(".");
+					fflush(stdout);
+				}
 			}
-			else	{
-				FLAGREADEDFILE3 = 0;
+			fclose(fd_aux2);
+			printf(" Done!\n");
+			memset(buffer_bloom_file,0,1024);
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_5_%" PRIu64 ".blm",bsgs_m2);
+			fd_aux2 = fopen(buffer_bloom_file,"rb");
+			if(fd_aux2 != NULL)	{
+				printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
+				fclose(fd_aux2);
 			}
-			
-			/*Reading file for 3rd bloom filter */
-			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_7_%" PRIu64 ".blm",bsgs_m3);
+			memset(buffer_bloom_file,0,1024);
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_1_%" PRIu64 ".blm",bsgs_m2);
 			fd_aux2 = fopen(buffer_bloom_file,"rb");
 			if(fd_aux2 != NULL)	{
-				printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
-				fflush(stdout);
-				for(i = 0; i < 256;i++)	{
-					bf_ptr = (char*) bloom_bPx3rd[i].bf;	/*We need to save the current bf pointer*/
-					readed = fread(&bloom_bPx3rd[i],sizeof(struct bloom),1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					bloom_bPx3rd[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
-					readed = fread(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					readed = fread(&bloom_bPx3rd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
-					if(readed != 1)	{
-						fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
-						exit(0);
-					}
-					memset(rawvalue,0,32);
-					if(FLAGSKIPCHECKSUM == 0)	{
-						sha256((uint8_t*)bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,(uint8_t*)rawvalue);
-						if(memcmp(bloom_bPx3rd_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bPx3rd_checksums[i].backup,rawvalue,32) != 0 )	{		/* Verification */
-							fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
-							exit(0);
-						}
-					}
-					if(i % 64 == 0)	{
-						printf(".");
-						fflush(stdout);
-					}
-				}
+				printf("[W] Unused file detected %s you can delete it without worry\n",buffer_bloom_file);
 				fclose(fd_aux2);
-				printf(" Done!\n");
-				FLAGREADEDFILE4 = 1;
 			}
-			else	{
-				FLAGREADEDFILE4 = 0;
+			FLAGREADEDFILE2 = 1;
+		}
+		else	{	
+			FLAGREADEDFILE2 = 0;
+		}
+		
+		/*Reading file for bPtable */
+		snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_2_%" PRIu64 ".tbl",bsgs_m3);
+		fd_aux3 = fopen(buffer_bloom_file,"rb");
+		if(fd_aux3 != NULL)	{
+			printf("[+] Reading bP Table from file %s .",buffer_bloom_file);
+			fflush(stdout);
+			rsize = fread(bPtable,bytes,1,fd_aux3);
+			if(rsize != 1)	{
+				fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+				return bsgs_tables_discard(fd_aux3);
 			}
-			
+			rsize = fread(checksum,32,1,fd_aux3);
+			if(FLAGSKIPCHECKSUM == 0)	{
+				sha256((uint8_t*)bPtable,bytes,(uint8_t*)checksum_backup);
+				if(memcmp(checksum,checksum_backup,32) != 0)	{
+					fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux3);
+				}
+			}
+			printf("... Done!\n");
+			fclose(fd_aux3);
+			FLAGREADEDFILE3 = 1;
+		}
+		else	{
+			FLAGREADEDFILE3 = 0;
 		}
 		
-		if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE3 || !FLAGREADEDFILE4)	{
-			if(FLAGREADEDFILE1 == 1)	{
-				/* 
-					We need just to make File 2 to File 4 this is
-					- Second bloom filter 5%
-					- third  bloom fitler 0.25 %
-					- bp Table 0.25 %
-				*/
-				printf("[I] We need to recalculate some files, don't worry this is only 3%% of the previous work\n");
-				FINISHED_THREADS_COUNTER = 0;
-				FINISHED_THREADS_BP = 0;
-				FINISHED_ITEMS = 0;
-				salir = 0;
-				BASE = 0;
-				THREADCOUNTER = 0;
-				if(THREADBPWORKLOAD >= bsgs_m2)	{
-					THREADBPWORKLOAD = bsgs_m2;
+		/*Reading file for 3rd bloom filter */
+		snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_7_%" PRIu64 ".blm",bsgs_m3);
+		fd_aux2 = fopen(buffer_bloom_file,"rb");
+		if(fd_aux2 != NULL)	{
+			printf("[+] Reading bloom filter from file %s ",buffer_bloom_file);
+			fflush(stdout);
+			for(i = 0; i < 256;i++)	{
+				bf_ptr = (char*) bloom_bPx3rd[i].bf;	/*We need to save the current bf pointer*/
+				readed = fread(&bloom_bPx3rd[i],sizeof(struct bloom),1,fd_aux2);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					bloom_bPx3rd[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+					return bsgs_tables_discard(fd_aux2);
 				}
-				THREADCYCLES = bsgs_m2 / THREADBPWORKLOAD;
-				PERTHREAD_R = bsgs_m2 % THREADBPWORKLOAD;
-				if(PERTHREAD_R != 0)	{
-					THREADCYCLES++;
+				bloom_bPx3rd[i].bf = (uint8_t*)bf_ptr;	/* Restoring the bf pointer*/
+				readed = fread(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,1,fd_aux2);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux2);
 				}
-				
-				printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
-				fflush(stdout);
-				
-				tid = (pthread_t *) calloc(NTHREADS,sizeof(pthread_t));
-				bPload_mutex = (pthread_mutex_t*) calloc(NTHREADS,sizeof(pthread_mutex_t));
-				checkpointer((void *)bPload_mutex,__FILE__,"calloc","bPload_mutex" ,__LINE__ -1 );
-				bPload_temp_ptr = (struct bPload*) calloc(NTHREADS,sizeof(struct bPload));
-				checkpointer((void *)bPload_temp_ptr,__FILE__,"calloc","bPload_temp_ptr" ,__LINE__ -1 );
-				bPload_threads_available = (char*) calloc(NTHREADS,sizeof(char));
-				checkpointer((void *)bPload_threads_available,__FILE__,"calloc","bPload_threads_available" ,__LINE__ -1 );
-				
-				memset(bPload_threads_available,1,NTHREADS);
-				
-				for(i = 0; i < NTHREADS; i++)	{
-					pthread_mutex_init(&bPload_mutex[i],NULL);
+				readed = fread(&bloom_bPx3rd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error reading the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux2);
 				}
-				
-				do	{
-					for(i = 0; i < NTHREADS && !salir; i++)	{
-
-						if(bPload_threads_available[i] && !salir)	{
-							bPload_threads_available[i] = 0;
-							bPload_temp_ptr[i].from = BASE;
-							bPload_temp_ptr[i].threadid = i;
-							bPload_temp_ptr[i].finished = 0;
-							if( THREADCOUNTER < THREADCYCLES-1)	{
-								bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD;
-								bPload_temp_ptr[i].workload = THREADBPWORKLOAD;
-							}
-							else	{
-								bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD + PERTHREAD_R;
-								bPload_temp_ptr[i].workload = THREADBPWORKLOAD + PERTHREAD_R;
-								salir = 1;
-							}
-							s = pthread_create(&tid[i],NULL,thread_bPload_2blooms,(void*) &bPload_temp_ptr[i]);
-							if(s != 0){
-								printf("Thread creation failed. Error code: %d\n", s);
-								exit(EXIT_FAILURE);
-							}
-							pthread_detach(tid[i]);
-							BASE+=THREADBPWORKLOAD;
-							THREADCOUNTER++;
-						}
-					}
-
-					if(OLDFINISHED_ITEMS != FINISHED_ITEMS)	{
-						printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m2,(int) (((double)FINISHED_ITEMS/(double)bsgs_m2)*100));
-						fflush(stdout);
-						OLDFINISHED_ITEMS = FINISHED_ITEMS;
-					}
-					
-					for(i = 0 ; i < NTHREADS ; i++)	{
-
-						pthread_mutex_lock(&bPload_mutex[i]);
-						finished = bPload_temp_ptr[i].finished;
-						pthread_mutex_unlock(&bPload_mutex[i]);
-						if(finished)	{
-							bPload_temp_ptr[i].finished = 0;
-							bPload_threads_available[i] = 1;
-							FINISHED_ITEMS += bPload_temp_ptr[i].workload;
-							FINISHED_THREADS_COUNTER++;
-						}
+				memset(rawvalue,0,32);
+				if(FLAGSKIPCHECKSUM == 0)	{
+					sha256((uint8_t*)bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,(uint8_t*)rawvalue);
+					if(memcmp(bloom_bPx3rd_checksums[i].data,rawvalue,32) != 0 || memcmp(bloom_bPx3rd_checksums[i].backup,rawvalue,32) != 0 )	{		/* Verification */
+						fprintf(stderr,"[E] Error checksum file mismatch! %s\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux2);
 					}
-					
-				}while(FINISHED_THREADS_COUNTER < THREADCYCLES);
-				printf("\r[+] processing %lu/%lu bP points : 100%%     \n",bsgs_m2,bsgs_m2);
-				
+				}
+				if(i % 64 == 0)	{
+					printf(".");
+					fflush(stdout);
+				}
+			}
+			fclose(fd_aux2);
+			printf(" Done!\n");
+			FLAGREADEDFILE4 = 1;
+		}
+		else	{
+			FLAGREADEDFILE4 = 0;
+		}
+		
+	}
+	
+	if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE3 || !FLAGREADEDFILE4)	{
+		if(FLAGREADEDFILE1 == 1)	{
+			/* 
+				We need just to make File 2 to File 4 this is
+				- Second bloom filter 5%
+				- third  bloom fitler 0.25 %
+				- bp Table 0.25 %
+			*/
+			printf("[I] We need to recalculate some files, don't worry this is only 3%% of the previous work\n");
+			FINISHED_THREADS_COUNTER = 0;
+			FINISHED_THREADS_BP = 0;
+			FINISHED_ITEMS = 0;
+			salir = 0;
+			BASE = 0;
+			THREADCOUNTER = 0;
+			if(THREADBPWORKLOAD >= bsgs_m2)	{
+				THREADBPWORKLOAD = bsgs_m2;
+			}
+			THREADCYCLES = bsgs_m2 / THREADBPWORKLOAD;
+			PERTHREAD_R = bsgs_m2 % THREADBPWORKLOAD;
+			if(PERTHREAD_R != 0)	{
+				THREADCYCLES++;
+			}
+			
+			printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
+			fflush(stdout);
+			
+			tid = (pthread_t *) calloc(NTHREADS,sizeof(pthread_t));
+			bPload_mutex = (pthread_mutex_t*) calloc(NTHREADS,sizeof(pthread_mutex_t));
+			bPload_temp_ptr = (struct bPload*) calloc(NTHREADS,sizeof(struct bPload));
+			bPload_threads_available = (char*) calloc(NTHREADS,sizeof(char));
+			if(tid == NULL || bPload_mutex == NULL || bPload_temp_ptr == NULL || bPload_threads_available == NULL)	{
+				fprintf(stderr,"[E] error in file %s, calloc pointer bPload on line %i\n",__FILE__,__LINE__);
 				free(tid);
 				free(bPload_mutex);
 				free(bPload_temp_ptr);
 				free(bPload_threads_available);
+				return bsgs_tables_discard(NULL);
 			}
-			else{	
-				/* We need just to do all the files 
-					- first  bllom filter 100% 
-					- Second bloom filter 5%
-					- third  bloom fitler 0.25 %
-					- bp Table 0.25 %
-				*/
-				FINISHED_THREADS_COUNTER = 0;
-				FINISHED_THREADS_BP = 0;
-				FINISHED_ITEMS = 0;
-				salir = 0;
-				BASE = 0;
-				THREADCOUNTER = 0;
-				if(THREADBPWORKLOAD >= bsgs_m)	{
-					THREADBPWORKLOAD = bsgs_m;
-				}
-				THREADCYCLES = bsgs_m / THREADBPWORKLOAD;
-				PERTHREAD_R = bsgs_m % THREADBPWORKLOAD;
-				if(PERTHREAD_R != 0)	{
-					THREADCYCLES++;
+			
+			memset(bPload_threads_available,1,NTHREADS);
+			
+			for(i = 0; i < NTHREADS; i++)	{
+				pthread_mutex_init(&bPload_mutex[i],NULL);
+			}
+			
+			do	{
+				for(i = 0; i < NTHREADS && !salir; i++)	{
+
+					if(bPload_threads_available[i] && !salir)	{
+						bPload_threads_available[i] = 0;
+						bPload_temp_ptr[i].from = BASE;
+						bPload_temp_ptr[i].threadid = i;
+						bPload_temp_ptr[i].finished = 0;
+						if( THREADCOUNTER < THREADCYCLES-1)	{
+							bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD;
+							bPload_temp_ptr[i].workload = THREADBPWORKLOAD;
+						}
+						else	{
+							bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD + PERTHREAD_R;
+							bPload_temp_ptr[i].workload = THREADBPWORKLOAD + PERTHREAD_R;
+							salir = 1;
+						}
+						s = pthread_create(&tid[i],NULL,thread_bPload_2blooms,(void*) &bPload_temp_ptr[i]);
+						if(s != 0){
+							printf("Thread creation failed. Error code: %d\n", s);
+							exit(EXIT_FAILURE);
+						}
+						pthread_detach(tid[i]);
+						BASE+=THREADBPWORKLOAD;
+						THREADCOUNTER++;
+					}
 				}
-				
-				printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
-				fflush(stdout);
-				
-				tid = (pthread_t *) calloc(NTHREADS,sizeof(pthread_t));
-				bPload_mutex = (pthread_mutex_t*) calloc(NTHREADS,sizeof(pthread_mutex_t));
-				checkpointer((void *)tid,__FILE__,"calloc","tid" ,__LINE__ -1 );
-				checkpointer((void *)bPload_mutex,__FILE__,"calloc","bPload_mutex" ,__LINE__ -1 );
-				
-				bPload_temp_ptr = (struct bPload*) calloc(NTHREADS,sizeof(struct bPload));
-				checkpointer((void *)bPload_temp_ptr,__FILE__,"calloc","bPload_temp_ptr" ,__LINE__ -1 );
-				bPload_threads_available = (char*) calloc(NTHREADS,sizeof(char));
-				checkpointer((void *)bPload_threads_available,__FILE__,"calloc","bPload_threads_available" ,__LINE__ -1 );
-				
 
-				memset(bPload_threads_available,1,NTHREADS);
-				
-				for(i = 0; i < NTHREADS; i++)	{
-					pthread_mutex_init(&bPload_mutex[i],NULL);
+				if(OLDFINISHED_ITEMS != FINISHED_ITEMS)	{
+					printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m2,(int) (((double)FINISHED_ITEMS/(double)bsgs_m2)*100));
+					fflush(stdout);
+					OLDFINISHED_ITEMS = FINISHED_ITEMS;
 				}
 				
-				do	{
-					for(i = 0; i < NTHREADS && !salir; i++)	{
-
-						if(bPload_threads_available[i] && !salir)	{
-							bPload_threads_available[i] = 0;
-							bPload_temp_ptr[i].from = BASE;
-							bPload_temp_ptr[i].threadid = i;
-							bPload_temp_ptr[i].finished = 0;
-							if( THREADCOUNTER < THREADCYCLES-1)	{
-								bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD;
-								bPload_temp_ptr[i].workload = THREADBPWORKLOAD;
-							}
-							else	{
-								bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD + PERTHREAD_R;
-								bPload_temp_ptr[i].workload = THREADBPWORKLOAD + PERTHREAD_R;
-								salir = 1;
-							}
-
-							s = pthread_create(&tid[i],NULL,thread_bPload,(void*) &bPload_temp_ptr[i]);
-							if(s != 0){
-								printf("Thread creation failed. Error code: %d\n", s);
-								exit(EXIT_FAILURE);
-							}
-							pthread_detach(tid[i]);
-							BASE+=THREADBPWORKLOAD;
-							THREADCOUNTER++;
-						}
-					}
-					if(OLDFINISHED_ITEMS != FINISHED_ITEMS)	{
-						printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
-						fflush(stdout);
-						OLDFINISHED_ITEMS = FINISHED_ITEMS;
+				for(i = 0 ; i < NTHREADS ; i++)	{
+
+					pthread_mutex_lock(&bPload_mutex[i]);
+					finished = bPload_temp_ptr[i].finished;
+					pthread_mutex_unlock(&bPload_mutex[i]);
+					if(finished)	{
+						bPload_temp_ptr[i].finished = 0;
+						bPload_threads_available[i] = 1;
+						FINISHED_ITEMS += bPload_temp_ptr[i].workload;
+						FINISHED_THREADS_COUNTER++;
 					}
-					
-					for(i = 0 ; i < NTHREADS ; i++)	{
-
-						pthread_mutex_lock(&bPload_mutex[i]);
-						finished = bPload_temp_ptr[i].finished;
-						pthread_mutex_unlock(&bPload_mutex[i]);
-						if(finished)	{
-							bPload_temp_ptr[i].finished = 0;
-							bPload_threads_available[i] = 1;
-							FINISHED_ITEMS += bPload_temp_ptr[i].workload;
-							FINISHED_THREADS_COUNTER++;
-						}
-					}
-					
-				}while(FINISHED_THREADS_COUNTER < THREADCYCLES);
-				printf("\r[+] processing %lu/%lu bP points : 100%%     \n",bsgs_m,bsgs_m);
+				}
 				
+			}while(FINISHED_THREADS_COUNTER < THREADCYCLES);
+			printf("\r[+] processing %lu/%lu bP points : 100%%     \n",bsgs_m2,bsgs_m2);
+			
+			free(tid);
+			free(bPload_mutex);
+			free(bPload_temp_ptr);
+			free(bPload_threads_available);
+		}
+		else{	
+			/* We need just to do all the files 
+				- first  bllom filter 100% 
+				- Second bloom filter 5%
+				- third  bloom fitler 0.25 %
+				- bp Table 0.25 %
+			*/
+			FINISHED_THREADS_COUNTER = 0;
+			FINISHED_THREADS_BP = 0;
+			FINISHED_ITEMS = 0;
+			salir = 0;
+			BASE = 0;
+			THREADCOUNTER = 0;
+			if(THREADBPWORKLOAD >= bsgs_m)	{
+				THREADBPWORKLOAD = bsgs_m;
+			}
+			THREADCYCLES = bsgs_m / THREADBPWORKLOAD;
+			PERTHREAD_R = bsgs_m % THREADBPWORKLOAD;
+			if(PERTHREAD_R != 0)	{
+				THREADCYCLES++;
+			}
+			
+			printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
+			fflush(stdout);
+			
+			tid = (pthread_t *) calloc(NTHREADS,sizeof(pthread_t));
+			bPload_mutex = (pthread_mutex_t*) calloc(NTHREADS,sizeof(pthread_mutex_t));
+			
+			bPload_temp_ptr = (struct bPload*) calloc(NTHREADS,sizeof(struct bPload));
+			bPload_threads_available = (char*) calloc(NTHREADS,sizeof(char));
+			if(tid == NULL || bPload_mutex == NULL || bPload_temp_ptr == NULL || bPload_threads_available == NULL)	{
+				fprintf(stderr,"[E] error in file %s, calloc pointer bPload on line %i\n",__FILE__,__LINE__);
 				free(tid);
 				free(bPload_mutex);
 				free(bPload_temp_ptr);
 				free(bPload_threads_available);
+				return bsgs_tables_discard(NULL);
 			}
-		}
-		
-		if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE4)	{
-			printf("[+] Making checkums .. ");
-			fflush(stdout);
-		}	
-		if(!FLAGREADEDFILE1)	{
-			for(i = 0; i < 256 ; i++)	{
-				sha256((uint8_t*)bloom_bP[i].bf, bloom_bP[i].bytes,(uint8_t*) bloom_bP_checksums[i].data);
-				memcpy(bloom_bP_checksums[i].backup,bloom_bP_checksums[i].data,32);
-			}
-			printf(".");
-		}
-		if(!FLAGREADEDFILE2)	{
-			for(i = 0; i < 256 ; i++)	{
-				sha256((uint8_t*)bloom_bPx2nd[i].bf, bloom_bPx2nd[i].bytes,(uint8_t*) bloom_bPx2nd_checksums[i].data);
-				memcpy(bloom_bPx2nd_checksums[i].backup,bloom_bPx2nd_checksums[i].data,32);
-			}
-			printf(".");
-		}
-		if(!FLAGREADEDFILE4)	{
-			for(i = 0; i < 256 ; i++)	{
-				sha256((uint8_t*)bloom_bPx3rd[i].bf, bloom_bPx3rd[i].bytes,(uint8_t*) bloom_bPx3rd_checksums[i].data);
-				memcpy(bloom_bPx3rd_checksums[i].backup,bloom_bPx3rd_checksums[i].data,32);
+						
+						
+			memset(bPload_threads_available,1,NTHREADS);
+						
+			for(i = 0; i < NTHREADS; i++)	{
+				pthread_mutex_init(&bPload_mutex[i],NULL);
 			}
-			printf(".");
-		}
-		if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE4)	{
-			printf(" done\n");
-			fflush(stdout);
-		}	
-		if(!FLAGREADEDFILE3)	{
-			printf("[+] Sorting %lu elements... ",bsgs_m3);
-			fflush(stdout);
-			bsgs_sort(bPtable,bsgs_m3);
-			sha256((uint8_t*)bPtable, bytes,(uint8_t*) checksum);
-			memcpy(checksum_backup,checksum,32);
-			printf("Done!\n");
-			fflush(stdout);
-		}
-		if(FLAGSAVEREADFILE || FLAGUPDATEFILE1 )	{
-			if(!FLAGREADEDFILE1 || FLAGUPDATEFILE1)	{
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_4_%" PRIu64 ".blm",bsgs_m);
-				
-				if(FLAGUPDATEFILE1)	{
-					printf("[W] Updating old file into a new one\n");
-				}
-				
-				/* Writing file for 1st bloom filter */
-				
-				fd_aux1 = fopen(buffer_bloom_file,"wb");
-				if(fd_aux1 != NULL)	{
-					printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
-					fflush(stdout);
-					for(i = 0; i < 256;i++)	{
-						readed = fwrite(&bloom_bP[i],sizeof(struct bloom),1,fd_aux1);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
-							exit(0);
-						}
-						readed = fwrite(bloom_bP[i].bf,bloom_bP[i].bytes,1,fd_aux1);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
-							exit(0);
+			
+			do	{
+				for(i = 0; i < NTHREADS && !salir; i++)	{
+
+					if(bPload_threads_available[i] && !salir)	{
+						bPload_threads_available[i] = 0;
+						bPload_temp_ptr[i].from = BASE;
+						bPload_temp_ptr[i].threadid = i;
+						bPload_temp_ptr[i].finished = 0;
+						if( THREADCOUNTER < THREADCYCLES-1)	{
+							bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD;
+							bPload_temp_ptr[i].workload = THREADBPWORKLOAD;
 						}
-						readed = fwrite(&bloom_bP_checksums[i],sizeof(struct checksumsha256),1,fd_aux1);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
-							exit(0);
+						else	{
+							bPload_temp_ptr[i].to = BASE + THREADBPWORKLOAD + PERTHREAD_R;
+							bPload_temp_ptr[i].workload = THREADBPWORKLOAD + PERTHREAD_R;
+							salir = 1;
 						}
-						if(i % 64 == 0)	{
-							printf(".");
-							fflush(stdout);
+
+						s = pthread_create(&tid[i],NULL,thread_bPload,(void*) &bPload_temp_ptr[i]);
+						if(s != 0){
+							printf("Thread creation failed. Error code: %d\n", s);
+							exit(EXIT_FAILURE);
 						}
+						pthread_detach(tid[i]);
+						BASE+=THREADBPWORKLOAD;
+						THREADCOUNTER++;
 					}
-					printf(" Done!\n");
-					fclose(fd_aux1);
 				}
-				else	{
-					fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
-					exit(0);
+				if(OLDFINISHED_ITEMS != FINISHED_ITEMS)	{
+					printf("\r[+] processing %lu/%lu bP points : %i%%\r",FINISHED_ITEMS,bsgs_m,(int) (((double)FINISHED_ITEMS/(double)bsgs_m)*100));
+					fflush(stdout);
+					OLDFINISHED_ITEMS = FINISHED_ITEMS;
 				}
-			}
-			if(!FLAGREADEDFILE2  )	{
 				
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_6_%" PRIu64 ".blm",bsgs_m2);
-								
-				/* Writing file for 2nd bloom filter */
-				fd_aux2 = fopen(buffer_bloom_file,"wb");
-				if(fd_aux2 != NULL)	{
-					printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
-					fflush(stdout);
-					for(i = 0; i < 256;i++)	{
-						readed = fwrite(&bloom_bPx2nd[i],sizeof(struct bloom),1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						readed = fwrite(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						readed = fwrite(&bloom_bPx2nd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
-							exit(0);
-						}
-						if(i % 64 == 0)	{
-							printf(".");
-							fflush(stdout);
-						}
+				for(i = 0 ; i < NTHREADS ; i++)	{
+
+					pthread_mutex_lock(&bPload_mutex[i]);
+					finished = bPload_temp_ptr[i].finished;
+					pthread_mutex_unlock(&bPload_mutex[i]);
+					if(finished)	{
+						bPload_temp_ptr[i].finished = 0;
+						bPload_threads_available[i] = 1;
+						FINISHED_ITEMS += bPload_temp_ptr[i].workload;
+						FINISHED_THREADS_COUNTER++;
 					}
-					printf(" Done!\n");
-					fclose(fd_aux2);	
 				}
-				else	{
-					fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
-					exit(0);
+				
+			}while(FINISHED_THREADS_COUNTER < THREADCYCLES);
+			printf("\r[+] processing %lu/%lu bP points : 100%%     \n",bsgs_m,bsgs_m);
+			
+			free(tid);
+			free(bPload_mutex);
+			free(bPload_temp_ptr);
+			free(bPload_threads_available);
+		}
+	}
+	
+	if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE4)	{
+		printf("[+] Making checkums .. ");
+		fflush(stdout);
+	}	
+	if(!FLAGREADEDFILE1)	{
+		for(i = 0; i < 256 ; i++)	{
+			sha256((uint8_t*)bloom_bP[i].bf, bloom_bP[i].bytes,(uint8_t*) bloom_bP_checksums[i].data);
+			memcpy(bloom_bP_checksums[i].backup,bloom_bP_checksums[i].data,32);
+		}
+		printf(".");
+	}
+	if(!FLAGREADEDFILE2)	{
+		for(i = 0; i < 256 ; i++)	{
+			sha256((uint8_t*)bloom_bPx2nd[i].bf, bloom_bPx2nd[i].bytes,(uint8_t*) bloom_bPx2nd_checksums[i].data);
+			memcpy(bloom_bPx2nd_checksums[i].backup,bloom_bPx2nd_checksums[i].data,32);
+		}
+		printf(".");
+	}
+	if(!FLAGREADEDFILE4)	{
+		for(i = 0; i < 256 ; i++)	{
+			sha256((uint8_t*)bloom_bPx3rd[i].bf, bloom_bPx3rd[i].bytes,(uint8_t*) bloom_bPx3rd_checksums[i].data);
+			memcpy(bloom_bPx3rd_checksums[i].backup,bloom_bPx3rd_checksums[i].data,32);
+		}
+		printf(".");
+	}
+	if(!FLAGREADEDFILE1 || !FLAGREADEDFILE2 || !FLAGREADEDFILE4)	{
+		printf(" done\n");
+		fflush(stdout);
+	}	
+	if(!FLAGREADEDFILE3)	{
+		printf("[+] Sorting %lu elements... ",bsgs_m3);
+		fflush(stdout);
+		bsgs_sort(bPtable,bsgs_m3);
+		sha256((uint8_t*)bPtable, bytes,(uint8_t*) checksum);
+		memcpy(checksum_backup,checksum,32);
+		printf("Done!\n");
+		fflush(stdout);
+	}
+	if(FLAGSAVEREADFILE || FLAGUPDATEFILE1 )	{
+		if(!FLAGREADEDFILE1 || FLAGUPDATEFILE1)	{
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_4_%" PRIu64 ".blm",bsgs_m);
+			
+			if(FLAGUPDATEFILE1)	{
+				printf("[W] Updating old file into a new one\n");
+			}
+			
+			/* Writing file for 1st bloom filter */
+			
+			fd_aux1 = fopen(buffer_bloom_file,"wb");
+			if(fd_aux1 != NULL)	{
+				printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
+				fflush(stdout);
+				for(i = 0; i < 256;i++)	{
+					readed = fwrite(&bloom_bP[i],sizeof(struct bloom),1,fd_aux1);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux1);
+					}
+					readed = fwrite(bloom_bP[i].bf,bloom_bP[i].bytes,1,fd_aux1);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux1);
+					}
+					readed = fwrite(&bloom_bP_checksums[i],sizeof(struct checksumsha256),1,fd_aux1);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux1);
+					}
+					if(i % 64 == 0)	{
+						printf(".");
+						fflush(stdout);
+					}
 				}
+				printf(" Done!\n");
+				fclose(fd_aux1);
 			}
+			else	{	
+				fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
+				return bsgs_tables_discard(NULL);
+			}
+		}
+		if(!FLAGREADEDFILE2  )	{
 			
-			if(!FLAGREADEDFILE3)	{
-				/* Writing file for bPtable */
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_2_%" PRIu64 ".tbl",bsgs_m3);
-				fd_aux3 = fopen(buffer_bloom_file,"wb");
-				if(fd_aux3 != NULL)	{
-					printf("[+] Writing bP Table to file %s .. ",buffer_bloom_file);
-					fflush(stdout);
-					readed = fwrite(bPtable,bytes,1,fd_aux3);
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_6_%" PRIu64 ".blm",bsgs_m2);
+							
+			/* Writing file for 2nd bloom filter */
+			fd_aux2 = fopen(buffer_bloom_file,"wb");
+			if(fd_aux2 != NULL)	{
+				printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
+				fflush(stdout);
+				for(i = 0; i < 256;i++)	{
+					readed = fwrite(&bloom_bPx2nd[i],sizeof(struct bloom),1,fd_aux2);
 					if(readed != 1)	{
 						fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-						exit(0);
+						return bsgs_tables_discard(fd_aux2);
 					}
-					readed = fwrite(checksum,32,1,fd_aux3);
+					readed = fwrite(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes,1,fd_aux2);
 					if(readed != 1)	{
 						fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-						exit(0);
+						return bsgs_tables_discard(fd_aux2);
 					}
-					printf("Done!\n");
-					fclose(fd_aux3);	
-				}
-				else	{
-					fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
-					exit(0);
-				}
-			}
-			if(!FLAGREADEDFILE4)	{
-				snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_7_%" PRIu64 ".blm",bsgs_m3);
-								
-				/* Writing file for 3rd bloom filter */
-				fd_aux2 = fopen(buffer_bloom_file,"wb");
-				if(fd_aux2 != NULL)	{
-					printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
-					fflush(stdout);
-					for(i = 0; i < 256;i++)	{
-						readed = fwrite(&bloom_bPx3rd[i],sizeof(struct bloom),1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						readed = fwrite(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
-							exit(0);
-						}
-						readed = fwrite(&bloom_bPx3rd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
-						if(readed != 1)	{
-							fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
-							exit(0);
-						}
-						if(i % 64 == 0)	{
-							printf(".");
-							fflush(stdout);
-						}
+					readed = fwrite(&bloom_bPx2nd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux2);
+					}
+					if(i % 64 == 0)	{
+						printf(".");
+						fflush(stdout);
 					}
-					printf(" Done!\n");
-					fclose(fd_aux2);
-				}
-				else	{
-					fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
-					exit(0);
 				}
+				printf(" Done!\n");
+				fclose(fd_aux2);
+			}
+			else	{
+				fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
+				return bsgs_tables_discard(NULL);
+			}
+		}
+		
+		if(!FLAGREADEDFILE3)	{
+			/* Writing file for bPtable */
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_2_%" PRIu64 ".tbl",bsgs_m3);
+			fd_aux3 = fopen(buffer_bloom_file,"wb");
+			if(fd_aux3 != NULL)	{
+				printf("[+] Writing bP Table to file %s .. ",buffer_bloom_file);
+				fflush(stdout);
+				readed = fwrite(bPtable,bytes,1,fd_aux3);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux3);
+				}
+				readed = fwrite(checksum,32,1,fd_aux3);
+				if(readed != 1)	{
+					fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
+					return bsgs_tables_discard(fd_aux3);
+				}
+				printf("Done!\n");
+				fclose(fd_aux3);	
+			}
+			else	{
+				fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
+				return bsgs_tables_discard(NULL);
+			}
+		}
+		if(!FLAGREADEDFILE4)	{
+			snprintf(buffer_bloom_file,1024,"keyhunt_bsgs_7_%" PRIu64 ".blm",bsgs_m3);
+				
+			/* Writing file for 3rd bloom filter */
+			fd_aux2 = fopen(buffer_bloom_file,"wb");
+			if(fd_aux2 != NULL)	{
+				printf("[+] Writing bloom filter to file %s ",buffer_bloom_file);
+				fflush(stdout);
+				for(i = 0; i < 256;i++)	{
+					readed = fwrite(&bloom_bPx3rd[i],sizeof(struct bloom),1,fd_aux2);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux2);
+					}
+					readed = fwrite(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes,1,fd_aux2);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux2);
+					}
+					readed = fwrite(&bloom_bPx3rd_checksums[i],sizeof(struct checksumsha256),1,fd_aux2);
+					if(readed != 1)	{
+						fprintf(stderr,"[E] Error writing the file %s please delete it\n",buffer_bloom_file);
+						return bsgs_tables_discard(fd_aux2);
+					}
+					if(i % 64 == 0)	{
+						printf(".");
+						fflush(stdout);
+					}
+				}
+				printf(" Done!\n");
+				fclose(fd_aux2);
+			}
+			else	{
+				fprintf(stderr,"[E] Error can't create the file %s\n",buffer_bloom_file);
+				return bsgs_tables_discard(NULL);
 			}
 		}
 	}
-	/* 
-		Here we already finish the BSGS setup
-		- Baby table and bloom filters are alrady setup
 	
-	*/
+	tables = new bsgs_tables();
+	tables->id = ++tables_counter;
+	tables->kfactor = KFACTOR;
+	tables->requests = 0;
+	tables->N.Set(&BSGS_N);
+	tables->M.Set(&BSGS_M);
+	tables->M_double.Set(&BSGS_M_double);
+	tables->M2_double.Set(&BSGS_M2_double);
+	tables->M3.Set(&BSGS_M3);
+	tables->M3_double.Set(&BSGS_M3_double);
+	tables->m3 = bsgs_m3;
+	tables->aux = bsgs_aux;
+	tables->GSn = GSn;
+	tables->_2GSn = _2GSn;
+	tables->AMP2 = BSGS_AMP2;
+	tables->AMP3 = BSGS_AMP3;
+	tables->bloom_bP = bloom_bP;
+	tables->bloom_bPx2nd = bloom_bPx2nd;
+	tables->bloom_bPx3rd = bloom_bPx3rd;
+	tables->bloom_bP_checksums = bloom_bP_checksums;
+	tables->bloom_bPx2nd_checksums = bloom_bPx2nd_checksums;
+	tables->bloom_bPx3rd_checksums = bloom_bPx3rd_checksums;
+	tables->bloom_bP_mutex = bloom_bP_mutex;
+	tables->bloom_bPx2nd_mutex = bloom_bPx2nd_mutex;
+	tables->bloom_bPx3rd_mutex = bloom_bPx3rd_mutex;
+	tables->bPtable = bPtable;
+	tables->bloom_bP_node = NULL;
+	tables->nodes = 0;
+	tables->bytes = bloom_bP_totalbytes + bloom_bP2_totalbytes + bloom_bP3_totalbytes + bytes;
+	if(NUMA_MODE == NUMA_REPLICATE)	{
+		bsgs_tables_replicate(tables,bloom_bP_totalbytes);
+	}
+	tables->load_seconds = metrics_now() - load_start;
+	return tables;
+}
+
+/*
+	The load failed, close its file and release the arrays of this load, the generations in use are not touched
+*/
+struct bsgs_tables *bsgs_tables_discard(FILE *fd)	{
+	int i;
+	if(fd != NULL)	{
+		fclose(fd);
+	}
+	for(i = 0; i < 256; i++)	{
+		if(bloom_bP != NULL)
+			bloom_free(&bloom_bP[i]);
+		if(bloom_bPx2nd != NULL)
+			bloom_free(&bloom_bPx2nd[i]);
+		if(bloom_bPx3rd != NULL)
+			bloom_free(&bloom_bPx3rd[i]);
+	}
+	free(bloom_bP);
+	free(bloom_bPx2nd);
+	free(bloom_bPx3rd);
+	free(bloom_bP_checksums);
+	free(bloom_bPx2nd_checksums);
+	free(bloom_bPx3rd_checksums);
+	free(bloom_bP_mutex);
+	free(bloom_bPx2nd_mutex);
+	free(bloom_bPx3rd_mutex);
+	free(bPtable);
+	bloom_bP = NULL;
+	bloom_bPx2nd = NULL;
+	bloom_bPx3rd = NULL;
+	bloom_bP_checksums = NULL;
+	bloom_bPx2nd_checksums = NULL;
+	bloom_bPx3rd_checksums = NULL;
+	bloom_bP_mutex = NULL;
+	bloom_bPx2nd_mutex = NULL;
+	bloom_bPx3rd_mutex = NULL;
+	bPtable = NULL;
+	fprintf(stderr,"[E] The BSGS tables were not loaded\n");
+	return NULL;
+}
 	
+/*
+	The 1st bloom filter is checked in every giant step, so each node get its own copy if there is RAM for it.
+	The 2nd and 3rd filters and the bP table are only checked on hits, they stay interleaved
+*/
+void bsgs_tables_replicate(struct bsgs_tables *tables,uint64_t bloom_bytes)	{
+	int node,i;
+	uint64_t available;
+	struct bloom *replica;
+	if(numa_nodes_count() < 2)	{
+		return;
+	}
+	available = numa_available_bytes();
+	if(available != 0 && bloom_bytes * numa_nodes_count() > available)	{
+		fprintf(stderr,"[W] Not enough RAM to replicate %.2f MB in %i nodes, using interleave\n",(double)bloom_bytes/1048576,numa_nodes_count());
+		return;
+	}
+	tables->nodes = numa_nodes_count();
+	tables->bloom_bP_node = (struct bloom **) calloc(tables->nodes,sizeof(struct bloom *));
+	checkpointer((void *)tables->bloom_bP_node,__FILE__,"calloc","bloom_bP_node" ,__LINE__ -1 );
+	for(node = 0; node < tables->nodes; node++)	{
+		replica = (struct bloom *) calloc(256,sizeof(struct bloom));
+		checkpointer((void *)replica,__FILE__,"calloc","replica" ,__LINE__ -1 );
+		for(i = 0; i < 256; i++)	{
+			replica[i] = tables->bloom_bP[i];
+			replica[i].bf = (uint8_t *) numa_alloc_node(tables->bloom_bP[i].bytes,node);
+			checkpointer((void *)replica[i].bf,__FILE__,"numa_alloc_node","replica" ,__LINE__ -1 );
+			memcpy(replica[i].bf,tables->bloom_bP[i].bf,tables->bloom_bP[i].bytes);
+		}
+		tables->bloom_bP_node[node] = replica;
+	}
+	tables->bytes += bloom_bytes * tables->nodes;
+	printf("[+] Bloom filter replicated in %i NUMA nodes\n",tables->nodes);
+}
 	
-    int server_fd, client_fd;
-    struct sockaddr_in address;
-	char clientIP[INET_ADDRSTRLEN];
-	int clientPort,addrlen = sizeof(address);
-
-    // Creating socket file descriptor
-    if ((server_fd = socket(AF_INET, SOCK_STREAM, 0)) == 0) {
-        perror("socket failed");
-        exit(EXIT_FAILURE);
-    }
-
-    // Setting socket options
-    int opt = 1;
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt))) {
-        perror("setsockopt SO_REUSEADDR failed");
-        exit(EXIT_FAILURE);
-    }
-#ifdef SO_REUSEPORT
-    if (setsockopt(server_fd, SOL_SOCKET, SO_REUSEPORT, &opt, sizeof(opt))) {
-        perror("setsockopt SO_REUSEPORT failed");
-        exit(EXIT_FAILURE);
-    }
-#endif
+void bsgs_tables_free(struct bsgs_tables *tables)	{
+	int i,node;
+	for(node = 0; node < tables->nodes; node++)	{
+		for(i = 0; i < 256; i++)	{
+			numa_free_node(tables->bloom_bP_node[node][i].bf,tables->bloom_bP_node[node][i].bytes);
+		}
+		free(tables->bloom_bP_node[node]);
+	}
+	free(tables->bloom_bP_node);
+	for(i = 0; i < 256; i++)	{
+		bloom_free(&tables->bloom_bP[i]);
+		bloom_free(&tables->bloom_bPx2nd[i]);
+		bloom_free(&tables->bloom_bPx3rd[i]);
+		pthread_mutex_destroy(&tables->bloom_bP_mutex[i]);
+		pthread_mutex_destroy(&tables->bloom_bPx2nd_mutex[i]);
+		pthread_mutex_destroy(&tables->bloom_bPx3rd_mutex[i]);
+	}
+	free(tables->bloom_bP);
+	free(tables->bloom_bPx2nd);
+	free(tables->bloom_bPx3rd);
+	free(tables->bloom_bP_checksums);
+	free(tables->bloom_bPx2nd_checksums);
+	free(tables->bloom_bPx3rd_checksums);
+	free(tables->bloom_bP_mutex);
+	free(tables->bloom_bPx2nd_mutex);
+	free(tables->bloom_bPx3rd_mutex);
+	free(tables->bPtable);
+	printf("[+] Tables generation %i released\n",tables->id);
+	fflush(stdout);
+	delete tables;
+}
 
-    // Setting address parameters
-    address.sin_family = AF_INET;
-    address.sin_addr.s_addr = inet_addr(IP);
-    address.sin_port = htons(PORT);
-    // Binding socket to address
-    if (bind(server_fd, (struct sockaddr *)&address, sizeof(address)) < 0) {
-        perror("bind failed");
-        exit(EXIT_FAILURE);
-    }
-	printf("[+] Listening in %s:%i\n",IP,port);
-    // Listening for incoming connections
-    if (listen(server_fd, 3) < 0) {
-        perror("listen failed");
-        exit(EXIT_FAILURE);
-    }
+/*
+	Same checks of the loader for -n and -k without exit, N must have exact square root divisible by 1024
+*/
+int bsgs_tables_valid(const char *str,int kfactor)	{
+	Int n,m;
+	if(kfactor <= 0)
+		return 0;
+	if(str[0] == '0' && (str[1] == 'x' || str[1] == 'X'))	{
+		if(str[2] == '\0' || strspn(str + 2,"0123456789abcdefABCDEF") != strlen(str + 2))
+			return 0;
+		n.SetBase16((char*)(str+2));
+	}
+	else	{
+		if(str[0] == '\0' || strspn(str,"0123456789") != strlen(str))
+			return 0;
+		n.SetBase10((char*)str);
+	}
+	if(n.IsZero() || !n.HasSqrt())
+		return 0;
+	m.Set(&n);
+	m.ModSqrt();
+	m.Mod(&BSGS_GROUP_SIZE);
+	return m.IsZero();
+}
 
-	pthread_t tid;
-	while(1) {
-		// Accepting incoming connection
-		if ((client_fd = accept(server_fd, (struct sockaddr *)&address, (socklen_t*)&addrlen)) < 0) {
-			perror("accept failed");
-			exit(EXIT_FAILURE);
-		}
-		inet_ntop(AF_INET, &(address.sin_addr), clientIP, INET_ADDRSTRLEN);
-		clientPort = ntohs(address.sin_port);
-		
-		printf("[+] Accepting incoming conection from %s:%i\n",clientIP,clientPort);
-		fflush(stdout);
-		// Creating new thread to handle client
-		if (pthread_create(&tid, NULL, client_handler, &client_fd) != 0) {
-			perror("pthread_create failed");
-			printf("Failed to attend to one client\n");
-		}
-		else	{
-			if (pthread_join(tid, NULL) != 0) {
-				fprintf(stderr, "Failed to join thread.\n");
-				exit(EXIT_FAILURE);
-			}
+/*
+	RELOAD thread, the workers continue with tables_current while the new generation is made or readed,
+	tables_switch in the I/O thread replace it
+*/
+void *thread_tables_load(void *vargp)	{
+	struct bsgs_tables *tables;
+	char *old_str_N = str_N;
+	int old_FLAG_N = FLAG_N,old_KFACTOR = KFACTOR;
+	FLAG_N = 1;
+	str_N = reload_str_N;
+	KFACTOR = reload_kfactor;
+	tables = bsgs_tables_load();
+	if(tables != NULL)	{
+		snprintf(tables_str_N,sizeof(tables_str_N),"%s",reload_str_N);
+		str_N = tables_str_N;
+	}
+	else	{
+		/* Back to the N and K of the generation in use */
+		str_N = old_str_N;
+		FLAG_N = old_FLAG_N;
+		KFACTOR = old_KFACTOR;
+	}
+	pthread_mutex_lock(&mutex_scheduler);
+	tables_loaded = tables;
+	tables_load_failed = (tables == NULL);
+	pthread_mutex_unlock(&mutex_scheduler);
+	if(write(wakeup_pipe[1],"",1) < 0)	{
+		/* The pipe is full, the I/O thread is already awake */
+	}
+	return NULL;
+}
+
+/*
+	New requests use the loaded generation, the old one is released by the last request that use it.
+	If the load failed tables_current stays and the client gets RELOAD 500
+*/
+void tables_switch()	{
+	struct bsgs_tables *loaded,*old = NULL;
+	char reply[LINE_SIZE],*hextemp;
+	int failed;
+	pthread_mutex_lock(&mutex_scheduler);
+	failed = tables_load_failed;
+	tables_load_failed = 0;
+	loaded = tables_loaded;
+	if(loaded != NULL)	{
+		tables_loaded = NULL;
+		if(tables_current->requests == 0)	{
+			old = tables_current;
 		}
-		printf("[+] Closing conection from %s:%i\n",clientIP,clientPort);
+		tables_current = loaded;
+	}
+	pthread_mutex_unlock(&mutex_scheduler);
+	if(failed)	{
+		printf("[E] RELOAD failed, tables generation %i still in use\n",tables_current->id);
 		fflush(stdout);
+		connection_send(tables_loading,"RELOAD 500 Internal Server Error\n");
+		tables_loading->outstanding--;
+		connection_check(tables_loading);
+		tables_loading = NULL;
+		return;
 	}
-	
-	close(server_fd);
+	if(loaded == NULL)
+		return;
+	if(old != NULL)	{
+		bsgs_tables_free(old);
+	}
+	hextemp = loaded->N.GetBase16();
+	snprintf(reply,LINE_SIZE,"RELOAD DONE %i N=0x%s K=%i\n",loaded->id,hextemp,loaded->kfactor);
+	free(hextemp);
+	printf("[+] Tables generation %i in use\n",loaded->id);
+	fflush(stdout);
+	connection_send(tables_loading,reply);
+	tables_loading->outstanding--;
+	connection_check(tables_loading);
+	tables_loading = NULL;
 }
 
 void pubkeytopubaddress_dst(char *pkey,int length,char *dst)	{
@@ -1588,44 +2267,379 @@ int bsgs_searchbinary(struct bsgs_xvalue *buffer,char *data,int64_t array_length
 	return r;
 }
 
+/*
+	Worker thread, it takes one block of 2*BSGS_N keys at time from the active requests
+	so the threads are split between all the requests that are running
+*/
 void *thread_process_bsgs(void *vargp)	{
 #ifdef __APPLE__
 	pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
 #endif
+	struct bsgs_request *request;
+	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
+	Int dx[CPU_GRP_SIZE / 2 + 1];
+	Point pts[CPU_GRP_SIZE];
+	Int base_key,range_length;
+	int i;
+	grp->Set(dx);
+	metrics_thread = (struct bsgs_metrics *) vargp;
+	if(NUMA_MODE != NUMA_NONE)	{
+		/* One pool of threads per node, each one with the memory of its node */
+		numa_thread_node = numa_node_of_thread((int)(metrics_thread - metrics_threads),NTHREADS);
+		numa_pin(numa_thread_node);
+	}
+
+	while(1)	{
+		pthread_mutex_lock(&mutex_scheduler);
+		while((request = bsgs_request_next_block(&base_key)) == NULL)	{
+			pthread_cond_wait(&cond_scheduler,&mutex_scheduler);
+		}
+		request->workers++;
+		pthread_mutex_unlock(&mutex_scheduler);
+
+		bsgs_process_block(request,&base_key,grp,dx,pts);
+
+		pthread_mutex_lock(&mutex_scheduler);
+		request->workers--;
+		/* A block left by a cancel stays in the list, so the scanned sub-range ends before it */
+		if(!request->cancelled)	{
+			for(i = 0; i < (int)request->blocks.size(); i++)	{
+				if(request->blocks[i].IsEqual(&base_key))	{
+					request->blocks.erase(request->blocks.begin() + i);
+					break;
+				}
+			}
+			request->scanned.Add(&request->chunk);
+			METRIC_ADD(metrics_thread->keys,request->chunk.GetInt64());
+			/* The last block can go beyond the range end */
+			range_length.Set(&request->range_end);
+			range_length.Sub(&request->range_start);
+			if(request->scanned.IsGreater(&range_length))
+				request->scanned.Set(&range_length);
+		}
+		if(request->workers == 0 && bsgs_request_exhausted(request))	{
+			bsgs_request_retire(request);
+		}
+		pthread_mutex_unlock(&mutex_scheduler);
+	}
+	delete grp;
+	pthread_exit(NULL);
+}
+
+/*
+	Pick the active request with less workers that still has blocks to scan and reserve its next block.
+	The search starts after the last request picked, so with one thread a long request don't keep it.
+	The caller must hold mutex_scheduler
+*/
+struct bsgs_request *bsgs_request_next_block(Int *base_key)	{
+	struct bsgs_request *request = NULL;
+	int i,j,picked = 0;
+	for(j = 0; j < requests_active_count; j++)	{
+		i = (requests_turn + j) % requests_active_count;
+		if(bsgs_request_exhausted(requests_active[i]))
+			continue;
+		if(request == NULL || requests_active[i]->workers < request->workers)	{
+			request = requests_active[i];
+			picked = i;
+		}
+	}
+	if(request != NULL)	{
+		requests_turn = picked + 1;
+		base_key->Set(&request->current);
+		request->blocks.push_back(request->current);
+		request->current.Add(&request->chunk);
+	}
+	return request;
+}
+
+/*
+	Nothing more to give to the workers: cancelled, all the keys found or the whole range taken.
+	The caller must hold mutex_scheduler
+*/
+int bsgs_request_exhausted(struct bsgs_request *request)	{
+	return __atomic_load_n(&request->cancelled,__ATOMIC_ACQUIRE) || __atomic_load_n(&request->found_count,__ATOMIC_ACQUIRE) == request->targets_count || request->current.IsGreaterOrEqual(&request->range_end);
+}
+
+/*
+	A range shorter than NTHREADS blocks of 2*N is split in blocks of less groups of giant steps,
+	so all the threads work in it. The base of every block is still aligned to 2*M*CPU_GRP_SIZE keys from the range start.
+	The caller must hold mutex_scheduler
+*/
+void bsgs_request_chunk(struct bsgs_request *request)	{
+	struct bsgs_tables *tables = request->tables;
+	Int length,group,threads;
+	uint64_t cycles,groups;
+	cycles = tables->aux / CPU_GRP_SIZE;
+	if(tables->aux % CPU_GRP_SIZE != 0)	{
+		cycles++;
+	}
+	group.Set(&tables->M_double);
+	group.Mult(CPU_GRP_SIZE);
+	length.Set(&request->range_end);
+	length.Sub(&request->range_start);
+	threads.SetInt32(NTHREADS);
+	length.Div(&threads);
+	length.Div(&group);
+	groups = length.GetInt64();
+	if(length.GetBitLength() > 63 || groups >= cycles)	{
+		request->cycles = cycles;
+		request->chunk.Set(&tables->N);
+		request->chunk.Add(&tables->N);
+	}
+	else	{
+		request->cycles = groups > 0 ? groups : 1;
+		request->chunk.Set(&group);
+		request->chunk.Mult((uint64_t)request->cycles);
+	}
+}
+
+/*
+	Move pending requests to the active list while there are free slots.
+	The caller must hold mutex_scheduler
+*/
+void bsgs_request_promote()	{
+	struct bsgs_request *request;
+	while(requests_active_count < MAXACTIVE && requests_pending_head != NULL)	{
+		request = requests_pending_head;
+		requests_pending_head = request->next;
+		if(requests_pending_head == NULL)	{
+			requests_pending_tail = NULL;
+		}
+		request->next = NULL;
+		request->started = time(NULL);
+		request->progress_last = request->started;
+		request->tables = tables_current;
+		tables_current->requests++;
+		bsgs_request_chunk(request);
+		requests_active[requests_active_count] = request;
+		requests_active_count++;
+	}
+	pthread_cond_broadcast(&cond_scheduler);
+}
+
+/*
+	Remove one finished request from the active list and queue its reply.
+	The caller must hold mutex_scheduler
+*/
+void bsgs_request_retire(struct bsgs_request *request)	{
+	int i;
+	for(i = 0; i < requests_active_count; i++)	{
+		if(requests_active[i] == request)	{
+			requests_active_count--;
+			memmove(&requests_active[i],&requests_active[i+1],(requests_active_count - i) * sizeof(struct bsgs_request *));
+			break;
+		}
+	}
+	request->done = 1;
+	request->tables->requests--;
+	if(request->tables->requests == 0 && request->tables != tables_current)	{
+		bsgs_tables_free(request->tables);
+	}
+	bsgs_request_complete(request);
+	bsgs_request_promote();
+}
+
+/*
+	Queue the finished request for the I/O thread and wake it up
+*/
+void bsgs_request_complete(struct bsgs_request *request)	{
+	pthread_mutex_lock(&mutex_completed);
+	request->next = NULL;
+	if(requests_completed_tail == NULL)	{
+		requests_completed_head = request;
+	}
+	else	{
+		requests_completed_tail->next = request;
+	}
+	requests_completed_tail = request;
+	pthread_mutex_unlock(&mutex_completed);
+	if(write(wakeup_pipe[1],"",1) < 0)	{
+		/* The pipe is full, the I/O thread is going to read the queue anyway */
+	}
+}
+
+/*
+	Stop one request, a pending request ends right now and an active one when its last worker leaves the block.
+	The caller must hold mutex_scheduler
+*/
+void bsgs_request_cancel(struct bsgs_request *request,int reason)	{
+	struct bsgs_request *aux,*prev = NULL;
+	if(request->done || request->cancelled)
+		return;
+	__atomic_store_n(&request->cancelled,reason,__ATOMIC_RELEASE);
+	for(aux = requests_pending_head; aux != NULL; prev = aux, aux = aux->next)	{
+		if(aux == request)	{
+			if(prev == NULL)	{
+				requests_pending_head = aux->next;
+			}
+			else	{
+				prev->next = aux->next;
+			}
+			if(requests_pending_tail == aux)	{
+				requests_pending_tail = prev;
+			}
+			request->done = 1;
+			bsgs_request_complete(request);
+			return;
+		}
+	}
+	if(request->workers == 0)	{
+		bsgs_request_retire(request);
+	}
+}
+
+/*
+	All the keys from range_start to the returned value are scanned, the end of the contiguous finished blocks.
+	The caller must hold mutex_scheduler or the request must be done
+*/
+void bsgs_request_scanned_to(struct bsgs_request *request,Int *to)	{
+	int i;
+	to->Set(&request->current);
+	for(i = 0; i < (int)request->blocks.size(); i++)	{
+		if(request->blocks[i].IsLower(to))
+			to->Set(&request->blocks[i]);
+	}
+	if(to->IsGreater(&request->range_end))
+		to->Set(&request->range_end);
+}
+
+/*
+	Cancel the requests of one connection, all of them if tag is NULL. Returns the number of cancelled requests
+*/
+int bsgs_requests_cancel(struct bsgs_connection *connection,const char *tag,int reason)	{
+	std::vector<struct bsgs_request *> list;
+	struct bsgs_request *request;
+	int i;
+	pthread_mutex_lock(&mutex_scheduler);
+	for(request = requests_pending_head; request != NULL; request = request->next)	{
+		if(request->connection == connection && (tag == NULL || strcmp(request->tag,tag) == 0))
+			list.push_back(request);
+	}
+	for(i = 0; i < requests_active_count; i++)	{
+		request = requests_active[i];
+		if(request->connection == connection && !request->cancelled && (tag == NULL || strcmp(request->tag,tag) == 0))
+			list.push_back(request);
+	}
+	for(i = 0; i < (int)list.size(); i++)	{
+		bsgs_request_cancel(list[i],reason);
+	}
+	pthread_mutex_unlock(&mutex_scheduler);
+	return list.size();
+}
+
+/*
+	Insert the request in the admission queue after the requests with the same or higher priority, this don't wait for the result
+*/
+void bsgs_request_enqueue(struct bsgs_request *request)	{
+	struct bsgs_request *aux,*prev;
+	pthread_mutex_lock(&mutex_scheduler);
+	request->id = requests_counter++;
+	request->current.Set(&request->range_start);
+	request->workers = 0;
+	request->done = 0;
+	request->cancelled = REQUEST_RUNNING;
+	request->scanned.SetInt32(0);
+	request->scanned_last.SetInt32(0);
+	request->progress_last = time(NULL);
+	request->started = request->progress_last;	/* Again when it leaves the admission queue */
+	request->next = NULL;
+	if(request->range_start.IsGreaterOrEqual(&request->range_end))	{
+		request->done = 1;
+		bsgs_request_complete(request);
+	}
+	else	{
+		/* After the last request with the same or higher priority */
+		for(prev = NULL, aux = requests_pending_head; aux != NULL && aux->priority >= request->priority; prev = aux, aux = aux->next);
+		request->next = aux;
+		if(prev == NULL)	{
+			requests_pending_head = request;
+		}
+		else	{
+			prev->next = request;
+		}
+		if(aux == NULL)	{
+			requests_pending_tail = request;
+		}
+		bsgs_request_promote();
+	}
+	pthread_mutex_unlock(&mutex_scheduler);
+}
+
+struct bsgs_request *bsgs_request_new(int targets_count)	{
+	struct bsgs_request *request = new bsgs_request();
+	request->targets_count = targets_count;
+	request->found_count = 0;
+	request->status = 200;
+	request->tag[0] = '\0';
+	request->targets = new Point[targets_count];
+	request->targets_compressed = new bool[targets_count];
+	request->keysfound = new Int[targets_count];
+	request->found = new int[targets_count];
+	memset(request->found,0,targets_count * sizeof(int));
+	request->cancelled = REQUEST_RUNNING;
+	request->deadline = 0;
+	request->progress = 0;
+	request->priority = 0;
+	request->job = NULL;
+	request->slot = -1;
+	request->created = metrics_now();
+	request->tables = NULL;
+	request->connection = NULL;
+	request->next = NULL;
+	return request;
+}
 
+void bsgs_request_free(struct bsgs_request *request)	{
+	free(request->job);
+	delete[] request->targets;
+	delete[] request->targets_compressed;
+	delete[] request->keysfound;
+	delete[] request->found;
+	delete request;
+}
+
+/*
+	tokens are <publickey> [<publickey> ...] <range from> <range to>
+*/
+int bsgs_request_parse(struct bsgs_request *request,char **tokens,int n)	{
+	int i;
+	for(i = 0; i < n - 2; i++)	{
+		if(!secp->ParsePublicKeyHex(tokens[i],request->targets[i],request->targets_compressed[i]))	{
+			printf("Invalid publickey format from client %s\n",tokens[i]);
+			return 0;
+		}
+	}
+	if(!(isValidHex(tokens[n-2]) && isValidHex(tokens[n-1])))	{
+		printf("Invalid hexadecimal format from client %s:%s\n",tokens[n-2],tokens[n-1]);
+		return 0;
+	}
+	request->range_start.SetBase16(tokens[n-2]);
+	request->range_end.SetBase16(tokens[n-1]);
+	return 1;
+}
+
+/*
+	Scan the block base_key to base_key + 2*BSGS_N for every target of the request that is not found yet,
+	base_point and point_aux are calculated only once per block for all the targets
+*/
+void bsgs_process_block(struct bsgs_request *request,Int *base_key,IntGroup *grp,Int *dx,Point *pts)	{
 	FILE *filekey;
 	char xpoint_raw[32],*aux_c,*hextemp;
-	Int base_key,keyfound;
+	Int keyfound;
 	Point base_point,point_aux,point_found;
 	uint32_t r, cycles;
-	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
-	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
-	
-	Int dx[CPU_GRP_SIZE / 2 + 1];
-	Point pts[CPU_GRP_SIZE];
-
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
-	grp->Set(dx);
+	int k;
+	struct bsgs_tables *tables = request->tables;
+	struct bloom *bloom_bP = (tables->bloom_bP_node != NULL) ? tables->bloom_bP_node[numa_thread_node] : tables->bloom_bP;
 	
-
+	cycles = request->cycles;
 	
-	cycles = bsgs_aux / 1024;
-	if(bsgs_aux % 1024 != 0)	{
-		cycles++;
-	}
 
-	
-	intaux.Set(&BSGS_M_double);
+	intaux.Set(&tables->M_double);
 	intaux.Mult(CPU_GRP_SIZE/2);
-	intaux.Add(&BSGS_M);
+	intaux.Add(&tables->M);
 	
 	/*
 		intaux hold the Current middle range value (Current)
@@ -1633,45 +2647,27 @@ void *thread_process_bsgs(void *vargp)	{
 		or
 		(BSGS_M * 512)  + BSGS_M
 	*/
-	/*
-		while base_key is less than n_range_end then:
-	*/
-	do	{
 		
-	/*
-		We do this in an atomic pthread_mutex operation to not affect others threads
-		so BSGS_CURRENT is never the same between threads
-	*/
-		pthread_mutex_lock(&mutex_bsgs_thread);
+	//base point is the point of the current start range (Base_key)
+	base_point = secp->ComputePublicKey(base_key);
 
-		base_key.Set(&BSGS_CURRENT);	/* we need to set our base_key to the current BSGS_CURRENT value*/
-		BSGS_CURRENT.Add(&BSGS_N);		/*Then add BSGS_N to BSGS_CURRENT*/
-		BSGS_CURRENT.Add(&BSGS_N);		/*Then add BSGS_N to BSGS_CURRENT*/
+	km.Set(base_key);
+	km.Neg();
 		
-		pthread_mutex_unlock(&mutex_bsgs_thread);
-
-		if(base_key.IsGreaterOrEqual(&n_range_end))
-			break;
+	km.Add(&secp->order);
+	km.Sub(&intaux);
 
+	//point_aux =-( basekey + ((BSGS_M*2) * 512)  + BSGS_M)
+	point_aux = secp->ComputePublicKey(&km);
 
-		//base point is the point of the current start range (Base_key)
-		base_point = secp->ComputePublicKey(&base_key);
-
-		km.Set(&base_key);
-		km.Neg();
-		 
-		km.Add(&secp->order);
-		km.Sub(&intaux);
-
-		//point_aux =-( basekey + ((BSGS_M*2) * 512)  + BSGS_M)
-		point_aux = secp->ComputePublicKey(&km);
-		
-		
+	for(k = 0; k < request->targets_count && !__atomic_load_n(&request->cancelled,__ATOMIC_ACQUIRE); k++)	{
+		if(__atomic_load_n(&request->found[k],__ATOMIC_ACQUIRE))
+			continue;
 
-		if(base_point.equals(OriginalPointsBSGS))	{
-			hextemp = base_key.GetBase16();
+		if(base_point.equals(request->targets[k]))	{
+			hextemp = base_key->GetBase16();
 			printf("[+] Thread Key found privkey %s  \n",hextemp);
-			aux_c = secp->GetPublicKeyHex(OriginalPointsBSGScompressed,base_point);
+			aux_c = secp->GetPublicKeyHex(request->targets_compressed[k],base_point);
 			printf("[+] Publickey %s\n",aux_c);
 			
 			pthread_mutex_lock(&write_keys);
@@ -1681,187 +2677,94 @@ void *thread_process_bsgs(void *vargp)	{
 				fprintf(filekey,"Key found privkey %s\nPublickey %s\n",hextemp,aux_c);
 				fclose(filekey);
 			}
-			BSGSkeyfound.Set(&base_key);
+			if(!request->found[k])	{
+				request->keysfound[k].Set(base_key);
+				__atomic_store_n(&request->found[k],1,__ATOMIC_RELEASE);
+				__atomic_add_fetch(&request->found_count,1,__ATOMIC_RELEASE);
+				METRIC_ADD(metrics_thread->found,1);
+			}
 			pthread_mutex_unlock(&write_keys);
 
 			free(hextemp);
 			free(aux_c);
-			
-			bsgs_found = 1;
+			continue;
 		}
-		else	{
+			
+		startP  = secp->AddDirect(request->targets[k],point_aux);
 
-			startP  = secp->AddDirect(OriginalPointsBSGS,point_aux);
+		uint32_t j = 0;
+		while( j < cycles && !__atomic_load_n(&request->found[k],__ATOMIC_ACQUIRE) && !__atomic_load_n(&request->cancelled,__ATOMIC_ACQUIRE) )	{
 			
-			uint32_t j = 0;
-			while( j < cycles && bsgs_found == 0 )	{
+			secp->AddDirectBatch(startP,&tables->GSn[0],&tables->_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
+			METRIC_ADD(metrics_thread->giant_steps,CPU_GRP_SIZE);
 			
-				int i;
+			for(int i = 0; i<CPU_GRP_SIZE && !__atomic_load_n(&request->found[k],__ATOMIC_RELAXED); i++) {
 				
-				for(i = 0; i < hLength; i++) {
-					dx[i].ModSub(&GSn[i].x,&startP.x);
-				}
-				dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-				dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
+				#ifdef __APPLE__
+					if (i + 1 < CPU_GRP_SIZE) {
+						__builtin_prefetch(pts[i+1].x.bits64, 0, 3);
+					}
+#endif
+					pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 
-				// Grouped ModInv
-				grp->ModInv();
+				r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
 				
-				/*
-				We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-				We compute key in the positive and negative way from the center of the group
-				*/
-
-				// center point
-				pts[CPU_GRP_SIZE / 2] = startP;
+				if(r) {
+					METRIC_ADD(metrics_thread->secondcheck,1);
+					r = bsgs_secondcheck(tables,base_key,((j*1024) + i),&request->targets[k],&keyfound);
+					/* The last block can go beyond the range end, a key there is not of this request */
+					if(r && keyfound.IsGreater(&request->range_end))	{
+						r = 0;
+					}
+					if(r)	{
+						hextemp = keyfound.GetBase16();
+						printf("[+] Thread Key found privkey %s   \n",hextemp);
+						point_found = secp->ComputePublicKey(&keyfound);
+						aux_c = secp->GetPublicKeyHex(request->targets_compressed[k],point_found);
+						printf("[+] Publickey %s\n",aux_c);
+						pthread_mutex_lock(&write_keys);
+
+						filekey = fopen("KEYFOUNDKEYFOUND.txt","a");
+						if(filekey != NULL)	{
+							fprintf(filekey,"Key found privkey %s\nPublickey %s\n",hextemp,aux_c);
+							fclose(filekey);
+						}
+						if(!request->found[k])	{
+							request->keysfound[k].Set(&keyfound);
+							__atomic_store_n(&request->found[k],1,__ATOMIC_RELEASE);
+							__atomic_add_fetch(&request->found_count,1,__ATOMIC_RELEASE);
+							METRIC_ADD(metrics_thread->found,1);
+						}
+						pthread_mutex_unlock(&write_keys);
+						free(hextemp);
+						free(aux_c);
 				
-				for(i = 0; i<hLength; i++) {
-
-					pp = startP;
-					pn = startP;
-
-					// P = startP + i*G
-					dy.ModSub(&GSn[i].y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-					
-#if 0 /* For this BSGS we don't neet to calculate the Y value of intermediate points */
-pp.y.ModSub(&GSn[i].x,&pp.x);
-pp.y.ModMulK1(&_s);
-pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
+					} //End if second check
 
-					// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
+				}//End if first check
 
-					_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
+			}// For for pts variable
 
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
 
-#if 0	/* For this BSGS we don't neet to calculate the Y value of intermediate points */
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
+			j++;
+		} //while all the aMP points
+	}
+}
 
-
-					pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-					pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-				}
-
-				// First point (startP - (GRP_SZIE/2)*G)
-				pn = startP;
-				dyn.Set(&GSn[i].y);
-				dyn.ModNeg();
-				dyn.ModSub(&pn.y);
-
-				_s.ModMulK1(&dyn,&dx[i]);
-				_p.ModSquareK1(&_s);
-
-				pn.x.ModNeg();
-				pn.x.ModAdd(&_p);
-				pn.x.ModSub(&GSn[i].x);
-
-
-#if 0 /* For this BSGS we don't neet to calculate the Y value of intermediate points */
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-				pts[0] = pn;
-				
-				for(int i = 0; i<CPU_GRP_SIZE && bsgs_found == 0; i++) {
-					
-					#ifdef __APPLE__
-						if (i + 1 < CPU_GRP_SIZE) {
-							__builtin_prefetch(pts[i+1].x.bits64, 0, 3);
-						}
-#endif
-						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
-					
-					r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-					
-					if(r) {
-						r = bsgs_secondcheck(&base_key,((j*1024) + i),&keyfound);
-						if(r)	{
-							hextemp = keyfound.GetBase16();
-							printf("[+] Thread Key found privkey %s   \n",hextemp);
-							point_found = secp->ComputePublicKey(&keyfound);
-							aux_c = secp->GetPublicKeyHex(OriginalPointsBSGScompressed,point_found);
-							printf("[+] Publickey %s\n",aux_c);
-							pthread_mutex_lock(&write_keys);
-
-							filekey = fopen("KEYFOUNDKEYFOUND.txt","a");
-							if(filekey != NULL)	{
-								fprintf(filekey,"Key found privkey %s\nPublickey %s\n",hextemp,aux_c);
-								fclose(filekey);
-							}
-							BSGSkeyfound.Set(&keyfound);
-							pthread_mutex_unlock(&write_keys);
-							free(hextemp);
-							free(aux_c);
-							bsgs_found = 1;
-
-						} //End if second check
-						
-					}//End if first check
-					
-				}// For for pts variable
-				
-				// Next start point (startP += (bsSize*GRP_SIZE).G)
-				
-				pp = startP;
-				dy.ModSub(&_2GSn.y,&pp.y);
-
-				_s.ModMulK1(&dy,&dx[i + 1]);
-				_p.ModSquareK1(&_s);
-
-				pp.x.ModNeg();
-				pp.x.ModAdd(&_p);
-				pp.x.ModSub(&_2GSn.x);
-				
-				
-				/* For this BSGS we only need to calculate the Y value of  the next start point  */
-
-				pp.y.ModSub(&_2GSn.x,&pp.x);
-				pp.y.ModMulK1(&_s);
-				pp.y.ModSub(&_2GSn.y);
-				startP = pp;
-				
-				j++;
-			} //while all the aMP points
-		} // end else
-	}while(base_key.IsLower(&n_range_end) && bsgs_found == 0);
-	delete grp;
-	pthread_exit(NULL);
-}
-
-/*
-	The bsgs_secondcheck function is made to perform a second BSGS search in a Range of less size.
-	This funtion is made with the especific purpouse to USE a smaller bPtable in RAM.
-*/
-int bsgs_secondcheck(Int *start_range,uint32_t a,Int *privatekey)	{
-	int i = 0,found = 0,r = 0;
-	Int base_key;
-	Point base_point,point_aux;
-	Point BSGS_Q, BSGS_S,BSGS_Q_AMP;
-	char xpoint_raw[32];
-	
-	base_key.Set(&BSGS_M_double);
-	base_key.Mult((uint64_t) a);
-	base_key.Add(start_range);
+/*
+	The bsgs_secondcheck function is made to perform a second BSGS search in a Range of less size.
+	This funtion is made with the especific purpouse to USE a smaller bPtable in RAM.
+*/
+int bsgs_secondcheck(struct bsgs_tables *tables,Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
+	int i = 0,found = 0,r = 0;
+	Int base_key;
+	Point base_point,point_aux;
+	Point BSGS_Q, BSGS_S,BSGS_Q_AMP;
+	char xpoint_raw[32];
+	
+	base_key.Set(&tables->M_double);
+	base_key.Mult((uint64_t) a);
+	base_key.Add(start_range);
 
 	base_point = secp->ComputePublicKey(&base_key);
 	point_aux = secp->Negation(base_point);
@@ -1871,24 +2774,25 @@ int bsgs_secondcheck(Int *start_range,uint32_t a,Int *privatekey)	{
 		base_key is the Start range + a*BSGS_M
 	*/
 	
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS,point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	do {
-		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,BSGS_AMP2[i]);
+		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,tables->AMP2[i]);
 		BSGS_S.Set(BSGS_Q_AMP);
 		BSGS_S.x.Get32Bytes((unsigned char *) xpoint_raw);
 		
-		r = bloom_check(&bloom_bPx2nd[(uint8_t) xpoint_raw[0]],xpoint_raw,32);
+		r = bloom_check(&tables->bloom_bPx2nd[(uint8_t) xpoint_raw[0]],xpoint_raw,32);
 
 		if(r)	{
-			found = bsgs_thirdcheck(&base_key,i,privatekey);
+			METRIC_ADD(metrics_thread->thirdcheck,1);
+			found = bsgs_thirdcheck(tables,&base_key,i,target,privatekey);
 		}
 		i++;
 	}while(i < 32 && !found);
 	return found;
 }
 
-int bsgs_thirdcheck(Int *start_range,uint32_t a,Int *privatekey)	{
+int bsgs_thirdcheck(struct bsgs_tables *tables,Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
 	uint64_t j = 0;
 	int i = 0,found = 0,r = 0;
 	Int base_key,calculatedkey;
@@ -1897,41 +2801,42 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,Int *privatekey)	{
 	char xpoint_raw[32];
 
 	base_key.SetInt32(a);
-	base_key.Mult(&BSGS_M2_double);
+	base_key.Mult(&tables->M2_double);
 	base_key.Add(start_range);
 
 	base_point = secp->ComputePublicKey(&base_key);
 	point_aux = secp->Negation(base_point);
 	
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS,point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	
 	do {
-		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,BSGS_AMP3[i]);
+		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,tables->AMP3[i]);
 		BSGS_S.Set(BSGS_Q_AMP);
 		BSGS_S.x.Get32Bytes((unsigned char *)xpoint_raw);
-		r = bloom_check(&bloom_bPx3rd[(uint8_t)xpoint_raw[0]],xpoint_raw,32);
+		r = bloom_check(&tables->bloom_bPx3rd[(uint8_t)xpoint_raw[0]],xpoint_raw,32);
 		if(r)	{
-			r = bsgs_searchbinary(bPtable,xpoint_raw,bsgs_m3,&j);
+			METRIC_ADD(metrics_thread->bptable,1);
+			r = bsgs_searchbinary(tables->bPtable,xpoint_raw,tables->m3,&j);
 			if(r)	{
-				calcualteindex(i,&calculatedkey);
+				calcualteindex(tables,i,&calculatedkey);
 				privatekey->Set(&calculatedkey);
 				privatekey->Add((uint64_t)(j+1));
 				privatekey->Add(&base_key);
 				
 				point_aux = secp->ComputePublicKey(privatekey);
 				
-				if(point_aux.x.IsEqual(&OriginalPointsBSGS.x))	{
+				if(point_aux.x.IsEqual(&target->x))	{
 					found = 1;
 				}
 				else	{
-					calcualteindex(i,&calculatedkey);
+					calcualteindex(tables,i,&calculatedkey);
 					privatekey->Set(&calculatedkey);
 					privatekey->Sub((uint64_t)(j+1));
 					privatekey->Add(&base_key);
 					
 					point_aux = secp->ComputePublicKey(privatekey);
-					if(point_aux.x.IsEqual(&OriginalPointsBSGS.x))	{
+					if(point_aux.x.IsEqual(&target->x))	{
 						found = 1;
 					}
 				}
@@ -1943,8 +2848,8 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,Int *privatekey)	{
 				Why JLP?
 				This is is an special case
 			*/
-			if(BSGS_Q.x.IsEqual(&BSGS_AMP3[i].x))	{
-				calcualteindex(i,&calculatedkey);
+			if(BSGS_Q.x.IsEqual(&tables->AMP3[i].x))	{
+				calcualteindex(tables,i,&calculatedkey);
 				privatekey->Set(&calculatedkey);
 				privatekey->Add(&base_key);
 				found = 1;
@@ -1956,14 +2861,14 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,Int *privatekey)	{
 	return found;
 }
 
-void calcualteindex(int i,Int *key)	{
+void calcualteindex(struct bsgs_tables *tables,int i,Int *key)	{
 	if(i == 0)	{
-		key->Set(&BSGS_M3);
+		key->Set(&tables->M3);
 	}
 	else	{
 		key->SetInt32(i);
-		key->Mult(&BSGS_M3_double);
-		key->Add(&BSGS_M3);
+		key->Mult(&tables->M3_double);
+		key->Add(&tables->M3);
 	}
 }
 
@@ -1997,10 +2902,8 @@ void *thread_bPload(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
 	
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from + 1));
 	threadid = tt->threadid;
@@ -2019,82 +2922,7 @@ void *thread_bPload(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -2122,21 +2950,6 @@ void *thread_bPload(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 	pthread_mutex_lock(&bPload_mutex[threadid]);
@@ -2157,9 +2970,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from +1 ));
 	threadid = tt->threadid;
@@ -2176,82 +2987,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -2273,21 +3009,6 @@ void *thread_bPload_2blooms(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 	pthread_mutex_lock(&bPload_mutex[threadid]);
@@ -2314,8 +3035,15 @@ void menu() {
 	printf("-k value    Use this only with bsgs mode, k value is factor for M, more speed but more RAM use wisely\n");
 	printf("-n number   Check for N sequential numbers before the random chosen, this only works with -R option\n");
 	printf("-t tn       Threads number, must be a positive integer\n");
+	printf("-a number   Max number of requests searched at the same time, default is the threads number\n");
 	printf("-p port     TCP port Number for listening conections");
 	printf("-i ip		IP Address for listening conections");
+	printf("-u path     Listen in one Unix domain socket instead of TCP\n");
+	printf("-r path     Admin Unix domain socket (mode 0600), only its clients can send RELOAD\n");
+	printf("-d dir      Spool mode, search the *.job files of dir and write the results in dir/done\n");
+	printf("-s name     Shared memory queries for local clients, see bsgsd_shm.h\n");
+	printf("-M port     Prometheus metrics in http://ip:port/metrics\n");
+	printf("-A mode     NUMA placement of the tables: interleave or replicate, threads pinned to its node\n");
 	printf("\nExample:\n\n");
 	printf("./bsgs -k 512 \n\n");
 	exit(EXIT_FAILURE);
@@ -2329,6 +3057,15 @@ void checkpointer(void *ptr,const char *file,const char *function,const  char *n
 	}
 }
 
+/* Same of checkpointer for the loader of the tables, a RELOAD that fails must not stop the server */
+int checkpointer_load(void *ptr,const char *file,const char *function,const  char *name,int line)	{
+	if(ptr == NULL)	{
+		fprintf(stderr,"[E] error in file %s, %s pointer %s on line %i\n",file,function,name,line); 
+		return 0;
+	}
+	return 1;
+}
+
 void writekey(bool compressed,Int *key)	{
 	Point publickey;
 	FILE *keys;
@@ -2371,131 +3108,1187 @@ void init_generator()	{
 	_2Gn = secp->DoubleDirect(Gn[CPU_GRP_SIZE / 2 - 1]);
 }
 
-void* client_handler(void* arg) {
-#ifdef __APPLE__
-	pthread_set_qos_class_self_np(QOS_CLASS_USER_INTERACTIVE, 0);
+/*
+	I/O thread, one epoll set (poll where epoll is not available) for the listening socket,
+	the wakeup pipe and every client. The sockets are non blocking, nothing here waits for the search
+*/
+void io_loop(int server_fd)	{
+	time_t now,last = 0;
+	int i,n;
+#if defined(__linux__)
+	struct epoll_event event,events[IO_EVENTS];
+	io_fd = epoll_create1(0);
+	if(io_fd < 0)	{
+		perror("epoll_create1 failed");
+		exit(EXIT_FAILURE);
+	}
+	if(server_fd >= 0)	{
+		event.events = EPOLLIN;
+		event.data.ptr = &server_fd;
+		epoll_ctl(io_fd,EPOLL_CTL_ADD,server_fd,&event);
+	}
+	if(metrics_fd >= 0)	{
+		event.events = EPOLLIN;
+		event.data.ptr = &metrics_fd;
+		epoll_ctl(io_fd,EPOLL_CTL_ADD,metrics_fd,&event);
+	}
+	if(admin_fd >= 0)	{
+		event.events = EPOLLIN;
+		event.data.ptr = &admin_fd;
+		epoll_ctl(io_fd,EPOLL_CTL_ADD,admin_fd,&event);
+	}
+	event.events = EPOLLIN;
+	event.data.ptr = wakeup_pipe;
+	epoll_ctl(io_fd,EPOLL_CTL_ADD,wakeup_pipe[0],&event);
+#else
+	std::vector<struct pollfd> fds;
+	std::vector<void *> owners;
+	struct bsgs_connection *connection;
+	struct pollfd fd;
 #endif
-    int client_fd = *(int*)arg;
-    char buffer[1024];
-	char *hextemp;
-	int bytes_received;
+	while(1)	{
+#if defined(__linux__)
+		n = epoll_wait(io_fd,events,IO_EVENTS,IO_TIMEOUT);
+		for(i = 0; i < n; i++)	{
+			io_event(events[i].data.ptr,events[i].events,&server_fd);
+		}
+#else
+		fds.clear();
+		owners.clear();
+		fd.fd = server_fd;	/* poll ignores negative fds */
+		fd.events = POLLIN;
+		fds.push_back(fd);
+		owners.push_back(&server_fd);
+		fd.fd = metrics_fd;
+		fds.push_back(fd);
+		owners.push_back(&metrics_fd);
+		fd.fd = admin_fd;
+		fds.push_back(fd);
+		owners.push_back(&admin_fd);
+		fd.fd = wakeup_pipe[0];
+		fds.push_back(fd);
+		owners.push_back(wakeup_pipe);
+		for(connection = connections; connection != NULL; connection = connection->next)	{
+			if(connection->dead)
+				continue;
+			fd.fd = connection->fd;
+			fd.events = connection->events;
+			fds.push_back(fd);
+			owners.push_back(connection);
+		}
+		n = poll(fds.data(),fds.size(),IO_TIMEOUT);
+		for(i = 0; n > 0 && i < (int)fds.size(); i++)	{
+			if(fds[i].revents != 0)	{
+				io_event(owners[i],fds[i].revents,&server_fd);
+			}
+		}
+#endif
+		now = time(NULL);
+		if(now != last)	{
+			io_expire(now);
+			io_progress(now);
+			io_heartbeat();
+			if(SPOOL_DIR != NULL)	{
+				spool_scan();
+			}
+			last = now;
+		}
+		connection_reap();
+	}
+}
+
+void io_event(void *owner,int events,int *server_fd)	{
+	struct bsgs_connection *connection;
+	if(owner == server_fd)	{
+		connection_accept(*server_fd,CONNECTION_NEW,0);
+	}
+	else if(owner == &admin_fd)	{
+		connection_accept(admin_fd,CONNECTION_NEW,1);
+	}
+	else if(owner == &metrics_fd)	{
+		connection_accept(metrics_fd,CONNECTION_METRICS,0);
+	}
+	else if(owner == wakeup_pipe)	{
+		requests_replies();
+	}
+	else	{
+		connection = (struct bsgs_connection*) owner;
+		if(!connection->dead && (events & (IO_READ | IO_ERROR)))	{
+			connection_read(connection);
+		}
+		if(!connection->dead && (events & IO_ERROR))	{
+			connection_hangup(connection);
+		}
+		if(!connection->dead && (events & IO_WRITE))	{
+			connection_write(connection);
+		}
+	}
+}
+
+/*
+	Watch the input until the client close its side and the output while there are replies waiting
+*/
+void io_update(struct bsgs_connection *connection)	{
+	int events = 0;
+	if(connection->dead)
+		return;
+	if(!connection->read_closed)
+		events |= IO_READ;
+	if(connection->output_length > 0)
+		events |= IO_WRITE;
+	if(events == connection->events)
+		return;
+#if defined(__linux__)
+	struct epoll_event event;
+	event.events = events;
+	event.data.ptr = connection;
+	epoll_ctl(io_fd,EPOLL_CTL_MOD,connection->fd,&event);
+#endif
+	connection->events = events;
+}
+
+/*
+	Cancel the requests that reach their deadline, the workers see the flag at the next group of points
+*/
+void io_expire(time_t now)	{
+	std::vector<struct bsgs_request *> list;
+	struct bsgs_request *request;
+	int i;
+	pthread_mutex_lock(&mutex_scheduler);
+	for(request = requests_pending_head; request != NULL; request = request->next)	{
+		if(request->deadline != 0 && request->deadline <= now)
+			list.push_back(request);
+	}
+	for(i = 0; i < requests_active_count; i++)	{
+		request = requests_active[i];
+		if(request->deadline != 0 && request->deadline <= now && !request->cancelled)
+			list.push_back(request);
+	}
+	for(i = 0; i < (int)list.size(); i++)	{
+		bsgs_request_cancel(list[i],REQUEST_TIMEOUT);
+	}
+	pthread_mutex_unlock(&mutex_scheduler);
+}
+
+/*
+	Streaming mode, every active request with progress gets one frame each progress seconds:
+		<id> PROGRESS <keys scanned> <scanned to> <keys/s>
+	scanned to is the end of the contiguous sub-range finished from the range start, both in hexadecimal
+*/
+void io_progress(time_t now)	{
+	std::vector<struct bsgs_connection *> owners;
+	std::vector<std::string> frames;
+	struct bsgs_request *request;
+	char *hexscanned,*hexto,frame[256];
+	Int to,delta;
+	double speed;
+	int i;
+	pthread_mutex_lock(&mutex_scheduler);
+	for(i = 0; i < requests_active_count; i++)	{
+		request = requests_active[i];
+		if(request->progress == 0 || request->cancelled || now - request->progress_last < request->progress)
+			continue;
+		bsgs_request_scanned_to(request,&to);
+		delta.Set(&request->scanned);
+		delta.Sub(&request->scanned_last);
+		speed = (double) delta.GetInt64() / (double)(now - request->progress_last);
+		request->scanned_last.Set(&request->scanned);
+		request->progress_last = now;
+		hexscanned = request->scanned.GetBase16();
+		hexto = to.GetBase16();
+		snprintf(frame,sizeof(frame),"%s PROGRESS %s %s %.0f\n",request->tag,hexscanned,hexto,speed);
+		free(hexscanned);
+		free(hexto);
+		frames.push_back(frame);
+		owners.push_back(request->connection);
+	}
+	pthread_mutex_unlock(&mutex_scheduler);
+	/* connection_send can cancel requests, so the frames are sent without mutex_scheduler */
+	for(i = 0; i < (int)frames.size(); i++)	{
+		connection_send(owners[i],frames[i].c_str());
+	}
+}
+
+/*
+	A closed socket looks like a half closed one until something is sent to it, so the pipelined
+	connections waiting for replies after the end of the queries get an empty line every second.
+	If the client is gone the send fails and its requests are cancelled
+*/
+void io_heartbeat()	{
+	struct bsgs_connection *connection;
+	for(connection = connections; connection != NULL; connection = connection->next)	{
+		if(!connection->dead && connection->mode == CONNECTION_PIPELINED && connection->read_closed && connection->outstanding > 0 && connection->output_length == 0)	{
+			connection_send(connection,"\n");
+		}
+	}
+}
+
+void connection_accept(int server_fd,int mode,int admin)	{
+	struct bsgs_connection *connection;
+	struct sockaddr_storage storage;
+	struct sockaddr_in *address = (struct sockaddr_in*) &storage;
+	socklen_t addrlen;
+	int client_fd;
+	while(1)	{
+		addrlen = sizeof(storage);
+		if ((client_fd = accept(server_fd, (struct sockaddr *)&storage, &addrlen)) < 0) {
+			if(errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR && errno != ECONNABORTED)	{
+				perror("accept failed");
+			}
+			return;
+		}
+		fcntl(client_fd,F_SETFL,fcntl(client_fd,F_GETFL,0) | O_NONBLOCK);
+		connection = (struct bsgs_connection*) calloc(1,sizeof(struct bsgs_connection));
+		checkpointer((void *)connection,__FILE__,"calloc","connection" ,__LINE__ -1 );
+		connection->input = (char*) malloc(LINE_SIZE);
+		checkpointer((void *)connection->input,__FILE__,"malloc","input" ,__LINE__ -1 );
+		connection->fd = client_fd;
+		if(storage.ss_family == AF_INET)	{
+			connection->port = ntohs(address->sin_port);
+			inet_ntop(AF_INET, &(address->sin_addr), connection->ip, INET_ADDRSTRLEN);
+		}
+		else	{
+			/* Unix domain socket, the fd tell apart the clients in the log */
+			connection->port = client_fd;
+			snprintf(connection->ip,INET_ADDRSTRLEN,"unix");
+		}
+		connection->mode = mode;
+		connection->admin = admin;
+		connection->events = IO_READ;
+		connection->next = connections;
+		connections = connection;
+#if defined(__linux__)
+		struct epoll_event event;
+		event.events = IO_READ;
+		event.data.ptr = connection;
+		epoll_ctl(io_fd,EPOLL_CTL_ADD,client_fd,&event);
+#endif
+		if(mode == CONNECTION_METRICS)
+			continue;
+		metrics_connections++;
+		printf("[+] Accepting incoming conection from %s:%i\n",connection->ip,connection->port);
+		fflush(stdout);
+	}
+}
+
+/*
+	Read everything available. The end of the stream means:
+		- In single line mode, after the query line: the client hang up, its request is cancelled
+		- In pipelined mode: no more queries, the connection is closed after the last reply
+*/
+void connection_read(struct bsgs_connection *connection)	{
+	int bytes;
+	while(!connection->dead && !connection->read_closed)	{
+		if(connection->input_length == LINE_SIZE - 1)	{
+			printf("[W] Line too long from client %s:%i\n",connection->ip,connection->port);
+			connection_hangup(connection);
+			return;
+		}
+		bytes = recv(connection->fd,connection->input + connection->input_length,LINE_SIZE - 1 - connection->input_length,0);
+		if(bytes > 0)	{
+			connection->input_length += bytes;
+			connection_lines(connection,0);
+		}
+		else if(bytes == 0)	{
+			connection->read_closed = 1;
+			if(connection->mode == CONNECTION_SINGLE && connection->outstanding > 0)	{
+				connection_hangup(connection);
+				return;
+			}
+			/* The last line can end without end of line */
+			connection_lines(connection,1);
+		}
+		else	{
+			if(errno == EINTR)
+				continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK)	{
+				connection_hangup(connection);
+				return;
+			}
+			break;
+		}
+	}
+	io_update(connection);
+	connection_check(connection);
+}
+
+/*
+	Process the complete lines of the input buffer, with eof the rest of the buffer is one line too
+*/
+void connection_lines(struct bsgs_connection *connection,int eof)	{
+	char *line,*end;
+	int offset = 0;
+	while(!connection->dead && offset < connection->input_length)	{
+		line = connection->input + offset;
+		end = (char*) memchr(line,'\n',connection->input_length - offset);
+		if(end == NULL)	{
+			if(!eof)
+				break;
+			end = connection->input + connection->input_length;
+		}
+		*end = '\0';
+		offset = end - connection->input + 1;
+		connection_line(connection,line);
+	}
+	if(offset >= connection->input_length)	{
+		connection->input_length = 0;
+	}
+	else if(offset > 0)	{
+		connection->input_length -= offset;
+		memmove(connection->input,connection->input + offset,connection->input_length);
+	}
+}
+
+void connection_line(struct bsgs_connection *connection,char *line)	{
+	char reply[64];
+	switch(connection->mode)	{
+		case CONNECTION_NEW:
+			if(strcmp(trim(line,"\t\r\n "),PROTOCOL_VERSION) == 0)	{
+				connection->mode = CONNECTION_PIPELINED;
+				snprintf(reply,sizeof(reply),"%s OK\n",PROTOCOL_VERSION);
+				connection_send(connection,reply);
+			}
+			else	{
+				connection->mode = CONNECTION_SINGLE;
+				connection_single(connection,line);
+			}
+		break;
+		case CONNECTION_PIPELINED:
+			connection_query(connection,line);
+		break;
+		case CONNECTION_METRICS:
+			/* The page is sent after the HTTP headers */
+			if(!connection->read_closed && trim(line,"\r")[0] == '\0')	{
+				metrics_reply(connection);
+			}
+		break;
+		default:
+			/* Single line protocol, only one query per connection */
+		break;
+	}
+}
+
+/*
+	Single line protocol: <publickey> <range from>:<range to> [deadline=<seconds>] [priority=<n>]
+	Streaming needs the pipelined mode
+*/
+void connection_single(struct bsgs_connection *connection,char *line)	{
+	struct bsgs_request *request;
+	time_t deadline;
+	int progress,priority;
 	Tokenizer t;
-	t.tokens = NULL;
-	
-	// Peek at the incoming data to determine its length
-	bytes_received = recv(client_fd, buffer, sizeof(buffer) - 1, MSG_PEEK);
-	if (bytes_received <= 0) {
-		close(client_fd);
-		pthread_exit(NULL);
+
+	stringtokenizer(line, &t);
+	if (!request_options(&t,&deadline,&progress,&priority) || progress != 0 || t.n != 3) {
+		printf("Invalid input format from client, tokens %i : %s\n",t.n, line);
+		freetokenizer(&t);
+		connection_send(connection,"400 Bad Request");
+		return;
 	}
-	
-    
-	char* newline = (char*) memchr(buffer, '\n', bytes_received);
-	size_t line_length = newline ? (newline - buffer) + 1 : bytes_received;
-	bytes_received = recv(client_fd, buffer, line_length, 0);
-	if (bytes_received <= 0)	{
-		close(client_fd);
-		pthread_exit(NULL);
-	}
-
-	// Process the received bytes here
-	buffer[bytes_received] = '\0';
-	stringtokenizer(buffer, &t);
-	if (t.n != 3) {
-		printf("Invalid input format from client, tokens %i : %s\n",t.n, buffer);
+	request = bsgs_request_new(1);
+	if(!bsgs_request_parse(request,t.tokens,t.n))	{
 		freetokenizer(&t);
-		sendstr(client_fd,"400 Bad Request");
-		close(client_fd);
-		pthread_exit(NULL);
+		bsgs_request_free(request);
+		connection_send(connection,"400 Bad Request");
+		return;
 	}
+	freetokenizer(&t);
+	request->deadline = deadline;
+	request->priority = priority;
+	request->connection = connection;
+	connection->outstanding++;
+	bsgs_request_enqueue(request);
+}
+
+/*
+	Pipelined mode, after the PROTOCOL_VERSION line the client can send any number of queries:
+		<id> <publickey> [<publickey> ...] <range from>:<range to> [deadline=<seconds>] [progress=<seconds>] [priority=<n>]
+		CANCEL <id>
+		RELOAD <N> [<K>]
+	every query is searched as soon as there are free threads and its reply is sent when it ends:
+		<id> <privatekey or 404> [<privatekey or 404> ...]
+		<id> 400 Bad Request
+	the keys not found before the deadline or CANCEL are replied as 408 or 499,
+	with progress the reply of a cancelled query comes after <id> SCANNED <range from>:<scanned to>
+*/
+void connection_query(struct bsgs_connection *connection,char *line)	{
+	struct bsgs_request *request;
+	char tag[TAG_SIZE];
+	time_t deadline;
+	int progress,priority,valid;
+	Tokenizer t;
 
-	if(!secp->ParsePublicKeyHex(t.tokens[0],OriginalPointsBSGS,OriginalPointsBSGScompressed))	{
-		printf("Invalid publickey format from client %s\n",t.tokens[0]);
+	stringtokenizer(line, &t);
+	if(t.n == 0)	{
 		freetokenizer(&t);
-		sendstr(client_fd,"400 Bad Request");
-		close(client_fd);
-		pthread_exit(NULL);		
+		return;
 	}
-	if(!(isValidHex(t.tokens[1]) && isValidHex(t.tokens[2])))	{
-		printf("Invalid hexadecimal format from client %s:%s\n",t.tokens[1],t.tokens[2]);
+	if(t.n == 2 && strcmp(t.tokens[0],"CANCEL") == 0)	{
+		bsgs_requests_cancel(connection,t.tokens[1],REQUEST_CANCELLED);
 		freetokenizer(&t);
-		sendstr(client_fd,"400 Bad Request");
-		close(client_fd);
-		pthread_exit(NULL);	
+		return;
 	}
-	
-	n_range_start.SetBase16(t.tokens[1]);
-	n_range_end.SetBase16(t.tokens[2]);
-	
+	if((t.n == 2 || t.n == 3) && strcmp(t.tokens[0],"RELOAD") == 0)	{
+		connection_reload(connection,t.tokens[1],t.n == 3 ? t.tokens[2] : NULL);
+		freetokenizer(&t);
+		return;
+	}
+	snprintf(tag,TAG_SIZE,"%s",t.tokens[0]);
+	valid = request_options(&t,&deadline,&progress,&priority);
+	if(!valid || t.n < 4)	{
+		request = bsgs_request_new(1);
+		request->status = 400;
+	}
+	else	{
+		request = bsgs_request_new(t.n - 3);
+		if(!bsgs_request_parse(request,t.tokens + 1,t.n - 1))	{
+			request->status = 400;
+		}
+	}
+	memcpy(request->tag,tag,TAG_SIZE);
 	freetokenizer(&t);
-	
-	BSGS_CURRENT.Set(&n_range_start);
-	
-	bool *threads_created;
-	pthread_t *threads;
-	int *thread_args;
-	
-	threads_created = (bool*) calloc(NTHREADS,sizeof(bool));
-	threads = (pthread_t*) calloc(NTHREADS,sizeof(pthread_t));
-	thread_args = (int*) calloc(NTHREADS,sizeof(int));
-	checkpointer(threads_created,__FILE__,"calloc","threads_created",__LINE__);
-	checkpointer(threads,__FILE__,"calloc","threads",__LINE__);
-	checkpointer(thread_args,__FILE__,"calloc","thread_args",__LINE__);
+	request->deadline = deadline;
+	request->progress = progress;
+	request->priority = priority;
+	request->connection = connection;
+	connection->outstanding++;
+
+	if(request->status == 200)	{
+		bsgs_request_enqueue(request);
+	}
+	else	{
+		bsgs_request_complete(request);
+	}
+}
 
-	
-	
-	int i, rc;
+/*
+	Start the load of the tables for other N and K factor, replies RELOAD STARTED and later RELOAD DONE
+	or RELOAD 500 if the load failed, 409 Conflict if there is other RELOAD in progress.
+	Only the clients of the admin socket (-r) can do it
+*/
+void connection_reload(struct bsgs_connection *connection,char *n,char *k)	{
+	pthread_t tid;
+	int kfactor;
+	if(!connection->admin)	{
+		connection_send(connection,"RELOAD 403 Forbidden\n");
+		return;
+	}
+	if(tables_loading != NULL)	{
+		connection_send(connection,"RELOAD 409 Conflict\n");
+		return;
+	}
+	kfactor = k != NULL ? (int)strtol(k,NULL,10) : KFACTOR;
+	if(FLAGMODE != MODE_BSGS || strlen(n) >= sizeof(reload_str_N) || !bsgs_tables_valid(n,kfactor))	{
+		connection_send(connection,"RELOAD 400 Bad Request\n");
+		return;
+	}
+	snprintf(reload_str_N,sizeof(reload_str_N),"%s",n);
+	reload_kfactor = kfactor;
+	tables_loading = connection;
+	connection->outstanding++;
+	if(pthread_create(&tid,NULL,thread_tables_load,NULL) != 0)	{
+		fprintf(stderr,"[E] pthread_create thread_tables_load\n");
+		exit(0);
+	}
+	pthread_detach(tid);
+	printf("[+] Client %s:%i RELOAD N=%s K=%i\n",connection->ip,connection->port,n,kfactor);
+	fflush(stdout);
+	connection_send(connection,"RELOAD STARTED\n");
+}
 
-	// Create threads
-	for (i = 0; i < NTHREADS; i++) {
-		thread_args[i] = i;
-		threads_created[i] = true;
-		rc = pthread_create(&threads[i], NULL, thread_process_bsgs, &thread_args[i]);
-		if (rc != 0) {
-			printf("Failed to create thread %d\n", i);
-			threads_created[i] = false;
+/*
+	Remove the optional last tokens deadline=<seconds>, progress=<seconds> and priority=<n>, deadline is the absolute time
+	Returns 0 for unknown options
+*/
+int request_options(Tokenizer *t,time_t *deadline,int *progress,int *priority)	{
+	char *option;
+	long value;
+	*deadline = 0;
+	*progress = 0;
+	*priority = 0;
+	while(t->n > 0 && (option = strchr(t->tokens[t->n - 1],'=')) != NULL)	{
+		value = strtol(option + 1,NULL,10);
+		if(strncmp(t->tokens[t->n - 1],"deadline=",9) == 0)	{
+			*deadline = value > 0 ? time(NULL) + value : 0;
+		}
+		else if(strncmp(t->tokens[t->n - 1],"progress=",9) == 0)	{
+			*progress = value > 0 ? value : 0;
+		}
+		else if(strncmp(t->tokens[t->n - 1],"priority=",9) == 0)	{
+			*priority = value;
+		}
+		else	{
+			return 0;
+		}
+		t->n--;
+		if(t->n == 0)	{
+			free(t->tokens);
+			t->tokens = NULL;
 		}
+	}
+	return 1;
+}
 
+/*
+	Send the replies of the requests finished by the workers, in the order that they end
+*/
+void requests_replies()	{
+	struct bsgs_request *request,*next;
+	struct bsgs_connection *connection;
+	char *reply,*hextemp,*hexfrom,drain[64];
+	Int scanned_to;
+
+	while(read(wakeup_pipe[0],drain,sizeof(drain)) > 0);
+	if(tables_loading != NULL)	{
+		tables_switch();
+	}
+	pthread_mutex_lock(&mutex_completed);
+	request = requests_completed_head;
+	requests_completed_head = NULL;
+	requests_completed_tail = NULL;
+	pthread_mutex_unlock(&mutex_completed);
+
+	reply = (char*) malloc(LINE_SIZE);
+	checkpointer((void *)reply,__FILE__,"malloc","reply" ,__LINE__ -1 );
+	for(; request != NULL; request = next)	{
+		next = request->next;
+		metrics_request(request);
+		connection = request->connection;
+		if(connection == NULL)	{
+			if(request->slot >= 0)	{
+				shm_done(request);
+			}
+			else	{
+				spool_done(request);
+			}
+			bsgs_request_free(request);
+			continue;
+		}
+		if(!connection->dead)	{
+			if(connection->mode == CONNECTION_SINGLE)	{
+				if(request->found[0])	{
+					hextemp = request->keysfound[0].GetBase16();
+					snprintf(reply,LINE_SIZE,"%s",hextemp);
+					free(hextemp);
+				}
+				else if(request->cancelled == REQUEST_TIMEOUT)	{
+					snprintf(reply,LINE_SIZE,"408 Request Timeout");
+				}
+				else	{
+					snprintf(reply,LINE_SIZE,"404 Not Found");
+				}
+			}
+			else	{
+				if(request->progress != 0 && request->cancelled && request->status == 200)	{
+					bsgs_request_scanned_to(request,&scanned_to);
+					hexfrom = request->range_start.GetBase16();
+					hextemp = scanned_to.GetBase16();
+					snprintf(reply,LINE_SIZE,"%s SCANNED %s:%s\n",request->tag,hexfrom,hextemp);
+					free(hexfrom);
+					free(hextemp);
+					connection_send(connection,reply);
+				}
+				request_reply(request,reply,LINE_SIZE);
+			}
+			connection_send(connection,reply);
+		}
+		connection->outstanding--;
+		bsgs_request_free(request);
+		connection_check(connection);
 	}
+	free(reply);
+}
 
-	// Wait for threads to finish
-	for (i = 0; i < NTHREADS; i++) {
-		if(threads_created[i]){
-			rc = pthread_join(threads[i], NULL);
-			if (rc != 0) {
-				printf("Failed to join thread %d\n", i);
+/*
+	<id> <privatekey, 404, 408 or 499> [...] or <id> 400 Bad Request, with end of line
+*/
+int request_reply(struct bsgs_request *request,char *reply,int size)	{
+	const char *missing;
+	char *hextemp;
+	int i,length;
+	missing = request->cancelled == REQUEST_TIMEOUT ? "408" : (request->cancelled == REQUEST_CANCELLED ? "499" : "404");
+	length = snprintf(reply,size,"%s",request->tag);
+	if(request->status != 200)	{
+		length += snprintf(reply + length,size - length," 400 Bad Request");
+	}
+	else	{
+		for(i = 0; i < request->targets_count && length < size - 80; i++)	{
+			if(request->found[i])	{
+				hextemp = request->keysfound[i].GetBase16();
+				length += snprintf(reply + length,size - length," %s",hextemp);
+				free(hextemp);
+			}
+			else	{
+				length += snprintf(reply + length,size - length," %s",missing);
 			}
 		}
 	}
+	length += snprintf(reply + length,size - length,"\n");
+	return length;
+}
 	
-	free(threads_created);
-	free(threads);
-	free(thread_args);
-	int message_len;
-	if(bsgs_found)	{
-		hextemp = BSGSkeyfound.GetBase16();
-		message_len = snprintf(buffer, sizeof(buffer), "%s",hextemp);
-		free(hextemp);
+void connection_send(struct bsgs_connection *connection,const char *str)	{
+	int length = strlen(str);
+	if(connection->dead)
+		return;
+	if(connection->output_length + length > connection->output_size)	{
+		connection->output_size = (connection->output_length + length) * 2;
+		connection->output = (char*) realloc(connection->output,connection->output_size);
+		checkpointer((void *)connection->output,__FILE__,"realloc","output" ,__LINE__ -1 );
+	}
+	memcpy(connection->output + connection->output_length,str,length);
+	connection->output_length += length;
+	connection_write(connection);
+}
+
+/*
+	Send as much output as the socket accept, the rest waits for IO_WRITE
+*/
+void connection_write(struct bsgs_connection *connection)	{
+	int bytes,sent = 0;
+	while(!connection->dead && sent < connection->output_length)	{
+		bytes = send(connection->fd,connection->output + sent,connection->output_length - sent,0);
+		if(bytes < 0)	{
+			if(errno == EINTR)
+				continue;
+			if(errno != EAGAIN && errno != EWOULDBLOCK)	{
+				printf("Failed to send message to client\n");
+				connection_hangup(connection);
+				return;
+			}
+			break;
+		}
+		sent += bytes;
+	}
+	if(sent > 0)	{
+		connection->output_length -= sent;
+		memmove(connection->output,connection->output + sent,connection->output_length);
+	}
+	io_update(connection);
+	connection_check(connection);
+}
+
+/*
+	Close the connection when there is nothing more to do with it
+*/
+void connection_check(struct bsgs_connection *connection)	{
+	if(connection->dead || connection->output_length > 0 || connection->outstanding > 0)
+		return;
+	if(connection->mode == CONNECTION_SINGLE || connection->read_closed)	{
+		connection_close(connection);
+	}
+}
+
+/*
+	The client is gone, stop all its requests
+*/
+void connection_hangup(struct bsgs_connection *connection)	{
+	int cancelled;
+	if(connection->dead)
+		return;
+	connection_close(connection);
+	cancelled = bsgs_requests_cancel(connection,NULL,REQUEST_CANCELLED);
+	if(cancelled > 0)	{
+		printf("[+] Client %s:%i hang up, %i requests cancelled\n",connection->ip,connection->port,cancelled);
+		fflush(stdout);
+	}
+}
+
+void connection_close(struct bsgs_connection *connection)	{
+	if(connection->dead)
+		return;
+#if defined(__linux__)
+	epoll_ctl(io_fd,EPOLL_CTL_DEL,connection->fd,NULL);
+#endif
+	close(connection->fd);
+	connection->dead = 1;
+	connection->output_length = 0;
+	if(connection->mode == CONNECTION_METRICS)
+		return;
+	printf("[+] Closing conection from %s:%i\n",connection->ip,connection->port);
+	fflush(stdout);
+}
+
+/*
+	Free the closed connections without requests in the workers or in the completed queue
+*/
+void connection_reap()	{
+	struct bsgs_connection **link = &connections,*connection;
+	while(*link != NULL)	{
+		connection = *link;
+		if(connection->dead && connection->outstanding == 0)	{
+			*link = connection->next;
+			free(connection->input);
+			free(connection->output);
+			free(connection);
+		}
+		else	{
+			link = &connection->next;
+		}
+	}
+}
+
+/*
+	Spool mode, every <name>.job file in SPOOL_DIR is one query:
+		<publickey> [<publickey> ...] <range from>:<range to> [deadline=<seconds>] [priority=<n>]
+	The files are taken in name order and renamed to <name>.running while they are searched,
+	the result is written in SPOOL_DIR/done/<name>.done
+*/
+void spool_init()	{
+	char path[PATH_SIZE],job[PATH_SIZE];
+	struct dirent *entry;
+	DIR *dir;
+	int length;
+	snprintf(path,PATH_SIZE,"%s/done",SPOOL_DIR);
+	if(mkdir(path,0755) != 0 && errno != EEXIST)	{
+		fprintf(stderr,"[E] Can't create the directory %s\n",path);
+		exit(EXIT_FAILURE);
+	}
+	/* The jobs of a previous run that didn't end go back to the queue */
+	dir = opendir(SPOOL_DIR);
+	if(dir == NULL)	{
+		fprintf(stderr,"[E] Can't open the spool directory %s\n",SPOOL_DIR);
+		exit(EXIT_FAILURE);
+	}
+	while((entry = readdir(dir)) != NULL)	{
+		length = strlen(entry->d_name);
+		if(length > 8 && strcmp(entry->d_name + length - 8,".running") == 0)	{
+			snprintf(path,PATH_SIZE,"%s/%s",SPOOL_DIR,entry->d_name);
+			snprintf(job,PATH_SIZE,"%s/%.*s.job",SPOOL_DIR,length - 8,entry->d_name);
+			rename(path,job);
+		}
+	}
+	closedir(dir);
+	printf("[+] Spool directory %s\n",SPOOL_DIR);
+	fflush(stdout);
+}
+
+void spool_scan()	{
+	std::vector<std::string> names;
+	struct dirent *entry;
+	DIR *dir;
+	int i,length;
+	dir = opendir(SPOOL_DIR);
+	if(dir == NULL)
+		return;
+	while((entry = readdir(dir)) != NULL)	{
+		length = strlen(entry->d_name);
+		if(length > 4 && strcmp(entry->d_name + length - 4,".job") == 0)	{
+			names.push_back(std::string(entry->d_name,length - 4));
+		}
+	}
+	closedir(dir);
+	std::sort(names.begin(),names.end());
+	for(i = 0; i < (int)names.size(); i++)	{
+		spool_claim(names[i].c_str());
+	}
+}
+
+/*
+	Take one job, the rename fails if other bsgsd already took it
+*/
+void spool_claim(const char *name)	{
+	struct bsgs_request *request;
+	char path[PATH_SIZE],running[PATH_SIZE],*line;
+	time_t deadline;
+	int progress,priority,valid = 0;
+	Tokenizer t;
+	FILE *fd;
+
+	snprintf(path,PATH_SIZE,"%s/%s.job",SPOOL_DIR,name);
+	snprintf(running,PATH_SIZE,"%s/%s.running",SPOOL_DIR,name);
+	if(rename(path,running) != 0)
+		return;
+	line = (char*) malloc(LINE_SIZE);
+	checkpointer((void *)line,__FILE__,"malloc","line" ,__LINE__ -1 );
+	line[0] = '\0';
+	fd = fopen(running,"r");
+	if(fd != NULL)	{
+		while(fgets(line,LINE_SIZE,fd) != NULL && trim(line,"\t\r\n ")[0] == '\0');
+		fclose(fd);
+	}
+	stringtokenizer(line,&t);
+	valid = request_options(&t,&deadline,&progress,&priority);
+	if(!valid || t.n < 3)	{
+		request = bsgs_request_new(1);
+		request->status = 400;
+	}
+	else	{
+		request = bsgs_request_new(t.n - 2);
+		if(!bsgs_request_parse(request,t.tokens,t.n))	{
+			request->status = 400;
+		}
+	}
+	freetokenizer(&t);
+	free(line);
+	snprintf(request->tag,TAG_SIZE,"%s",name);
+	request->job = strdup(name);
+	request->deadline = deadline;
+	request->priority = priority;
+	printf("[+] Spool job %s priority %i\n",name,priority);
+	fflush(stdout);
+	if(request->status == 200)	{
+		bsgs_request_enqueue(request);
 	}
 	else	{
-		message_len = snprintf(buffer, sizeof(buffer), "404 Not Found");
+		bsgs_request_complete(request);
 	}
-	bsgs_found = 0;
-	int bytes_sent = send(client_fd, buffer, message_len, 0);
-	if (bytes_sent == -1) {
-		printf("Failed to send message to client\n");
+}
+
+/*
+	Write the result in done/<name>.tmp and rename it, so a reader never see half a file:
+		<name> <privatekey, 404 or 408> [...]
+		scanned <range from>:<scanned to>
+		keys <keys scanned>
+		seconds <seconds>
+		speed <keys/s>
+*/
+void spool_done(struct bsgs_request *request)	{
+	char path[PATH_SIZE],done[PATH_SIZE],*reply,*hexfrom,*hexto,*hexkeys;
+	Int scanned_to;
+	time_t seconds;
+	double speed;
+	FILE *fd;
+
+	seconds = time(NULL) - request->started;
+	speed = (double)request->scanned.GetInt64() / (double)(seconds > 0 ? seconds : 1);
+	bsgs_request_scanned_to(request,&scanned_to);
+	reply = (char*) malloc(LINE_SIZE);
+	checkpointer((void *)reply,__FILE__,"malloc","reply" ,__LINE__ -1 );
+	request_reply(request,reply,LINE_SIZE);
+	hexfrom = request->range_start.GetBase16();
+	hexto = scanned_to.GetBase16();
+	hexkeys = request->scanned.GetBase16();
+
+	snprintf(path,PATH_SIZE,"%s/done/%s.tmp",SPOOL_DIR,request->job);
+	snprintf(done,PATH_SIZE,"%s/done/%s.done",SPOOL_DIR,request->job);
+	fd = fopen(path,"w");
+	if(fd != NULL)	{
+		fprintf(fd,"%s",reply);
+		if(request->status == 200)	{
+			fprintf(fd,"scanned %s:%s\nkeys %s\nseconds %li\nspeed %.0f\n",hexfrom,hexto,hexkeys,(long)seconds,speed);
+		}
+		fclose(fd);
+		if(rename(path,done) != 0)	{
+			fprintf(stderr,"[E] Can't rename %s\n",path);
+		}
+	}
+	else	{
+		fprintf(stderr,"[E] Can't create the file %s\n",path);
 	}
+	snprintf(path,PATH_SIZE,"%s/%s.running",SPOOL_DIR,request->job);
+	unlink(path);
+	printf("[+] Spool job %s done, %s",request->job,reply);
+	fflush(stdout);
+	free(hexfrom);
+	free(hexto);
+	free(hexkeys);
+	free(reply);
+}
 
-	
-    close(client_fd);
-    pthread_exit(NULL);
+/*
+	Shared memory mode, made again at every start, the clients of a previous run must open it again
+*/
+void shm_init()	{
+	pthread_mutexattr_t mutexattr;
+	pthread_condattr_t condattr;
+	pthread_t tid_shm;
+	int fd;
+
+	shm_unlink(SHM_NAME);
+	fd = shm_open(SHM_NAME,O_RDWR | O_CREAT | O_EXCL,0666);
+	if(fd < 0 || ftruncate(fd,sizeof(struct bsgsd_shm)) != 0)	{
+		fprintf(stderr,"[E] Can't create the shared memory %s\n",SHM_NAME);
+		exit(EXIT_FAILURE);
+	}
+	shm = (struct bsgsd_shm *) mmap(NULL,sizeof(struct bsgsd_shm),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(shm == MAP_FAILED)	{
+		fprintf(stderr,"[E] Can't map the shared memory %s\n",SHM_NAME);
+		exit(EXIT_FAILURE);
+	}
+	pthread_mutexattr_init(&mutexattr);
+	pthread_mutexattr_setpshared(&mutexattr,PTHREAD_PROCESS_SHARED);
+#if defined(__linux__)
+	pthread_mutexattr_setrobust(&mutexattr,PTHREAD_MUTEX_ROBUST);
+#endif
+	pthread_mutex_init(&shm->mutex,&mutexattr);
+	pthread_mutexattr_destroy(&mutexattr);
+	pthread_condattr_init(&condattr);
+	pthread_condattr_setpshared(&condattr,PTHREAD_PROCESS_SHARED);
+	pthread_cond_init(&shm->cond_submitted,&condattr);
+	pthread_cond_init(&shm->cond_done,&condattr);
+	pthread_condattr_destroy(&condattr);
+	shm->version = BSGSD_SHM_VERSION;
+	shm->slots = BSGSD_SHM_SLOTS;
+	shm->slot_size = sizeof(struct bsgsd_shm_slot);
+	__atomic_store_n(&shm->magic,BSGSD_SHM_MAGIC,__ATOMIC_RELEASE);
+	if(pthread_create(&tid_shm,NULL,thread_shm,NULL) != 0)	{
+		fprintf(stderr,"[E] pthread_create thread_shm\n");
+		exit(EXIT_FAILURE);
+	}
+	pthread_detach(tid_shm);
+	printf("[+] Shared memory %s, %i slots\n",SHM_NAME,BSGSD_SHM_SLOTS);
+	fflush(stdout);
+}
+
+/*
+	Wait for submitted slots and enqueue them, starting after the last one taken so the order is kept
+*/
+void *thread_shm(void *vargp)	{
+	std::vector<int> taken;
+	uint32_t i,index,start = 0;
+	for(;;)	{
+		bsgsd_shm_lock(shm);
+		while(shm->submitted == 0)	{
+#if defined(__linux__)
+			if(pthread_cond_wait(&shm->cond_submitted,&shm->mutex) == EOWNERDEAD)	{
+				pthread_mutex_consistent(&shm->mutex);
+			}
+#else
+			pthread_cond_wait(&shm->cond_submitted,&shm->mutex);
+#endif
+		}
+		shm->submitted = 0;
+		for(i = 0; i < BSGSD_SHM_SLOTS; i++)	{
+			index = (start + i) % BSGSD_SHM_SLOTS;
+			if(__atomic_load_n(&shm->slot[index].state,__ATOMIC_ACQUIRE) == BSGSD_SLOT_SUBMITTED)	{
+				__atomic_store_n(&shm->slot[index].state,BSGSD_SLOT_QUEUED,__ATOMIC_RELAXED);
+				taken.push_back(index);
+			}
+		}
+		bsgsd_shm_unlock(shm);
+		if(!taken.empty())	{
+			start = (taken.back() + 1) % BSGSD_SHM_SLOTS;
+		}
+		for(i = 0; i < taken.size(); i++)	{
+			shm_take(taken[i]);
+		}
+		taken.clear();
+	}
+	return NULL;
 }
 
-int sendstr(int client_fd,const char *str)	{
-	int len = strlen(str);
-	int bytes = send(client_fd, str, len, 0);
-	if (bytes == -1) {
-		printf("Failed to send message to client\n");
+void shm_take(int index)	{
+	struct bsgsd_shm_slot *slot = &shm->slot[index];
+	struct bsgs_request *request;
+	int i;
+	if(slot->count < 1 || slot->count > BSGSD_SHM_TARGETS)	{
+		request = bsgs_request_new(1);
+		request->status = 400;
 	}
-	return bytes;
-}
\ No newline at end of file
+	else	{
+		request = bsgs_request_new(slot->count);
+		for(i = 0; i < request->targets_count; i++)	{
+			if(!secp->ParsePublicKeyRaw(slot->publickeys[i],request->targets[i],request->targets_compressed[i]))	{
+				request->status = 400;
+			}
+		}
+		request->range_start.Set32Bytes(slot->range_from);
+		request->range_end.Set32Bytes(slot->range_to);
+	}
+	snprintf(request->tag,TAG_SIZE,"shm%i",index);
+	request->slot = index;
+	request->deadline = slot->deadline > 0 ? time(NULL) + slot->deadline : 0;
+	request->priority = slot->priority;
+	if(request->status == 200)	{
+		bsgs_request_enqueue(request);
+	}
+	else	{
+		bsgs_request_complete(request);
+	}
+}
+
+/*
+	Write the result in the slot and wake up the clients waiting in cond_done
+*/
+void shm_done(struct bsgs_request *request)	{
+	struct bsgsd_shm_slot *slot = &shm->slot[request->slot];
+	Int scanned_to;
+	int i;
+	slot->found = 0;
+	memset(slot->keys,0,sizeof(slot->keys));
+	memset(slot->scanned_to,0,sizeof(slot->scanned_to));
+	if(request->status != 200)	{
+		slot->status = 400;
+	}
+	else	{
+		for(i = 0; i < request->targets_count; i++)	{
+			if(request->found[i])	{
+				request->keysfound[i].Get32Bytes(slot->keys[i]);
+				slot->found |= 1U << i;
+			}
+		}
+		if(request->found_count == request->targets_count)	{
+			slot->status = 200;
+		}
+		else	{
+			slot->status = request->cancelled == REQUEST_TIMEOUT ? 408 : 404;
+		}
+		bsgs_request_scanned_to(request,&scanned_to);
+		scanned_to.Get32Bytes(slot->scanned_to);
+	}
+	slot->seconds = request->status == 200 ? time(NULL) - request->started : 0;
+	bsgsd_shm_lock(shm);
+	__atomic_store_n(&slot->state,BSGSD_SLOT_DONE,__ATOMIC_RELEASE);
+	pthread_cond_broadcast(&shm->cond_done);
+	bsgsd_shm_unlock(shm);
+}
+
+double metrics_now()	{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC,&now);
+	return (double)now.tv_sec + (double)now.tv_nsec / 1e9;
+}
+
+/*
+	200 all the keys found, 404 the range ended, 408 deadline, 499 cancelled, 400 bad query
+*/
+int request_code(struct bsgs_request *request)	{
+	if(request->status != 200)
+		return 400;
+	if(request->found_count == request->targets_count)
+		return 200;
+	if(request->cancelled == REQUEST_TIMEOUT)
+		return 408;
+	if(request->cancelled == REQUEST_CANCELLED)
+		return 499;
+	return 404;
+}
+
+/*
+	Count one finished request, called by the I/O thread only
+*/
+void metrics_request(struct bsgs_request *request)	{
+	double seconds = metrics_now() - request->created;
+	int i,code = request_code(request);
+	for(i = 0; i < 5; i++)	{
+		if(metrics_codes[i] == code)
+			metrics_requests[i]++;
+	}
+	for(i = 0; i < METRICS_BUCKETS; i++)	{
+		if(seconds <= metrics_bounds[i])
+			metrics_buckets[i]++;
+	}
+	metrics_count++;
+	metrics_sum += seconds;
+}
+
+/*
+	Prometheus label value, without \ " and end of line
+*/
+static void metrics_label(char *dst,int size,const char *src)	{
+	int i = 0;
+	for(; *src != '\0' && i < size - 3; src++)	{
+		if(*src == '\\' || *src == '"')	{
+			dst[i++] = '\\';
+			dst[i++] = *src;
+		}
+		else if(*src == '\n')	{
+			dst[i++] = '\\';
+			dst[i++] = 'n';
+		}
+		else	{
+			dst[i++] = *src;
+		}
+	}
+	dst[i] = '\0';
+}
+
+/*
+	Write the page and close the connection after it
+*/
+void metrics_reply(struct bsgs_connection *connection)	{
+	struct bsgs_metrics total;
+	struct bsgs_connection *aux;
+	struct bsgs_request *request;
+	std::string body;
+	char line[512],tag[2 * TAG_SIZE];
+	uint64_t pending = 0,clients = 0;
+	double speed;
+	int i;
+
+	memset(&total,0,sizeof(total));
+	for(i = 0; i < NTHREADS; i++)	{
+		total.keys += __atomic_load_n(&metrics_threads[i].keys,__ATOMIC_RELAXED);
+		total.giant_steps += __atomic_load_n(&metrics_threads[i].giant_steps,__ATOMIC_RELAXED);
+		total.secondcheck += __atomic_load_n(&metrics_threads[i].secondcheck,__ATOMIC_RELAXED);
+		total.thirdcheck += __atomic_load_n(&metrics_threads[i].thirdcheck,__ATOMIC_RELAXED);
+		total.bptable += __atomic_load_n(&metrics_threads[i].bptable,__ATOMIC_RELAXED);
+		total.found += __atomic_load_n(&metrics_threads[i].found,__ATOMIC_RELAXED);
+	}
+	for(aux = connections; aux != NULL; aux = aux->next)	{
+		if(!aux->dead && aux->mode != CONNECTION_METRICS)
+			clients++;
+	}
+
+	body += "# HELP bsgsd_keys_scanned_total Keys of the finished blocks\n# TYPE bsgsd_keys_scanned_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_keys_scanned_total %" PRIu64 "\n",total.keys);
+	body += line;
+	body += "# HELP bsgsd_giant_steps_total Level 1 bloom filter checks\n# TYPE bsgsd_giant_steps_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_giant_steps_total %" PRIu64 "\n",total.giant_steps);
+	body += line;
+	body += "# HELP bsgsd_secondcheck_total bsgs_secondcheck calls, level 1 bloom filter hits\n# TYPE bsgsd_secondcheck_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_secondcheck_total %" PRIu64 "\n",total.secondcheck);
+	body += line;
+	body += "# HELP bsgsd_thirdcheck_total bsgs_thirdcheck calls, level 2 bloom filter hits\n# TYPE bsgsd_thirdcheck_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_thirdcheck_total %" PRIu64 "\n",total.thirdcheck);
+	body += line;
+	body += "# HELP bsgsd_bptable_searches_total Searches in the bP table, level 3 bloom filter hits\n# TYPE bsgsd_bptable_searches_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_bptable_searches_total %" PRIu64 "\n",total.bptable);
+	body += line;
+	body += "# HELP bsgsd_keys_found_total Private keys found\n# TYPE bsgsd_keys_found_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_keys_found_total %" PRIu64 "\n",total.found);
+	body += line;
+	
+	body += "# HELP bsgsd_requests_total Finished requests by reply code\n# TYPE bsgsd_requests_total counter\n";
+	for(i = 0; i < 5; i++)	{
+		snprintf(line,sizeof(line),"bsgsd_requests_total{code=\"%i\"} %" PRIu64 "\n",metrics_codes[i],metrics_requests[i]);
+		body += line;
+	}
+	body += "# HELP bsgsd_request_duration_seconds Time from the query to the reply, queue included\n# TYPE bsgsd_request_duration_seconds histogram\n";
+	for(i = 0; i < METRICS_BUCKETS; i++)	{
+		snprintf(line,sizeof(line),"bsgsd_request_duration_seconds_bucket{le=\"%g\"} %" PRIu64 "\n",metrics_bounds[i],metrics_buckets[i]);
+		body += line;
+	}
+	snprintf(line,sizeof(line),"bsgsd_request_duration_seconds_bucket{le=\"+Inf\"} %" PRIu64 "\nbsgsd_request_duration_seconds_sum %f\nbsgsd_request_duration_seconds_count %" PRIu64 "\n",metrics_count,metrics_sum,metrics_count);
+	body += line;
+	body += "# HELP bsgsd_connections_total Client connections accepted\n# TYPE bsgsd_connections_total counter\n";
+	snprintf(line,sizeof(line),"bsgsd_connections_total %" PRIu64 "\n",metrics_connections);
+	body += line;
+	body += "# HELP bsgsd_connections Client connections open\n# TYPE bsgsd_connections gauge\n";
+	snprintf(line,sizeof(line),"bsgsd_connections %" PRIu64 "\n",clients);
+	body += line;
+
+	pthread_mutex_lock(&mutex_scheduler);
+	for(request = requests_pending_head; request != NULL; request = request->next)
+		pending++;
+	body += "# HELP bsgsd_requests_pending Requests in the admission queue\n# TYPE bsgsd_requests_pending gauge\n";
+	snprintf(line,sizeof(line),"bsgsd_requests_pending %" PRIu64 "\n",pending);
+	body += line;
+	body += "# HELP bsgsd_requests_active Requests using the worker threads\n# TYPE bsgsd_requests_active gauge\n";
+	snprintf(line,sizeof(line),"bsgsd_requests_active %i\n",requests_active_count);
+	body += line;
+	body += "# HELP bsgsd_request_keys_per_second Speed of every active request since it left the queue\n# TYPE bsgsd_request_keys_per_second gauge\n";
+	for(i = 0; i < requests_active_count; i++)	{
+		request = requests_active[i];
+		speed = (double)request->scanned.GetInt64() / (double)(time(NULL) - request->started > 0 ? time(NULL) - request->started : 1);
+		metrics_label(tag,sizeof(tag),request->tag);
+		snprintf(line,sizeof(line),"bsgsd_request_keys_per_second{id=\"%" PRIu64 "\",tag=\"%s\"} %.0f\n",request->id,tag,speed);
+		body += line;
+	}
+	body += "# HELP bsgsd_tables_load_seconds Time to make or read the tables in use\n# TYPE bsgsd_tables_load_seconds gauge\n";
+	snprintf(line,sizeof(line),"bsgsd_tables_load_seconds{generation=\"%i\"} %f\n",tables_current->id,tables_current->load_seconds);
+	body += line;
+	body += "# HELP bsgsd_tables_bytes Memory of the tables in use\n# TYPE bsgsd_tables_bytes gauge\n";
+	snprintf(line,sizeof(line),"bsgsd_tables_bytes{generation=\"%i\"} %" PRIu64 "\n",tables_current->id,tables_current->bytes);
+	body += line;
+	pthread_mutex_unlock(&mutex_scheduler);
+
+	snprintf(line,sizeof(line),"HTTP/1.0 200 OK\r\nContent-Type: text/plain; version=0.0.4\r\nContent-Length: %i\r\nConnection: close\r\n\r\n",(int)body.size());
+	connection_send(connection,line);
+	connection_send(connection,body.c_str());
+	connection->read_closed = 1;
+	io_update(connection);
+}
+
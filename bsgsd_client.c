@@ -0,0 +1,130 @@
+/*
+	Client of the bsgsd shared memory interface, see bsgsd_shm.h
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "bsgsd_shm.h"
+
+/*
+	Map the shared memory made by bsgsd -s name, NULL if it doesn't exist or is other version
+*/
+struct bsgsd_shm *bsgsd_open(const char *name)	{
+	struct bsgsd_shm *shm;
+	int fd;
+	fd = shm_open(name,O_RDWR,0);
+	if(fd < 0)
+		return NULL;
+	shm = (struct bsgsd_shm *) mmap(NULL,sizeof(struct bsgsd_shm),PROT_READ | PROT_WRITE,MAP_SHARED,fd,0);
+	close(fd);
+	if(shm == MAP_FAILED)
+		return NULL;
+	if(shm->magic != BSGSD_SHM_MAGIC || shm->version != BSGSD_SHM_VERSION || shm->slot_size != sizeof(struct bsgsd_shm_slot))	{
+		munmap(shm,sizeof(struct bsgsd_shm));
+		return NULL;
+	}
+	return shm;
+}
+
+void bsgsd_close(struct bsgsd_shm *shm)	{
+	munmap(shm,sizeof(struct bsgsd_shm));
+}
+
+/*
+	Take one FREE slot for a new query, -1 if all of them are in use
+*/
+int bsgsd_claim(struct bsgsd_shm *shm)	{
+	uint32_t i,slot,expected;
+	for(i = 0; i < shm->slots; i++)	{
+		slot = __atomic_fetch_add(&shm->next,1,__ATOMIC_RELAXED) % shm->slots;
+		expected = BSGSD_SLOT_FREE;
+		if(__atomic_compare_exchange_n(&shm->slot[slot].state,&expected,BSGSD_SLOT_CLAIMED,0,__ATOMIC_ACQUIRE,__ATOMIC_RELAXED))	{
+			return slot;
+		}
+	}
+	return -1;
+}
+
+/*
+	The query in the slot is complete, count, publickeys and range must be already written
+*/
+void bsgsd_submit(struct bsgsd_shm *shm,int slot)	{
+	bsgsd_shm_lock(shm);
+	__atomic_store_n(&shm->slot[slot].state,BSGSD_SLOT_SUBMITTED,__ATOMIC_RELEASE);
+	shm->submitted++;
+	pthread_cond_signal(&shm->cond_submitted);
+	bsgsd_shm_unlock(shm);
+}
+
+/*
+	1 if the result is ready
+*/
+int bsgsd_poll(struct bsgsd_shm *shm,int slot)	{
+	return __atomic_load_n(&shm->slot[slot].state,__ATOMIC_ACQUIRE) == BSGSD_SLOT_DONE;
+}
+
+/*
+	Wait for the result, milliseconds < 0 waits forever. Returns 1 if the result is ready, 0 on timeout
+*/
+int bsgsd_wait(struct bsgsd_shm *shm,int slot,int milliseconds)	{
+	struct timespec until;
+	int r = 0;
+	if(bsgsd_poll(shm,slot))
+		return 1;
+	if(milliseconds >= 0)	{
+		clock_gettime(CLOCK_REALTIME,&until);
+		until.tv_sec += milliseconds / 1000;
+		until.tv_nsec += (long)(milliseconds % 1000) * 1000000;
+		if(until.tv_nsec >= 1000000000)	{
+			until.tv_sec++;
+			until.tv_nsec -= 1000000000;
+		}
+	}
+	bsgsd_shm_lock(shm);
+	while(!bsgsd_poll(shm,slot) && r != ETIMEDOUT)	{
+		if(milliseconds >= 0)	{
+			r = pthread_cond_timedwait(&shm->cond_done,&shm->mutex,&until);
+		}
+		else	{
+			r = pthread_cond_wait(&shm->cond_done,&shm->mutex);
+		}
+#if defined(__linux__)
+		if(r == EOWNERDEAD)	{
+			pthread_mutex_consistent(&shm->mutex);
+		}
+#endif
+	}
+	bsgsd_shm_unlock(shm);
+	return bsgsd_poll(shm,slot);
+}
+
+/*
+	Give back the slot after read the result
+*/
+void bsgsd_release(struct bsgsd_shm *shm,int slot)	{
+	__atomic_store_n(&shm->slot[slot].state,BSGSD_SLOT_FREE,__ATOMIC_RELEASE);
+}
+
+/*
+	A client that die with the mutex locked don't block the others where robust mutex exist
+*/
+void bsgsd_shm_lock(struct bsgsd_shm *shm)	{
+#if defined(__linux__)
+	if(pthread_mutex_lock(&shm->mutex) == EOWNERDEAD)	{
+		pthread_mutex_consistent(&shm->mutex);
+	}
+#else
+	pthread_mutex_lock(&shm->mutex);
+#endif
+}
+
+void bsgsd_shm_unlock(struct bsgsd_shm *shm)	{
+	pthread_mutex_unlock(&shm->mutex);
+}
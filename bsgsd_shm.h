@@ -0,0 +1,76 @@
+#ifndef BSGSD_SHM_H
+#define BSGSD_SHM_H
+
+/*
+	Shared memory interface of bsgsd (-s name) for local clients, no sockets and no hexadecimal:
+	the client takes one FREE slot, writes the binary query in it and submits it,
+	bsgsd writes the result in the same slot and mark it DONE, then the client release it.
+	All the numbers are big endian 32 bytes like Int::Get32Bytes
+*/
+
+#include <stdint.h>
+#include <pthread.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define BSGSD_SHM_MAGIC 0x44534742		/* "BGSD" */
+#define BSGSD_SHM_VERSION 1
+#define BSGSD_SHM_SLOTS 1024
+#define BSGSD_SHM_TARGETS 16
+
+#define BSGSD_SLOT_FREE 0
+#define BSGSD_SLOT_CLAIMED 1		/* The client is writing the query */
+#define BSGSD_SLOT_SUBMITTED 2
+#define BSGSD_SLOT_QUEUED 3			/* Taken by bsgsd */
+#define BSGSD_SLOT_DONE 4
+
+struct bsgsd_shm_slot	{
+	uint32_t state;
+	uint32_t count;					/* Publickeys, 1 to BSGSD_SHM_TARGETS */
+	int32_t priority;
+	uint32_t deadline;				/* Seconds, 0 without deadline */
+	uint64_t tag;					/* Free for the client, bsgsd don't touch it */
+	uint8_t publickeys[BSGSD_SHM_TARGETS][65];	/* 02/03 and X (33 bytes) or 04, X and Y */
+	uint8_t range_from[32];
+	uint8_t range_to[32];
+	/* Result */
+	uint32_t status;				/* 200 all found, 404, 408 deadline or 400 bad query */
+	uint32_t found;					/* Bit i set if publickeys[i] was found */
+	uint8_t keys[BSGSD_SHM_TARGETS][32];
+	uint8_t scanned_to[32];			/* range_from to scanned_to is finished */
+	uint64_t seconds;
+};
+
+struct bsgsd_shm	{
+	uint32_t magic;
+	uint32_t version;
+	uint32_t slots;
+	uint32_t slot_size;
+	uint32_t next;					/* Where the next claim starts to look */
+	uint32_t submitted;				/* Slots submitted and not taken by bsgsd, protected by mutex */
+	pthread_mutex_t mutex;			/* Process shared */
+	pthread_cond_t cond_submitted;	/* bsgsd waits here */
+	pthread_cond_t cond_done;		/* The clients wait here */
+	struct bsgsd_shm_slot slot[BSGSD_SHM_SLOTS];
+};
+
+/* Client side */
+struct bsgsd_shm *bsgsd_open(const char *name);
+void bsgsd_close(struct bsgsd_shm *shm);
+int bsgsd_claim(struct bsgsd_shm *shm);
+void bsgsd_submit(struct bsgsd_shm *shm,int slot);
+int bsgsd_poll(struct bsgsd_shm *shm,int slot);
+int bsgsd_wait(struct bsgsd_shm *shm,int slot,int milliseconds);
+void bsgsd_release(struct bsgsd_shm *shm,int slot);
+
+/* Shared with bsgsd */
+void bsgsd_shm_lock(struct bsgsd_shm *shm);
+void bsgsd_shm_unlock(struct bsgsd_shm *shm);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -181,7 +181,7 @@ bool Secp256K1::ParsePublicKeyHex(char *str,Point &ret,bool &isCompressed) {
 			strncpy(tempbuffer,str+2,64);
 			tempbuffer[64] = 0x00;
 			ret.x.SetBase16(tempbuffer);
-			ret.x.SetBase16(str+66);
+			ret.y.SetBase16(str+66);
 			isCompressed = false;
 		break;
 		default:
@@ -325,6 +325,95 @@ Point Secp256K1::AddDirect(Point &p1,Point &p2) {
   return r;
 }
 
+/*
+  out[k] = center + (k - size/2)*S for k = 0 .. size-1, table[i] = (i+1)*S for i < size/2.
+  center + i*S and center - i*S have the same delta x, so one batched inversion of
+  size/2 + 1 values covers all the points, grp must be an IntGroup(size/2 + 1) set on dx.
+  If next is not NULL the center is moved to center + next with the same inversion.
+  The Y of out is only calculated with calculate_y, the new center always has it.
+*/
+void Secp256K1::AddDirectBatch(Point &center,Point *table,Point *next,int size,Point *out,bool calculate_y,IntGroup *grp,Int *dx) {
+  Int _s;
+  Int _p;
+  Int dy;
+  Point *pp;
+  Point *pn;
+  int i;
+  int half = size / 2;
+
+  for(i = 0; i < half; i++) {
+    dx[i].ModSub(&table[i].x,&center.x);
+  }
+  if(next != NULL) {
+    dx[half].ModSub(&next->x,&center.x);
+  }
+  else {
+    dx[half].SetInt32(1);
+  }
+  grp->ModInv();
+
+  out[half] = center;
+  for(i = 0; i < half - 1; i++) {
+    pp = &out[half + i + 1];
+    pn = &out[half - i - 1];
+
+    // center + (i+1)*S
+    dy.ModSub(&table[i].y,&center.y);
+    _s.ModMulK1(&dy,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
+    _p.ModSquareK1(&_s);           // _p = pow2(s)
+
+    pp->x.ModSub(&_p,&center.x);
+    pp->x.ModSub(&table[i].x);     // rx = pow2(s) - p1.x - p2.x;
+    if(calculate_y) {
+      pp->y.ModSub(&table[i].x,&pp->x);
+      pp->y.ModMulK1(&_s);
+      pp->y.ModSub(&table[i].y);   // ry = - p2.y - s*(ret.x-p2.x);
+    }
+
+    // center - (i+1)*S, if (x,y) = i*S then (x,-y) = -i*S
+    dy.ModAdd(&table[i].y,&center.y);
+    dy.ModNeg();
+    _s.ModMulK1(&dy,&dx[i]);
+    _p.ModSquareK1(&_s);
+
+    pn->x.ModSub(&_p,&center.x);
+    pn->x.ModSub(&table[i].x);
+    if(calculate_y) {
+      pn->y.ModSub(&table[i].x,&pn->x);
+      pn->y.ModMulK1(&_s);
+      pn->y.ModAdd(&table[i].y);
+    }
+  }
+
+  // First point center - (size/2)*S
+  pn = &out[0];
+  dy.ModAdd(&table[i].y,&center.y);
+  dy.ModNeg();
+  _s.ModMulK1(&dy,&dx[i]);
+  _p.ModSquareK1(&_s);
+
+  pn->x.ModSub(&_p,&center.x);
+  pn->x.ModSub(&table[i].x);
+  if(calculate_y) {
+    pn->y.ModSub(&table[i].x,&pn->x);
+    pn->y.ModMulK1(&_s);
+    pn->y.ModAdd(&table[i].y);
+  }
+
+  if(next != NULL) {
+    dy.ModSub(&next->y,&center.y);
+    _s.ModMulK1(&dy,&dx[half]);
+    _p.ModSquareK1(&_s);
+
+    _p.ModSub(&center.x);
+    center.x.ModSub(&_p,&next->x);   // rx = pow2(s) - p1.x - p2.x;
+
+    center.y.ModSub(&next->x,&center.x);
+    center.y.ModMulK1(&_s);
+    center.y.ModSub(&next->y);       // ry = - p2.y - s*(ret.x-p2.x);
+  }
+}
+
 Point Secp256K1::Add2(Point &p1, Point &p2) {
   // P2.z = 1
   Int u;
@@ -501,6 +590,7 @@ Point Secp256K1::Double(Point &p) {
 Point Secp256K1::ScalarMultiplication(Point &P,Int *scalar)	{
 	Point R,Q,T,Dummy;
 	int  no_of_bits, loop;
+	bool empty = true;	//R is still the point at infinity, Add can't take it
 	no_of_bits = scalar->GetBitLength();
 	R.Clear();
 	R.z.SetInt32(1);
@@ -508,13 +598,20 @@ Point Secp256K1::ScalarMultiplication(Point &P,Int *scalar)	{
 		Q.Set(P);
 		if(scalar->GetBit(0) == 1)	{
 			R.Set(P);
+			empty = false;
 		}
 		for(loop = 1; loop < no_of_bits; loop++) {
 			T = Double(Q);
 			Q.Set(T);
 			T.Set(R);
 			if(scalar->GetBit(loop)){
-				R = Add(T,Q);
+				if(empty)	{
+					R.Set(Q);
+					empty = false;
+				}
+				else	{
+					R = Add(T,Q);
+				}
 			}
 			else	{
 				Dummy = Add(T,Q);
@@ -600,21 +697,52 @@ void Secp256K1::GetHash160(int type,bool compressed,
 		
 		break;
 			case P2SH:
-			printf("Unsoported P2SH\n");
-			exit(0);
-			/*
-			// Redeem Script (1 to 1 P2SH)
-			unsigned char script[64];
-			script[0] = 0x00;  // OP_0
-			script[1] = 0x14;  // PUSH 20 bytes
-			GetHash160(P2PKH, compressed, pubKey, script + 2);
-			sha256(script, 22, shapk);
-			rmd160(shapk,32,hash);
-			*/
+			unsigned char kh[4][20];
+			GetHash160(P2PKH,compressed,k0,k1,k2,k3,kh[0],kh[1],kh[2],kh[3]);
+			GetHash160_P2SH(kh[0],kh[1],kh[2],kh[3],h0,h1,h2,h3);
 		break;
 	}
 }
 
+/*
+	Compressed and uncompressed Hash160 of 4 keys with y already known, only the prefix of the parity of y
+	is hashed and X is serialized once for both messages. hc and hu get the 4 hashes one after the other
+*/
+void Secp256K1::GetHash160_both(Point &k0,Point &k1,Point &k2,Point &k3,uint8_t *hc,uint8_t *hu) {
+	unsigned char digests[4][65];
+	unsigned char compressed[4][33];
+	Point *k[4] = {&k0,&k1,&k2,&k3};
+	int i;
+	for(i = 0; i < 4; i++)	{
+		digests[i][0] = 0x4;
+		k[i]->x.Get32Bytes(digests[i] + 1);
+		k[i]->y.Get32Bytes(digests[i] + 33);
+		compressed[i][0] = 0x2 + (digests[i][64] & 1);
+		memcpy(compressed[i] + 1,digests[i] + 1,32);
+	}
+	sha256_4(33, compressed[0], compressed[1],compressed[2],compressed[3],compressed[0], compressed[1],compressed[2],compressed[3]);
+	rmd160_4(32, compressed[0], compressed[1],compressed[2],compressed[3],hc,hc + 20,hc + 40,hc + 60);
+	sha256_4(65, digests[0], digests[1],digests[2],digests[3],digests[0], digests[1],digests[2],digests[3]);
+	rmd160_4(32, digests[0], digests[1],digests[2],digests[3],hu,hu + 20,hu + 40,hu + 60);
+}
+
+/*
+	Hash160 of the P2SH-P2WPKH redeem script (OP_0 PUSH20 keyhash) of 4 keyhashes
+*/
+void Secp256K1::GetHash160_P2SH(uint8_t *k0,uint8_t *k1,uint8_t *k2,uint8_t *k3,
+  uint8_t *h0,uint8_t *h1,uint8_t *h2,uint8_t *h3) {
+	unsigned char scripts[4][32];
+	int i;
+	uint8_t *keyhashes[4] = {k0,k1,k2,k3};
+	for(i = 0; i < 4; i++)	{
+		scripts[i][0] = 0x00;	// OP_0
+		scripts[i][1] = 0x14;	// PUSH 20 bytes
+		memcpy(scripts[i] + 2,keyhashes[i],20);
+	}
+	sha256_4(22, scripts[0], scripts[1],scripts[2],scripts[3],scripts[0], scripts[1],scripts[2],scripts[3]);
+	rmd160_4(32, scripts[0], scripts[1],scripts[2],scripts[3],h0,h1,h2,h3);
+}
+
 
 void Secp256K1::GetHash160_fromX(int type,unsigned char prefix,
   Int *k0,Int *k1,Int *k2,Int *k3,
@@ -639,8 +767,9 @@ void Secp256K1::GetHash160_fromX(int type,unsigned char prefix,
 		break;
 
 		case P2SH:
-			fprintf(stderr,"[E] Fixme unsopported case");
-			exit(0);
+			unsigned char kh[4][20];
+			GetHash160_fromX(P2PKH,prefix,k0,k1,k2,k3,kh[0],kh[1],kh[2],kh[3]);
+			GetHash160_P2SH(kh[0],kh[1],kh[2],kh[3],h0,h1,h2,h3);
 		break;
 	}
 }
\ No newline at end of file
@@ -25,6 +25,7 @@
 #define SECP256K1H
 
 #include "Point.h"
+#include "IntGroup.h"
 #include <vector>
 
 // Address type
@@ -60,11 +61,15 @@ public:
 	void GetHash160(int type,bool compressed,
     Point &k0, Point &k1, Point &k2, Point &k3,
     uint8_t *h0, uint8_t *h1, uint8_t *h2, uint8_t *h3);
+	void GetHash160_P2SH(uint8_t *k0,uint8_t *k1,uint8_t *k2,uint8_t *k3,
+	uint8_t *h0,uint8_t *h1,uint8_t *h2,uint8_t *h3);
+	void GetHash160_both(Point &k0,Point &k1,Point &k2,Point &k3,uint8_t *hc,uint8_t *hu);
 	
 	Point Negation(Point &p);
 	Point Double(Point &p);
 	Point DoubleDirect(Point &p);
 	Point AddDirect(Point &p1, Point &p2);
+	void AddDirectBatch(Point &center,Point *table,Point *next,int size,Point *out,bool calculate_y,IntGroup *grp,Int *dx);
 	Point G;                 // Generator
 	Int P;                   // Prime for the finite field
 	Int   order;             // Curve order
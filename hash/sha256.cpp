@@ -67,9 +67,11 @@ inline uint32_t _rotr(uint32_t x, uint8_t r) {
     h = t1 + t2;
 
 #ifdef BSWAP
-#define WRITEBE32(ptr,x) *((uint32_t *)(ptr)) = _byteswap_ulong(x)
-#define WRITEBE64(ptr,x) *((uint64_t *)(ptr)) = _byteswap_uint64(x)
-#define READBE32(ptr) (uint32_t)_byteswap_ulong(*(uint32_t *)(ptr))
+// memcpy and not a uint32_t pointer, the buffers are bytes and LTO reorders the accesses
+static inline uint32_t readbe32(const void *ptr) { uint32_t x; memcpy(&x, ptr, 4); return _byteswap_ulong(x); }
+#define WRITEBE32(ptr,x) do { uint32_t _x = _byteswap_ulong(x); memcpy((ptr), &_x, 4); } while (0)
+#define WRITEBE64(ptr,x) do { uint64_t _x = _byteswap_uint64(x); memcpy((ptr), &_x, 8); } while (0)
+#define READBE32(ptr) readbe32(ptr)
 #else
 #define WRITEBE32(ptr,x) *(ptr) = x
 #define WRITEBE64(ptr,x) *(ptr) = x
@@ -16,7 +16,10 @@ email: albertobsd@gmail.com
 #include "oldbloom/oldbloom.h"
 #include "bloom/bloom.h"
 #include "sha3/sha3.h"
+#include "sha3/keccak_batch.h"
+#include "bech32/bech32.h"
 #include "util.h"
+#include "numa.h"
 
 #include "secp256k1/SECP256k1.h"
 #include "secp256k1/Point.h"
@@ -34,6 +37,9 @@ email: albertobsd@gmail.com
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/random.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <sys/mman.h>
 #endif
 
 #ifdef __unix__
@@ -55,11 +61,20 @@ email: albertobsd@gmail.com
 #define MODE_PUB2RMD 4
 #define MODE_MINIKEYS 5
 #define MODE_VANITY 6
+#define MODE_KANGAROO 7
+#define MODE_DPMERGE 8
+#define MODE_RHO 9
 
 #define SEARCH_UNCOMPRESS 0
 #define SEARCH_COMPRESS 1
 #define SEARCH_BOTH 2
 
+
+#define ADDRESS_PREFETCH 4			//Slots of 4 keys between the prefetch and the check of the bloom filters
+#define BLOOM_ADDRESS_MAGIC "bloom256"		//First 8 bytes of the data_ files with 256 bloom filters
+#define TARGETS_P2SH 1		//Kinds of targets saved at the end of the data_ files
+#define TARGETS_BECH32 2
+
 uint32_t  THREADBPWORKLOAD = 1048576;
 
 struct checksumsha256	{
@@ -76,12 +91,97 @@ struct address_value	{
 	uint8_t value[20];
 };
 
+#define XPOINT_BUCKET_SLOTS 15		/* Fingerprints of a bucket of the xpoint index, 64 bytes with the count */
+#define XPOINT_BUCKET_LOAD 8		/* Targets per bucket at most on average */
+#define XPOINT_BUCKET_FULL 0xFFFFFFFF		/* Count of a bucket with more targets than slots */
+
+struct xpoint_bucket	{
+	uint32_t fingerprint[XPOINT_BUCKET_SLOTS];
+	uint32_t count;
+};
+
+#define KANGAROO_NB_JUMP 32
+#define KANGAROO_TAME 0
+#define KANGAROO_WILD 1
+#define KANGAROO_HERD(i) ((i) < CPU_GRP_SIZE / 2 ? KANGAROO_TAME : KANGAROO_WILD)
+#define KANGAROO_MAX_RANGE_BITS 180
+#define KANGAROO_DISTANCE_MASK 0x7FFFFFFFFFFFFFFFULL
+#ifndef KANGAROO_SAVE_SECONDS
+#define KANGAROO_SAVE_SECONDS 300		//-S, the tests build it with a few seconds
+#endif
+#define KANGAROO_FILE_MAGIC "KDP1"
+#define KANGAROO_FILE_SORTED 1
+#define KANGAROO_FILE_COMPRESSED 2
+
+#define RHO_NB_JUMP 64
+#define RHO_DP_BITS 24			//Default, the whole group is too big to derive it like kangaroo mode
+#define RHO_CYCLE_LENGTH 8		//Fruitless cycles up to this length are checked every step
+#define RHO_STEPS_FACTOR 20		//A walk without DP after 20 * 2^dp steps is in a longer cycle
+#define RHO_DOUBLE RHO_NB_JUMP		//Next step of the walk is a doubling
+#ifndef RHO_TABLE_MAX
+#define RHO_TABLE_MAX (1ULL << 22)	//DPs kept per publickey, 2^23 slots of 80 bytes, the tests build it smaller
+#endif
+
+struct dp_table	{
+	uint8_t *data;
+	uint64_t size;			//Number of slots, always a power of 2
+	uint64_t count;
+	uint32_t item_size;		//The first 16 bytes of every item are the X fragment
+};
+
+struct kangaroo_dp	{
+	uint64_t x[2];			//Lower 128 bits of X
+	uint64_t d[3];			//Distance, the bit 63 of d[2] is the herd type
+};
+
+/*
+	DP files are this 128 bytes header followed by count kangaroo_dp items sorted
+	by X fragment, so they can be mapped in memory and merged as streams
+*/
+struct kangaroo_file_header	{
+	char magic[4];
+	uint32_t dp_bits;
+	uint64_t count;
+	uint8_t target[33];		//Compressed publickey
+	uint8_t range_start[32];
+	uint8_t range_end[32];
+	uint8_t flags;			//KANGAROO_FILE_SORTED, KANGAROO_FILE_COMPRESSED
+	uint8_t reserved[14];
+};
+
+/*
+	Rho walks are points P = a*G + b*Q, a DP keeps the X fragment and both coefficients
+*/
+struct rho_dp	{
+	uint64_t x[2];			//Lower 128 bits of X
+	uint64_t a[4];
+	uint64_t b[4];
+};
+
 struct tothread {
 	int nt;     //Number thread
 	char *rs;   //range start
 	char *rpt;  //rng per thread
 };
 
+#define TARGET_LOAD_COUNT 0
+#define TARGET_LOAD_PARSE 1
+#define TARGET_LOAD_SCATTER 2
+#define TARGET_LOAD_SORT 3
+
+struct target_load	{
+	int threadid;
+	int finished;
+	uint64_t from,to;				/* Bytes of the file for this thread, from the start of a line */
+	uint64_t lines;					/* Lines of the chunk */
+	uint64_t start;					/* First item of this thread in target_load_parsed */
+	uint64_t count;					/* Valid items parsed */
+	uint64_t parsed;				/* Bytes parsed, for the progress */
+	uint64_t histogram[256];		/* Items by first byte */
+	uint64_t position[256];			/* Next position in addressTable of the items of every first byte */
+	int byte_from,byte_to;			/* First bytes sorted by this thread */
+};
+
 struct bPload	{
 	uint32_t threadid;
 	uint64_t from;
@@ -134,8 +234,18 @@ Point _2GSn;
 
 void menu();
 void init_generator();
+void subtract_generate(Point &base,uint64_t count,int (*callback)(uint64_t i,Point &target,void *arg),void *arg);
+int subtract_store_bsgs(uint64_t i,Point &target,void *arg);
+int subtract_store_xpoint(uint64_t i,Point &target,void *arg);
+int subtract_find(uint64_t i,Point &target,void *arg);
+bool subtract_load_xpoint(char *fileName);
+void subtract_xpoint_resolve(Int *privatekey);
+void subtract_bsgs_resolve(uint32_t k_index,Int *privatekey);
 
 int searchbinary(struct address_value *buffer,char *data,int64_t array_length);
+int searchaddress(char *data);
+void address_index_build();
+void xpoint_index_build();
 void sleep_ms(int milliseconds);
 
 void _sort(struct address_value *arr,int64_t N);
@@ -156,18 +266,26 @@ int64_t bsgs_partition(struct bsgs_xvalue *arr, int64_t n);
 
 int bsgs_searchbinary(struct bsgs_xvalue *arr,char *data,int64_t array_length,uint64_t *r_value);
 int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey);
-int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey);
+int bsgs_secondcheck_point(Int *start_range,uint32_t a,Point *target,Int *privatekey);
+int bsgs_thirdcheck(Int *start_range,uint32_t a,Point *target,Int *privatekey);
+int bsgs_endomorphism_check(Int *start_range,uint32_t a,uint32_t k_index,Int *x,Int *privatekey);
+void bsgs_setfound(uint32_t k_index);
 
 void sha256sse_22(uint8_t *src0, uint8_t *src1, uint8_t *src2, uint8_t *src3, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2, uint8_t *dst3);
 void sha256sse_23(uint8_t *src0, uint8_t *src1, uint8_t *src2, uint8_t *src3, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2, uint8_t *dst3);
 
 bool vanityrmdmatch(unsigned char *rmdhash);
 void writevanitykey(bool compress,Int *key);
+void writevanitykey_point(bool compressed,Int *key,Point &publickey);
 int addvanity(char *target);
 int minimum_same_bytes(unsigned char* A,unsigned char* B, int length);
 
 void writekey(bool compressed,Int *key);
+void writekey_point(bool compressed,Int *key,Point &publickey);
 void writekeyeth(Int *key);
+void writekeyeth_point(Int *key,Point &publickey);
+void group_hit_point(Point *pts,Point &center,int i,bool calculate_y,Point *publickey);
+void hit_resolve(Int *key,Point *publickey,int variant,int negated);
 
 void checkpointer(void *ptr,const char *file,const char *function,const  char *name,int line);
 
@@ -179,13 +297,55 @@ bool readFileVanity(char *fileName);
 bool forceReadFileAddress(char *fileName);
 bool forceReadFileAddressEth(char *fileName);
 bool forceReadFileXPoint(char *fileName);
+bool readFileTargets(char *fileName,int (*parse)(char *line,uint8_t *value));
+bool target_file_map(char *fileName,char **data,uint64_t *size);
+void target_file_unmap(char *data,uint64_t size);
+int parse_target_address(char *line,uint8_t *value);
+int parse_target_eth(char *line,uint8_t *value);
+int parse_target_xpoint(char *line,uint8_t *value);
 bool processOneVanity();
 
 bool initBloomFilter(struct bloom *bloom_arg,uint64_t items_bloom);
+bool initBloomAddress(uint64_t items_bloom);
+void address_prefetch(uint64_t j,Point *pts,Point *beta,Point *beta2,char (*group_endomorphism)[12][4][20],char (*group_uncompress)[4][20],char (*group_p2sh)[6][4][20]);
 
 void writeFileIfNeeded(const char *fileName);
 
 void calcualteindex(int i,Int *key);
+
+void dp_table_init(struct dp_table *table,uint32_t item_size,uint64_t size);
+void dp_table_clear(struct dp_table *table);
+void dp_table_grow(struct dp_table *table);
+int dp_table_insert(struct dp_table *table,void *item,void *found);
+int dp_table_find(struct dp_table *table,void *item,void *found);
+
+void kangaroo_dp_set(struct kangaroo_dp *dp,Point *p,Int *distance,int type);
+int kangaroo_dp_get(struct kangaroo_dp *dp,Int *distance);
+void kangaroo_init();
+void kangaroo_filename(uint32_t index,char *dst);
+void kangaroo_spawn(uint32_t index,int type,Point *p,Int *distance);
+bool kangaroo_solve(Point *target,Int *start,struct kangaroo_dp *a,struct kangaroo_dp *b,Int *key);
+void kangaroo_settarget(uint32_t index);
+bool kangaroo_load(uint32_t index);
+void kangaroo_save();
+int kangaroo_dp_cmp(const void *a,const void *b);
+void kangaroo_header(uint32_t index,struct kangaroo_file_header *header,uint64_t count);
+bool kangaroo_writefile(const char *filename,struct kangaroo_file_header *header,struct kangaroo_dp *dps);
+bool kangaroo_headermatch(struct kangaroo_file_header *a,struct kangaroo_file_header *b);
+void kangaroo_merge(char *master,int n,char **files);
+void kangaroo_nexttarget(uint32_t index);
+bool readFilePublicKeys(char *fileName,std::vector<Point> &points,std::vector<bool> &compressed);
+
+void rho_init();
+void rho_settarget(uint32_t index);
+void rho_nexttarget(uint32_t index);
+void rho_spawn(uint32_t index,Point *p,Int *a,Int *b);
+void rho_canonical(Point *p,Int *a,Int *b);
+void rho_negorder(Int *x);
+void rho_invorder(Int *x);
+void rho_dp_set(struct rho_dp *dp,Point *p,Int *a,Int *b);
+void rho_dp_get(struct rho_dp *dp,Int *a,Int *b);
+bool rho_solve(Point *target,struct rho_dp *x,struct rho_dp *y,Int *key);
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_process_vanity(LPVOID vargp);
 DWORD WINAPI thread_process_minikeys(LPVOID vargp);
@@ -197,6 +357,9 @@ DWORD WINAPI thread_process_bsgs_random(LPVOID vargp);
 DWORD WINAPI thread_process_bsgs_dance(LPVOID vargp);
 DWORD WINAPI thread_bPload(LPVOID vargp);
 DWORD WINAPI thread_bPload_2blooms(LPVOID vargp);
+DWORD WINAPI thread_target_load(LPVOID vargp);
+DWORD WINAPI thread_process_kangaroo(LPVOID vargp);
+DWORD WINAPI thread_process_rho(LPVOID vargp);
 #else
 void *thread_process_vanity(void *vargp);
 void *thread_process_minikeys(void *vargp);	
@@ -208,24 +371,29 @@ void *thread_process_bsgs_random(void *vargp);
 void *thread_process_bsgs_dance(void *vargp);
 void *thread_bPload(void *vargp);
 void *thread_bPload_2blooms(void *vargp);
+void *thread_target_load(void *vargp);
+void *thread_process_kangaroo(void *vargp);
+void *thread_process_rho(void *vargp);
 #endif
 
 char *pubkeytopubaddress(char *pkey,int length);
 void pubkeytopubaddress_dst(char *pkey,int length,char *dst);
 void rmd160toaddress_dst(char *rmd,char *dst);
+void hash160toaddress_dst(uint8_t version,char *rmd,char *dst);
 void set_minikey(char *buffer,char *rawbuffer,int length);
 bool increment_minikey_index(char *buffer,char *rawbuffer,int index);
 void increment_minikey_N(char *rawbuffer);
 	
 void KECCAK_256(uint8_t *source, size_t size,uint8_t *dst);
 void generate_binaddress_eth(Point &publickey,unsigned char *dst_address);
+void generate_binaddress_eth_group(Point *pts,Point *beta,Point *beta2,int count,unsigned char *bin_publickeys,unsigned char *dst_addresses);
 
 int THREADOUTPUT = 0;
 char *bit_range_str_min;
 char *bit_range_str_max;
 
 const char *bsgs_modes[5] = {"sequential","backward","both","random","dance"};
-const char *modes[7] = {"xpoint","address","bsgs","rmd160","pub2rmd","minikeys","vanity"};
+const char *modes[10] = {"xpoint","address","bsgs","rmd160","pub2rmd","minikeys","vanity","kangaroo","dpmerge","rho"};
 const char *cryptos[3] = {"btc","eth","all"};
 const char *publicsearch[3] = {"uncompress","compress","both"};
 const char *default_fileName = "addresses.txt";
@@ -236,12 +404,16 @@ HANDLE write_keys;
 HANDLE write_random;
 HANDLE bsgs_thread;
 HANDLE *bPload_mutex = NULL;
+HANDLE kangaroo_mutex;
+HANDLE rho_mutex;
 #else
 pthread_t *tid = NULL;
 pthread_mutex_t write_keys;
 pthread_mutex_t write_random;
 pthread_mutex_t bsgs_thread;
 pthread_mutex_t *bPload_mutex = NULL;
+pthread_mutex_t kangaroo_mutex;
+pthread_mutex_t rho_mutex;
 #endif
 
 uint64_t FINISHED_THREADS_COUNTER = 0;
@@ -262,11 +434,24 @@ int vanity_rmd_minimun_bytes_check_length = 999999;
 char **vanity_address_targets = NULL;
 struct bloom *vanity_bloom = NULL;
 
-struct bloom bloom;
+struct bloom *bloom_address = NULL;		/* 256 bloom filters of the targets, the first byte of the value selects one */
+
+struct target_load *target_load_threads = NULL;		/* Threads of readFileTargets */
+int target_load_phase;
+char *target_load_data = NULL;
+struct address_value *target_load_parsed = NULL;
+uint64_t target_load_bucket[257];		/* First item of every first byte in addressTable */
+uint64_t target_load_count[256];		/* Items of every first byte without duplicates */
+int (*target_load_parse)(char *line,uint8_t *value) = NULL;
 
 uint64_t *steps = NULL;
 unsigned int *ends = NULL;
 uint64_t N = 0;
+uint32_t *address_index = NULL;		/* Bucket index of addressTable, see address_index_build */
+uint32_t address_index_bits = 0;
+struct xpoint_bucket *xpoint_index = NULL;		/* Fingerprint index of the xpoint targets, see xpoint_index_build */
+void *xpoint_index_raw = NULL;		/* Allocation of xpoint_index before the alignment to 64 bytes */
+uint32_t xpoint_index_bits = 0;
 
 uint64_t N_SEQUENTIAL_MAX = 0x100000000;
 uint64_t DEBUGCOUNT = 0x400;
@@ -287,6 +472,7 @@ int FLAGMATRIX = 0;
 int KFACTOR = 1;
 int MAXLENGTHADDRESS = -1;
 int NTHREADS = 1;
+int NUMA_MODE = NUMA_NONE;
 
 int FLAGSAVEREADFILE = 0;
 int FLAGREADEDFILE1 = 0;
@@ -297,7 +483,12 @@ int FLAGUPDATEFILE1 = 0;
 
 
 int FLAGSTRIDE = 0;
+int FLAGSUBTRACT = 0;		/* -x count:spacing, the targets are Q - i*spacing*G from one publickey Q, see subtract_generate */
 int FLAGSEARCH = 2;
+int FLAGCOMPRESSPARITY = 0;		/* -P, -l compress calculates Y and hashes only the prefix of its parity */
+int ADDRESS_COMPRESS_END = 2;		/* Compressed hashes of thread_process in group_endomorphism[j][l], l from 0 to ADDRESS_COMPRESS_END */
+int FLAGP2SH = 0;		/* Some target is a P2SH address, the compressed keys are also hashed as P2SH-P2WPKH */
+int FLAGBECH32 = 0;		/* Some target is a bc1q address, it is the same hash160 of the compressed key */
 int FLAGBITRANGE = 0;
 int FLAGRANGE = 0;
 int FLAGFILE = 0;
@@ -314,6 +505,11 @@ char *range_start;
 char *range_end;
 char *str_stride;
 Int stride;
+char *str_subtract;
+uint64_t subtract_count;
+Int subtract_spacing;
+Point subtract_base;
+bool subtract_compressed;
 
 uint64_t BSGS_XVALUE_RAM = 6;
 uint64_t BSGS_BUFFERXPOINTLENGTH = 32;
@@ -410,6 +606,35 @@ Int n_range_aux;
 
 Int lambda,lambda2,beta,beta2;
 
+/*
+Kangaroo Variables
+*/
+std::vector<Point> kangaroo_targets;
+std::vector<bool> kangaroo_targets_compressed;
+uint32_t kangaroo_target_number = 0;
+uint32_t kangaroo_current = 0;		//Index of the publickey that all threads are solving
+int kangaroo_dp_bits = -1;			//-1 to choose it from the range and the number of kangaroos
+uint64_t kangaroo_dp_mask;
+Int kangaroo_range_width;
+Int kangaroo_jump_distance[KANGAROO_NB_JUMP];
+Point kangaroo_jump_point[KANGAROO_NB_JUMP];
+struct dp_table kangaroo_table;
+std::vector<struct kangaroo_dp> kangaroo_batch;	//DPs found since the last save
+char kangaroo_node[9];							//Random id of this run for the batch file names
+uint32_t kangaroo_batch_sequence = 0;
+
+std::vector<Point> rho_targets;
+std::vector<bool> rho_targets_compressed;
+uint32_t rho_target_number = 0;
+uint32_t rho_current = 0;			//Index of the publickey that all threads are solving
+int rho_dp_bits;
+uint64_t rho_dp_mask;
+Int rho_jump_a[RHO_NB_JUMP];
+Int rho_jump_b[RHO_NB_JUMP];
+Point rho_jump_point[RHO_NB_JUMP];	//a*G + b*Q, new for every target
+struct dp_table rho_table;
+int rho_table_full = 0;			//Warned that the table reached RHO_TABLE_MAX
+
 Secp256K1 *secp;
 
 int main(int argc, char **argv)	{
@@ -442,10 +667,14 @@ int main(int argc, char **argv)	{
 	write_keys = CreateMutex(NULL, FALSE, NULL);
 	write_random = CreateMutex(NULL, FALSE, NULL);
 	bsgs_thread = CreateMutex(NULL, FALSE, NULL);
+	kangaroo_mutex = CreateMutex(NULL, FALSE, NULL);
+	rho_mutex = CreateMutex(NULL, FALSE, NULL);
 #else
 	pthread_mutex_init(&write_keys,NULL);
 	pthread_mutex_init(&write_random,NULL);
 	pthread_mutex_init(&bsgs_thread,NULL);
+	pthread_mutex_init(&kangaroo_mutex,NULL);
+	pthread_mutex_init(&rho_mutex,NULL);
 	int s;
 #endif
 
@@ -486,7 +715,7 @@ int main(int argc, char **argv)	{
 	
 	printf("[+] Version %s, developed by AlbertoBSD\n",version);
 
-	while ((c = getopt(argc, argv, "deh6MqRSB:b:c:C:E:f:I:k:l:m:N:n:p:r:s:t:v:G:8:z:")) != -1) {
+	while ((c = getopt(argc, argv, "deh6MPqRSA:B:b:c:C:D:E:f:I:k:l:m:N:n:p:r:s:t:v:G:8:x:z:")) != -1) {
 		switch(c) {
 			case 'h':
 				menu();
@@ -572,6 +801,13 @@ int main(int argc, char **argv)	{
 				}
 				
 			break;
+			case 'D':
+				kangaroo_dp_bits = strtol(optarg,NULL,10);
+				if(kangaroo_dp_bits < 0 || kangaroo_dp_bits > 63)	{
+					fprintf(stderr,"[W] Invalid distinguished point bits %s, using the default value\n",optarg);
+					kangaroo_dp_bits = -1;
+				}
+			break;
 			case 'd':
 				FLAGDEBUG = 1;
 				printf("[+] Flag DEBUG enabled\n");
@@ -621,7 +857,7 @@ int main(int argc, char **argv)	{
 				printf("[+] Matrix screen\n");
 			break;
 			case 'm':
-				switch(indexOf(optarg,modes,7)) {
+				switch(indexOf(optarg,modes,10)) {
 					case MODE_XPOINT: //xpoint
 						FLAGMODE = MODE_XPOINT;
 						printf("[+] Mode xpoint\n");
@@ -656,6 +892,18 @@ int main(int argc, char **argv)	{
 							checkpointer((void *)vanity_bloom,__FILE__,"calloc","vanity_bloom" ,__LINE__ -1);
 						}
 					break;
+					case MODE_KANGAROO:
+						FLAGMODE = MODE_KANGAROO;
+						printf("[+] Mode kangaroo\n");
+					break;
+					case MODE_DPMERGE:
+						FLAGMODE = MODE_DPMERGE;
+						printf("[+] Mode dpmerge\n");
+					break;
+					case MODE_RHO:
+						FLAGMODE = MODE_RHO;
+						printf("[+] Mode rho\n");
+					break;
 					default:
 						fprintf(stderr,"[E] Unknow mode value %s\n",optarg);
 						exit(EXIT_FAILURE);
@@ -666,6 +914,9 @@ int main(int argc, char **argv)	{
 				FLAG_N = 1;
 				str_N = optarg;
 			break;
+			case 'P':
+				FLAGCOMPRESSPARITY = 1;
+			break;
 			case 'q':
 				FLAGQUIET	= 1;
 				printf("[+] Quiet thread output\n");
@@ -763,6 +1014,21 @@ int main(int argc, char **argv)	{
 					exit(EXIT_FAILURE);
 				}
 			break;
+			case 'A':
+				NUMA_MODE = numa_mode_parse(optarg);
+				if(NUMA_MODE < 0)	{
+					fprintf(stderr,"[E] Unknow NUMA mode %s, use interleave or none\n",optarg);
+					exit(EXIT_FAILURE);
+				}
+				if(NUMA_MODE == NUMA_REPLICATE)	{
+					fprintf(stderr,"[W] NUMA replicate is only for bsgsd, using interleave\n");
+					NUMA_MODE = NUMA_INTERLEAVE;
+				}
+			break;
+			case 'x':
+				FLAGSUBTRACT = 1;
+				str_subtract = optarg;
+			break;
 			case 'z':
 				FLAGBLOOMMULTIPLIER= strtol(optarg,NULL,10);
 				if(FLAGBLOOMMULTIPLIER <= 0)	{
@@ -777,12 +1043,15 @@ int main(int argc, char **argv)	{
 		}
 	}
 	
-	if(  FLAGBSGSMODE == MODE_BSGS && FLAGENDOMORPHISM)	{
-		fprintf(stderr,"[E] Endomorphism doesn't work with BSGS\n");
-		exit(EXIT_FAILURE);
+	if(FLAGMODE == MODE_DPMERGE)	{
+		if(FLAGFILE == 0)	{
+			fprintf(stderr,"[E] dpmerge needs the master file: -f master.dat batch1.dat batch2.dat ...\n");
+			exit(EXIT_FAILURE);
+		}
+		kangaroo_merge(fileName,argc - optind,argv + optind);
+		exit(EXIT_SUCCESS);
 	}
 	
-	
 	if(  FLAGBSGSMODE == MODE_BSGS  && FLAGSTRIDE)	{
 		fprintf(stderr,"[E] Stride doesn't work with BSGS\n");
 		exit(EXIT_FAILURE);
@@ -800,9 +1069,40 @@ int main(int argc, char **argv)	{
 		FLAGSTRIDE = 1;
 		stride.Set(&ONE);
 	}
+	if(FLAGSUBTRACT)	{
+		if(FLAGMODE != MODE_BSGS && FLAGMODE != MODE_XPOINT)	{
+			fprintf(stderr,"[E] -x only works with bsgs and xpoint modes\n");
+			exit(EXIT_FAILURE);
+		}
+		subtract_count = strtoull(str_subtract,NULL,10);
+		hextemp = strchr(str_subtract,':');
+		if(hextemp == NULL)	{
+			subtract_spacing.SetInt32(1);
+		}
+		else if(hextemp[1] == '0' && hextemp[2] == 'x')	{
+			subtract_spacing.SetBase16(hextemp+3);
+		}
+		else	{
+			subtract_spacing.SetBase10(hextemp+1);
+		}
+		/* bsgs_point_number is 32 bits */
+		if(subtract_count == 0 || subtract_count > 0xFFFFFFFF || subtract_spacing.IsZero())	{
+			fprintf(stderr,"[E] -x count:spacing, count from 1 to %u and spacing not zero\n",0xFFFFFFFF);
+			exit(EXIT_FAILURE);
+		}
+		hextemp = subtract_spacing.GetBase10();
+		printf("[+] Subtract : %" PRIu64 " targets Q - i*%s*G\n",subtract_count,hextemp);
+		free(hextemp);
+	}
 	init_generator();
 	if(FLAGMODE == MODE_BSGS )	{
 		printf("[+] Mode BSGS %s\n",bsgs_modes[FLAGBSGSMODE]);
+		if(FLAGENDOMORPHISM)	{
+			fprintf(stderr,"[W] -e with bsgs is a lottery over the whole group, it only finds keys out of the range and the search is slower\n");
+		}
+		if(NUMA_MODE != NUMA_NONE)	{
+			printf("[+] NUMA nodes : %i, interleave\n",numa_nodes_init());
+		}
 	}
 	
 	if(FLAGFILE == 0) {
@@ -864,7 +1164,32 @@ int main(int argc, char **argv)	{
 	}
 	N = 0;
 	
-	if(FLAGMODE != MODE_BSGS )	{
+	if(FLAGMODE == MODE_KANGAROO)	{
+		hextemp = n_range_start.GetBase16();
+		printf("[+] -- from : 0x%s\n",hextemp);
+		free(hextemp);
+		hextemp = n_range_end.GetBase16();
+		printf("[+] -- to   : 0x%s\n",hextemp);
+		free(hextemp);
+		if(!readFilePublicKeys(fileName,kangaroo_targets,kangaroo_targets_compressed))	{
+			exit(EXIT_FAILURE);
+		}
+		kangaroo_target_number = kangaroo_targets.size();
+		kangaroo_init();
+	}
+	
+	if(FLAGMODE == MODE_RHO)	{
+		if(FLAGRANGE || FLAGBITRANGE)	{
+			printf("[W] Rho mode walks over the whole group, the range is ignored\n");
+		}
+		if(!readFilePublicKeys(fileName,rho_targets,rho_targets_compressed))	{
+			exit(EXIT_FAILURE);
+		}
+		rho_target_number = rho_targets.size();
+		rho_init();
+	}
+	
+	if(FLAGMODE != MODE_BSGS && FLAGMODE != MODE_KANGAROO && FLAGMODE != MODE_RHO)	{
 		if(FLAG_N){
 			if(str_N[0] == '0' && str_N[1] == 'x')	{
 				N_SEQUENTIAL_MAX =strtol(str_N,NULL,16);
@@ -938,7 +1263,7 @@ int main(int argc, char **argv)	{
 			case MODE_RMD160:
 			case MODE_ADDRESS:
 			case MODE_XPOINT:
-				if(!readFileAddress(fileName))	{
+				if(FLAGSUBTRACT ? !subtract_load_xpoint(fileName) : !readFileAddress(fileName))	{
 					fprintf(stderr,"[E] Unenexpected error\n");
 					exit(EXIT_FAILURE);
 				}
@@ -952,11 +1277,28 @@ int main(int argc, char **argv)	{
 		}
 		
 		if(FLAGMODE != MODE_VANITY && !FLAGREADEDFILE1)	{
-			printf("[+] Sorting data ...");
-			_sort(addressTable,N);
-			printf(" done! %" PRIu64 " values were loaded and sorted\n",N);
+			address_index_build();
 			writeFileIfNeeded(fileName);
 		}
+		if(FLAGMODE == MODE_ADDRESS || FLAGMODE == MODE_RMD160)	{
+			if(FLAGSEARCH == SEARCH_UNCOMPRESS && (FLAGP2SH || FLAGBECH32))	{
+				fprintf(stderr,"[W] The P2SH and bc1q targets are only of compressed keys, they are not searched with -l uncompress\n");
+			}
+			else if(FLAGP2SH)	{
+				printf("[+] P2SH targets, the compressed keys are also checked as P2SH-P2WPKH\n");
+			}
+			if(FLAGCOMPRESSPARITY)	{
+				/* With -e the other prefix is also the negated key of lambda*k and lambda^2*k, both prefixes are needed */
+				if(FLAGSEARCH != SEARCH_COMPRESS || FLAGCRYPTO != CRYPTO_BTC || FLAGENDOMORPHISM)	{
+					fprintf(stderr,"[W] -P is only for -l compress without -e, ignored\n");
+					FLAGCOMPRESSPARITY = 0;
+				}
+				else	{
+					printf("[+] Compressed keys: parity of Y, one hash per X, the negated keys n - k are not checked\n");
+				}
+			}
+			ADDRESS_COMPRESS_END = FLAGENDOMORPHISM ? 6 : ((FLAGCOMPRESSPARITY || FLAGSEARCH == SEARCH_BOTH) ? 1 : 2);
+		}
 	}
 	
 	if(FLAGMODE == MODE_BSGS )	{
@@ -986,7 +1328,7 @@ int main(int argc, char **argv)	{
 		}
 		bsgs_found = (int*) calloc(N,sizeof(int));
 		checkpointer((void *)bsgs_found,__FILE__,"calloc","bsgs_found" ,__LINE__ -1 );
-		OriginalPointsBSGS.reserve(N);
+		OriginalPointsBSGS.resize(N,secp->G);
 		OriginalPointsBSGScompressed = (bool*) malloc(N*sizeof(bool));
 		checkpointer((void *)OriginalPointsBSGScompressed,__FILE__,"malloc","OriginalPointsBSGScompressed" ,__LINE__ -1 );
 		pointx_str = (char*) malloc(65);
@@ -1042,6 +1384,29 @@ int main(int argc, char **argv)	{
 			fprintf(stderr,"[E] The file don't have any valid publickeys\n");
 			exit(EXIT_FAILURE);
 		}
+		if(FLAGSUBTRACT)	{
+			/* The only publickey Q is replaced by the targets Q - i*spacing*G */
+			if(N != 1)	{
+				fprintf(stderr,"[E] -x needs only one publickey in the file\n");
+				exit(EXIT_FAILURE);
+			}
+			subtract_base.Set(OriginalPointsBSGS[0]);
+			subtract_compressed = OriginalPointsBSGScompressed[0];
+			N = subtract_count;
+			free(bsgs_found);
+			bsgs_found = (int*) calloc(N,sizeof(int));
+			checkpointer((void *)bsgs_found,__FILE__,"calloc","bsgs_found" ,__LINE__ -1 );
+			free(OriginalPointsBSGScompressed);
+			OriginalPointsBSGScompressed = (bool*) malloc(N*sizeof(bool));
+			checkpointer((void *)OriginalPointsBSGScompressed,__FILE__,"malloc","OriginalPointsBSGScompressed" ,__LINE__ -1 );
+			OriginalPointsBSGS.resize(N,secp->G);
+			subtract_generate(subtract_base,N,subtract_store_bsgs,NULL);
+			bsgs_point_number = N;
+			printf("[+] Subtract: searching %u points\n",bsgs_point_number);
+		}
+		if(FLAGENDOMORPHISM)	{
+			printf("[+] Endomorphism: beta*X and beta^2*X of every giant step are also checked\n");
+		}
 		BSGS_N.SetInt32(0);
 		BSGS_M.SetInt32(0);
 		
@@ -1239,6 +1604,9 @@ int main(int argc, char **argv)	{
 				fprintf(stderr,"[E] error bloom_init _ [%" PRIu64 "]\n",i);
 				exit(EXIT_FAILURE);
 			}
+			if(NUMA_MODE != NUMA_NONE)	{
+				numa_interleave_range(bloom_bP[i].bf,bloom_bP[i].bytes);
+			}
 			bloom_bP_totalbytes += bloom_bP[i].bytes;
 			//if(FLAGDEBUG) bloom_print(&bloom_bP[i]);
 		}
@@ -1268,6 +1636,9 @@ int main(int argc, char **argv)	{
 				fprintf(stderr,"[E] error bloom_init _ [%" PRIu64 "]\n",i);
 				exit(EXIT_FAILURE);
 			}
+			if(NUMA_MODE != NUMA_NONE)	{
+				numa_interleave_range(bloom_bPx2nd[i].bf,bloom_bPx2nd[i].bytes);
+			}
 			bloom_bP2_totalbytes += bloom_bPx2nd[i].bytes;
 			//if(FLAGDEBUG) bloom_print(&bloom_bPx2nd[i]);
 		}
@@ -1297,6 +1668,9 @@ int main(int argc, char **argv)	{
 				fprintf(stderr,"[E] error bloom_init [%" PRIu64 "]\n",i);
 				exit(EXIT_FAILURE);
 			}
+			if(NUMA_MODE != NUMA_NONE)	{
+				numa_interleave_range(bloom_bPx3rd[i].bf,bloom_bPx3rd[i].bytes);
+			}
 			bloom_bP3_totalbytes += bloom_bPx3rd[i].bytes;
 			//if(FLAGDEBUG) bloom_print(&bloom_bPx3rd[i]);
 		}
@@ -1368,6 +1742,10 @@ int main(int argc, char **argv)	{
 		
 		bPtable = (struct bsgs_xvalue*) malloc(bytes);
 		checkpointer((void *)bPtable,__FILE__,"malloc","bPtable" ,__LINE__ -1 );
+		if(NUMA_MODE != NUMA_NONE)	{
+			/* Before the first touch, so the threads of bPload don't put all the pages in its own node */
+			numa_interleave_range(bPtable,bytes);
+		}
 		memset(bPtable,0,bytes);
 		
 		if(FLAGSAVEREADFILE)	{
@@ -2044,6 +2422,10 @@ int main(int argc, char **argv)	{
 			tt->nt = j;
 			steps[j] = 0;
 			s = 0;
+			if(NUMA_MODE != NUMA_NONE)	{
+				/* The new thread inherit the CPUs of its node, one pool of threads per node */
+				numa_pin(numa_node_of_thread(j,NTHREADS));
+			}
 			switch(FLAGBSGSMODE)	{
 #if defined(_WIN64) && !defined(__CYGWIN__)
 				case 0:
@@ -2089,6 +2471,9 @@ int main(int argc, char **argv)	{
 				exit(EXIT_FAILURE);
 			}
 		}
+		if(NUMA_MODE != NUMA_NONE)	{
+			numa_pin(-1);
+		}
 		free(aux);
 	}
 	if(FLAGMODE != MODE_BSGS)	{
@@ -2121,6 +2506,12 @@ int main(int argc, char **argv)	{
 				case MODE_VANITY:
 					tid[j] = CreateThread(NULL, 0, thread_process_vanity, (void*)tt, 0, &s);
 				break;
+				case MODE_KANGAROO:
+					tid[j] = CreateThread(NULL, 0, thread_process_kangaroo, (void*)tt, 0, &s);
+				break;
+				case MODE_RHO:
+					tid[j] = CreateThread(NULL, 0, thread_process_rho, (void*)tt, 0, &s);
+				break;
 #else
 				case MODE_ADDRESS:
 				case MODE_XPOINT:
@@ -2133,6 +2524,12 @@ int main(int argc, char **argv)	{
 				case MODE_VANITY:
 					s = pthread_create(&tid[j],NULL,thread_process_vanity,(void *)tt);
 				break;
+				case MODE_KANGAROO:
+					s = pthread_create(&tid[j],NULL,thread_process_kangaroo,(void *)tt);
+				break;
+				case MODE_RHO:
+					s = pthread_create(&tid[j],NULL,thread_process_rho,(void *)tt);
+				break;
 #endif
 			}
 			if(s != 0)	{
@@ -2161,6 +2558,11 @@ int main(int argc, char **argv)	{
 		if(check_flag)	{
 			continue_flag = 0;
 		}
+		if(FLAGMODE == MODE_KANGAROO && FLAGSAVEREADFILE)	{
+			if(seconds.GetInt64() % KANGAROO_SAVE_SECONDS == 0)	{
+				kangaroo_save();
+			}
+		}
 		if(OUTPUTSECONDS.IsGreater(&ZERO) ){
 			MPZAUX.Set(&seconds);
 			MPZAUX.Mod(&OUTPUTSECONDS);
@@ -2172,7 +2574,7 @@ int main(int argc, char **argv)	{
 					total.Add(&pretotal);
 				}
 				
-				if(FLAGENDOMORPHISM)	{
+				if(FLAGENDOMORPHISM && FLAGMODE != MODE_BSGS)	{
 					if(FLAGMODE == MODE_XPOINT)	{
 						total.Mult(3);
 					}
@@ -2181,7 +2583,7 @@ int main(int argc, char **argv)	{
 					}
 				}
 				else	{
-					if(FLAGSEARCH == SEARCH_COMPRESS)	{
+					if(FLAGSEARCH == SEARCH_COMPRESS && !FLAGCOMPRESSPARITY && FLAGMODE != MODE_KANGAROO && FLAGMODE != MODE_RHO)	{
 						total.Mult(2);
 					}
 				}
@@ -2272,9 +2674,16 @@ void pubkeytopubaddress_dst(char *pkey,int length,char *dst)	{
 }
 
 void rmd160toaddress_dst(char *rmd,char *dst){
+	hash160toaddress_dst(byte_encode_crypto,rmd,dst);
+}
+
+/*
+	Base58check of a hash160 with any version byte, 0x05 for the P2SH addresses
+*/
+void hash160toaddress_dst(uint8_t version,char *rmd,char *dst){
 	char digest[60];
 	size_t pubaddress_size = 40;
-	digest[0] = byte_encode_crypto;
+	digest[0] = version;
 	memcpy(digest+1,rmd,20);
 	sha256((uint8_t*)digest, 21,(uint8_t*) digest+21);
 	sha256((uint8_t*)digest+21, 32,(uint8_t*) digest+21);
@@ -2334,6 +2743,165 @@ int searchbinary(struct address_value *buffer,char *data,int64_t array_length) {
 	return r;
 }
 
+/* Bucket index of the sorted addressTable, see address_index_fill */
+void address_index_build()	{
+	free(address_index);
+	address_index = NULL;
+	address_index_bits = address_index_size_bits(N);
+	if(address_index_bits == 0)	{
+		return;		/* searchaddress uses searchbinary */
+	}
+	address_index = (uint32_t*) malloc(((1ULL << address_index_bits) + 1) * sizeof(uint32_t));
+	checkpointer((void *)address_index,__FILE__,"malloc","address_index" ,__LINE__ -1 );
+	address_index_fill(address_index,address_index_bits,(uint8_t*)addressTable,N);
+	if(FLAGMODE == MODE_XPOINT)	{
+		xpoint_index_build();
+	}
+}
+
+int searchaddress(char *data)	{
+	if(address_index == NULL)	{
+		return searchbinary(addressTable,data,N);
+	}
+	return address_index_search(address_index,address_index_bits,(uint8_t*)addressTable,data);
+}
+
+static inline int bloom_address_check(const void *data,int len)	{
+	return bloom_check(&bloom_address[((const uint8_t*)data)[0]],data,len);
+}
+
+static inline int bloom_address_add(const void *data,int len)	{
+	return bloom_add(&bloom_address[((const uint8_t*)data)[0]],data,len);
+}
+
+/*
+	Fingerprint index of the xpoint targets. X is already uniform, so its first xpoint_index_bits bits select a bucket
+	of one cache line without any hash, and the bucket has the next 32 bits of X of its targets in sorted order.
+	A generated X is checked against all the targets with one memory access that address_prefetch already requested,
+	so the cost does not grow with the count of targets. Full buckets are left to searchaddress
+*/
+void xpoint_index_build()	{
+	uint64_t i,buckets,prefix;
+	struct xpoint_bucket *b;
+	free(xpoint_index_raw);
+	xpoint_index_raw = NULL;
+	xpoint_index = NULL;
+	xpoint_index_bits = 0;
+	if(N == 0)	{
+		return;
+	}
+	while(xpoint_index_bits < 40 && (N >> xpoint_index_bits) > XPOINT_BUCKET_LOAD)	{
+		xpoint_index_bits++;
+	}
+	buckets = 1ULL << xpoint_index_bits;
+	xpoint_index_raw = calloc(buckets * sizeof(struct xpoint_bucket) + 63,1);
+	checkpointer((void *)xpoint_index_raw,__FILE__,"calloc","xpoint_index_raw" ,__LINE__ -1 );
+	xpoint_index = (struct xpoint_bucket *)(((uintptr_t)xpoint_index_raw + 63) & ~(uintptr_t)63);
+	for(i = 0; i < N; i++)	{
+		prefix = address_prefix((char*)addressTable[i].value);
+		b = &xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0];
+		if(b->count < XPOINT_BUCKET_SLOTS)	{
+			b->fingerprint[b->count++] = (uint32_t)((prefix << xpoint_index_bits) >> 32);
+		}
+		else	{
+			b->count = XPOINT_BUCKET_FULL;
+		}
+	}
+	printf("[+] X fingerprint index: %" PRIu64 " buckets, %.2f MB\n",buckets,(double)(buckets * sizeof(struct xpoint_bucket)) / 1048576);
+}
+
+/*
+	Filter of the xpoint mode in place of the bloom filter, a match is confirmed by searchaddress
+*/
+static inline int xpoint_check(const char *data)	{
+	uint64_t prefix;
+	uint32_t i,fingerprint;
+	const struct xpoint_bucket *b;
+	if(xpoint_index == NULL)	{
+		return bloom_address_check(data,MAXLENGTHADDRESS);
+	}
+	prefix = address_prefix(data);
+	b = &xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0];
+	if(b->count == XPOINT_BUCKET_FULL)	{
+		return 1;
+	}
+	fingerprint = (uint32_t)((prefix << xpoint_index_bits) >> 32);
+	for(i = 0; i < b->count; i++)	{
+		if(b->fingerprint[i] >= fingerprint)	{
+			return b->fingerprint[i] == fingerprint;
+		}
+	}
+	return 0;
+}
+
+static inline void xpoint_prefetch(const char *data)	{
+	uint64_t prefix;
+	if(xpoint_index == NULL)	{
+		bloom_prefetch(&bloom_address[(uint8_t)data[0]],data,MAXLENGTHADDRESS);
+		return;
+	}
+	prefix = address_prefix(data);
+	__builtin_prefetch(&xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0],0,1);
+}
+
+/*
+	Start the bloom filter reads of the 4 keys of the slot j of the group. thread_process checks the slot j
+	ADDRESS_PREFETCH slots after this, so the memory reads of several keys are waited at the same time
+	instead of one DRAM miss per key
+*/
+void address_prefetch(uint64_t j,Point *pts,Point *beta,Point *beta2,char (*group_endomorphism)[12][4][20],char (*group_uncompress)[4][20],char (*group_p2sh)[6][4][20])	{
+	char rawvalue[32];
+	int k,l;
+	switch(FLAGMODE)	{
+		case MODE_RMD160:
+		case MODE_ADDRESS:
+			for(k = 0; k < 4; k++)	{
+				if(FLAGCRYPTO == CRYPTO_ETH)	{
+					if(FLAGENDOMORPHISM)	{
+						for(l = 0; l < 6; l++)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+					else	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_uncompress[j][k][0]],group_uncompress[j][k],MAXLENGTHADDRESS);
+					}
+					continue;
+				}
+				if(FLAGSEARCH == SEARCH_COMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
+					for(l = 0; l < ADDRESS_COMPRESS_END; l++)	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						if(group_p2sh != NULL)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_p2sh[j][l][k][0]],group_p2sh[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+				}
+				if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
+					if(FLAGENDOMORPHISM)	{
+						for(l = 6; l < 12; l++)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+					else	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_uncompress[j][k][0]],group_uncompress[j][k],MAXLENGTHADDRESS);
+					}
+				}
+			}
+		break;
+		case MODE_XPOINT:
+			for(k = 0; k < 4; k++)	{
+				pts[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+				xpoint_prefetch(rawvalue);
+				if(FLAGENDOMORPHISM)	{
+					beta[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+					xpoint_prefetch(rawvalue);
+					beta2[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+					xpoint_prefetch(rawvalue);
+				}
+			}
+		break;
+	}
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_process_minikeys(LPVOID vargp) {
 #else
@@ -2464,9 +3032,9 @@ void *thread_process_minikeys(void *vargp)	{
 					secp->GetHash160(P2PKH,false,publickey[0],publickey[1],publickey[2],publickey[3],(uint8_t*)publickeyhashrmd160_uncompress[0],(uint8_t*)publickeyhashrmd160_uncompress[1],(uint8_t*)publickeyhashrmd160_uncompress[2],(uint8_t*)publickeyhashrmd160_uncompress[3]);
 					
 					for(k = 0; k < 4; k++)	{
-						r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],20);
+						r = bloom_address_check(publickeyhashrmd160_uncompress[k],20);
 						if(r) {
-							r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+							r = searchaddress(publickeyhashrmd160_uncompress[k]);
 							if(r) {
 								/* hit */
 								hextemp = key_mpz[k].GetBase16();
@@ -2518,31 +3086,43 @@ void *thread_process(void *vargp)	{
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
-	Point startP;
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
-	Point pp;
-	Point pn;
-	int i,l,pp_offset,pn_offset,hLength = (CPU_GRP_SIZE / 2 - 1);
+	Point startP,groupcenter;
+	int i,l;
 	uint64_t j,count;
 	Point R,temporal,publickey;
 	int r,thread_number,continue_flag = 1,k;
 	char *hextemp = NULL;
 	
-	char publickeyhashrmd160[20];
-	char publickeyhashrmd160_uncompress[4][20];
+	char (*publickeyhashrmd160_uncompress)[20];		/* Slot j of group_uncompress */
 	char rawvalue[32];
 	
-	char publickeyhashrmd160_endomorphism[12][4][20];
+	char (*publickeyhashrmd160_endomorphism)[4][20];		/* Slot j of group_endomorphism */
+	char (*group_uncompress)[4][20],(*group_endomorphism)[12][4][20];		/* Hashes of the whole group, 4 keys per slot */
+	char (*group_p2sh)[6][4][20] = NULL;		/* Script hashes of the compressed hashes, only with P2SH targets */
+	unsigned char *eth_publickeys = NULL,*eth_addresses = NULL;
 	
-	bool calculate_y = FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH || FLAGCRYPTO  == CRYPTO_ETH;
+	bool calculate_y = FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH || FLAGCOMPRESSPARITY || FLAGCRYPTO  == CRYPTO_ETH;
+	bool compress_prefixes = !FLAGCOMPRESSPARITY && (FLAGENDOMORPHISM || FLAGSEARCH != SEARCH_BOTH);		/* Compressed hashes of the prefixes 02 and 03 of X, else only the prefix of Y */
 	Int key_mpz,keyfound,temp_stride;
 	tt = (struct tothread *)vargp;
 	thread_number = tt->nt;
 	free(tt);
 	grp->Set(dx);
+	group_uncompress = (char (*)[4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_uncompress));
+	checkpointer((void *)group_uncompress,__FILE__,"malloc","group_uncompress" ,__LINE__ -1 );
+	group_endomorphism = (char (*)[12][4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_endomorphism));
+	checkpointer((void *)group_endomorphism,__FILE__,"malloc","group_endomorphism" ,__LINE__ -1 );
+	if(FLAGP2SH && FLAGCRYPTO == CRYPTO_BTC && FLAGSEARCH != SEARCH_UNCOMPRESS)	{
+		group_p2sh = (char (*)[6][4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_p2sh));
+		checkpointer((void *)group_p2sh,__FILE__,"malloc","group_p2sh" ,__LINE__ -1 );
+	}
+	if(FLAGCRYPTO == CRYPTO_ETH)	{
+		/* The Keccak of the whole group is done at once, 6 addresses per point with endomorphism */
+		eth_publickeys = (unsigned char*) malloc(6 * CPU_GRP_SIZE * 64);
+		checkpointer((void *)eth_publickeys,__FILE__,"malloc","eth_publickeys" ,__LINE__ -1 );
+		eth_addresses = (unsigned char*) malloc(6 * CPU_GRP_SIZE * 20);
+		checkpointer((void *)eth_addresses,__FILE__,"malloc","eth_addresses" ,__LINE__ -1 );
+	}
 			
 	do {
 		if(FLAGRANDOM){
@@ -2583,134 +3163,40 @@ void *thread_process(void *vargp)	{
 					THREADOUTPUT = 1;
 				}
 			}
+			temp_stride.SetInt32(CPU_GRP_SIZE / 2);
+			temp_stride.Mult(&stride);
+			key_mpz.Add(&temp_stride);
+			startP = secp->ComputePublicKey(&key_mpz);
+			key_mpz.Sub(&temp_stride);
 			do {
-				temp_stride.SetInt32(CPU_GRP_SIZE / 2);
-				temp_stride.Mult(&stride);
-				key_mpz.Add(&temp_stride);
-	 			startP = secp->ComputePublicKey(&key_mpz);
-				key_mpz.Sub(&temp_stride);
-
-				for(i = 0; i < hLength; i++) {
-					dx[i].ModSub(&Gn[i].x,&startP.x);
-				}
-			
-				dx[i].ModSub(&Gn[i].x,&startP.x);  // For the first point
-				dx[i + 1].ModSub(&_2Gn.x,&startP.x); // For the next center point
-				grp->ModInv();
-
-				pts[CPU_GRP_SIZE / 2] = startP;
-
-				for(i = 0; i<hLength; i++) {
-					pp = startP;
-					pn = startP;
-
-					// P = startP + i*G
-					dy.ModSub(&Gn[i].y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-					if(calculate_y)	{
-						pp.y.ModSub(&Gn[i].x,&pp.x);
-						pp.y.ModMulK1(&_s);
-						pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-					dyn.Set(&Gn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-					if(calculate_y)	{
-						pn.y.ModSub(&Gn[i].x,&pn.x);
-						pn.y.ModMulK1(&_s);
-						pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					pp_offset = CPU_GRP_SIZE / 2 + (i + 1);
-					pn_offset = CPU_GRP_SIZE / 2 - (i + 1);
-
-					pts[pp_offset] = pp;
-					pts[pn_offset] = pn;
-					
-					if(FLAGENDOMORPHISM)	{
-						/*
-							Q = (x,y)
-							For any point Q
-							Q*lambda = (x*beta mod p ,y)
-							Q*lambda is a Scalar Multiplication
-							x*beta is just a Multiplication (Very fast)
-						*/
-						
-						if( calculate_y  )	{
-							endomorphism_beta[pp_offset].y.Set(&pp.y);
-							endomorphism_beta[pn_offset].y.Set(&pn.y);
-							endomorphism_beta2[pp_offset].y.Set(&pp.y);
-							endomorphism_beta2[pn_offset].y.Set(&pn.y);
-						}
-						endomorphism_beta[pp_offset].x.ModMulK1(&pp.x, &beta);
-						endomorphism_beta[pn_offset].x.ModMulK1(&pn.x, &beta);
-						endomorphism_beta2[pp_offset].x.ModMulK1(&pp.x, &beta2);
-						endomorphism_beta2[pn_offset].x.ModMulK1(&pn.x, &beta2);
-					}
-				}
-				/*
-					Half point for endomorphism because pts[CPU_GRP_SIZE / 2] was not calcualte in the previous cycle
-				*/
+				/* The center moves CPU_GRP_SIZE*stride every round, AddDirectBatch updates it */
+				groupcenter.Set(startP);		/* Center of this group for group_hit_point */
+				secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,calculate_y,grp,dx);
 				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-
-						endomorphism_beta[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
-						endomorphism_beta2[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
+					/*
+						Q = (x,y)
+						For any point Q
+						Q*lambda = (x*beta mod p ,y)
+						Q*lambda is a Scalar Multiplication
+						x*beta is just a Multiplication (Very fast)
+					*/
+					for(i = 0; i < CPU_GRP_SIZE; i++)	{
+						if(calculate_y)	{
+							endomorphism_beta[i].y.Set(&pts[i].y);
+							endomorphism_beta2[i].y.Set(&pts[i].y);
+						}
+						endomorphism_beta[i].x.ModMulK1(&pts[i].x, &beta);
+						endomorphism_beta2[i].x.ModMulK1(&pts[i].x, &beta2);
 					}
-					endomorphism_beta[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta);
-					endomorphism_beta2[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta2);
-				}
-
-				// First point (startP - (GRP_SZIE/2)*G)
-				pn = startP;
-				dyn.Set(&Gn[i].y);
-				dyn.ModNeg();
-				dyn.ModSub(&pn.y);
-
-				_s.ModMulK1(&dyn,&dx[i]);
-				_p.ModSquareK1(&_s);
-
-				pn.x.ModNeg();
-				pn.x.ModAdd(&_p);
-				pn.x.ModSub(&Gn[i].x);
-				
-				if(calculate_y)	{
-					pn.y.ModSub(&Gn[i].x,&pn.x);
-					pn.y.ModMulK1(&_s);
-					pn.y.ModAdd(&Gn[i].y);
 				}
-
-				pts[0] = pn;
 				
-				/*
-					First point for endomorphism because pts[0] was not calcualte previously
-				*/
-				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-						endomorphism_beta[0].y.Set(&pn.y);
-						endomorphism_beta2[0].y.Set(&pn.y);
-					}
-					endomorphism_beta[0].x.ModMulK1(&pn.x, &beta);
-					endomorphism_beta2[0].x.ModMulK1(&pn.x, &beta2);
-				}
 								
+				if(FLAGCRYPTO == CRYPTO_ETH && (FLAGMODE == MODE_ADDRESS || FLAGMODE == MODE_RMD160))	{
+					generate_binaddress_eth_group(pts,FLAGENDOMORPHISM ? endomorphism_beta : NULL,endomorphism_beta2,CPU_GRP_SIZE,eth_publickeys,eth_addresses);
+				}
 				for(j = 0; j < CPU_GRP_SIZE/4;j++){
+					publickeyhashrmd160_uncompress = group_uncompress[j];
+					publickeyhashrmd160_endomorphism = group_endomorphism[j];
 					switch(FLAGMODE)	{
 						case MODE_RMD160:
 						case MODE_ADDRESS:
@@ -2727,11 +3213,23 @@ void *thread_process(void *vargp)	{
 										secp->GetHash160_fromX(P2PKH,0x02,&endomorphism_beta2[(j*4)].x,&endomorphism_beta2[(j*4)+1].x,&endomorphism_beta2[(j*4)+2].x,&endomorphism_beta2[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[4][0],(uint8_t*)publickeyhashrmd160_endomorphism[4][1],(uint8_t*)publickeyhashrmd160_endomorphism[4][2],(uint8_t*)publickeyhashrmd160_endomorphism[4][3]);
 										secp->GetHash160_fromX(P2PKH,0x03,&endomorphism_beta2[(j*4)].x,&endomorphism_beta2[(j*4)+1].x,&endomorphism_beta2[(j*4)+2].x,&endomorphism_beta2[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[5][0],(uint8_t*)publickeyhashrmd160_endomorphism[5][1],(uint8_t*)publickeyhashrmd160_endomorphism[5][2],(uint8_t*)publickeyhashrmd160_endomorphism[5][3]);
 									}
+									else if(FLAGCOMPRESSPARITY)	{
+										secp->GetHash160(P2PKH,true,pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_endomorphism[0][0],(uint8_t*)publickeyhashrmd160_endomorphism[0][1],(uint8_t*)publickeyhashrmd160_endomorphism[0][2],(uint8_t*)publickeyhashrmd160_endomorphism[0][3]);
+									}
+									else if(FLAGSEARCH == SEARCH_BOTH)	{
+										/* Y is known, only the prefix of its parity and the uncompressed hash in the same pass */
+										secp->GetHash160_both(pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_endomorphism[0],(uint8_t*)publickeyhashrmd160_uncompress);
+									}
 									else	{
 										secp->GetHash160_fromX(P2PKH,0x02,&pts[(j*4)].x,&pts[(j*4)+1].x,&pts[(j*4)+2].x,&pts[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[0][0],(uint8_t*)publickeyhashrmd160_endomorphism[0][1],(uint8_t*)publickeyhashrmd160_endomorphism[0][2],(uint8_t*)publickeyhashrmd160_endomorphism[0][3]);
 										secp->GetHash160_fromX(P2PKH,0x03,&pts[(j*4)].x,&pts[(j*4)+1].x,&pts[(j*4)+2].x,&pts[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[1][0],(uint8_t*)publickeyhashrmd160_endomorphism[1][1],(uint8_t*)publickeyhashrmd160_endomorphism[1][2],(uint8_t*)publickeyhashrmd160_endomorphism[1][3]);
 									}
-									
+									if(group_p2sh != NULL)	{
+										/* P2SH-P2WPKH, second hash over the redeem script of every compressed hash */
+										for(l = 0; l < ADDRESS_COMPRESS_END; l++)	{
+											secp->GetHash160_P2SH((uint8_t*)publickeyhashrmd160_endomorphism[l][0],(uint8_t*)publickeyhashrmd160_endomorphism[l][1],(uint8_t*)publickeyhashrmd160_endomorphism[l][2],(uint8_t*)publickeyhashrmd160_endomorphism[l][3],(uint8_t*)group_p2sh[j][l][0],(uint8_t*)group_p2sh[j][l][1],(uint8_t*)group_p2sh[j][l][2],(uint8_t*)group_p2sh[j][l][3]);
+										}
+									}
 								}
 								if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH){
 									if(FLAGENDOMORPHISM)	{
@@ -2753,37 +3251,36 @@ void *thread_process(void *vargp)	{
 										secp->GetHash160(P2PKH,false, endomorphism_negeted_point[0], endomorphism_negeted_point[1],   endomorphism_negeted_point[2],endomorphism_negeted_point[3],(uint8_t*)publickeyhashrmd160_endomorphism[11][0],(uint8_t*)publickeyhashrmd160_endomorphism[11][1],(uint8_t*)publickeyhashrmd160_endomorphism[11][2],(uint8_t*)publickeyhashrmd160_endomorphism[11][3]);
 
 									}
-									else	{
+									else if(FLAGSEARCH == SEARCH_UNCOMPRESS)	{	/* With -l both it was made by GetHash160_both */
 										secp->GetHash160(P2PKH,false,pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_uncompress[0],(uint8_t*)publickeyhashrmd160_uncompress[1],(uint8_t*)publickeyhashrmd160_uncompress[2],(uint8_t*)publickeyhashrmd160_uncompress[3]);
 										
 									}
 								}
 							}								
 							else if(FLAGCRYPTO == CRYPTO_ETH){
+								/* Already hashed by generate_binaddress_eth_group */
 								if(FLAGENDOMORPHISM)	{
-									for(k = 0; k < 4;k++)	{
-										endomorphism_negeted_point[k] = secp->Negation(pts[(j*4)+k]);
-										generate_binaddress_eth(pts[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[0][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[1][k]);
-										endomorphism_negeted_point[k] = secp->Negation(endomorphism_beta[(j*4)+k]);
-										generate_binaddress_eth(endomorphism_beta[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[2][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[3][k]);
-										endomorphism_negeted_point[k] = secp->Negation(endomorphism_beta2[(j*4)+k]);
-										generate_binaddress_eth(endomorphism_beta[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[4][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[5][k]);
+									for(l = 0; l < 6; l++)	{
+										memcpy(publickeyhashrmd160_endomorphism[l],eth_addresses + ((uint64_t)l*CPU_GRP_SIZE + j*4) * 20,4 * 20);
 									}
 								}
 								else	{
-									for(k = 0; k < 4;k++)	{
-										generate_binaddress_eth(pts[(4*j)+k],(uint8_t*)publickeyhashrmd160_uncompress[k]);
-									}
+									memcpy(publickeyhashrmd160_uncompress,eth_addresses + (uint64_t)j * 4 * 20,4 * 20);
 								}
 								
 							}
 						break;
 					}
-
-
+				}
+				for(j = 0; j < ADDRESS_PREFETCH && j < CPU_GRP_SIZE/4; j++)	{
+					address_prefetch(j,pts,endomorphism_beta,endomorphism_beta2,group_endomorphism,group_uncompress,group_p2sh);
+				}
+				for(j = 0; j < CPU_GRP_SIZE/4;j++){
+					publickeyhashrmd160_uncompress = group_uncompress[j];
+					publickeyhashrmd160_endomorphism = group_endomorphism[j];
+					if(j + ADDRESS_PREFETCH < CPU_GRP_SIZE/4)	{
+						address_prefetch(j + ADDRESS_PREFETCH,pts,endomorphism_beta,endomorphism_beta2,group_endomorphism,group_uncompress,group_p2sh);
+					}
 					switch(FLAGMODE)	{
 						case MODE_RMD160:
 						case MODE_ADDRESS:
@@ -2792,85 +3289,35 @@ void *thread_process(void *vargp)	{
 								for(k = 0; k < 4;k++)	{
 									if(FLAGSEARCH == SEARCH_COMPRESS || FLAGSEARCH == SEARCH_BOTH){
 										if(FLAGENDOMORPHISM)	{
-											for(l = 0;l < 6; l++)	{
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											for(l = 0;l < ADDRESS_COMPRESS_END; l++)	{
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS) || (group_p2sh != NULL && bloom_address_check(group_p2sh[j][l][k],MAXLENGTHADDRESS));
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]) || (group_p2sh != NULL && searchaddress(group_p2sh[j][l][k]));
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
-														publickey = secp->ComputePublicKey(&keyfound);
-														switch(l)	{
-															case 0:	//Original point, prefix 02
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 1:	//Original point, prefix 03
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 03
-															break;
-															case 2:	//Beta point, prefix 02
-																keyfound.ModMulK1order(&lambda);
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 3:	//Beta point, prefix 03											
-																keyfound.ModMulK1order(&lambda);
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 4:	//Beta^2 point, prefix 02
-																keyfound.ModMulK1order(&lambda2);
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 5:	//Beta^2 point, prefix 03
-																keyfound.ModMulK1order(&lambda2);
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-														}
-														writekey(true,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														/* Slot l is the prefix 02 + (l & 1) of the point, beta and beta^2 points for l / 2 */
+														hit_resolve(&keyfound,&publickey,l / 2,compress_prefixes && publickey.y.IsOdd() != (l & 1));
+														writekey_point(true,&keyfound,publickey);
 													}
 												}
 											}
 										}
 										else	{
-											for(l = 0;l < 2; l++)	{
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											for(l = 0;l < ADDRESS_COMPRESS_END; l++)	{
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS) || (group_p2sh != NULL && bloom_address_check(group_p2sh[j][l][k],MAXLENGTHADDRESS));
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]) || (group_p2sh != NULL && searchaddress(group_p2sh[j][l][k]));
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
 														
-														publickey = secp->ComputePublicKey(&keyfound);
-														secp->GetHash160(P2PKH,true,publickey,(uint8_t*)publickeyhashrmd160);
-														if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160,20) != 0)	{
-															keyfound.Neg();
-															keyfound.Add(&secp->order);
-														}
-														writekey(true,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														hit_resolve(&keyfound,&publickey,0,compress_prefixes && publickey.y.IsOdd() != (l & 1));
+														writekey_point(true,&keyfound,publickey);
 													}
 												}
 											}
@@ -2880,58 +3327,31 @@ void *thread_process(void *vargp)	{
 									if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
 										if(FLAGENDOMORPHISM)	{
 											for(l = 6;l < 12; l++)	{	//We check the array from 6 to 12(excluded) because we save the uncompressed information there
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);	//Check in Bloom filter
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);	//Check in Bloom filter
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);		//Check in Array using Binary search
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]);		//Check in Array using Binary search
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
-														switch(l)	{
-															case 6:
-															case 7:
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-															case 8:
-															case 9:
-																keyfound.ModMulK1order(&lambda);
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-															case 10:
-															case 11:
-																keyfound.ModMulK1order(&lambda2);
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-														}
-														writekey(false,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														/* Slots 6 to 11 are the point, beta and beta^2 points, each one followed by its negation */
+														hit_resolve(&keyfound,&publickey,(l - 6) / 2,l & 1);
+														writekey_point(false,&keyfound,publickey);
 													}
 												}
 											}
 										}
 										else	{
-											r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
+											r = bloom_address_check(publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
 											if(r) {
-												r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+												r = searchaddress(publickeyhashrmd160_uncompress[k]);
 												if(r) {
 													keyfound.SetInt32(k);
 													keyfound.Mult(&stride);
 													keyfound.Add(&key_mpz);
-													writekey(false,&keyfound);
+													group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+													writekey_point(false,&keyfound,publickey);
 												}
 											}
 										}
@@ -2942,45 +3362,17 @@ void *thread_process(void *vargp)	{
 								if(FLAGENDOMORPHISM)	{
 									for(k = 0; k < 4;k++)	{
 										for(l = 0;l < 6; l++)	{
-											r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
 											if(r) {
-												r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+												r = searchaddress(publickeyhashrmd160_endomorphism[l][k]);
 												if(r) {												
 													keyfound.SetInt32(k);
 													keyfound.Mult(&stride);
 													keyfound.Add(&key_mpz);
-													switch(l)	{
-														case 0:
-														case 1:
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-														case 2:
-														case 3:
-															keyfound.ModMulK1order(&lambda);
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-														case 4:
-														case 5:
-															keyfound.ModMulK1order(&lambda2);
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-													}
-													writekeyeth(&keyfound);											
+													group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+													/* The same slots of generate_binaddress_eth_group */
+													hit_resolve(&keyfound,&publickey,l / 2,l & 1);
+													writekeyeth_point(&keyfound,publickey);											
 												}
 											}
 										}
@@ -2988,14 +3380,15 @@ void *thread_process(void *vargp)	{
 								}
 								else	{
 									for(k = 0; k < 4;k++)	{
-										r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
+										r = bloom_address_check(publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
 										if(r) {
-											r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+											r = searchaddress(publickeyhashrmd160_uncompress[k]);
 											if(r) {
 												keyfound.SetInt32(k);
 												keyfound.Mult(&stride);
 												keyfound.Add(&key_mpz);
-												writekeyeth(&keyfound);
+												group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+												writekeyeth_point(&keyfound,publickey);
 											}
 										}
 									}
@@ -3006,54 +3399,66 @@ void *thread_process(void *vargp)	{
 							for(k = 0; k < 4;k++)	{
 								if(FLAGENDOMORPHISM)	{
 									pts[(4*j)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 									endomorphism_beta[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											keyfound.ModMulK1order(&lambda);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 									
 									endomorphism_beta2[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											keyfound.ModMulK1order(&lambda2);
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 								}
 								else	{
 									pts[(4*j)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
@@ -3075,25 +3480,14 @@ void *thread_process(void *vargp)	{
 
 				steps[thread_number]++;
 
-				// Next start point (startP + GRP_SIZE*G)
-				pp = startP;
-				dy.ModSub(&_2Gn.y,&pp.y);
-
-				_s.ModMulK1(&dy,&dx[i + 1]);
-				_p.ModSquareK1(&_s);
-
-				pp.x.ModNeg();
-				pp.x.ModAdd(&_p);
-				pp.x.ModSub(&_2Gn.x);
-
-				//The Y value for the next start point always need to be calculated
-				pp.y.ModSub(&_2Gn.x,&pp.x);
-				pp.y.ModMulK1(&_s);
-				pp.y.ModSub(&_2Gn.y);
-				startP = pp;
 			}while(count < N_SEQUENTIAL_MAX && continue_flag);
 		}
 	} while(continue_flag);
+	free(eth_publickeys);
+	free(eth_addresses);
+	free(group_uncompress);
+	free(group_endomorphism);
+	free(group_p2sh);
 	ends[thread_number] = 1;
 	return NULL;
 }
@@ -3113,19 +3507,12 @@ void *thread_process_vanity(void *vargp)	{
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
-	Point startP;
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
-	Point pp;	//point positive
-	Point pn;	//point negative
-	int l,pp_offset,pn_offset,i,hLength = (CPU_GRP_SIZE / 2 - 1);
+	Point startP,groupcenter;
+	int l,i;
 	uint64_t j,count;
 	Point R,temporal,publickey;
 	int thread_number,continue_flag = 1,k;
 	char *hextemp = NULL;
-	char publickeyhashrmd160[20];
 	char publickeyhashrmd160_uncompress[4][20];
 	
 	char publickeyhashrmd160_endomorphism[12][4][20];
@@ -3193,130 +3580,33 @@ void *thread_process_vanity(void *vargp)	{
 					THREADOUTPUT = 1;
 				}
 			}
+			temp_stride.SetInt32(CPU_GRP_SIZE / 2);
+			temp_stride.Mult(&stride);
+			key_mpz.Add(&temp_stride);
+			startP = secp->ComputePublicKey(&key_mpz);
+			key_mpz.Sub(&temp_stride);
 			do {
-				temp_stride.SetInt32(CPU_GRP_SIZE / 2);
-				temp_stride.Mult(&stride);
-				key_mpz.Add(&temp_stride);
-	 			startP = secp->ComputePublicKey(&key_mpz);
-				key_mpz.Sub(&temp_stride);
-
-				for(i = 0; i < hLength; i++) {
-					dx[i].ModSub(&Gn[i].x,&startP.x);
-				}
-			
-				dx[i].ModSub(&Gn[i].x,&startP.x);  // For the first point
-				dx[i + 1].ModSub(&_2Gn.x,&startP.x); // For the next center point
-				grp->ModInv();
-
-				pts[CPU_GRP_SIZE / 2] = startP;
-
-				for(i = 0; i<hLength; i++) {
-					pp = startP;
-					pn = startP;
-
-					// P = startP + i*G
-					dy.ModSub(&Gn[i].y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-					
-					if(calculate_y)	{
-						pp.y.ModSub(&Gn[i].x,&pp.x);
-						pp.y.ModMulK1(&_s);
-						pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-					dyn.Set(&Gn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-					if( calculate_y  )	{
-						pn.y.ModSub(&Gn[i].x,&pn.x);
-						pn.y.ModMulK1(&_s);
-						pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-					}
-					pp_offset = CPU_GRP_SIZE / 2 + (i + 1);
-					pn_offset = CPU_GRP_SIZE / 2 - (i + 1);
-
-					pts[pp_offset] = pp;
-					pts[pn_offset] = pn;
-					
-					if(FLAGENDOMORPHISM)	{
-						/*
-							Q = (x,y)
-							For any point Q
-							Q*lambda = (x*beta mod p ,y)
-							Q*lambda is a Scalar Multiplication
-							x*beta is just a Multiplication (Very fast)
-						*/
-						
-						if( calculate_y  )	{
-							endomorphism_beta[pp_offset].y.Set(&pp.y);
-							endomorphism_beta[pn_offset].y.Set(&pn.y);
-							endomorphism_beta2[pp_offset].y.Set(&pp.y);
-							endomorphism_beta2[pn_offset].y.Set(&pn.y);
-						}
-						endomorphism_beta[pp_offset].x.ModMulK1(&pp.x, &beta);
-						endomorphism_beta[pn_offset].x.ModMulK1(&pn.x, &beta);
-						endomorphism_beta2[pp_offset].x.ModMulK1(&pp.x, &beta2);
-						endomorphism_beta2[pn_offset].x.ModMulK1(&pn.x, &beta2);
-					}
-				}
-				/*
-					Half point for endomorphism because pts[CPU_GRP_SIZE / 2] was not calcualte in the previous cycle
-				*/
+				/* The center moves CPU_GRP_SIZE*stride every round, AddDirectBatch updates it */
+				groupcenter.Set(startP);		/* Center of this group for group_hit_point */
+				secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,calculate_y,grp,dx);
 				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-
-						endomorphism_beta[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
-						endomorphism_beta2[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
+					/*
+						Q = (x,y)
+						For any point Q
+						Q*lambda = (x*beta mod p ,y)
+						Q*lambda is a Scalar Multiplication
+						x*beta is just a Multiplication (Very fast)
+					*/
+					for(i = 0; i < CPU_GRP_SIZE; i++)	{
+						if(calculate_y)	{
+							endomorphism_beta[i].y.Set(&pts[i].y);
+							endomorphism_beta2[i].y.Set(&pts[i].y);
+						}
+						endomorphism_beta[i].x.ModMulK1(&pts[i].x, &beta);
+						endomorphism_beta2[i].x.ModMulK1(&pts[i].x, &beta2);
 					}
-					endomorphism_beta[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta);
-					endomorphism_beta2[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta2);
 				}
 				
-				// First point (startP - (GRP_SZIE/2)*G)
-				pn = startP;
-				dyn.Set(&Gn[i].y);
-				dyn.ModNeg();
-				dyn.ModSub(&pn.y);
-
-				_s.ModMulK1(&dyn,&dx[i]);
-				_p.ModSquareK1(&_s);
-
-				pn.x.ModNeg();
-				pn.x.ModAdd(&_p);
-				pn.x.ModSub(&Gn[i].x);
-				
-				if(calculate_y )	{
-					pn.y.ModSub(&Gn[i].x,&pn.x);
-					pn.y.ModMulK1(&_s);
-					pn.y.ModAdd(&Gn[i].y);
-				}
-				pts[0] = pn;
-				
-				/*
-					First point for endomorphism because pts[0] was not calcualte previously
-				*/
-				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-						endomorphism_beta[0].y.Set(&pn.y);
-						endomorphism_beta2[0].y.Set(&pn.y);
-					}
-					endomorphism_beta[0].x.ModMulK1(&pn.x, &beta);
-					endomorphism_beta2[0].x.ModMulK1(&pn.x, &beta2);
-				}
 				
 				for(j = 0; j < CPU_GRP_SIZE/4;j++)	{
 					if(FLAGSEARCH == SEARCH_COMPRESS || FLAGSEARCH == SEARCH_BOTH ){
@@ -3371,57 +3661,10 @@ void *thread_process_vanity(void *vargp)	{
 										keyfound.SetInt32(k);
 										keyfound.Mult(&stride);
 										keyfound.Add(&key_mpz);
-										publickey = secp->ComputePublicKey(&keyfound);
-										
-										switch(l)	{
-											case 0:	//Original point, prefix 02
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 1:	//Original point, prefix 03
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 03
-											break;
-											case 2:	//Beta point, prefix 02
-												keyfound.ModMulK1order(&lambda);
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 3:	//Beta point, prefix 03											
-												keyfound.ModMulK1order(&lambda);
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 4:	//Beta^2 point, prefix 02
-												keyfound.ModMulK1order(&lambda2);
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 5:	//Beta^2 point, prefix 03
-												keyfound.ModMulK1order(&lambda2);
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-										}
-										writevanitykey(true,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										/* Slot l is the prefix 02 + (l & 1) of the point, beta and beta^2 points for l / 2 */
+										hit_resolve(&keyfound,&publickey,l / 2,publickey.y.IsOdd() != (l & 1));
+										writevanitykey_point(true,&keyfound,publickey);
 									}
 								}
 							}
@@ -3432,14 +3675,9 @@ void *thread_process_vanity(void *vargp)	{
 										keyfound.Mult(&stride);
 										keyfound.Add(&key_mpz);
 										
-										publickey = secp->ComputePublicKey(&keyfound);
-										secp->GetHash160(P2PKH,true,publickey,(uint8_t*)publickeyhashrmd160);
-										if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160,20) != 0){
-											keyfound.Neg();
-											keyfound.Add(&secp->order);
-											//if(FLAGDEBUG) printf("[D] Key need to be negated\n");
-										}
-										writevanitykey(true,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										hit_resolve(&keyfound,&publickey,0,publickey.y.IsOdd() != (l & 1));
+										writevanitykey_point(true,&keyfound,publickey);
 									}
 								}									
 							}
@@ -3457,38 +3695,10 @@ void *thread_process_vanity(void *vargp)	{
 										keyfound.Add(&key_mpz);
 										
 										
-										switch(l)	{
-											case 6:
-											case 7:
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-											case 8:
-											case 9:
-												keyfound.ModMulK1order(&lambda);
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-											case 10:
-											case 11:
-												keyfound.ModMulK1order(&lambda2);
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-										}
-										writevanitykey(false,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										/* Slots 6 to 11 are the point, beta and beta^2 points, each one followed by its negation */
+										hit_resolve(&keyfound,&publickey,(l - 6) / 2,l & 1);
+										writevanitykey_point(false,&keyfound,publickey);
 									}
 								}
 
@@ -3498,7 +3708,8 @@ void *thread_process_vanity(void *vargp)	{
 									keyfound.SetInt32(k);
 									keyfound.Mult(&stride);
 									keyfound.Add(&key_mpz);
-									writevanitykey(false,&keyfound);
+									group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+									writevanitykey_point(false,&keyfound,publickey);
 								}
 							}
 						}
@@ -3512,22 +3723,6 @@ void *thread_process_vanity(void *vargp)	{
 				}
 				steps[thread_number]++;
 
-				// Next start point (startP + GRP_SIZE*G)
-				pp = startP;
-				dy.ModSub(&_2Gn.y,&pp.y);
-
-				_s.ModMulK1(&dy,&dx[i + 1]);
-				_p.ModSquareK1(&_s);
-
-				pp.x.ModNeg();
-				pp.x.ModAdd(&_p);
-				pp.x.ModSub(&_2Gn.x);
-				
-				//The Y value for the next start point always need to be calculated
-				pp.y.ModSub(&_2Gn.x,&pp.x);
-				pp.y.ModMulK1(&_s);
-				pp.y.ModSub(&_2Gn.y);
-				startP = pp;
 			}while(count < N_SEQUENTIAL_MAX && continue_flag);
 		}
 	} while(continue_flag);
@@ -3788,19 +3983,17 @@ void *thread_process_bsgs(void *vargp)	{
 	Int base_key, keyfound;
 	IntGroup* grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Int dx[CPU_GRP_SIZE / 2 + 1];
-	Int dy, dyn, _s, _p, km, intaux;
+	Int km, intaux;
 
 	// Point variables
 	Point base_point, point_aux, point_found;
 	Point startP;
-	Point pp, pn;
 	Point pts[CPU_GRP_SIZE];
 
 	// Unsigned integer variables
 	uint32_t k, l, r, salir, thread_number, cycles;
 
 	// Other variables
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	grp->Set(dx);
 
 	tt = (struct tothread *)vargp;
@@ -3869,84 +4062,19 @@ void *thread_process_bsgs(void *vargp)	{
 				startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-					// Grouped ModInv
-					grp->ModInv();
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					for(i = 0; i<hLength; i++) {
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-					}
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -3970,7 +4098,7 @@ pn.y.ModAdd(&GSn[i].y);
 #else
 				pthread_mutex_unlock(&write_keys);
 #endif
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -3982,21 +4110,6 @@ pn.y.ModAdd(&GSn[i].y);
 							} //End if second check
 						}//End if first check
 					}// For for pts variable
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 				} // end while
@@ -4024,18 +4137,11 @@ void *thread_process_bsgs_random(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 
@@ -4106,96 +4212,20 @@ void *thread_process_bsgs_random(void *vargp)	{
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
 				
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s    \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -4220,7 +4250,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -4234,22 +4264,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 					
@@ -4269,6 +4283,11 @@ pn.y.ModAdd(&GSn[i].y);
 	This funtion is made with the especific purpouse to USE a smaller bPtable in RAM.
 */
 int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey)	{
+	return bsgs_secondcheck_point(start_range,a,&OriginalPointsBSGS[k_index],privatekey);
+}
+
+/* The same second check for any target point, not only the publickeys of the file */
+int bsgs_secondcheck_point(Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
 	int i = 0,found = 0,r = 0;
 	Int base_key;
 	Point base_point,point_aux;
@@ -4288,7 +4307,7 @@ int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privateke
 				 Q is the target Key
 		base_key is the Start range + a*BSGS_M
 	*/
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	do {
 		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,BSGS_AMP2[i]);
@@ -4296,14 +4315,14 @@ int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privateke
 		BSGS_S.x.Get32Bytes((unsigned char *) xpoint_raw);
 		r = bloom_check(&bloom_bPx2nd[(uint8_t) xpoint_raw[0]],xpoint_raw,32);
 		if(r)	{
-			found = bsgs_thirdcheck(&base_key,i,k_index,privatekey);
+			found = bsgs_thirdcheck(&base_key,i,target,privatekey);
 		}
 		i++;
 	}while(i < 32 && !found);
 	return found;
 }
 
-int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey)	{
+int bsgs_thirdcheck(Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
 	uint64_t j = 0;
 	int i = 0,found = 0,r = 0;
 	Int base_key,calculatedkey;
@@ -4318,7 +4337,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 	base_point = secp->ComputePublicKey(&base_key);
 	point_aux = secp->Negation(base_point);
 	
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	
 	do {
@@ -4334,7 +4353,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 				privatekey->Add((uint64_t)(j+1));
 				privatekey->Add(&base_key);
 				point_aux = secp->ComputePublicKey(privatekey);
-				if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x))	{
+				if(point_aux.x.IsEqual(&target->x))	{
 					found = 1;
 				}
 				else	{
@@ -4343,7 +4362,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 					privatekey->Sub((uint64_t)(j+1));
 					privatekey->Add(&base_key);
 					point_aux = secp->ComputePublicKey(privatekey);
-					if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x))	{
+					if(point_aux.x.IsEqual(&target->x))	{
 						found = 1;
 					}
 				}
@@ -4367,6 +4386,53 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 	return found;
 }
 
+/*
+	-e in BSGS: lambda*P = (beta*x,y), so beta*X and beta^2*X of the giant step point P = Q - center*G are also
+	checked in the same baby step table. A hit is lambda^v*P = r*G with |r| <= M, r is solved with the second and
+	third checks over r*G + 3*M*G and then key(Q) = center + lambda^(3-v)*r. Those keys are out of the range
+*/
+int bsgs_endomorphism_check(Int *start_range,uint32_t a,uint32_t k_index,Int *x,Int *privatekey)	{
+	Int x_v,center,window,r;
+	Point point_aux,rotated;
+	char xpoint_raw[32];
+	int v;
+	for(v = 1; v <= 2; v++)	{
+		x_v.ModMulK1(x,v == 1 ? &beta : &beta2);
+		x_v.Get32Bytes((unsigned char*)xpoint_raw);
+		if(!bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32))	{
+			continue;
+		}
+		/* The giant step point again, now with its Y */
+		center.Set(&BSGS_M_double);
+		center.Mult((uint64_t)a);
+		center.Add(start_range);
+		center.Add(&BSGS_M);
+		point_aux = secp->ComputePublicKey(&center);
+		point_aux = secp->Negation(point_aux);
+		rotated = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+		rotated.x.Set(&x_v);
+		window.Set(&BSGS_M);
+		window.Mult((uint64_t)3);
+		point_aux = secp->ComputePublicKey(&window);
+		rotated = secp->AddDirect(rotated,point_aux);
+		if(bsgs_secondcheck_point(&BSGS_M_double,0,&rotated,&r))	{
+			r.Sub(&window);
+			if(r.IsNegative())	{
+				r.Add(&secp->order);
+			}
+			r.ModMulK1order(v == 1 ? &lambda2 : &lambda);
+			privatekey->Set(&center);
+			privatekey->Add(&r);
+			privatekey->Mod(&secp->order);
+			point_aux = secp->ComputePublicKey(privatekey);
+			if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x) && point_aux.y.IsEqual(&OriginalPointsBSGS[k_index].y))	{
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
 void sleep_ms(int milliseconds)	{ // cross-platform sleep function
 #if defined(_WIN64) && !defined(__CYGWIN__)
     Sleep(milliseconds);
@@ -4383,6 +4449,19 @@ void sleep_ms(int milliseconds)	{ // cross-platform sleep function
 }
 
 
+/* Mark the publickey as found, with -x all the targets are the same publickey */
+void bsgs_setfound(uint32_t k_index)	{
+	uint32_t l;
+	if(FLAGSUBTRACT)	{
+		for(l = 0; l < bsgs_point_number; l++)	{
+			bsgs_found[l] = 1;
+		}
+	}
+	else	{
+		bsgs_found[k_index] = 1;
+	}
+}
+
 void init_generator()	{
 	Point G = secp->ComputePublicKey(&stride);
 	Point g;
@@ -4398,6 +4477,196 @@ void init_generator()	{
 	_2Gn = secp->DoubleDirect(Gn[CPU_GRP_SIZE / 2 - 1]);
 }
 
+/*
+	pts[i] of a group of AddDirectBatch with its Y, for a hit. With calculate_y the group has it, else it is
+	one addition to the center of the group: pts[i] = center + (i - CPU_GRP_SIZE/2)*Gn[0]
+*/
+void group_hit_point(Point *pts,Point &center,int i,bool calculate_y,Point *publickey)	{
+	Point aux;
+	int d = i - CPU_GRP_SIZE / 2;
+	if(calculate_y)	{
+		publickey->Set(pts[i]);
+	}
+	else if(d == 0)	{
+		publickey->Set(center);
+	}
+	else if(d > 0)	{
+		*publickey = secp->AddDirect(center,Gn[d - 1]);
+	}
+	else	{
+		aux = secp->Negation(Gn[-d - 1]);
+		*publickey = secp->AddDirect(center,aux);
+	}
+	publickey->z.SetInt32(1);
+}
+
+/*
+	key and publickey of a hit from the ones of its point, without scalar multiplication or hash:
+	variant 1 and 2 are the beta and beta^2 points, lambda*key and lambda^2*key with the same Y,
+	negated is the point with -Y and the key n - key
+*/
+void hit_resolve(Int *key,Point *publickey,int variant,int negated)	{
+	switch(variant)	{
+		case 1:
+			key->ModMulK1order(&lambda);
+			publickey->x.ModMulK1(&beta);
+		break;
+		case 2:
+			key->ModMulK1order(&lambda2);
+			publickey->x.ModMulK1(&beta2);
+		break;
+	}
+	if(negated)	{
+		key->Neg();
+		key->Add(&secp->order);
+		*publickey = secp->Negation(*publickey);
+	}
+}
+
+/*
+	-x count:spacing, the targets of one publickey Q are T_i = Q - i*spacing*G for i from 0 to count - 1.
+	They are made by groups of CPU_GRP_SIZE around a center with one batched inversion like the threads:
+	table[j] = -(j+1)*spacing*G, so out[k] of AddDirectBatch is center - (k - CPU_GRP_SIZE/2)*spacing*G.
+	callback gets every target in order of i, a nonzero return stops
+*/
+void subtract_generate(Point &base,uint64_t count,int (*callback)(uint64_t i,Point &target,void *arg),void *arg)	{
+	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
+	Int dx[CPU_GRP_SIZE / 2 + 1];
+	Point *pts = new Point[CPU_GRP_SIZE];
+	Point *table = new Point[CPU_GRP_SIZE / 2];
+	Point S,center,next;
+	uint64_t i,k;
+	int stop = 0;
+	grp->Set(dx);
+	S = secp->ComputePublicKey(&subtract_spacing);
+	S = secp->Negation(S);
+	table[0] = S;
+	table[1] = secp->DoubleDirect(S);
+	for(k = 2; k < CPU_GRP_SIZE / 2; k++)	{
+		table[k] = secp->AddDirect(table[k - 1],S);
+	}
+	next = secp->DoubleDirect(table[CPU_GRP_SIZE / 2 - 1]);
+	center = secp->AddDirect(base,table[CPU_GRP_SIZE / 2 - 1]);
+	for(i = 0; i < count && !stop; i += CPU_GRP_SIZE)	{
+		secp->AddDirectBatch(center,table,&next,CPU_GRP_SIZE,pts,true,grp,dx);
+		for(k = 0; k < CPU_GRP_SIZE && i + k < count && !stop; k++)	{
+			pts[k].z.SetInt32(1);
+			stop = callback(i + k,pts[k],arg);
+		}
+	}
+	delete grp;
+	delete[] pts;
+	delete[] table;
+}
+
+int subtract_store_bsgs(uint64_t i,Point &target,void *arg)	{
+	OriginalPointsBSGS[i].Set(target);
+	OriginalPointsBSGScompressed[i] = subtract_compressed;
+	return 0;
+}
+
+int subtract_store_xpoint(uint64_t i,Point &target,void *arg)	{
+	uint8_t rawvalue[32];
+	target.x.Get32Bytes(rawvalue);
+	memcpy(addressTable[i].value,rawvalue,20);
+	bloom_address_add(rawvalue,20);
+	return 0;
+}
+
+struct subtract_search	{
+	Point point;
+	uint64_t index;
+	int found;
+	int negated;
+};
+
+int subtract_find(uint64_t i,Point &target,void *arg)	{
+	struct subtract_search *search = (struct subtract_search *)arg;
+	if(target.x.IsEqual(&search->point.x))	{
+		search->index = i;
+		search->found = 1;
+		search->negated = !target.y.IsEqual(&search->point.y);
+	}
+	return search->found;
+}
+
+/*
+	The targets file of xpoint mode with -x has only one publickey, the table and the bloom filters
+	are made in memory from it and they are never saved with -S
+*/
+bool subtract_load_xpoint(char *fileName)	{
+	FILE *fd;
+	char line[1024];
+	int found = 0;
+	fd = fopen(fileName,"r");
+	if(fd == NULL)	{
+		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
+		return false;
+	}
+	while(fgets(line,1024,fd) == line)	{
+		trim(line," \t\n\r");
+		line[strcspn(line," \t:")] = '\0';
+		if(strlen(line) == 66 || strlen(line) == 130)	{
+			if(found || !secp->ParsePublicKeyHex(line,subtract_base,subtract_compressed))	{
+				fprintf(stderr,"[E] -x needs only one valid publickey in the file\n");
+				fclose(fd);
+				return false;
+			}
+			found = 1;
+		}
+	}
+	fclose(fd);
+	if(!found)	{
+		fprintf(stderr,"[E] -x needs a publickey in the file, not only the X value\n");
+		return false;
+	}
+	MAXLENGTHADDRESS = 20;
+	N = subtract_count;
+	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",N,(double)(((double) sizeof(struct address_value)*N)/(double)1048576));
+	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*N + 1);
+	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
+	if(!initBloomAddress(N))	{
+		return false;
+	}
+	subtract_generate(subtract_base,N,subtract_store_xpoint,NULL);
+	_sort(addressTable,N);
+	printf("[+] %" PRIu64 " values were made from the publickey and sorted\n",N);
+	return true;
+}
+
+/*
+	privatekey is the key of a target with the X of T_i, the targets are made again until that X to know i.
+	It is once per hit so the cost is no problem. With the other Y the key is of -T_i
+*/
+void subtract_xpoint_resolve(Int *privatekey)	{
+	struct subtract_search search;
+	Int aux;
+	search.point = secp->ComputePublicKey(privatekey);
+	search.found = 0;
+	subtract_generate(subtract_base,subtract_count,subtract_find,&search);
+	if(!search.found)	{
+		return;
+	}
+	if(search.negated)	{
+		aux.Set(&secp->order);
+		aux.Sub(privatekey);
+		privatekey->Set(&aux);
+	}
+	aux.SetInt64(search.index);
+	aux.Mult(&subtract_spacing);
+	privatekey->Add(&aux);
+	privatekey->Mod(&secp->order);
+}
+
+/* key(Q) = key(T_i) + i*spacing */
+void subtract_bsgs_resolve(uint32_t k_index,Int *privatekey)	{
+	Int aux;
+	aux.SetInt64(k_index);
+	aux.Mult(&subtract_spacing);
+	privatekey->Add(&aux);
+	privatekey->Mod(&secp->order);
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_bPload(LPVOID vargp) {
 #else
@@ -4412,10 +4681,8 @@ void *thread_bPload(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
 	
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from + 1));
 	threadid = tt->threadid;
@@ -4435,82 +4702,7 @@ void *thread_bPload(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -4561,21 +4753,6 @@ void *thread_bPload(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 #if defined(_WIN64) && !defined(__CYGWIN__)
@@ -4603,9 +4780,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from +1 ));
 	threadid = tt->threadid;
@@ -4624,82 +4799,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -4733,21 +4833,6 @@ void *thread_bPload_2blooms(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 #if defined(_WIN64) && !defined(__CYGWIN__)
@@ -4788,6 +4873,41 @@ void generate_binaddress_eth(Point &publickey,unsigned char *dst_address)	{
 	memcpy(dst_address,bin_publickey+12,20);
 }
 
+/*
+	ETH addresses of a whole group with the lane parallel Keccak, dst_addresses[l*count + i] is the point i (l = 0),
+	its negation (l = 1) and with beta != NULL the beta (2, 3) and beta^2 (4, 5) points with the same Y.
+	bin_publickeys needs 64 bytes for every address
+*/
+void generate_binaddress_eth_group(Point *pts,Point *beta,Point *beta2,int count,unsigned char *bin_publickeys,unsigned char *dst_addresses)	{
+	Point negated;
+	unsigned char *bin;
+	int i,variants = (beta != NULL) ? 6 : 1;
+	for(i = 0; i < count; i++)	{
+		bin = bin_publickeys + (uint64_t)i * 64;
+		pts[i].x.Get32Bytes(bin);
+		pts[i].y.Get32Bytes(bin + 32);
+		if(beta != NULL)	{
+			negated = secp->Negation(pts[i]);
+			bin = bin_publickeys + (uint64_t)(count + i) * 64;
+			pts[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(2*count + i) * 64;
+			beta[i].x.Get32Bytes(bin);
+			pts[i].y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(3*count + i) * 64;
+			beta[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(4*count + i) * 64;
+			beta2[i].x.Get32Bytes(bin);
+			pts[i].y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(5*count + i) * 64;
+			beta2[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+		}
+	}
+	keccak256_eth_batch(bin_publickeys,variants * count,dst_addresses);
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_process_bsgs_dance(LPVOID vargp) {
 #else
@@ -4796,14 +4916,13 @@ void *thread_process_bsgs_dance(void *vargp)	{
 
 	Point pts[CPU_GRP_SIZE];
 	Int dx[CPU_GRP_SIZE / 2 + 1];
-	Point pp,pn,startP,base_point,point_aux,point_found;
+	Point startP,base_point,point_aux,point_found;
 	FILE *filekey;
 	struct tothread *tt;
 	char xpoint_raw[32],*aux_c,*hextemp;
-	Int base_key,keyfound,dy,dyn,_s,_p,km,intaux;
+	Int base_key,keyfound,km,intaux;
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	uint32_t k,l,r,salir,thread_number,entrar,cycles;
-	int hLength = (CPU_GRP_SIZE / 2 - 1);	
 
 	grp->Set(dx);
 	
@@ -4910,97 +5029,20 @@ void *thread_process_bsgs_dance(void *vargp)	{
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
 				
-					int i;
-					
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -5025,7 +5067,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -5039,22 +5081,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 				}//while all the aMP points
@@ -5081,18 +5107,11 @@ void *thread_process_bsgs_backward(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 	tt = (struct tothread *)vargp;
@@ -5169,96 +5188,20 @@ void *thread_process_bsgs_backward(void *vargp)	{
 				startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -5283,7 +5226,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -5297,22 +5240,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					j++;
 				}//while all the aMP points
 			}// End if 
@@ -5338,18 +5265,11 @@ void *thread_process_bsgs_both(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 	
@@ -5453,96 +5373,20 @@ void *thread_process_bsgs_both(void *vargp)	{
 					startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 					uint32_t j = 0;
 					while( j < cycles && bsgs_found[k]== 0 )	{
-						int i;
-						for(i = 0; i < hLength; i++) {
-							dx[i].ModSub(&GSn[i].x,&startP.x);
-						}
-						dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-						dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-						// Grouped ModInv
-						grp->ModInv();
-						
-						/*
-						We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-						We compute key in the positive and negative way from the center of the group
-						*/
-
-						// center point
-						pts[CPU_GRP_SIZE / 2] = startP;
-						
-						for(i = 0; i<hLength; i++) {
-
-							pp = startP;
-							pn = startP;
-
-							// P = startP + i*G
-							dy.ModSub(&GSn[i].y,&pp.y);
-
-							_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-							_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-							pp.x.ModNeg();
-							pp.x.ModAdd(&_p);
-							pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-							
-#if 0
-	  pp.y.ModSub(&GSn[i].x,&pp.x);
-	  pp.y.ModMulK1(&_s);
-	  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-							// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-							dyn.Set(&GSn[i].y);
-							dyn.ModNeg();
-							dyn.ModSub(&pn.y);
-
-							_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-							_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-							pn.x.ModNeg();
-							pn.x.ModAdd(&_p);
-							pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-	  pn.y.ModSub(&GSn[i].x,&pn.x);
-	  pn.y.ModMulK1(&_s);
-	  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-							pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-							pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-						}
-
-						// First point (startP - (GRP_SZIE/2)*G)
-						pn = startP;
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);
-						_p.ModSquareK1(&_s);
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);
-
-#if 0
-	pn.y.ModSub(&GSn[i].x,&pn.x);
-	pn.y.ModMulK1(&_s);
-	pn.y.ModAdd(&GSn[i].y);
-#endif
-
-						pts[0] = pn;
+						secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 						
 						for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 							pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 							r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-							if(r) {
-								r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(r || FLAGENDOMORPHISM) {
+								r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+								if(!r && FLAGENDOMORPHISM)	{
+									r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+								}
 								if(r)	{
+									if(FLAGSUBTRACT)	{
+										subtract_bsgs_resolve(k,&keyfound);
+									}
 									hextemp = keyfound.GetBase16();
 									printf("[+] Thread Key found privkey %s   \n",hextemp);
 									point_found = secp->ComputePublicKey(&keyfound);
@@ -5567,7 +5411,7 @@ void *thread_process_bsgs_both(void *vargp)	{
 									pthread_mutex_unlock(&write_keys);
 #endif
 
-									bsgs_found[k] = 1;
+									bsgs_setfound(k);
 									salir = 1;
 									for(l = 0; l < bsgs_point_number && salir; l++)	{
 										salir &= bsgs_found[l];
@@ -5581,22 +5425,6 @@ void *thread_process_bsgs_both(void *vargp)	{
 							
 						}// For for pts variable
 						
-						// Next start point (startP += (bsSize*GRP_SIZE).G)
-						
-						pp = startP;
-						dy.ModSub(&_2GSn.y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i + 1]);
-						_p.ModSquareK1(&_s);
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&_2GSn.x);
-
-						pp.y.ModSub(&_2GSn.x,&pp.x);
-						pp.y.ModMulK1(&_s);
-						pp.y.ModSub(&_2GSn.y);
-						startP = pp;
 						
 						j++;
 					}//while all the aMP points
@@ -5745,13 +5573,17 @@ void menu() {
 	printf("-b bits     For some puzzles you only need some numbers of bits in the test keys.\n");
 	printf("-c crypto   Search for specific crypto. <btc, eth> valid only w/ -m address\n");
 	printf("-C mini     Set the minikey Base only 22 character minikeys, ex: SRPqx8QiwnW4WNWnTVa2W5\n");
+	printf("-D bits     Distinguished point bits for kangaroo and rho modes, default from the range and threads\n");
+	printf("            in kangaroo mode, %i in rho mode\n",RHO_DP_BITS);
 	printf("-8 alpha    Set the bas58 alphabet for minikeys\n");
-	printf("-e          Enable endomorphism search (Only for address, rmd160 and vanity)\n");
+	printf("-e          Enable endomorphism search (Only for address, rmd160, vanity and bsgs)\n");
+	printf("            With bsgs it is a lottery over the whole group, the keys found are out of the range and it is slower\n");
 	printf("-f file     Specify file name with addresses or xpoints or uncompressed public keys\n");
 	printf("-I stride   Stride for xpoint, rmd160 and address, this option don't work with bsgs\n");
 	printf("-k value    Use this only with bsgs mode, k value is factor for M, more speed but more RAM use wisely\n");
 	printf("-l look     What type of address/hash160 are you looking for <compress, uncompress, both> Only for rmd160 and address\n");
-	printf("-m mode     mode of search for cryptos. (bsgs, xpoint, rmd160, address, vanity) default: address\n");
+	printf("-P          With -l compress and without -e, calculate Y and hash only the prefix of its parity (not the keys n - k)\n");
+	printf("-m mode     mode of search for cryptos. (bsgs, xpoint, rmd160, address, vanity, kangaroo, dpmerge, rho) default: address\n");
 	printf("-M          Matrix screen, feel like a h4x0r, but performance will dropped\n");
 	printf("-n number   Check for N sequential numbers before the random chosen, this only works with -R option\n");
 	printf("            Use -n to set the N for the BSGS process. Bigger N more RAM needed\n");
@@ -5760,9 +5592,12 @@ void menu() {
 	printf("-R          Random, this is the default behavior\n");
 	printf("-s ns       Number of seconds for the stats output, 0 to omit output.\n");
 	printf("-S          S is for SAVING in files BSGS data (Bloom filters and bPtable)\n");
-	printf("-6          to skip sha256 Checksum on data files");
+	printf("            With kangaroo mode it saves the distinguished points every %i seconds\n",KANGAROO_SAVE_SECONDS);
+	printf("-6          to skip sha256 Checksum on data files\n");
+	printf("-A mode     NUMA placement of the BSGS tables: interleave or none, threads pinned to its node\n");
 	printf("-t tn       Threads number, must be a positive integer\n");
 	printf("-v value    Search for vanity Address, only with -m vanity\n");
+	printf("-x n[:s]    Only bsgs and xpoint, one publickey Q in the file: search Q - i*s*G for i < n, s default 1\n");
 	printf("-z value    Bloom size multiplier, only address,rmd160,vanity, xpoint, value >= 1\n");
 	printf("\nExample:\n\n");
 	printf("./keyhunt -m rmd160 -f tests/unsolvedpuzzles.rmd -b 66 -l compress -R -q -t 8\n\n");
@@ -5801,11 +5636,14 @@ bool vanityrmdmatch(unsigned char *rmdhash)	{
 }
 
 void writevanitykey(bool compressed,Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writevanitykey_point(compressed,key,publickey);
+}
+
+void writevanitykey_point(bool compressed,Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,*hexrmd,public_key_hex[131],address[50],rmdhash[20];
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	secp->GetPublicKeyHex(compressed,publickey,public_key_hex);
 	
 	secp->GetHash160(P2PKH,compressed,publickey,(uint8_t*)rmdhash);
@@ -5987,17 +5825,30 @@ void checkpointer(void *ptr,const char *file,const char *function,const  char *n
 }
 
 void writekey(bool compressed,Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writekey_point(compressed,key,publickey);
+}
+
+void writekey_point(bool compressed,Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,*hexrmd,public_key_hex[132],address[50],rmdhash[20];
+	char address_p2sh[50],address_bech32[BECH32_P2WPKH_LENGTH + 1],scripthash[20],segwit[160];
 	memset(address,0,50);
 	memset(public_key_hex,0,132);
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	secp->GetPublicKeyHex(compressed,publickey,public_key_hex);
 	secp->GetHash160(P2PKH,compressed,publickey,(uint8_t*)rmdhash);
 	hexrmd = tohex(rmdhash,20);
 	rmd160toaddress_dst(rmdhash,address);
+	segwit[0] = '\0';
+	if(compressed && (FLAGP2SH || FLAGBECH32))	{
+		/* The same key in the segwit addresses */
+		memset(address_p2sh,0,50);
+		secp->GetHash160(P2SH,true,publickey,(uint8_t*)scripthash);
+		hash160toaddress_dst(0x05,scripthash,address_p2sh);
+		bech32_encode_p2wpkh(address_bech32,(uint8_t*)rmdhash);
+		snprintf(segwit,sizeof(segwit),"Address P2SH-P2WPKH %s\nAddress Bech32 %s\n",address_p2sh,address_bech32);
+	}
 
 #if defined(_WIN64) && !defined(__CYGWIN__)
 	WaitForSingleObject(write_keys, INFINITE);
@@ -6006,10 +5857,10 @@ void writekey(bool compressed,Int *key)	{
 #endif
 	keys = fopen("KEYFOUNDKEYFOUND.txt","a+");
 	if(keys != NULL)	{
-		fprintf(keys,"Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n",hextemp,public_key_hex,address,hexrmd);
+		fprintf(keys,"Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n%s",hextemp,public_key_hex,address,hexrmd,segwit);
 		fclose(keys);
 	}
-	printf("\nHit! Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n",hextemp,public_key_hex,address,hexrmd);
+	printf("\nHit! Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n%s",hextemp,public_key_hex,address,hexrmd,segwit);
 	
 #if defined(_WIN64) && !defined(__CYGWIN__)
 	ReleaseMutex(write_keys);
@@ -6021,11 +5872,14 @@ void writekey(bool compressed,Int *key)	{
 }
 
 void writekeyeth(Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writekeyeth_point(key,publickey);
+}
+
+void writekeyeth_point(Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,address[43],hash[20];
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	generate_binaddress_eth(publickey,(unsigned char*)hash);
 	address[0] = '0';
 	address[1] = 'x';
@@ -6132,9 +5986,11 @@ bool readFileAddress(char *fileName)	{
 	FILE *fileDescriptor;
 	char fileBloomName[30];	/* Actually it is Bloom and Table but just to keep the variable name short*/
 	uint8_t checksum[32],hexPrefix[9];
-	char dataChecksum[32],bloomChecksum[32];
+	char dataChecksum[32],bloomChecksum[32],indexChecksum[32],bloomMagic[8];
 	size_t bytesRead;
-	uint64_t dataSize;
+	uint64_t dataSize,indexSize,bloomEntries = 0,bloomBytes = 0;
+	uint32_t targets;
+	int i;
 	/*
 		if the FLAGSAVEREADFILE is Set to 1 we need to the checksum and check if we have that information already saved
 	*/
@@ -6146,6 +6002,12 @@ bool readFileAddress(char *fileName)	{
 		tohex_dst((char*)checksum,4,(char*)hexPrefix); // we save the prefix (last fourt bytes) hexadecimal value
 		snprintf(fileBloomName,30,"data_%s.dat",hexPrefix);
 		fileDescriptor = fopen(fileBloomName,"rb");
+		if(fileDescriptor != NULL && (fread(bloomMagic,1,8,fileDescriptor) != 8 || memcmp(bloomMagic,BLOOM_ADDRESS_MAGIC,8) != 0))	{
+			/* Files made before the 256 bloom filters have only one, it is made again */
+			fprintf(stderr,"[W] The file %s is from an older version, it will be made again\n",fileBloomName);
+			fclose(fileDescriptor);
+			fileDescriptor = NULL;
+		}
 		if(fileDescriptor != NULL)	{
 			printf("[+] Reading file %s\n",fileBloomName);
 		
@@ -6161,67 +6023,57 @@ bool readFileAddress(char *fileName)	{
 			//compare the expected bloom checksum againts the current bloom checksum
 			
 
-			//read bloom checksum (expected value to be checked)
-			bytesRead = fread(bloomChecksum,1,32,fileDescriptor);
-			if(bytesRead != 32)	{
-				fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			
-			//read bloom filter structure
-			bytesRead = fread(&bloom,1,sizeof(struct bloom),fileDescriptor);
-			if(bytesRead != sizeof(struct bloom))	{
-				fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			
-			printf("[+] Bloom filter for %" PRIu64 " elements.\n",bloom.entries);
-			
-			bloom.bf = (uint8_t*) malloc(bloom.bytes);
-			if(bloom.bf == NULL)	{
+			bloom_address = (struct bloom*) calloc(256,sizeof(struct bloom));
+			if(bloom_address == NULL)	{
 				fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
 				fclose(fileDescriptor);
 				return false;
 			}
+			for(i = 0; i < 256; i++)	{
+				//read bloom checksum (expected value to be checked)
+				bytesRead = fread(bloomChecksum,1,32,fileDescriptor);
+				if(bytesRead != 32)	{
+					fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
+				}
 
-			//read bloom filter data
-			bytesRead = fread(bloom.bf,1,bloom.bytes,fileDescriptor);
-			if(bytesRead != bloom.bytes)	{
-				fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			if(FLAGSKIPCHECKSUM == 0){
-				
-				//calculate checksum of the current readed data
-				sha256((uint8_t*)bloom.bf,bloom.bytes,(uint8_t*)checksum);
-				
-				//Compare checksums
-				/*
-				if(FLAGDEBUG)	{
-					hextemp = tohex((char*)checksum,32);
-					printf("[D] Current Bloom checksum %s\n",hextemp);
-					free(hextemp);
+				//read bloom filter structure
+				bytesRead = fread(&bloom_address[i],1,sizeof(struct bloom),fileDescriptor);
+				if(bytesRead != sizeof(struct bloom))	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
 				}
-				*/
-				if(memcmp(checksum,bloomChecksum,32) != 0)	{
-					fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+
+				bloom_address[i].bf = (uint8_t*) malloc(bloom_address[i].bytes);
+				if(bloom_address[i].bf == NULL)	{
+					fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
 					fclose(fileDescriptor);
 					return false;
 				}
+
+				//read bloom filter data
+				bytesRead = fread(bloom_address[i].bf,1,bloom_address[i].bytes,fileDescriptor);
+				if(bytesRead != bloom_address[i].bytes)	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
+				}
+				if(FLAGSKIPCHECKSUM == 0){
+					//calculate checksum of the current readed data and compare it
+					sha256((uint8_t*)bloom_address[i].bf,bloom_address[i].bytes,(uint8_t*)checksum);
+					if(memcmp(checksum,bloomChecksum,32) != 0)	{
+						fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+				}
+				bloomEntries += bloom_address[i].entries;
+				bloomBytes += bloom_address[i].bytes;
 			}
-			
-			/*
-			if(FLAGDEBUG) {
-				hextemp = tohex((char*)bloom.bf,32);
-				printf("[D] first 32 bytes of the bloom : %s\n",hextemp);
-				bloom_print(&bloom);
-				printf("[D] bloom.bf points to %p\n",bloom.bf);
-			}
-			*/
-			
+			printf("[+] Bloom filter for %" PRIu64 " elements: %.2f MB\n",bloomEntries,(double)(((double) bloomBytes)/(double)1048576));
+
 			bytesRead = fread(dataChecksum,1,32,fileDescriptor);
 			if(bytesRead != 32)	{
 				fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
@@ -6261,7 +6113,48 @@ bool readFileAddress(char *fileName)	{
 					return false;
 				}
 			}
-			//printf("[D] bloom.bf points to %p\n",bloom.bf);
+			/* Files made before the bucket index don't have it, it is made again */
+			bytesRead = fread(indexChecksum,1,32,fileDescriptor);
+			if(bytesRead != 32)	{
+				printf("[+] Making the bucket index\n");
+				address_index_build();
+			}
+			else	{
+				bytesRead = fread(&indexSize,1,sizeof(uint64_t),fileDescriptor);
+				bytesRead += fread(&address_index_bits,1,sizeof(uint32_t),fileDescriptor);
+				if(bytesRead != sizeof(uint64_t) + sizeof(uint32_t))	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 3);
+					fclose(fileDescriptor);
+					return false;
+				}
+				if(indexSize > 0)	{
+					address_index = (uint32_t*) malloc(indexSize);
+					if(address_index == NULL)	{
+						fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+					bytesRead = fread(address_index,1,indexSize,fileDescriptor);
+					if(bytesRead != indexSize || indexSize != ((1ULL << address_index_bits) + 1) * sizeof(uint32_t))	{
+						fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+					if(FLAGSKIPCHECKSUM == 0)	{
+						sha256((uint8_t*)address_index,indexSize,(uint8_t*)checksum);
+						if(memcmp(checksum,indexChecksum,32) != 0)	{
+							fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+							fclose(fileDescriptor);
+							return false;
+						}
+					}
+				}
+				/* Files made before the segwit targets don't have the kinds of targets */
+				if(fread(&targets,1,sizeof(uint32_t),fileDescriptor) == sizeof(uint32_t))	{
+					FLAGP2SH = (targets & TARGETS_P2SH) != 0;
+					FLAGBECH32 = (targets & TARGETS_BECH32) != 0;
+				}
+			}
 			FLAGREADEDFILE1 = 1;	/* We mark the file as readed*/
 			fclose(fileDescriptor);
 			MAXLENGTHADDRESS = sizeof(struct address_value);
@@ -6298,260 +6191,378 @@ bool readFileAddress(char *fileName)	{
 	return true;
 }
 
-bool forceReadFileAddress(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	bool validAddress;
-	uint64_t numberItems,i;
-	size_t r,raw_value_length;
-	uint8_t rawvalue[50];
-	char aux[100],*hextemp;
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
+/*
+	The targets file is split in one chunk per thread at line boundaries and read from memory:
+	1. every thread counts the lines of its chunk, that is the room of its items
+	2. every thread parses its lines, the items are counted by first byte
+	3. the items are copied to addressTable grouped by first byte, the first byte is also the bloom filter
+	4. every thread sorts, removes the duplicates and fills the bloom filters of its own first bytes,
+	   one bloom filter is never shared between threads so the bits are set without locks
+	At the end addressTable is sorted and only the gaps of the removed duplicates are closed
+*/
+bool readFileTargets(char *fileName,int (*parse)(char *line,uint8_t *value))	{
+	char *data;
+	uint64_t size,lines,items,duplicates,bucket,offset;
+	int i,b,s,finished;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	HANDLE *tid;
+	DWORD t;
+#else
+	pthread_t *tid;
+#endif
+	if(!target_file_map(fileName,&data,&size))	{
+		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 1);
 		return false;
 	}
-
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r > 20)	{ 
-				numberItems++;
-			}
-		}
+	target_load_threads = (struct target_load*) calloc(NTHREADS,sizeof(struct target_load));
+	checkpointer((void *)target_load_threads,__FILE__,"calloc","target_load_threads" ,__LINE__ -1 );
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	tid = (HANDLE*) calloc(NTHREADS,sizeof(HANDLE));
+#else
+	tid = (pthread_t*) calloc(NTHREADS,sizeof(pthread_t));
+#endif
+	checkpointer((void *)tid,__FILE__,"calloc","tid" ,__LINE__ -1 );
+	target_load_data = data;
+	target_load_parse = parse;
+	offset = 0;
+	for(i = 0; i < NTHREADS; i++)	{
+		target_load_threads[i].threadid = i;
+		target_load_threads[i].from = offset;
+		offset = (i == NTHREADS - 1) ? size : (size / NTHREADS) * (i + 1);
+		if(offset < target_load_threads[i].from)	{
+			offset = target_load_threads[i].from;
+		}
+		while(offset < size && offset > 0 && data[offset - 1] != '\n')	{
+			offset++;
+		}
+		target_load_threads[i].to = offset;
+		target_load_threads[i].byte_from = (i * 256) / NTHREADS;
+		target_load_threads[i].byte_to = ((i + 1) * 256) / NTHREADS;
 	}
-	fseek(fileDescriptor,0,SEEK_SET);
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
-		
-	if(!initBloomFilter(&bloom,numberItems))
-		return false;
 
-	i = 0;
-	while(i < numberItems)	{
-		validAddress = false;
-		memset(aux,0,100);
-		memset(addressTable[i].value,0,sizeof(struct address_value));
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");			
-		r = strlen(aux);
-		if(r > 0 && r <= 40)	{
-			if(r<40 && isValidBase58String(aux))	{	//Address
-				raw_value_length = 25;
-				b58tobin(rawvalue,&raw_value_length,aux,r);
-				if(raw_value_length == 25)	{
-					//hextemp = tohex((char*)rawvalue+1,20);
-					bloom_add(&bloom, rawvalue+1 ,sizeof(struct address_value));
-					memcpy(addressTable[i].value,rawvalue+1,sizeof(struct address_value));											
-					i++;
-					validAddress = true;
-				}
-			}
-			if(r == 40 && isValidHex(aux))	{	//RMD
-				hexs2bin(aux,rawvalue);				
-				bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-				memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-				i++;
-				validAddress = true;
-			}
-		}
-		if(!validAddress)	{
-			fprintf(stderr,"[I] Ommiting invalid line %s\n",aux);
-			numberItems--;
-		}
-	}
-	N = numberItems;
-	return true;
-}
-
-bool forceReadFileAddressEth(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	bool validAddress;
-	uint64_t numberItems,i;
-	size_t r;
-	uint8_t rawvalue[50];
-	char aux[100],*hextemp;
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
-		return false;
-	}
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r >= 40)	{ 
-				numberItems++;
+	for(target_load_phase = TARGET_LOAD_COUNT; target_load_phase <= TARGET_LOAD_SORT; target_load_phase++)	{
+		switch(target_load_phase)	{
+			case TARGET_LOAD_PARSE:
+				lines = 0;
+				for(i = 0; i < NTHREADS; i++)	{
+					target_load_threads[i].start = lines;
+					lines += target_load_threads[i].lines;
+				}
+				printf("[+] Reading %" PRIu64 " lines of %s with %i threads\n",lines,fileName,NTHREADS);
+				target_load_parsed = (struct address_value*) malloc(lines * sizeof(struct address_value) + 1);
+				checkpointer((void *)target_load_parsed,__FILE__,"malloc","target_load_parsed" ,__LINE__ -1 );
+			break;
+			case TARGET_LOAD_SCATTER:
+				/* Position of the first item of every first byte and thread in addressTable */
+				items = 0;
+				for(b = 0; b < 256; b++)	{
+					target_load_bucket[b] = items;
+					for(i = 0; i < NTHREADS; i++)	{
+						target_load_threads[i].position[b] = items;
+						items += target_load_threads[i].histogram[b];
+					}
+				}
+				target_load_bucket[256] = items;
+				printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",items,(double)(((double) sizeof(struct address_value)*items)/(double)1048576));
+				addressTable = (struct address_value*) malloc(sizeof(struct address_value)*items + 1);
+				checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
+			break;
+			case TARGET_LOAD_SORT:
+				free(target_load_parsed);
+				target_load_parsed = NULL;
+				target_file_unmap(data,size);
+				if(!initBloomAddress(items))	{
+					return false;
+				}
+			break;
+		}
+		for(i = 0; i < NTHREADS; i++)	{
+			target_load_threads[i].finished = 0;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			tid[i] = CreateThread(NULL, 0, thread_target_load, (void*) &target_load_threads[i], 0, &t);
+			s = (tid[i] == NULL);
+#else
+			s = pthread_create(&tid[i],NULL,thread_target_load,(void*) &target_load_threads[i]);
+#endif
+			if(s != 0)	{
+				fprintf(stderr,"[E] thread_target_load\n");
+				exit(EXIT_FAILURE);
 			}
 		}
-	}
-	fseek(fileDescriptor,0,SEEK_SET);
-
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	N = numberItems;
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
-	
-	
-	if(!initBloomFilter(&bloom,N))
-		return false;
-	
-	i = 0;
-	while(i < numberItems)	{
-		validAddress = false;
-		memset(aux,0,100);
-		memset(addressTable[i].value,0,sizeof(struct address_value));
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");			
-		r = strlen(aux);
-		if(r >= 40 && r <= 42){
-			switch(r)		{
-				case 40:
-					if(isValidHex(aux)){
-						hexs2bin(aux,rawvalue);
-						bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-						memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-						i++;
-						validAddress = true;
-					}
-				break;
-				case 42:
-					if(isValidHex(aux+2)){
-						hexs2bin(aux+2,rawvalue);
-						bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-						memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-						i++;
-						validAddress = true;
+		if(target_load_phase == TARGET_LOAD_PARSE)	{
+			do	{
+				finished = 1;
+				if(FLAGQUIET == 0)	{
+					printf("\r[+] Parsing:");
+				}
+				for(i = 0; i < NTHREADS; i++)	{
+					finished &= target_load_threads[i].finished;
+					if(FLAGQUIET == 0)	{
+						printf(" %i%%",(target_load_threads[i].to > target_load_threads[i].from) ? (int)((target_load_threads[i].parsed * 100) / (target_load_threads[i].to - target_load_threads[i].from)) : 100);
 					}
-				break;
+				}
+				fflush(stdout);
+				if(!finished)	{
+					sleep_ms(500);
+				}
+			}while(!finished);
+			if(FLAGQUIET == 0)	{
+				printf("\n");
 			}
 		}
-		if(!validAddress)	{
-			fprintf(stderr,"[I] Ommiting invalid line %s\n",aux);
-			numberItems--;
+		for(i = 0; i < NTHREADS; i++)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			WaitForSingleObject(tid[i],INFINITE);
+			CloseHandle(tid[i]);
+#else
+			pthread_join(tid[i],NULL);
+#endif
 		}
 	}
-	
-	fclose(fileDescriptor);
-	return true;
-}
-
 
-
-bool forceReadFileXPoint(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	uint64_t numberItems,i;
-	size_t r,lenaux;
-	uint8_t rawvalue[100];
-	char aux[1000],*hextemp;
-	Tokenizer tokenizer_xpoint;	//tokenizer
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
-		return false;
-	}
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,1000,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r >= 40)	{ 
-				numberItems++;
-			}
+	/* Close the gaps of the removed duplicates */
+	offset = 0;
+	duplicates = 0;
+	for(b = 0; b < 256; b++)	{
+		bucket = target_load_bucket[b];
+		if(offset != bucket && target_load_count[b] > 0)	{
+			memmove(&addressTable[offset],&addressTable[bucket],target_load_count[b] * sizeof(struct address_value));
 		}
+		offset += target_load_count[b];
+		duplicates += (target_load_bucket[b + 1] - bucket) - target_load_count[b];
 	}
-	fseek(fileDescriptor,0,SEEK_SET);
+	N = offset;
+	printf("[+] %" PRIu64 " values were loaded and sorted, %" PRIu64 " duplicates removed\n",N,duplicates);
+	free(target_load_threads);
+	target_load_threads = NULL;
+	free(tid);
+	return true;
+}
 
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ - 1);
-	
-	N = numberItems;
-	
-	if(!initBloomFilter(&bloom,N))
-		return false;
-	
-	i= 0;
-	while(i < N)	{
-		memset(aux,0,1000);
-		hextemp = fgets(aux,1000,fileDescriptor);
-		memset((void *)&addressTable[i],0,sizeof(struct address_value));
-		if(hextemp == aux)	{
-			trim(aux," \t\n\r");
-			stringtokenizer(aux,&tokenizer_xpoint);
-			hextemp = nextToken(&tokenizer_xpoint);
-			lenaux = strlen(hextemp);
-			if(isValidHex(hextemp)) {
-				switch(lenaux)	{
-					case 64:	/*X value*/
-						r = hexs2bin(aux,(uint8_t*) rawvalue);
-						if(r)	{
-							memcpy(addressTable[i].value,rawvalue,20);
-							bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
-						}
-						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
-						}
-					break;
-					case 66:	/*Compress publickey*/
-						r = hexs2bin(aux+2, (uint8_t*)rawvalue);
-						if(r)	{
-							memcpy(addressTable[i].value,rawvalue,20);
-							bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
-						}
-						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
-						}
-					break;
-					case 130:	/* Uncompress publickey length*/
-						r = hexs2bin(aux, (uint8_t*) rawvalue);
-						if(r)	{
-								memcpy(addressTable[i].value,rawvalue+2,20);
-								bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
+#if defined(_WIN64) && !defined(__CYGWIN__)
+DWORD WINAPI thread_target_load(LPVOID vargp) {
+#else
+void *thread_target_load(void *vargp)	{
+#endif
+	struct target_load *tl = (struct target_load *)vargp;
+	struct address_value *item;
+	char line[1024],*p,*end,*to;
+	uint64_t length,i,j,from,count;
+	int b;
+	p = target_load_data + tl->from;
+	to = target_load_data + tl->to;
+	switch(target_load_phase)	{
+		case TARGET_LOAD_COUNT:
+			tl->lines = 0;
+			while(p < to)	{
+				end = (char*) memchr(p,'\n',to - p);
+				tl->lines++;
+				p = (end == NULL) ? to : end + 1;
+			}
+		break;
+		case TARGET_LOAD_PARSE:
+			item = target_load_parsed + tl->start;
+			while(p < to)	{
+				end = (char*) memchr(p,'\n',to - p);
+				if(end == NULL)	{
+					end = to;
+				}
+				length = end - p;
+				if(length < sizeof(line))	{
+					memcpy(line,p,length);
+					line[length] = '\0';
+					trim(line," \t\n\r");
+					if(line[0] != '\0')	{
+						if(target_load_parse(line,item->value))	{
+							tl->histogram[item->value[0]]++;
+							item++;
 						}
 						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
+							fprintf(stderr,"[I] Ommiting invalid line %s\n",line);
 						}
-					break;
-					default:
-						fprintf(stderr,"[E] Omiting line unknow length size %li: %s\n",lenaux,aux);
-					break;
+					}
+				}
+				else	{
+					fprintf(stderr,"[I] Ommiting line of %" PRIu64 " bytes\n",length);
 				}
+				p = end + 1;
+				tl->parsed = (p < to ? p : to) - (target_load_data + tl->from);
 			}
-			else	{
-				fprintf(stderr,"[E] Ignoring invalid hexvalue %s\n",aux);
+			tl->count = item - (target_load_parsed + tl->start);
+		break;
+		case TARGET_LOAD_SCATTER:
+			item = target_load_parsed + tl->start;
+			for(i = 0; i < tl->count; i++)	{
+				memcpy(&addressTable[tl->position[item[i].value[0]]++],&item[i],sizeof(struct address_value));
 			}
-			freetokenizer(&tokenizer_xpoint);
-		}
-		else	{
-			fprintf(stderr,"[E] Omiting line : %s\n",aux);
-			N--;
-		}
-		i++;
+		break;
+		case TARGET_LOAD_SORT:
+			for(b = tl->byte_from; b < tl->byte_to; b++)	{
+				from = target_load_bucket[b];
+				count = target_load_bucket[b + 1] - from;
+				item = addressTable + from;
+				if(count > 1)	{
+					_sort(item,count);
+				}
+				j = 0;
+				for(i = 0; i < count; i++)	{
+					if(j == 0 || memcmp(item[j - 1].value,item[i].value,sizeof(struct address_value)) != 0)	{
+						if(j != i)	{
+							memcpy(&item[j],&item[i],sizeof(struct address_value));
+						}
+						bloom_add(&bloom_address[b],item[j].value,MAXLENGTHADDRESS);
+						j++;
+					}
+				}
+				target_load_count[b] = j;
+			}
+		break;
 	}
-	fclose(fileDescriptor);
-	return true;
+	tl->finished = 1;
+	return NULL;
 }
 
-
+/*
+	The whole file in memory: mapped where there is mmap, else read in a buffer
+*/
+bool target_file_map(char *fileName,char **data,uint64_t *size)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	FILE *fd;
+	fd = fopen(fileName,"rb");
+	if(fd == NULL)	{
+		return false;
+	}
+	_fseeki64(fd,0,SEEK_END);
+	*size = _ftelli64(fd);
+	_fseeki64(fd,0,SEEK_SET);
+	*data = (char*) malloc(*size + 1);
+	checkpointer((void *)*data,__FILE__,"malloc","data" ,__LINE__ -1 );
+	if(fread(*data,1,*size,fd) != *size)	{
+		fclose(fd);
+		free(*data);
+		return false;
+	}
+	fclose(fd);
+	return true;
+#else
+	struct stat st;
+	int fd;
+	fd = open(fileName,O_RDONLY);
+	if(fd < 0)	{
+		return false;
+	}
+	if(fstat(fd,&st) != 0)	{
+		close(fd);
+		return false;
+	}
+	*size = st.st_size;
+	*data = NULL;
+	if(*size > 0)	{
+		*data = (char*) mmap(NULL,*size,PROT_READ,MAP_PRIVATE,fd,0);
+		if(*data == MAP_FAILED)	{
+			close(fd);
+			return false;
+		}
+		madvise(*data,*size,MADV_SEQUENTIAL);
+	}
+	close(fd);
+	return true;
+#endif
+}
+
+void target_file_unmap(char *data,uint64_t size)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	free(data);
+#else
+	if(size > 0)	{
+		munmap(data,size);
+	}
+#endif
+}
+
+/*
+	Parsers of one trimmed line of the targets file, they return 1 and the 20 bytes of the table for a valid line
+*/
+int parse_target_address(char *line,uint8_t *value)	{
+	uint8_t rawvalue[50];
+	size_t r,raw_value_length;
+	r = strlen(line);
+	if(r == BECH32_P2WPKH_LENGTH && bech32_decode_p2wpkh(value,line))	{	//Bech32, the hash160 of the compressed key
+		FLAGBECH32 = 1;
+		return 1;
+	}
+	if(r < 40 && isValidBase58String(line))	{	//Address
+		raw_value_length = 25;
+		b58tobin(rawvalue,&raw_value_length,line,r);
+		if(raw_value_length == 25)	{
+			if(rawvalue[0] == 0x05)	{	//P2SH, the hash160 of the redeem script
+				FLAGP2SH = 1;
+			}
+			memcpy(value,rawvalue+1,20);
+			return 1;
+		}
+	}
+	if(r == 40 && isValidHex(line))	{	//RMD
+		hexs2bin(line,value);
+		return 1;
+	}
+	return 0;
+}
+
+int parse_target_eth(char *line,uint8_t *value)	{
+	size_t r = strlen(line);
+	if(r == 42)	{		//0x prefix
+		line += 2;
+		r -= 2;
+	}
+	if(r == 40 && isValidHex(line))	{
+		hexs2bin(line,value);
+		return 1;
+	}
+	return 0;
+}
+
+int parse_target_xpoint(char *line,uint8_t *value)	{
+	uint8_t rawvalue[65];
+	size_t lenaux;
+	lenaux = strcspn(line," \t:");		/* Only the first token */
+	line[lenaux] = '\0';
+	if(!isValidHex(line))	{
+		return 0;
+	}
+	switch(lenaux)	{
+		case 64:	/*X value*/
+			hexs2bin(line,rawvalue);
+			memcpy(value,rawvalue,20);
+			return 1;
+		case 66:	/*Compress publickey*/
+			hexs2bin(line+2,rawvalue);
+			memcpy(value,rawvalue,20);
+			return 1;
+		case 130:	/* Uncompress publickey length*/
+			hexs2bin(line,rawvalue);
+			memcpy(value,rawvalue+1,20);
+			return 1;
+	}
+	return 0;
+}
+
+bool forceReadFileAddress(char *fileName)	{
+	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
+	return readFileTargets(fileName,parse_target_address);
+}
+
+bool forceReadFileAddressEth(char *fileName)	{
+	MAXLENGTHADDRESS = 20;
+	return readFileTargets(fileName,parse_target_eth);
+}
+
+bool forceReadFileXPoint(char *fileName)	{
+	MAXLENGTHADDRESS = 20;
+	return readFileTargets(fileName,parse_target_xpoint);
+}
+
+
 /*
 	I write this as a function because i have the same segment of code in 3 different functions
 */
@@ -6575,15 +6586,42 @@ bool initBloomFilter(struct bloom *bloom_arg,uint64_t items_bloom)	{
 	return r;
 }
 
+/*
+	The targets of address, rmd160 and xpoint modes are in 256 bloom filters like the BSGS ones. The values
+	are hashes or X values, random enough to give items_bloom/256 items to each filter
+*/
+bool initBloomAddress(uint64_t items_bloom)	{
+	uint64_t items_shard,bytes = 0;
+	int i;
+	printf("[+] Bloom filter for %" PRIu64 " elements.\n",items_bloom);
+	items_shard = FLAGBLOOMMULTIPLIER * (items_bloom / 256 + 1);
+	if(items_shard < 1000)	{
+		items_shard = 1000;		/* Minimum of bloom_init2 */
+	}
+	bloom_address = (struct bloom*) calloc(256,sizeof(struct bloom));
+	checkpointer((void *)bloom_address,__FILE__,"calloc","bloom_address" ,__LINE__ -1 );
+	for(i = 0; i < 256; i++)	{
+		if(bloom_init2(&bloom_address[i],items_shard,0.000001) == 1)	{
+			fprintf(stderr,"[E] error bloom_init for %" PRIu64 " elements.\n",items_shard);
+			return false;
+		}
+		bytes += bloom_address[i].bytes;
+	}
+	printf("[+] Loading data to the bloomfilter total: %.2f MB\n",(double)(((double) bytes)/(double)1048576));
+	return true;
+}
+
 void writeFileIfNeeded(const char *fileName)	{
 	//printf("[D] FLAGSAVEREADFILE %i, FLAGREADEDFILE1 %i\n",FLAGSAVEREADFILE,FLAGREADEDFILE1);
-	if(FLAGSAVEREADFILE && !FLAGREADEDFILE1)	{
+	if(FLAGSAVEREADFILE && !FLAGREADEDFILE1 && !FLAGSUBTRACT)	{
 		FILE *fileDescriptor;
 		char fileBloomName[30];
 		uint8_t checksum[32],hexPrefix[9];
-		char dataChecksum[32],bloomChecksum[32];
+		char dataChecksum[32],bloomChecksum[32],indexChecksum[32];
 		size_t bytesWrite;
-		uint64_t dataSize;
+		uint64_t dataSize,indexSize;
+		uint32_t targets;
+		int i;
 		if(!sha256_file((const char*)fileName,checksum)){
 			fprintf(stderr,"[E] sha256_file error line %i\n",__LINE__ - 1);
 			exit(EXIT_FAILURE);
@@ -6611,41 +6649,34 @@ void writeFileIfNeeded(const char *fileName)	{
 			
 			
 
-			sha256((uint8_t*)bloom.bf,bloom.bytes,(uint8_t*)bloomChecksum);
-			printf(".");
-			bytesWrite = fwrite(bloomChecksum,1,32,fileDescriptor);
-			if(bytesWrite != 32)	{
+			bytesWrite = fwrite(BLOOM_ADDRESS_MAGIC,1,8,fileDescriptor);
+			if(bytesWrite != 8)	{
 				fprintf(stderr,"[E] Errore writing file, code line %i\n",__LINE__ - 2);
 				exit(EXIT_FAILURE);
 			}
-			printf(".");
-			
-			bytesWrite = fwrite(&bloom,1,sizeof(struct bloom),fileDescriptor);
-			if(bytesWrite != sizeof(struct bloom))	{
-				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
-				exit(EXIT_FAILURE);
-			}
-			printf(".");
-			
-			bytesWrite = fwrite(bloom.bf,1,bloom.bytes,fileDescriptor);
-			if(bytesWrite != bloom.bytes)	{
-				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				exit(EXIT_FAILURE);
+			for(i = 0; i < 256; i++)	{
+				sha256((uint8_t*)bloom_address[i].bf,bloom_address[i].bytes,(uint8_t*)bloomChecksum);
+				bytesWrite = fwrite(bloomChecksum,1,32,fileDescriptor);
+				if(bytesWrite != 32)	{
+					fprintf(stderr,"[E] Errore writing file, code line %i\n",__LINE__ - 2);
+					exit(EXIT_FAILURE);
+				}
+
+				bytesWrite = fwrite(&bloom_address[i],1,sizeof(struct bloom),fileDescriptor);
+				if(bytesWrite != sizeof(struct bloom))	{
+					fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+					exit(EXIT_FAILURE);
+				}
+
+				bytesWrite = fwrite(bloom_address[i].bf,1,bloom_address[i].bytes,fileDescriptor);
+				if(bytesWrite != bloom_address[i].bytes)	{
+					fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					exit(EXIT_FAILURE);
+				}
 			}
 			printf(".");
-			
-			/*
-			if(FLAGDEBUG)	{
-				hextemp = tohex((char*)bloom.bf,32);
-				printf("\n[D] first 32 bytes bloom : %s\n",hextemp);
-				bloom_print(&bloom);
-				free(hextemp);
-			}
-			*/
 
-			
-			
 			sha256((uint8_t*)addressTable,dataSize,(uint8_t*)dataChecksum);
 			printf(".");
 
@@ -6669,6 +6700,27 @@ void writeFileIfNeeded(const char *fileName)	{
 				exit(EXIT_FAILURE);
 			}
 			printf(".");
+
+			/* Bucket index, size 0 if there is no index */
+			indexSize = (address_index != NULL) ? ((1ULL << address_index_bits) + 1) * sizeof(uint32_t) : 0;
+			sha256((uint8_t*)address_index,indexSize,(uint8_t*)indexChecksum);
+			bytesWrite = fwrite(indexChecksum,1,32,fileDescriptor);
+			bytesWrite += fwrite(&indexSize,1,sizeof(uint64_t),fileDescriptor);
+			bytesWrite += fwrite(&address_index_bits,1,sizeof(uint32_t),fileDescriptor);
+			if(indexSize > 0)	{
+				bytesWrite += fwrite(address_index,1,indexSize,fileDescriptor);
+			}
+			if(bytesWrite != 32 + sizeof(uint64_t) + sizeof(uint32_t) + indexSize)	{
+				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 6);
+				exit(EXIT_FAILURE);
+			}
+			targets = (FLAGP2SH ? TARGETS_P2SH : 0) | (FLAGBECH32 ? TARGETS_BECH32 : 0);
+			bytesWrite = fwrite(&targets,1,sizeof(uint32_t),fileDescriptor);
+			if(bytesWrite != sizeof(uint32_t))	{
+				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
 			
 			FLAGREADEDFILE1 = 1;	
 			fclose(fileDescriptor);		
@@ -6687,3 +6739,1101 @@ void calcualteindex(int i,Int *key)	{
 		key->Add(&BSGS_M3);
 	}
 }
+
+/*
+	Distinguished point table, open addressing with linear probing.
+	Every item starts with the lower 128 bits of the X value, those bits are random
+	enough to be used directly as hash. An empty slot has the X fragment in zero.
+	The caller must hold the lock of the table.
+*/
+void dp_table_init(struct dp_table *table,uint32_t item_size,uint64_t size)	{
+	table->item_size = item_size;
+	table->size = size;
+	table->count = 0;
+	table->data = (uint8_t*) calloc(size,item_size);
+	checkpointer((void *)table->data,__FILE__,"calloc","dp_table" ,__LINE__ -1 );
+}
+
+void dp_table_clear(struct dp_table *table)	{
+	memset(table->data,0,table->size * table->item_size);
+	table->count = 0;
+}
+
+void dp_table_grow(struct dp_table *table)	{
+	struct dp_table bigger;
+	uint64_t i;
+	uint8_t *item;
+	dp_table_init(&bigger,table->item_size,table->size * 2);
+	for(i = 0; i < table->size; i++)	{
+		item = table->data + i*table->item_size;
+		if(((uint64_t*)item)[0] != 0 || ((uint64_t*)item)[1] != 0)	{
+			dp_table_insert(&bigger,item,NULL);
+		}
+	}
+	free(table->data);
+	table->data = bigger.data;
+	table->size = bigger.size;
+}
+
+/*
+	Returns 0 if the item was added, 1 if there was already an item with the same
+	X fragment, in that case the old item is copied in found and nothing is added
+*/
+int dp_table_insert(struct dp_table *table,void *item,void *found)	{
+	uint64_t index,mask;
+	uint64_t *x = (uint64_t*) item;
+	uint64_t *slot;
+	if((table->count + 1) * 2 > table->size)	{
+		dp_table_grow(table);
+	}
+	mask = table->size - 1;
+	index = x[0] & mask;
+	while(1)	{
+		slot = (uint64_t*)(table->data + index*table->item_size);
+		if(slot[0] == 0 && slot[1] == 0)	{
+			memcpy(slot,item,table->item_size);
+			table->count++;
+			return 0;
+		}
+		if(slot[0] == x[0] && slot[1] == x[1])	{
+			if(found != NULL)	{
+				memcpy(found,slot,table->item_size);
+			}
+			return 1;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+/* Same as dp_table_insert but nothing is added, for the tables that reached their limit */
+int dp_table_find(struct dp_table *table,void *item,void *found)	{
+	uint64_t index,mask;
+	uint64_t *x = (uint64_t*) item;
+	uint64_t *slot;
+	mask = table->size - 1;
+	index = x[0] & mask;
+	while(1)	{
+		slot = (uint64_t*)(table->data + index*table->item_size);
+		if(slot[0] == 0 && slot[1] == 0)	{
+			return 0;
+		}
+		if(slot[0] == x[0] && slot[1] == x[1])	{
+			if(found != NULL)	{
+				memcpy(found,slot,table->item_size);
+			}
+			return 1;
+		}
+		index = (index + 1) & mask;
+	}
+}
+
+void kangaroo_dp_set(struct kangaroo_dp *dp,Point *p,Int *distance,int type)	{
+	dp->x[0] = p->x.bits64[0];
+	dp->x[1] = p->x.bits64[1];
+	dp->d[0] = distance->bits64[0];
+	dp->d[1] = distance->bits64[1];
+	dp->d[2] = (distance->bits64[2] & KANGAROO_DISTANCE_MASK) | ((uint64_t)type << 63);
+}
+
+int kangaroo_dp_get(struct kangaroo_dp *dp,Int *distance)	{
+	distance->SetInt32(0);
+	distance->bits64[0] = dp->d[0];
+	distance->bits64[1] = dp->d[1];
+	distance->bits64[2] = dp->d[2] & KANGAROO_DISTANCE_MASK;
+	return (int)(dp->d[2] >> 63);
+}
+
+/*
+	The jump table only depends on the range width, so kangaroos of a previous run
+	or of other machines follow the same paths and their DPs are still useful
+*/
+void kangaroo_init()	{
+	unsigned char seed[16],digest[32];
+	int i,range_bits,jump_bits,herd_bits;
+	kangaroo_range_width.Set(&n_range_end);
+	kangaroo_range_width.Sub(&n_range_start);
+	range_bits = kangaroo_range_width.GetBitLength();
+	if(range_bits > KANGAROO_MAX_RANGE_BITS)	{
+		fprintf(stderr,"[E] The range is too big for kangaroo mode (%i bits, max %i), use -r or -b\n",range_bits,KANGAROO_MAX_RANGE_BITS);
+		exit(EXIT_FAILURE);
+	}
+	jump_bits = range_bits / 2 + 1;
+	for(i = 0; i < KANGAROO_NB_JUMP; i++)	{
+		memset(seed,0,16);
+		memcpy(seed,"kangaroo",8);
+		seed[8] = (uint8_t) i;
+		seed[9] = (uint8_t) jump_bits;
+		sha256(seed,16,digest);
+		kangaroo_jump_distance[i].Set32Bytes(digest);
+		kangaroo_jump_distance[i].ShiftR(256 - jump_bits);
+		if(kangaroo_jump_distance[i].IsZero())	{
+			kangaroo_jump_distance[i].SetInt32(1);
+		}
+		kangaroo_jump_point[i] = secp->ComputePublicKey(&kangaroo_jump_distance[i]);
+	}
+	if(kangaroo_dp_bits < 0)	{
+		herd_bits = 0;
+		while((1ULL << herd_bits) < (uint64_t)NTHREADS * CPU_GRP_SIZE)	{
+			herd_bits++;
+		}
+		kangaroo_dp_bits = range_bits / 2 - herd_bits - 2;
+		if(kangaroo_dp_bits < 0)	{
+			kangaroo_dp_bits = 0;
+		}
+	}
+	if(kangaroo_dp_bits > 63)	{
+		kangaroo_dp_bits = 63;
+	}
+	kangaroo_dp_mask = (kangaroo_dp_bits == 0) ? 0 : (0xFFFFFFFFFFFFFFFFULL << (64 - kangaroo_dp_bits));
+	printf("[+] Kangaroo range width %i bits, mean jump 2^%i\n",range_bits,jump_bits - 1);
+	printf("[+] Distinguished point bits %i\n",kangaroo_dp_bits);
+	printf("[+] Expected ~2^%.1f group operations per publickey\n",(double)range_bits / 2.0 + 1.0);
+	dp_table_init(&kangaroo_table,sizeof(struct kangaroo_dp),1 << 16);
+	snprintf(kangaroo_node,sizeof(kangaroo_node),"%08x",(uint32_t)rndl());
+	kangaroo_current = 0;
+	kangaroo_settarget(0);
+}
+
+/* File name for the saved DPs, it depends on the target, the range and the DP bits */
+void kangaroo_filename(uint32_t index,char *dst)	{
+	unsigned char data[100],digest[32];
+	char hexdigest[9];
+	secp->GetPublicKeyRaw(true,kangaroo_targets[index],(char*)data);
+	n_range_start.Get32Bytes(data + 33);
+	n_range_end.Get32Bytes(data + 65);
+	data[97] = (uint8_t) kangaroo_dp_bits;
+	data[98] = 0;
+	data[99] = 0;
+	sha256(data,100,digest);
+	tohex_dst((char*)digest,4,hexdigest);
+	snprintf(dst,1024,"kangaroo_%s.dat",hexdigest);
+}
+
+/* Start a kangaroo of the given herd, tame ones at start + d, wild ones at Q + d */
+void kangaroo_spawn(uint32_t index,int type,Point *p,Int *distance)	{
+	Int max,key;
+	Point point_distance;
+	max.Set(&kangaroo_range_width);
+	if(type == KANGAROO_WILD)	{
+		max.ShiftR(1);
+	}
+	distance->Rand(&ZERO,&max);
+	if(type == KANGAROO_TAME)	{
+		key.Set(&n_range_start);
+		key.Add(distance);
+		key.Mod(&secp->order);
+		*p = secp->ComputePublicKey(&key);
+	}
+	else	{
+		point_distance = secp->ComputePublicKey(distance);
+		*p = secp->AddDirect(kangaroo_targets[index],point_distance);
+	}
+}
+
+/*
+	A tame and a wild kangaroo on the same X: start + dt = k + dw or start + dt = -(k + dw)
+	Both candidates are checked against the target
+*/
+bool kangaroo_solve(Point *target,Int *start,struct kangaroo_dp *a,struct kangaroo_dp *b,Int *key)	{
+	Int dt,dw;
+	Point candidate;
+	int type_a,type_b;
+	type_a = kangaroo_dp_get(a,&dt);
+	type_b = kangaroo_dp_get(b,&dw);
+	if(type_a == type_b)	{
+		return false;
+	}
+	if(type_a == KANGAROO_WILD)	{
+		kangaroo_dp_get(b,&dt);
+		kangaroo_dp_get(a,&dw);
+	}
+	key->Set(start);
+	key->Add(&dt);
+	key->Sub(&dw);
+	if(key->IsNegative())	{
+		key->Add(&secp->order);
+	}
+	key->Mod(&secp->order);
+	candidate = secp->ComputePublicKey(key);
+	if(candidate.x.IsEqual(&target->x) && candidate.y.IsEqual(&target->y))	{
+		return true;
+	}
+	key->Set(start);
+	key->Add(&dt);
+	key->Add(&dw);
+	key->Mod(&secp->order);
+	key->Neg();
+	key->Add(&secp->order);
+	candidate = secp->ComputePublicKey(key);
+	return candidate.x.IsEqual(&target->x) && candidate.y.IsEqual(&target->y);
+}
+
+/* Called with kangaroo_mutex locked */
+void kangaroo_settarget(uint32_t index)	{
+	char *hextemp;
+	dp_table_clear(&kangaroo_table);
+	kangaroo_batch.clear();
+	if(index >= kangaroo_target_number)	{
+		return;
+	}
+	hextemp = secp->GetPublicKeyHex(kangaroo_targets_compressed[index],kangaroo_targets[index]);
+	printf("[+] Kangaroo target %u/%u: %s\n",index + 1,kangaroo_target_number,hextemp);
+	free(hextemp);
+	if(FLAGSAVEREADFILE)	{
+		kangaroo_load(index);
+	}
+}
+
+bool kangaroo_load(uint32_t index)	{
+	FILE *fd;
+	struct kangaroo_file_header header,expected;
+	struct kangaroo_dp dp;
+	uint64_t i;
+	char filename[1024];
+	kangaroo_filename(index,filename);
+	fd = fopen(filename,"rb");
+	if(fd == NULL)	{
+		return false;
+	}
+	if(fread(&header,1,sizeof(struct kangaroo_file_header),fd) != sizeof(struct kangaroo_file_header) || memcmp(header.magic,KANGAROO_FILE_MAGIC,4) != 0)	{
+		fprintf(stderr,"[W] Ignoring invalid file %s\n",filename);
+		fclose(fd);
+		return false;
+	}
+	/* The name is only 32 bits of a hash, the header must be of this target, range and DP bits */
+	kangaroo_header(index,&expected,0);
+	if(header.dp_bits != expected.dp_bits || memcmp(header.target,expected.target,33) != 0 || memcmp(header.range_start,expected.range_start,32) != 0 || memcmp(header.range_end,expected.range_end,32) != 0)	{
+		fprintf(stderr,"[W] Ignoring file %s, it is of another target, range or DP bits\n",filename);
+		fclose(fd);
+		return false;
+	}
+	for(i = 0; i < header.count; i++)	{
+		if(fread(&dp,1,sizeof(struct kangaroo_dp),fd) != sizeof(struct kangaroo_dp))	{
+			fprintf(stderr,"[W] File %s is truncated, %" PRIu64 " of %" PRIu64 " DPs were read\n",filename,i,header.count);
+			break;
+		}
+		dp_table_insert(&kangaroo_table,&dp,NULL);
+	}
+	fclose(fd);
+	printf("[+] Loaded %" PRIu64 " distinguished points from %s\n",kangaroo_table.count,filename);
+	return true;
+}
+
+/* Order of the DP files, the X fragment as a 128 bits number */
+int kangaroo_dp_cmp(const void *a,const void *b)	{
+	const struct kangaroo_dp *da = (const struct kangaroo_dp *)a;
+	const struct kangaroo_dp *db = (const struct kangaroo_dp *)b;
+	if(da->x[1] != db->x[1])	{
+		return (da->x[1] < db->x[1]) ? -1 : 1;
+	}
+	if(da->x[0] != db->x[0])	{
+		return (da->x[0] < db->x[0]) ? -1 : 1;
+	}
+	return 0;
+}
+
+void kangaroo_header(uint32_t index,struct kangaroo_file_header *header,uint64_t count)	{
+	memset(header,0,sizeof(struct kangaroo_file_header));
+	memcpy(header->magic,KANGAROO_FILE_MAGIC,4);
+	header->dp_bits = kangaroo_dp_bits;
+	header->count = count;
+	header->flags = KANGAROO_FILE_SORTED;
+	if(kangaroo_targets_compressed[index])	{
+		header->flags |= KANGAROO_FILE_COMPRESSED;
+	}
+	secp->GetPublicKeyRaw(true,kangaroo_targets[index],(char*)header->target);
+	n_range_start.Get32Bytes(header->range_start);
+	n_range_end.Get32Bytes(header->range_end);
+}
+
+/* Sort the DPs and write them, the file is replaced only after it is fully written */
+bool kangaroo_writefile(const char *filename,struct kangaroo_file_header *header,struct kangaroo_dp *dps)	{
+	FILE *fd;
+	char filename_temp[1032];
+	qsort(dps,header->count,sizeof(struct kangaroo_dp),kangaroo_dp_cmp);
+	snprintf(filename_temp,sizeof(filename_temp),"%s.tmp",filename);
+	fd = fopen(filename_temp,"wb");
+	if(fd == NULL)	{
+		fprintf(stderr,"[E] Can't create file %s\n",filename_temp);
+		return false;
+	}
+	fwrite(header,1,sizeof(struct kangaroo_file_header),fd);
+	fwrite(dps,sizeof(struct kangaroo_dp),header->count,fd);
+	if(fclose(fd) != 0 || rename(filename_temp,filename) != 0)	{
+		fprintf(stderr,"[E] Error writing file %s\n",filename);
+		return false;
+	}
+	return true;
+}
+
+/*
+	It writes the whole table for restarts and the DPs found since the previous save in a
+	new batch file for dpmerge. Only the copy is done with kangaroo_mutex locked, the
+	workers don't wait for the sort and the writes
+*/
+void kangaroo_save()	{
+	struct kangaroo_file_header header,batch_header;
+	struct kangaroo_dp *dps;
+	std::vector<struct kangaroo_dp> batch;
+	uint64_t i,j;
+	uint64_t *slot;
+	uint32_t index,sequence;
+	char filename[1024],filename_batch[1024];
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	WaitForSingleObject(kangaroo_mutex, INFINITE);
+#else
+	pthread_mutex_lock(&kangaroo_mutex);
+#endif
+	index = kangaroo_current;
+	if(index >= kangaroo_target_number)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+		ReleaseMutex(kangaroo_mutex);
+#else
+		pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+		return;
+	}
+	kangaroo_filename(index,filename);
+	kangaroo_header(index,&header,kangaroo_table.count);
+	dps = (struct kangaroo_dp*) malloc((kangaroo_table.count + 1) * sizeof(struct kangaroo_dp));
+	checkpointer((void *)dps,__FILE__,"malloc","dps" ,__LINE__ -1 );
+	for(i = 0, j = 0; i < kangaroo_table.size; i++)	{
+		slot = (uint64_t*)(kangaroo_table.data + i*kangaroo_table.item_size);
+		if(slot[0] != 0 || slot[1] != 0)	{
+			memcpy(&dps[j++],slot,sizeof(struct kangaroo_dp));
+		}
+	}
+	batch.swap(kangaroo_batch);
+	kangaroo_header(index,&batch_header,batch.size());
+	sequence = kangaroo_batch_sequence;
+	if(batch.size() > 0)	{
+		kangaroo_batch_sequence++;
+	}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	ReleaseMutex(kangaroo_mutex);
+#else
+	pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+	kangaroo_writefile(filename,&header,dps);
+	free(dps);
+	if(batch.size() > 0)	{
+		filename[strlen(filename) - 4] = '\0';	//Remove .dat
+		snprintf(filename_batch,sizeof(filename_batch),"%s_%s_%u.dat",filename,kangaroo_node,sequence);
+		if(!kangaroo_writefile(filename_batch,&batch_header,batch.data()))	{
+			/* Keep them for the next save if the target is still the same */
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			WaitForSingleObject(kangaroo_mutex, INFINITE);
+#else
+			pthread_mutex_lock(&kangaroo_mutex);
+#endif
+			if(kangaroo_current == index)	{
+				kangaroo_batch.insert(kangaroo_batch.begin(),batch.begin(),batch.end());
+			}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			ReleaseMutex(kangaroo_mutex);
+#else
+			pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+		}
+	}
+	if(FLAGDEBUG)	{
+		printf("\n[D] Saved %" PRIu64 " distinguished points in %s.dat\n",header.count,filename);
+	}
+}
+
+bool readFilePublicKeys(char *fileName,std::vector<Point> &points,std::vector<bool> &compressed)	{
+	FILE *fd;
+	char aux[1024];
+	Tokenizer tokenizer;
+	char *hexvalue;
+	Point point;
+	bool is_compressed;
+	printf("[+] Opening file %s\n",fileName);
+	fd = fopen(fileName,"rb");
+	if(fd == NULL)	{
+		fprintf(stderr,"[E] Can't open file %s\n",fileName);
+		return false;
+	}
+	while(!feof(fd))	{
+		if(fgets(aux,1022,fd) == aux)	{
+			trim(aux," \t\n\r");
+			if(strlen(aux) >= 66)	{
+				stringtokenizer(aux,&tokenizer);
+				hexvalue = nextToken(&tokenizer);
+				if((strlen(hexvalue) == 66 || strlen(hexvalue) == 130) && secp->ParsePublicKeyHex(hexvalue,point,is_compressed))	{
+					points.push_back(point);
+					compressed.push_back(is_compressed);
+				}
+				else	{
+					printf("Invalid publickey: %s\n",hexvalue);
+				}
+				freetokenizer(&tokenizer);
+			}
+		}
+	}
+	fclose(fd);
+	if(points.size() == 0)	{
+		fprintf(stderr,"[E] The file don't have any valid publickeys\n");
+		return false;
+	}
+	printf("[+] Added %u points from file\n",(uint32_t)points.size());
+	return true;
+}
+
+/* Move to the next target if nobody else did it yet */
+void kangaroo_nexttarget(uint32_t index)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	WaitForSingleObject(kangaroo_mutex, INFINITE);
+#else
+	pthread_mutex_lock(&kangaroo_mutex);
+#endif
+	if(kangaroo_current == index)	{
+		kangaroo_current++;
+		kangaroo_settarget(kangaroo_current);
+		if(kangaroo_current == kangaroo_target_number)	{
+			printf("All points were found\n");
+		}
+	}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	ReleaseMutex(kangaroo_mutex);
+#else
+	pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+}
+
+#if defined(_WIN64) && !defined(__CYGWIN__)
+DWORD WINAPI thread_process_kangaroo(LPVOID vargp) {
+#else
+void *thread_process_kangaroo(void *vargp)	{
+#endif
+	struct tothread *tt;
+	struct kangaroo_dp dp,dp_found;
+	Point herd[CPU_GRP_SIZE];
+	Int distance[CPU_GRP_SIZE];
+	Int dx[CPU_GRP_SIZE];
+	Int dy,_s,_p,keyfound;
+	Point *jump;
+	IntGroup *grp = new IntGroup(CPU_GRP_SIZE);
+	uint32_t target = 0xFFFFFFFF,current;
+	int i,r,type,thread_number;
+
+	tt = (struct tothread *)vargp;
+	thread_number = tt->nt;
+	free(tt);
+	grp->Set(dx);
+
+	do	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+		WaitForSingleObject(kangaroo_mutex, INFINITE);
+		current = kangaroo_current;
+		ReleaseMutex(kangaroo_mutex);
+#else
+		pthread_mutex_lock(&kangaroo_mutex);
+		current = kangaroo_current;
+		pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+		if(current >= kangaroo_target_number)	{
+			break;
+		}
+		if(current != target)	{
+			target = current;
+			for(i = 0; i < CPU_GRP_SIZE; i++)	{
+				kangaroo_spawn(target,KANGAROO_HERD(i),&herd[i],&distance[i]);
+			}
+		}
+		for(i = 0; i < CPU_GRP_SIZE; i++)	{
+			jump = &kangaroo_jump_point[herd[i].x.bits64[0] % KANGAROO_NB_JUMP];
+			dx[i].ModSub(&jump->x,&herd[i].x);
+		}
+		grp->ModInv();
+		for(i = 0; i < CPU_GRP_SIZE; i++)	{
+			r = herd[i].x.bits64[0] % KANGAROO_NB_JUMP;
+			jump = &kangaroo_jump_point[r];
+			distance[i].Add(&kangaroo_jump_distance[r]);
+
+			dy.ModSub(&jump->y,&herd[i].y);
+			_s.ModMulK1(&dy,&dx[i]);		// s = (p2.y-p1.y)*inverse(p2.x-p1.x)
+			_p.ModSquareK1(&_s);			// _p = pow2(s)
+
+			dy.Set(&herd[i].x);
+			herd[i].x.ModSub(&_p,&herd[i].x);
+			herd[i].x.ModSub(&jump->x);		// rx = pow2(s) - p1.x - p2.x
+
+			dy.ModSub(&herd[i].x);
+			dy.ModMulK1(&_s);
+			herd[i].y.ModSub(&dy,&herd[i].y);	// ry = s*(p1.x - rx) - p1.y
+
+			if((herd[i].x.bits64[3] & kangaroo_dp_mask) == 0)	{
+				type = KANGAROO_HERD(i);
+				kangaroo_dp_set(&dp,&herd[i],&distance[i],type);
+#if defined(_WIN64) && !defined(__CYGWIN__)
+				WaitForSingleObject(kangaroo_mutex, INFINITE);
+#else
+				pthread_mutex_lock(&kangaroo_mutex);
+#endif
+				r = 0;
+				if(target == kangaroo_current)	{
+					r = dp_table_insert(&kangaroo_table,&dp,&dp_found);
+					if(r == 0 && FLAGSAVEREADFILE)	{
+						kangaroo_batch.push_back(dp);
+					}
+				}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+				ReleaseMutex(kangaroo_mutex);
+#else
+				pthread_mutex_unlock(&kangaroo_mutex);
+#endif
+				if(r)	{
+					if(kangaroo_solve(&kangaroo_targets[target],&n_range_start,&dp,&dp_found,&keyfound))	{
+						writekey(kangaroo_targets_compressed[target],&keyfound);
+						kangaroo_nexttarget(target);
+					}
+					else	{
+						/* Same herd, this kangaroo is now following the other one */
+						kangaroo_spawn(target,type,&herd[i],&distance[i]);
+					}
+				}
+			}
+		}
+		steps[thread_number]++;
+	}while(1);
+	delete grp;
+	ends[thread_number] = 1;
+	return NULL;
+}
+
+bool kangaroo_headermatch(struct kangaroo_file_header *a,struct kangaroo_file_header *b)	{
+	return a->dp_bits == b->dp_bits && memcmp(a->target,b->target,33) == 0 && memcmp(a->range_start,b->range_start,32) == 0 && memcmp(a->range_end,b->range_end,32) == 0;
+}
+
+/*
+	dpmerge: merge the sorted DP batch files of several runs into the master file.
+	All the inputs are walked as sorted streams, a tame and a wild DP with the same X
+	give the key. The batches already merged are renamed to .merged so the next
+	merge only reads the new ones.
+*/
+void kangaroo_merge(char *master,int n,char **files)	{
+	FILE *fd;
+	struct kangaroo_file_header header,aux_header;
+	std::vector<struct kangaroo_dp*> inputs;
+	std::vector<uint64_t> counts;
+	std::vector<uint64_t> cursors;
+	std::vector<int> merged;
+	struct kangaroo_dp *dps,*item,*last = NULL;
+	struct kangaroo_dp last_value;
+	uint64_t written = 0,master_count = 0,collisions = 0;
+	size_t master_length = 0;
+	bool have_header = false,found = false;
+	char *hextemp,filename_temp[1032];
+	Point target;
+	Int start,keyfound;
+	bool compressed;
+	int i,k;
+
+	/* The master file is mapped, it can be much bigger than the batches */
+	dps = NULL;
+	fd = fopen(master,"rb");
+	if(fd != NULL)	{
+		if(fread(&header,1,sizeof(struct kangaroo_file_header),fd) != sizeof(struct kangaroo_file_header) || memcmp(header.magic,KANGAROO_FILE_MAGIC,4) != 0 || !(header.flags & KANGAROO_FILE_SORTED))	{
+			fprintf(stderr,"[E] Invalid master file %s\n",master);
+			exit(EXIT_FAILURE);
+		}
+		have_header = true;
+		master_count = header.count;
+		if(master_count > 0)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			dps = (struct kangaroo_dp*) malloc(master_count * sizeof(struct kangaroo_dp));
+			checkpointer((void *)dps,__FILE__,"malloc","dps" ,__LINE__ -1 );
+			if(fread(dps,sizeof(struct kangaroo_dp),master_count,fd) != master_count)	{
+				fprintf(stderr,"[E] File %s is truncated\n",master);
+				exit(EXIT_FAILURE);
+			}
+#else
+			/* A DP past the end of a truncated file would be a SIGBUS in the mmap */
+			struct stat st;
+			if(fstat(fileno(fd),&st) != 0 || (uint64_t)st.st_size < sizeof(struct kangaroo_file_header) || master_count > ((uint64_t)st.st_size - sizeof(struct kangaroo_file_header)) / sizeof(struct kangaroo_dp))	{
+				fprintf(stderr,"[E] File %s is truncated\n",master);
+				exit(EXIT_FAILURE);
+			}
+			master_length = sizeof(struct kangaroo_file_header) + master_count * sizeof(struct kangaroo_dp);
+			dps = (struct kangaroo_dp*) mmap(NULL,master_length,PROT_READ,MAP_PRIVATE,fileno(fd),0);
+			if(dps == MAP_FAILED)	{
+				fprintf(stderr,"[E] Can't map the file %s\n",master);
+				exit(EXIT_FAILURE);
+			}
+			madvise(dps,master_length,MADV_SEQUENTIAL);
+			dps = (struct kangaroo_dp*)((uint8_t*)dps + sizeof(struct kangaroo_file_header));
+#endif
+		}
+		fclose(fd);
+		printf("[+] Master %s: %" PRIu64 " distinguished points\n",master,master_count);
+	}
+	inputs.push_back(dps);
+	counts.push_back(master_count);
+	merged.push_back(-1);
+
+	for(i = 0; i < n; i++)	{
+		fd = fopen(files[i],"rb");
+		if(fd == NULL)	{
+			fprintf(stderr,"[W] Can't open file %s\n",files[i]);
+			continue;
+		}
+		if(fread(&aux_header,1,sizeof(struct kangaroo_file_header),fd) != sizeof(struct kangaroo_file_header) || memcmp(aux_header.magic,KANGAROO_FILE_MAGIC,4) != 0)	{
+			fprintf(stderr,"[W] Ignoring invalid file %s\n",files[i]);
+			fclose(fd);
+			continue;
+		}
+		if(!have_header)	{
+			memcpy(&header,&aux_header,sizeof(struct kangaroo_file_header));
+			have_header = true;
+		}
+		if(!kangaroo_headermatch(&header,&aux_header))	{
+			fprintf(stderr,"[W] Ignoring %s, it is for other publickey, range or DP bits\n",files[i]);
+			fclose(fd);
+			continue;
+		}
+		dps = (struct kangaroo_dp*) malloc((aux_header.count + 1) * sizeof(struct kangaroo_dp));
+		checkpointer((void *)dps,__FILE__,"malloc","dps" ,__LINE__ -1 );
+		aux_header.count = fread(dps,sizeof(struct kangaroo_dp),aux_header.count,fd);
+		fclose(fd);
+		if(!(aux_header.flags & KANGAROO_FILE_SORTED))	{
+			qsort(dps,aux_header.count,sizeof(struct kangaroo_dp),kangaroo_dp_cmp);
+		}
+		printf("[+] Batch %s: %" PRIu64 " distinguished points\n",files[i],aux_header.count);
+		inputs.push_back(dps);
+		counts.push_back(aux_header.count);
+		merged.push_back(i);
+	}
+	if(!have_header)	{
+		fprintf(stderr,"[E] There is no valid DP file to merge\n");
+		exit(EXIT_FAILURE);
+	}
+
+	hextemp = tohex((char*)header.target,33);
+	if(!secp->ParsePublicKeyHex(hextemp,target,compressed))	{
+		fprintf(stderr,"[E] Invalid publickey in the DP files %s\n",hextemp);
+		exit(EXIT_FAILURE);
+	}
+	printf("[+] Publickey %s\n",hextemp);
+	free(hextemp);
+	start.Set32Bytes(header.range_start);
+	compressed = (header.flags & KANGAROO_FILE_COMPRESSED) != 0;
+
+	snprintf(filename_temp,sizeof(filename_temp),"%s.tmp",master);
+	fd = fopen(filename_temp,"wb");
+	if(fd == NULL)	{
+		fprintf(stderr,"[E] Can't create file %s\n",filename_temp);
+		exit(EXIT_FAILURE);
+	}
+	header.flags |= KANGAROO_FILE_SORTED;
+	fwrite(&header,1,sizeof(struct kangaroo_file_header),fd);
+	cursors.assign(inputs.size(),0);
+	do	{
+		item = NULL;
+		k = -1;
+		for(i = 0; i < (int)inputs.size(); i++)	{
+			if(cursors[i] < counts[i] && (item == NULL || kangaroo_dp_cmp(&inputs[i][cursors[i]],item) < 0))	{
+				item = &inputs[i][cursors[i]];
+				k = i;
+			}
+		}
+		if(item == NULL)	{
+			break;
+		}
+		cursors[k]++;
+		if(last != NULL && kangaroo_dp_cmp(last,item) == 0)	{
+			if((last->d[2] >> 63) != (item->d[2] >> 63))	{
+				collisions++;
+				if(!found && kangaroo_solve(&target,&start,last,item,&keyfound))	{
+					writekey(compressed,&keyfound);
+					found = true;
+				}
+			}
+			continue;
+		}
+		memcpy(&last_value,item,sizeof(struct kangaroo_dp));
+		last = &last_value;
+		fwrite(item,1,sizeof(struct kangaroo_dp),fd);
+		written++;
+	}while(1);
+	header.count = written;
+	fseek(fd,0,SEEK_SET);
+	fwrite(&header,1,sizeof(struct kangaroo_file_header),fd);
+	if(fclose(fd) != 0 || rename(filename_temp,master) != 0)	{
+		fprintf(stderr,"[E] Error writing file %s\n",master);
+		exit(EXIT_FAILURE);
+	}
+
+	for(i = 1; i < (int)inputs.size(); i++)	{
+		free(inputs[i]);
+		snprintf(filename_temp,sizeof(filename_temp),"%s.merged",files[merged[i]]);
+		if(rename(files[merged[i]],filename_temp) != 0)	{
+			fprintf(stderr,"[W] Can't rename %s\n",files[merged[i]]);
+		}
+	}
+	if(inputs[0] != NULL)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+		free(inputs[0]);
+#else
+		munmap((uint8_t*)inputs[0] - sizeof(struct kangaroo_file_header),master_length);
+#endif
+	}
+	printf("[+] Master %s: %" PRIu64 " distinguished points (%" PRIu64 " new), %" PRIu64 " tame/wild collisions\n",master,written,written - master_count,collisions);
+}
+
+/*
+	Rho mode, every walk is a point P = a*G + b*Q and every step adds R[j] = c[j]*G + d[j]*Q
+	with j taken from X. With the negation map only the point with even Y is kept, so the
+	walk runs over the classes {P,-P} and needs sqrt(2) less steps. Two walks on the same
+	point give a1 + b1*k = a2 + b2*k
+*/
+void rho_init()	{
+	rho_dp_bits = (kangaroo_dp_bits < 0) ? RHO_DP_BITS : kangaroo_dp_bits;
+	rho_dp_mask = (rho_dp_bits == 0) ? 0 : (0xFFFFFFFFFFFFFFFFULL << (64 - rho_dp_bits));
+	printf("[+] Distinguished point bits %i\n",rho_dp_bits);
+	printf("[+] Expected steps per publickey 2^128\n");
+	/* 2^(128 - D) DPs never fit in RAM, the first ones are kept and the rest only checked */
+	printf("[+] Rho table up to %" PRIu64 " distinguished points (%" PRIu64 " MB)\n",(uint64_t)RHO_TABLE_MAX,(uint64_t)(2 * RHO_TABLE_MAX * sizeof(struct rho_dp)) >> 20);
+	dp_table_init(&rho_table,sizeof(struct rho_dp),1 << 16);
+	rho_current = 0;
+	rho_settarget(0);
+}
+
+/* Called with rho_mutex locked, the threads copy the jump table when they see the new target */
+void rho_settarget(uint32_t index)	{
+	char *hextemp;
+	Point aux;
+	int i;
+	dp_table_clear(&rho_table);
+	rho_table_full = 0;
+	if(index >= rho_target_number)	{
+		return;
+	}
+	hextemp = secp->GetPublicKeyHex(rho_targets_compressed[index],rho_targets[index]);
+	printf("[+] Rho target %u/%u: %s\n",index + 1,rho_target_number,hextemp);
+	free(hextemp);
+	for(i = 0; i < RHO_NB_JUMP; i++)	{
+#ifdef RHO_TEST_BITS
+		/* Test build, the walks stay near G and Q so a key of RHO_TEST_BITS is found in seconds */
+		rho_jump_a[i].Rand(RHO_TEST_BITS / 2);
+		rho_jump_a[i].AddOne();
+		rho_jump_b[i].SetInt32(0);
+		rho_jump_point[i] = secp->ComputePublicKey(&rho_jump_a[i]);
+#else
+		rho_jump_a[i].Rand(&ONE,&secp->order);
+		rho_jump_b[i].Rand(&ONE,&secp->order);
+		aux = secp->ScalarMultiplication(rho_targets[index],&rho_jump_b[i]);
+		rho_jump_point[i] = secp->ComputePublicKey(&rho_jump_a[i]);
+		rho_jump_point[i] = secp->AddDirect(rho_jump_point[i],aux);
+#endif
+	}
+}
+
+/* Move to the next target if nobody else did it yet */
+void rho_nexttarget(uint32_t index)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	WaitForSingleObject(rho_mutex, INFINITE);
+#else
+	pthread_mutex_lock(&rho_mutex);
+#endif
+	if(rho_current == index)	{
+		rho_current++;
+		rho_settarget(rho_current);
+		if(rho_current == rho_target_number)	{
+			printf("All points were found\n");
+		}
+	}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	ReleaseMutex(rho_mutex);
+#else
+	pthread_mutex_unlock(&rho_mutex);
+#endif
+}
+
+void rho_spawn(uint32_t index,Point *p,Int *a,Int *b)	{
+	Point aux;
+#ifdef RHO_TEST_BITS
+	/* Half of the walks start at a*G and half at a*G + Q */
+	a->Rand(RHO_TEST_BITS);
+	a->AddOne();
+	b->SetInt32(a->GetBit(1));
+	*p = secp->ComputePublicKey(a);
+	if(!b->IsZero())	{
+		*p = secp->AddDirect(*p,rho_targets[index]);
+	}
+#else
+	a->Rand(&ONE,&secp->order);
+	b->Rand(&ONE,&secp->order);
+	aux = secp->ScalarMultiplication(rho_targets[index],b);
+	*p = secp->ComputePublicKey(a);
+	*p = secp->AddDirect(*p,aux);
+#endif
+	rho_canonical(p,a,b);
+}
+
+/* Keep the point with even Y, -P = -a*G - b*Q */
+void rho_canonical(Point *p,Int *a,Int *b)	{
+	if(p->y.IsOdd())	{
+		p->y.ModNeg();
+		rho_negorder(a);
+		rho_negorder(b);
+	}
+}
+
+void rho_negorder(Int *x)	{
+	if(!x->IsZero())	{
+		x->Neg();
+		x->Add(&secp->order);
+	}
+}
+
+/* x^(n-2) mod n, only used when two walks collide */
+void rho_invorder(Int *x)	{
+	Int e,r;
+	int i;
+	e.Set(&secp->order);
+	e.SubOne();
+	e.SubOne();
+	r.SetInt32(1);
+	for(i = e.GetBitLength() - 1; i >= 0; i--)	{
+		r.ModMulK1order(&r);
+		if(e.GetBit(i))	{
+			r.ModMulK1order(x);
+		}
+	}
+	x->Set(&r);
+}
+
+void rho_dp_set(struct rho_dp *dp,Point *p,Int *a,Int *b)	{
+	dp->x[0] = p->x.bits64[0];
+	dp->x[1] = p->x.bits64[1];
+	memcpy(dp->a,a->bits64,32);
+	memcpy(dp->b,b->bits64,32);
+}
+
+void rho_dp_get(struct rho_dp *dp,Int *a,Int *b)	{
+	a->SetInt32(0);
+	b->SetInt32(0);
+	memcpy(a->bits64,dp->a,32);
+	memcpy(b->bits64,dp->b,32);
+}
+
+/*
+	Both DPs are the same canonical point so a1 - a2 = (b2 - b1)*k, if b1 == b2 the walk
+	found its own track and there is nothing to solve
+*/
+bool rho_solve(Point *target,struct rho_dp *x,struct rho_dp *y,Int *key)	{
+	Int a1,b1,a2,b2,denominator;
+	Point candidate;
+	rho_dp_get(x,&a1,&b1);
+	rho_dp_get(y,&a2,&b2);
+	if(b1.IsEqual(&b2))	{
+		return false;
+	}
+	rho_negorder(&a2);
+	key->ModAddK1order(&a1,&a2);
+	rho_negorder(&b1);
+	denominator.ModAddK1order(&b2,&b1);
+	rho_invorder(&denominator);
+	key->ModMulK1order(&denominator);
+	candidate = secp->ComputePublicKey(key);
+	return candidate.x.IsEqual(&target->x) && candidate.y.IsEqual(&target->y);
+}
+
+/*
+	With the negation map a walk can fall in a fruitless cycle, P -> -(P + R[j]) -> P when
+	the new point uses the same j. That step is replaced by P + R[j+1]. The last X values
+	of every walk are kept to find the longer cycles, the walk leaves them doubling the point.
+	Both cases wait for the next round so they share the batch inversion, a single ModInv
+	costs more than a full round of additions
+*/
+#if defined(_WIN64) && !defined(__CYGWIN__)
+DWORD WINAPI thread_process_rho(LPVOID vargp) {
+#else
+void *thread_process_rho(void *vargp)	{
+#endif
+	struct tothread *tt;
+	struct rho_dp dp,dp_found;
+	Point *walk = new Point[CPU_GRP_SIZE];
+	Int *a = new Int[CPU_GRP_SIZE];
+	Int *b = new Int[CPU_GRP_SIZE];
+	Int dx[CPU_GRP_SIZE];
+	uint64_t *history,*walk_steps;
+	int *forced;					//Jump index or RHO_DOUBLE for the next step, -1 to take it from X
+	Point jump_point[RHO_NB_JUMP];
+	Int jump_a[RHO_NB_JUMP];
+	Int jump_b[RHO_NB_JUMP];
+	Int dy,_s,_p,keyfound;
+	Point *jump,next;
+	IntGroup *grp = new IntGroup(CPU_GRP_SIZE);
+	/* Saturated, -D accepts up to 63 bits and the shift would wrap to a few steps */
+	uint64_t max_steps = ((UINT64_MAX >> rho_dp_bits) < RHO_STEPS_FACTOR) ? UINT64_MAX : (uint64_t)RHO_STEPS_FACTOR << rho_dp_bits;
+	uint32_t target = 0xFFFFFFFF,current;
+	int i,j,r,k,negated,cycle,thread_number;
+
+	tt = (struct tothread *)vargp;
+	thread_number = tt->nt;
+	free(tt);
+	history = (uint64_t*) calloc(CPU_GRP_SIZE * RHO_CYCLE_LENGTH,sizeof(uint64_t));
+	checkpointer((void *)history,__FILE__,"calloc","history" ,__LINE__ -1 );
+	walk_steps = (uint64_t*) calloc(CPU_GRP_SIZE,sizeof(uint64_t));
+	checkpointer((void *)walk_steps,__FILE__,"calloc","walk_steps" ,__LINE__ -1 );
+	forced = (int*) malloc(CPU_GRP_SIZE * sizeof(int));
+	checkpointer((void *)forced,__FILE__,"malloc","forced" ,__LINE__ -1 );
+	grp->Set(dx);
+
+	do	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+		WaitForSingleObject(rho_mutex, INFINITE);
+#else
+		pthread_mutex_lock(&rho_mutex);
+#endif
+		current = rho_current;
+		if(current != target && current < rho_target_number)	{
+			for(j = 0; j < RHO_NB_JUMP; j++)	{
+				jump_point[j].Set(rho_jump_point[j]);
+				jump_a[j].Set(&rho_jump_a[j]);
+				jump_b[j].Set(&rho_jump_b[j]);
+			}
+		}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+		ReleaseMutex(rho_mutex);
+#else
+		pthread_mutex_unlock(&rho_mutex);
+#endif
+		if(current >= rho_target_number)	{
+			break;
+		}
+		if(current != target)	{
+			target = current;
+			for(i = 0; i < CPU_GRP_SIZE; i++)	{
+				rho_spawn(target,&walk[i],&a[i],&b[i]);
+				walk_steps[i] = 0;
+				forced[i] = -1;
+			}
+			memset(history,0,CPU_GRP_SIZE * RHO_CYCLE_LENGTH * sizeof(uint64_t));
+		}
+		for(i = 0; i < CPU_GRP_SIZE; i++)	{
+			if(forced[i] == RHO_DOUBLE)	{
+				dx[i].ModAdd(&walk[i].y,&walk[i].y);
+			}
+			else	{
+				j = (forced[i] < 0) ? walk[i].x.bits64[0] % RHO_NB_JUMP : forced[i];
+				dx[i].ModSub(&jump_point[j].x,&walk[i].x);
+			}
+		}
+		grp->ModInv();
+		for(i = 0; i < CPU_GRP_SIZE; i++)	{
+			if(forced[i] == RHO_DOUBLE)	{
+				_s.ModSquareK1(&walk[i].x);
+				_p.ModAdd(&_s,&_s);
+				_p.ModAdd(&_s);
+				_s.ModMulK1(&_p,&dx[i]);		// s = (3*pow2(p.x))*inverse(2*p.y)
+				_p.ModSquareK1(&_s);
+
+				next.x.ModSub(&_p,&walk[i].x);
+				next.x.ModSub(&walk[i].x);		// rx = pow2(s) - 2*p.x
+
+				dy.ModSub(&walk[i].x,&next.x);
+				dy.ModMulK1(&_s);
+				next.y.ModSub(&dy,&walk[i].y);	// ry = s*(p.x - rx) - p.y
+
+				a[i].ModAddK1order(&a[i],&a[i]);
+				b[i].ModAddK1order(&b[i],&b[i]);
+				memset(history + i*RHO_CYCLE_LENGTH,0,RHO_CYCLE_LENGTH * sizeof(uint64_t));
+				walk_steps[i] = 0;
+			}
+			else	{
+				j = (forced[i] < 0) ? walk[i].x.bits64[0] % RHO_NB_JUMP : forced[i];
+				jump = &jump_point[j];
+
+				dy.ModSub(&jump->y,&walk[i].y);
+				_s.ModMulK1(&dy,&dx[i]);		// s = (p2.y-p1.y)*inverse(p2.x-p1.x)
+				_p.ModSquareK1(&_s);			// _p = pow2(s)
+
+				next.x.ModSub(&_p,&walk[i].x);
+				next.x.ModSub(&jump->x);		// rx = pow2(s) - p1.x - p2.x
+
+				dy.ModSub(&walk[i].x,&next.x);
+				dy.ModMulK1(&_s);
+				next.y.ModSub(&dy,&walk[i].y);	// ry = s*(p1.x - rx) - p1.y
+
+				if(forced[i] < 0 && next.y.IsOdd() && (int)(next.x.bits64[0] % RHO_NB_JUMP) == j)	{
+					forced[i] = (j + 1) % RHO_NB_JUMP;
+					continue;
+				}
+				a[i].ModAddK1order(&a[i],&jump_a[j]);
+				b[i].ModAddK1order(&b[i],&jump_b[j]);
+			}
+			forced[i] = -1;
+			negated = next.y.IsOdd();
+			walk[i].x.Set(&next.x);
+			walk[i].y.Set(&next.y);
+			if(negated)	{
+				walk[i].y.ModNeg();
+				rho_negorder(&a[i]);
+				rho_negorder(&b[i]);
+			}
+
+			cycle = 0;
+			for(k = 0; k < RHO_CYCLE_LENGTH; k++)	{
+				if(history[i*RHO_CYCLE_LENGTH + k] == walk[i].x.bits64[0])	{
+					cycle = 1;
+				}
+			}
+			history[i*RHO_CYCLE_LENGTH + walk_steps[i] % RHO_CYCLE_LENGTH] = walk[i].x.bits64[0];
+			walk_steps[i]++;
+			if(cycle || walk_steps[i] > max_steps)	{
+				forced[i] = RHO_DOUBLE;
+			}
+
+			if((walk[i].x.bits64[3] & rho_dp_mask) == 0)	{
+				rho_dp_set(&dp,&walk[i],&a[i],&b[i]);
+				walk_steps[i] = 0;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+				WaitForSingleObject(rho_mutex, INFINITE);
+#else
+				pthread_mutex_lock(&rho_mutex);
+#endif
+				r = 0;
+				if(target == rho_current)	{
+					if(rho_table.count < RHO_TABLE_MAX)	{
+						r = dp_table_insert(&rho_table,&dp,&dp_found);
+					}
+					else	{
+						r = dp_table_find(&rho_table,&dp,&dp_found);
+						if(!rho_table_full)	{
+							rho_table_full = 1;
+							printf("\n[W] Rho table is full with %" PRIu64 " distinguished points, the new ones are only checked, use a bigger -D\n",rho_table.count);
+						}
+					}
+				}
+#if defined(_WIN64) && !defined(__CYGWIN__)
+				ReleaseMutex(rho_mutex);
+#else
+				pthread_mutex_unlock(&rho_mutex);
+#endif
+				if(r)	{
+					if(rho_solve(&rho_targets[target],&dp,&dp_found,&keyfound))	{
+						writekey(rho_targets_compressed[target],&keyfound);
+						rho_nexttarget(target);
+					}
+					else	{
+						rho_spawn(target,&walk[i],&a[i],&b[i]);
+						forced[i] = -1;
+					}
+				}
+			}
+		}
+		steps[thread_number]++;
+	}while(1);
+	free(history);
+	free(walk_steps);
+	free(forced);
+	delete grp;
+	delete[] walk;
+	delete[] a;
+	delete[] b;
+	ends[thread_number] = 1;
+	return NULL;
+}
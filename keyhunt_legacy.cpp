@@ -16,6 +16,8 @@ email: albertobsd@gmail.com
 #include "bloom/bloom.h"
 #include "util.h"
 #include "hashing.h"
+#include "sha3/keccak_batch.h"
+#include "bech32/bech32.h"
 
 #include "gmp256k1/GMP256K1.h"
 #include "gmp256k1/Point.h"
@@ -31,6 +33,9 @@ email: albertobsd@gmail.com
 #include <unistd.h>
 #include <pthread.h>
 #include <sys/random.h>
+#include <sys/stat.h>
+#include <sys/mman.h>
+#include <fcntl.h>
 #ifdef __APPLE__
 #include <sys/qos.h>
 #endif
@@ -60,6 +65,12 @@ email: albertobsd@gmail.com
 #define SEARCH_COMPRESS 1
 #define SEARCH_BOTH 2
 
+
+#define ADDRESS_PREFETCH 4			//Slots of 4 keys between the prefetch and the check of the bloom filters
+#define BLOOM_ADDRESS_MAGIC "bloom256"		//First 8 bytes of the data_ files with 256 bloom filters
+#define TARGETS_P2SH 1		//Kinds of targets saved at the end of the data_ files
+#define TARGETS_BECH32 2
+
 uint32_t  THREADBPWORKLOAD = 1048576;
 
 struct checksumsha256	{
@@ -76,12 +87,39 @@ struct address_value	{
 	uint8_t value[20];
 };
 
+#define XPOINT_BUCKET_SLOTS 15		/* Fingerprints of a bucket of the xpoint index, 64 bytes with the count */
+#define XPOINT_BUCKET_LOAD 8		/* Targets per bucket at most on average */
+#define XPOINT_BUCKET_FULL 0xFFFFFFFF		/* Count of a bucket with more targets than slots */
+
+struct xpoint_bucket	{
+	uint32_t fingerprint[XPOINT_BUCKET_SLOTS];
+	uint32_t count;
+};
+
 struct tothread {
 	int nt;     //Number thread
 	char *rs;   //range start
 	char *rpt;  //rng per thread
 };
 
+#define TARGET_LOAD_COUNT 0
+#define TARGET_LOAD_PARSE 1
+#define TARGET_LOAD_SCATTER 2
+#define TARGET_LOAD_SORT 3
+
+struct target_load	{
+	int threadid;
+	int finished;
+	uint64_t from,to;				/* Bytes of the file for this thread, from the start of a line */
+	uint64_t lines;					/* Lines of the chunk */
+	uint64_t start;					/* First item of this thread in target_load_parsed */
+	uint64_t count;					/* Valid items parsed */
+	uint64_t parsed;				/* Bytes parsed, for the progress */
+	uint64_t histogram[256];		/* Items by first byte */
+	uint64_t position[256];			/* Next position in addressTable of the items of every first byte */
+	int byte_from,byte_to;			/* First bytes sorted by this thread */
+};
+
 struct bPload	{
 	uint32_t threadid;
 	uint64_t from;
@@ -134,8 +172,19 @@ Point _2GSn;
 
 void menu();
 void init_generator();
+void bsgs_setfound(uint32_t k_index);
+void subtract_generate(Point &base,uint64_t count,int (*callback)(uint64_t i,Point &target,void *arg),void *arg);
+int subtract_store_bsgs(uint64_t i,Point &target,void *arg);
+int subtract_store_xpoint(uint64_t i,Point &target,void *arg);
+int subtract_find(uint64_t i,Point &target,void *arg);
+bool subtract_load_xpoint(char *fileName);
+void subtract_xpoint_resolve(Int *privatekey);
+void subtract_bsgs_resolve(uint32_t k_index,Int *privatekey);
 
 int searchbinary(struct address_value *buffer,char *data,int64_t array_length);
+int searchaddress(char *data);
+void address_index_build();
+void xpoint_index_build();
 void sleep_ms(int milliseconds);
 
 void _sort(struct address_value *arr,int64_t N);
@@ -156,18 +205,25 @@ int64_t bsgs_partition(struct bsgs_xvalue *arr, int64_t n);
 
 int bsgs_searchbinary(struct bsgs_xvalue *arr,char *data,int64_t array_length,uint64_t *r_value);
 int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey);
-int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey);
+int bsgs_secondcheck_point(Int *start_range,uint32_t a,Point *target,Int *privatekey);
+int bsgs_thirdcheck(Int *start_range,uint32_t a,Point *target,Int *privatekey);
+int bsgs_endomorphism_check(Int *start_range,uint32_t a,uint32_t k_index,Int *x,Int *privatekey);
 
 void sha256sse_22(uint8_t *src0, uint8_t *src1, uint8_t *src2, uint8_t *src3, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2, uint8_t *dst3);
 void sha256sse_23(uint8_t *src0, uint8_t *src1, uint8_t *src2, uint8_t *src3, uint8_t *dst0, uint8_t *dst1, uint8_t *dst2, uint8_t *dst3);
 
 bool vanityrmdmatch(unsigned char *rmdhash);
 void writevanitykey(bool compress,Int *key);
+void writevanitykey_point(bool compressed,Int *key,Point &publickey);
 int addvanity(char *target);
 int minimum_same_bytes(unsigned char* A,unsigned char* B, int length);
 
 void writekey(bool compressed,Int *key);
+void writekey_point(bool compressed,Int *key,Point &publickey);
 void writekeyeth(Int *key);
+void writekeyeth_point(Int *key,Point &publickey);
+void group_hit_point(Point *pts,Point &center,int i,bool calculate_y,Point *publickey);
+void hit_resolve(Int *key,Point *publickey,int variant,int negated);
 
 void checkpointer(void *ptr,const char *file,const char *function,const  char *name,int line);
 
@@ -179,9 +235,17 @@ bool readFileVanity(char *fileName);
 bool forceReadFileAddress(char *fileName);
 bool forceReadFileAddressEth(char *fileName);
 bool forceReadFileXPoint(char *fileName);
+bool readFileTargets(char *fileName,int (*parse)(char *line,uint8_t *value));
+bool target_file_map(char *fileName,char **data,uint64_t *size);
+void target_file_unmap(char *data,uint64_t size);
+int parse_target_address(char *line,uint8_t *value);
+int parse_target_eth(char *line,uint8_t *value);
+int parse_target_xpoint(char *line,uint8_t *value);
 bool processOneVanity();
 
 bool initBloomFilter(struct bloom *bloom_arg,uint64_t items_bloom);
+bool initBloomAddress(uint64_t items_bloom);
+void address_prefetch(uint64_t j,Point *pts,Point *beta,Point *beta2,char (*group_endomorphism)[12][4][20],char (*group_uncompress)[4][20],char (*group_p2sh)[6][4][20]);
 
 void writeFileIfNeeded(const char *fileName);
 
@@ -198,6 +262,7 @@ DWORD WINAPI thread_process_bsgs_random(LPVOID vargp);
 DWORD WINAPI thread_process_bsgs_dance(LPVOID vargp);
 DWORD WINAPI thread_bPload(LPVOID vargp);
 DWORD WINAPI thread_bPload_2blooms(LPVOID vargp);
+DWORD WINAPI thread_target_load(LPVOID vargp);
 DWORD WINAPI thread_pub2rmd(LPVOID vargp);
 #else
 void *thread_process_vanity(void *vargp);
@@ -210,18 +275,21 @@ void *thread_process_bsgs_random(void *vargp);
 void *thread_process_bsgs_dance(void *vargp);
 void *thread_bPload(void *vargp);
 void *thread_bPload_2blooms(void *vargp);
+void *thread_target_load(void *vargp);
 void *thread_pub2rmd(void *vargp);
 #endif
 
 char *pubkeytopubaddress(char *pkey,int length);
 void pubkeytopubaddress_dst(char *pkey,int length,char *dst);
 void rmd160toaddress_dst(char *rmd,char *dst);
+void hash160toaddress_dst(uint8_t version,char *rmd,char *dst);
 void set_minikey(char *buffer,char *rawbuffer,int length);
 bool increment_minikey_index(char *buffer,char *rawbuffer,int index);
 void increment_minikey_N(char *rawbuffer);
 	
 
 void generate_binaddress_eth(Point &publickey,unsigned char *dst_address);
+void generate_binaddress_eth_group(Point *pts,Point *beta,Point *beta2,int count,unsigned char *bin_publickeys,unsigned char *dst_addresses);
 
 int THREADOUTPUT = 0;
 char *bit_range_str_min;
@@ -265,11 +333,24 @@ int vanity_rmd_minimun_bytes_check_length = 999999;
 char **vanity_address_targets = NULL;
 struct bloom *vanity_bloom = NULL;
 
-struct bloom bloom;
+struct bloom *bloom_address = NULL;		/* 256 bloom filters of the targets, the first byte of the value selects one */
+
+struct target_load *target_load_threads = NULL;		/* Threads of readFileTargets */
+int target_load_phase;
+char *target_load_data = NULL;
+struct address_value *target_load_parsed = NULL;
+uint64_t target_load_bucket[257];		/* First item of every first byte in addressTable */
+uint64_t target_load_count[256];		/* Items of every first byte without duplicates */
+int (*target_load_parse)(char *line,uint8_t *value) = NULL;
 
 uint64_t *steps = NULL;
 unsigned int *ends = NULL;
 uint64_t N = 0;
+uint32_t *address_index = NULL;		/* Bucket index of addressTable, see address_index_build */
+uint32_t address_index_bits = 0;
+struct xpoint_bucket *xpoint_index = NULL;		/* Fingerprint index of the xpoint targets, see xpoint_index_build */
+void *xpoint_index_raw = NULL;		/* Allocation of xpoint_index before the alignment to 64 bytes */
+uint32_t xpoint_index_bits = 0;
 
 uint64_t N_SEQUENTIAL_MAX = 0x100000000;
 uint64_t DEBUGCOUNT = 0x400;
@@ -300,7 +381,12 @@ int FLAGUPDATEFILE1 = 0;
 
 
 int FLAGSTRIDE = 0;
+int FLAGSUBTRACT = 0;		/* -x count:spacing, the targets are Q - i*spacing*G from one publickey Q, see subtract_generate */
 int FLAGSEARCH = 2;
+int FLAGCOMPRESSPARITY = 0;		/* -P, -l compress calculates Y and hashes only the prefix of its parity */
+int ADDRESS_COMPRESS_END = 2;		/* Compressed hashes of thread_process in group_endomorphism[j][l], l from 0 to ADDRESS_COMPRESS_END */
+int FLAGP2SH = 0;		/* Some target is a P2SH address, the compressed keys are also hashed as P2SH-P2WPKH */
+int FLAGBECH32 = 0;		/* Some target is a bc1q address, it is the same hash160 of the compressed key */
 int FLAGBITRANGE = 0;
 int FLAGRANGE = 0;
 int FLAGFILE = 0;
@@ -317,6 +403,11 @@ char *range_start;
 char *range_end;
 char *str_stride;
 Int stride;
+char *str_subtract;
+uint64_t subtract_count;
+Int subtract_spacing;
+Point subtract_base;
+bool subtract_compressed;
 
 uint64_t BSGS_XVALUE_RAM = 6;
 uint64_t BSGS_BUFFERXPOINTLENGTH = 32;
@@ -492,7 +583,7 @@ int main(int argc, char **argv)	{
 	
 	printf("[+] Version %s, developed by AlbertoBSD\n",version);
 
-	while ((c = getopt(argc, argv, "deh6MqRSB:b:c:C:E:f:I:k:l:m:N:n:p:r:s:t:v:G:8:z:")) != -1) {
+	while ((c = getopt(argc, argv, "deh6MPqRSB:b:c:C:E:f:I:k:l:m:N:n:p:r:s:t:v:G:8:x:z:")) != -1) {
 		switch(c) {
 			case 'h':
 				menu();
@@ -671,6 +762,9 @@ int main(int argc, char **argv)	{
 				FLAG_N = 1;
 				str_N = optarg;
 			break;
+			case 'P':
+				FLAGCOMPRESSPARITY = 1;
+			break;
 			case 'q':
 				FLAGQUIET	= 1;
 				printf("[+] Quiet thread output\n");
@@ -768,6 +862,10 @@ int main(int argc, char **argv)	{
 					exit(EXIT_FAILURE);
 				}
 			break;
+			case 'x':
+				FLAGSUBTRACT = 1;
+				str_subtract = optarg;
+			break;
 			case 'z':
 				FLAGBLOOMMULTIPLIER= strtol(optarg,NULL,10);
 				if(FLAGBLOOMMULTIPLIER <= 0)	{
@@ -782,11 +880,6 @@ int main(int argc, char **argv)	{
 		}
 	}
 	//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
-	if(  FLAGBSGSMODE == MODE_BSGS && FLAGENDOMORPHISM)	{
-		fprintf(stderr,"[E] Endomorphism doesn't work with BSGS\n");
-		exit(EXIT_FAILURE);
-	}
-	
 	//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
 	if( ( FLAGBSGSMODE == MODE_BSGS || FLAGBSGSMODE == MODE_PUB2RMD ) && FLAGSTRIDE)	{
 		fprintf(stderr,"[E] Stride doesn't work with BSGS, pub2rmd\n");
@@ -805,11 +898,39 @@ int main(int argc, char **argv)	{
 		FLAGSTRIDE = 1;
 		stride.Set(&ONE);
 	}
+	if(FLAGSUBTRACT)	{
+		if(FLAGMODE != MODE_BSGS && FLAGMODE != MODE_XPOINT)	{
+			fprintf(stderr,"[E] -x only works with bsgs and xpoint modes\n");
+			exit(EXIT_FAILURE);
+		}
+		subtract_count = strtoull(str_subtract,NULL,10);
+		hextemp = strchr(str_subtract,':');
+		if(hextemp == NULL)	{
+			subtract_spacing.SetInt32(1);
+		}
+		else if(hextemp[1] == '0' && hextemp[2] == 'x')	{
+			subtract_spacing.SetBase16(hextemp+3);
+		}
+		else	{
+			subtract_spacing.SetBase10(hextemp+1);
+		}
+		/* bsgs_point_number is 32 bits */
+		if(subtract_count == 0 || subtract_count > 0xFFFFFFFF || subtract_spacing.IsZero())	{
+			fprintf(stderr,"[E] -x count:spacing, count from 1 to %u and spacing not zero\n",0xFFFFFFFF);
+			exit(EXIT_FAILURE);
+		}
+		hextemp = subtract_spacing.GetBase10();
+		printf("[+] Subtract : %" PRIu64 " targets Q - i*%s*G\n",subtract_count,hextemp);
+		free(hextemp);
+	}
 	//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
 	init_generator();
 	//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
 	if(FLAGMODE == MODE_BSGS )	{
 		printf("[+] Mode BSGS %s\n",bsgs_modes[FLAGBSGSMODE]);
+		if(FLAGENDOMORPHISM)	{
+			fprintf(stderr,"[W] -e with bsgs is a lottery over the whole group, it only finds keys out of the range and the search is slower\n");
+		}
 	}
 	
 	if(FLAGFILE == 0) {
@@ -947,7 +1068,7 @@ int main(int argc, char **argv)	{
 			case MODE_RMD160:
 			case MODE_ADDRESS:
 			case MODE_XPOINT:
-				if(!readFileAddress(fileName))	{
+				if(FLAGSUBTRACT ? !subtract_load_xpoint(fileName) : !readFileAddress(fileName))	{
 					fprintf(stderr,"[E] Unenexpected error\n");
 					exit(EXIT_FAILURE);
 				}
@@ -961,11 +1082,28 @@ int main(int argc, char **argv)	{
 		}
 		//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
 		if(FLAGMODE != MODE_VANITY && !FLAGREADEDFILE1)	{
-			printf("[+] Sorting data ...");
-			_sort(addressTable,N);
-			printf(" done! %" PRIu64 " values were loaded and sorted\n",N);
+			address_index_build();
 			writeFileIfNeeded(fileName);
 		}
+		if(FLAGMODE == MODE_ADDRESS || FLAGMODE == MODE_RMD160)	{
+			if(FLAGSEARCH == SEARCH_UNCOMPRESS && (FLAGP2SH || FLAGBECH32))	{
+				fprintf(stderr,"[W] The P2SH and bc1q targets are only of compressed keys, they are not searched with -l uncompress\n");
+			}
+			else if(FLAGP2SH)	{
+				printf("[+] P2SH targets, the compressed keys are also checked as P2SH-P2WPKH\n");
+			}
+			if(FLAGCOMPRESSPARITY)	{
+				/* With -e the other prefix is also the negated key of lambda*k and lambda^2*k, both prefixes are needed */
+				if(FLAGSEARCH != SEARCH_COMPRESS || FLAGCRYPTO != CRYPTO_BTC || FLAGENDOMORPHISM)	{
+					fprintf(stderr,"[W] -P is only for -l compress without -e, ignored\n");
+					FLAGCOMPRESSPARITY = 0;
+				}
+				else	{
+					printf("[+] Compressed keys: parity of Y, one hash per X, the negated keys n - k are not checked\n");
+				}
+			}
+			ADDRESS_COMPRESS_END = FLAGENDOMORPHISM ? 6 : ((FLAGCOMPRESSPARITY || FLAGSEARCH == SEARCH_BOTH) ? 1 : 2);
+		}
 	}
 	//if(FLAGDEBUG) { printf("[D] File: %s Line %i\n",__FILE__,__LINE__); fflush(stdout); }
 	if(FLAGMODE == MODE_BSGS )	{
@@ -1050,6 +1188,29 @@ int main(int argc, char **argv)	{
 			fprintf(stderr,"[E] The file don't have any valid publickeys\n");
 			exit(EXIT_FAILURE);
 		}
+		if(FLAGSUBTRACT)	{
+			/* The only publickey Q is replaced by the targets Q - i*spacing*G, see subtract_bsgs_resolve */
+			if(N != 1)	{
+				fprintf(stderr,"[E] -x needs only one publickey in the file\n");
+				exit(EXIT_FAILURE);
+			}
+			subtract_base.Set(OriginalPointsBSGS[0]);
+			subtract_compressed = OriginalPointsBSGScompressed[0];
+			N = subtract_count;
+			free(bsgs_found);
+			bsgs_found = (int*) calloc(N,sizeof(int));
+			checkpointer((void *)bsgs_found,__FILE__,"calloc","bsgs_found" ,__LINE__ -1 );
+			free(OriginalPointsBSGScompressed);
+			OriginalPointsBSGScompressed = (bool*) malloc(N*sizeof(bool));
+			checkpointer((void *)OriginalPointsBSGScompressed,__FILE__,"malloc","OriginalPointsBSGScompressed" ,__LINE__ -1 );
+			OriginalPointsBSGS.resize(N,secp->G);
+			subtract_generate(subtract_base,N,subtract_store_bsgs,NULL);
+			bsgs_point_number = N;
+			printf("[+] Subtract: searching %u points\n",bsgs_point_number);
+		}
+		if(FLAGENDOMORPHISM)	{
+			printf("[+] Endomorphism: beta*X and beta^2*X of every giant step are also checked\n");
+		}
 		BSGS_N.SetInt32(0);
 		BSGS_M.SetInt32(0);
 		
@@ -2194,7 +2355,7 @@ int main(int argc, char **argv)	{
 					i++;
 				}
 				
-				if(FLAGENDOMORPHISM)	{
+				if(FLAGENDOMORPHISM && FLAGMODE != MODE_BSGS)	{
 					if(FLAGMODE == MODE_XPOINT)	{
 						total.Mult(3);
 					}
@@ -2203,7 +2364,7 @@ int main(int argc, char **argv)	{
 					}
 				}
 				else	{
-					if(FLAGSEARCH == SEARCH_COMPRESS)	{
+					if(FLAGSEARCH == SEARCH_COMPRESS && !FLAGCOMPRESSPARITY)	{
 						total.Mult(2);
 					}
 				}
@@ -2293,9 +2454,16 @@ void pubkeytopubaddress_dst(char *pkey,int length,char *dst)	{
 }
 
 void rmd160toaddress_dst(char *rmd,char *dst){
+	hash160toaddress_dst(byte_encode_crypto,rmd,dst);
+}
+
+/*
+	Base58check of a hash160 with any version byte, 0x05 for the P2SH addresses
+*/
+void hash160toaddress_dst(uint8_t version,char *rmd,char *dst){
 	char digest[60];
 	size_t pubaddress_size = 40;
-	digest[0] = byte_encode_crypto;
+	digest[0] = version;
 	memcpy(digest+1,rmd,20);
 	sha256((uint8_t*)digest, 21,(uint8_t*) digest+21);
 	sha256((uint8_t*)digest+21, 32,(uint8_t*) digest+21);
@@ -2355,6 +2523,165 @@ int searchbinary(struct address_value *buffer,char *data,int64_t array_length) {
 	return r;
 }
 
+/* Bucket index of the sorted addressTable, see address_index_fill */
+void address_index_build()	{
+	free(address_index);
+	address_index = NULL;
+	address_index_bits = address_index_size_bits(N);
+	if(address_index_bits == 0)	{
+		return;		/* searchaddress uses searchbinary */
+	}
+	address_index = (uint32_t*) malloc(((1ULL << address_index_bits) + 1) * sizeof(uint32_t));
+	checkpointer((void *)address_index,__FILE__,"malloc","address_index" ,__LINE__ -1 );
+	address_index_fill(address_index,address_index_bits,(uint8_t*)addressTable,N);
+	if(FLAGMODE == MODE_XPOINT)	{
+		xpoint_index_build();
+	}
+}
+
+int searchaddress(char *data)	{
+	if(address_index == NULL)	{
+		return searchbinary(addressTable,data,N);
+	}
+	return address_index_search(address_index,address_index_bits,(uint8_t*)addressTable,data);
+}
+
+static inline int bloom_address_check(const void *data,int len)	{
+	return bloom_check(&bloom_address[((const uint8_t*)data)[0]],data,len);
+}
+
+static inline int bloom_address_add(const void *data,int len)	{
+	return bloom_add(&bloom_address[((const uint8_t*)data)[0]],data,len);
+}
+
+/*
+	Fingerprint index of the xpoint targets. X is already uniform, so its first xpoint_index_bits bits select a bucket
+	of one cache line without any hash, and the bucket has the next 32 bits of X of its targets in sorted order.
+	A generated X is checked against all the targets with one memory access that address_prefetch already requested,
+	so the cost does not grow with the count of targets. Full buckets are left to searchaddress
+*/
+void xpoint_index_build()	{
+	uint64_t i,buckets,prefix;
+	struct xpoint_bucket *b;
+	free(xpoint_index_raw);
+	xpoint_index_raw = NULL;
+	xpoint_index = NULL;
+	xpoint_index_bits = 0;
+	if(N == 0)	{
+		return;
+	}
+	while(xpoint_index_bits < 40 && (N >> xpoint_index_bits) > XPOINT_BUCKET_LOAD)	{
+		xpoint_index_bits++;
+	}
+	buckets = 1ULL << xpoint_index_bits;
+	xpoint_index_raw = calloc(buckets * sizeof(struct xpoint_bucket) + 63,1);
+	checkpointer((void *)xpoint_index_raw,__FILE__,"calloc","xpoint_index_raw" ,__LINE__ -1 );
+	xpoint_index = (struct xpoint_bucket *)(((uintptr_t)xpoint_index_raw + 63) & ~(uintptr_t)63);
+	for(i = 0; i < N; i++)	{
+		prefix = address_prefix((char*)addressTable[i].value);
+		b = &xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0];
+		if(b->count < XPOINT_BUCKET_SLOTS)	{
+			b->fingerprint[b->count++] = (uint32_t)((prefix << xpoint_index_bits) >> 32);
+		}
+		else	{
+			b->count = XPOINT_BUCKET_FULL;
+		}
+	}
+	printf("[+] X fingerprint index: %" PRIu64 " buckets, %.2f MB\n",buckets,(double)(buckets * sizeof(struct xpoint_bucket)) / 1048576);
+}
+
+/*
+	Filter of the xpoint mode in place of the bloom filter, a match is confirmed by searchaddress
+*/
+static inline int xpoint_check(const char *data)	{
+	uint64_t prefix;
+	uint32_t i,fingerprint;
+	const struct xpoint_bucket *b;
+	if(xpoint_index == NULL)	{
+		return bloom_address_check(data,MAXLENGTHADDRESS);
+	}
+	prefix = address_prefix(data);
+	b = &xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0];
+	if(b->count == XPOINT_BUCKET_FULL)	{
+		return 1;
+	}
+	fingerprint = (uint32_t)((prefix << xpoint_index_bits) >> 32);
+	for(i = 0; i < b->count; i++)	{
+		if(b->fingerprint[i] >= fingerprint)	{
+			return b->fingerprint[i] == fingerprint;
+		}
+	}
+	return 0;
+}
+
+static inline void xpoint_prefetch(const char *data)	{
+	uint64_t prefix;
+	if(xpoint_index == NULL)	{
+		bloom_prefetch(&bloom_address[(uint8_t)data[0]],data,MAXLENGTHADDRESS);
+		return;
+	}
+	prefix = address_prefix(data);
+	__builtin_prefetch(&xpoint_index[xpoint_index_bits ? prefix >> (64 - xpoint_index_bits) : 0],0,1);
+}
+
+/*
+	Start the bloom filter reads of the 4 keys of the slot j of the group. thread_process checks the slot j
+	ADDRESS_PREFETCH slots after this, so the memory reads of several keys are waited at the same time
+	instead of one DRAM miss per key
+*/
+void address_prefetch(uint64_t j,Point *pts,Point *beta,Point *beta2,char (*group_endomorphism)[12][4][20],char (*group_uncompress)[4][20],char (*group_p2sh)[6][4][20])	{
+	char rawvalue[32];
+	int k,l;
+	switch(FLAGMODE)	{
+		case MODE_RMD160:
+		case MODE_ADDRESS:
+			for(k = 0; k < 4; k++)	{
+				if(FLAGCRYPTO == CRYPTO_ETH)	{
+					if(FLAGENDOMORPHISM)	{
+						for(l = 0; l < 6; l++)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+					else	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_uncompress[j][k][0]],group_uncompress[j][k],MAXLENGTHADDRESS);
+					}
+					continue;
+				}
+				if(FLAGSEARCH == SEARCH_COMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
+					for(l = 0; l < ADDRESS_COMPRESS_END; l++)	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						if(group_p2sh != NULL)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_p2sh[j][l][k][0]],group_p2sh[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+				}
+				if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
+					if(FLAGENDOMORPHISM)	{
+						for(l = 6; l < 12; l++)	{
+							bloom_prefetch(&bloom_address[(uint8_t)group_endomorphism[j][l][k][0]],group_endomorphism[j][l][k],MAXLENGTHADDRESS);
+						}
+					}
+					else	{
+						bloom_prefetch(&bloom_address[(uint8_t)group_uncompress[j][k][0]],group_uncompress[j][k],MAXLENGTHADDRESS);
+					}
+				}
+			}
+		break;
+		case MODE_XPOINT:
+			for(k = 0; k < 4; k++)	{
+				pts[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+				xpoint_prefetch(rawvalue);
+				if(FLAGENDOMORPHISM)	{
+					beta[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+					xpoint_prefetch(rawvalue);
+					beta2[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
+					xpoint_prefetch(rawvalue);
+				}
+			}
+		break;
+	}
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_process_minikeys(LPVOID vargp) {
 #else
@@ -2489,9 +2816,9 @@ void *thread_process_minikeys(void *vargp)	{
 					secp->GetHash160(P2PKH,false,publickey[0],publickey[1],publickey[2],publickey[3],(uint8_t*)publickeyhashrmd160_uncompress[0],(uint8_t*)publickeyhashrmd160_uncompress[1],(uint8_t*)publickeyhashrmd160_uncompress[2],(uint8_t*)publickeyhashrmd160_uncompress[3]);
 					
 					for(k = 0; k < 4; k++)	{
-						r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],20);
+						r = bloom_address_check(publickeyhashrmd160_uncompress[k],20);
 						if(r) {
-							r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+							r = searchaddress(publickeyhashrmd160_uncompress[k]);
 							if(r) {
 								/* hit */
 								hextemp = key_mpz[k].GetBase16();
@@ -2548,32 +2875,44 @@ void *thread_process(void *vargp)	{
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
-	Point startP;
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
-	Point pp;
-	Point pn;
-	int l,pp_offset,pn_offset;
-	int i,hLength = (CPU_GRP_SIZE / 2 - 1);
+	Point startP,groupcenter;
+	int l;
+	int i;
 	uint64_t j,count;
 	Point R,temporal,publickey;
 	int r,thread_number,continue_flag = 1,k;
 	char *hextemp = NULL;
 	
-	char publickeyhashrmd160[20];
-	char publickeyhashrmd160_uncompress[4][20];
+	char (*publickeyhashrmd160_uncompress)[20];		/* Slot j of group_uncompress */
 	char rawvalue[32];
 	
-	char publickeyhashrmd160_endomorphism[12][4][20];
+	char (*publickeyhashrmd160_endomorphism)[4][20];		/* Slot j of group_endomorphism */
+	char (*group_uncompress)[4][20],(*group_endomorphism)[12][4][20];		/* Hashes of the whole group, 4 keys per slot */
+	char (*group_p2sh)[6][4][20] = NULL;		/* Script hashes of the compressed hashes, only with P2SH targets */
+	unsigned char *eth_publickeys = NULL,*eth_addresses = NULL;
 	
-	bool calculate_y = FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH;
+	bool calculate_y = FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH || FLAGCOMPRESSPARITY;
+	bool compress_prefixes = !FLAGCOMPRESSPARITY && (FLAGENDOMORPHISM || FLAGSEARCH != SEARCH_BOTH);		/* Compressed hashes of the prefixes 02 and 03 of X, else only the prefix of Y */
 	Int key_mpz,keyfound,temp_stride;
 	tt = (struct tothread *)vargp;
 	thread_number = tt->nt;
 	free(tt);
 	grp->Set(dx);
+	group_uncompress = (char (*)[4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_uncompress));
+	checkpointer((void *)group_uncompress,__FILE__,"malloc","group_uncompress" ,__LINE__ -1 );
+	group_endomorphism = (char (*)[12][4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_endomorphism));
+	checkpointer((void *)group_endomorphism,__FILE__,"malloc","group_endomorphism" ,__LINE__ -1 );
+	if(FLAGP2SH && FLAGCRYPTO == CRYPTO_BTC && FLAGSEARCH != SEARCH_UNCOMPRESS)	{
+		group_p2sh = (char (*)[6][4][20]) malloc(CPU_GRP_SIZE/4 * sizeof(*group_p2sh));
+		checkpointer((void *)group_p2sh,__FILE__,"malloc","group_p2sh" ,__LINE__ -1 );
+	}
+	if(FLAGCRYPTO == CRYPTO_ETH)	{
+		/* The Keccak of the whole group is done at once, 6 addresses per point with endomorphism */
+		eth_publickeys = (unsigned char*) malloc(6 * CPU_GRP_SIZE * 64);
+		checkpointer((void *)eth_publickeys,__FILE__,"malloc","eth_publickeys" ,__LINE__ -1 );
+		eth_addresses = (unsigned char*) malloc(6 * CPU_GRP_SIZE * 20);
+		checkpointer((void *)eth_addresses,__FILE__,"malloc","eth_addresses" ,__LINE__ -1 );
+	}
 
 	do {
 		if(FLAGRANDOM){
@@ -2614,135 +2953,40 @@ void *thread_process(void *vargp)	{
 					THREADOUTPUT = 1;
 				}
 			}
+			temp_stride.SetInt32(CPU_GRP_SIZE / 2);
+			temp_stride.Mult(&stride);
+			key_mpz.Add(&temp_stride);
+			startP = secp->ComputePublicKey(&key_mpz);
+			key_mpz.Sub(&temp_stride);
 			do {
-				temp_stride.SetInt32(CPU_GRP_SIZE / 2);
-				temp_stride.Mult(&stride);
-				key_mpz.Add(&temp_stride);
-	 			startP = secp->ComputePublicKey(&key_mpz);
-				key_mpz.Sub(&temp_stride);
-
-				for(i = 0; i < hLength; i++) {
-					dx[i].ModSub(&Gn[i].x,&startP.x);
-				}
-			
-				dx[i].ModSub(&Gn[i].x,&startP.x);  // For the first point
-				dx[i + 1].ModSub(&_2Gn.x,&startP.x); // For the next center point
-				grp->ModInv();
-
-				pts[CPU_GRP_SIZE / 2] = startP;
-
-				for(i = 0; i<hLength; i++) {
-					pp = startP;
-					pn = startP;
-
-					// P = startP + i*G
-					dy.ModSub(&Gn[i].y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-					if(calculate_y)	{
-						pp.y.ModSub(&Gn[i].x,&pp.x);
-						pp.y.ModMulK1(&_s);
-						pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-					dyn.Set(&Gn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-					if(calculate_y)	{
-						pn.y.ModSub(&Gn[i].x,&pn.x);
-						pn.y.ModMulK1(&_s);
-						pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					pp_offset = CPU_GRP_SIZE / 2 + (i + 1);
-					pn_offset = CPU_GRP_SIZE / 2 - (i + 1);
-
-					pts[pp_offset] = pp;
-					pts[pn_offset] = pn;
-					
-					if(FLAGENDOMORPHISM)	{
-						/*
-							Q = (x,y)
-							For any point Q
-							Q*lambda = (x*beta mod p ,y)
-							Q*lambda is a Scalar Multiplication
-							x*beta is just a Multiplication (Very fast)
-						*/
-						
-						if( calculate_y  )	{
-							endomorphism_beta[pp_offset].y.Set(&pp.y);
-							endomorphism_beta[pn_offset].y.Set(&pn.y);
-							endomorphism_beta2[pp_offset].y.Set(&pp.y);
-							endomorphism_beta2[pn_offset].y.Set(&pn.y);
-						}
-						endomorphism_beta[pp_offset].x.ModMulK1(&pp.x, &beta);
-						endomorphism_beta[pn_offset].x.ModMulK1(&pn.x, &beta);
-						endomorphism_beta2[pp_offset].x.ModMulK1(&pp.x, &beta2);
-						endomorphism_beta2[pn_offset].x.ModMulK1(&pn.x, &beta2);
-					}
-				}
-				/*
-					Half point for endomorphism because pts[CPU_GRP_SIZE / 2] was not calcualte in the previous cycle
-				*/
+				/* The center moves CPU_GRP_SIZE*stride every round, AddDirectBatch updates it */
+				groupcenter.Set(startP);		/* Center of this group for group_hit_point */
+				secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,calculate_y,grp,dx);
 				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-
-						endomorphism_beta[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
-						endomorphism_beta2[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
+					/*
+						Q = (x,y)
+						For any point Q
+						Q*lambda = (x*beta mod p ,y)
+						Q*lambda is a Scalar Multiplication
+						x*beta is just a Multiplication (Very fast)
+					*/
+					for(i = 0; i < CPU_GRP_SIZE; i++)	{
+						if(calculate_y)	{
+							endomorphism_beta[i].y.Set(&pts[i].y);
+							endomorphism_beta2[i].y.Set(&pts[i].y);
+						}
+						endomorphism_beta[i].x.ModMulK1(&pts[i].x, &beta);
+						endomorphism_beta2[i].x.ModMulK1(&pts[i].x, &beta2);
 					}
-					endomorphism_beta[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta);
-					endomorphism_beta2[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta2);
 				}
-
-				// First point (startP - (GRP_SZIE/2)*G)
-				pn = startP;
-				dyn.Set(&Gn[i].y);
-				dyn.ModNeg();
-				dyn.ModSub(&pn.y);
-
-				_s.ModMulK1(&dyn,&dx[i]);
-				_p.ModSquareK1(&_s);
-
-				pn.x.ModNeg();
-				pn.x.ModAdd(&_p);
-				pn.x.ModSub(&Gn[i].x);
 				
-				if(calculate_y)	{
-					pn.y.ModSub(&Gn[i].x,&pn.x);
-					pn.y.ModMulK1(&_s);
-					pn.y.ModAdd(&Gn[i].y);
-				}
-
-				pts[0] = pn;
 				
-				/*
-					First point for endomorphism because pts[0] was not calcualte previously
-				*/
-				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-						endomorphism_beta[0].y.Set(&pn.y);
-						endomorphism_beta2[0].y.Set(&pn.y);
-					}
-					endomorphism_beta[0].x.ModMulK1(&pn.x, &beta);
-					endomorphism_beta2[0].x.ModMulK1(&pn.x, &beta2);
+				if(FLAGCRYPTO == CRYPTO_ETH && (FLAGMODE == MODE_ADDRESS || FLAGMODE == MODE_RMD160))	{
+					generate_binaddress_eth_group(pts,FLAGENDOMORPHISM ? endomorphism_beta : NULL,endomorphism_beta2,CPU_GRP_SIZE,eth_publickeys,eth_addresses);
 				}
-				
-				
 				for(j = 0; j < CPU_GRP_SIZE/4;j++){
+					publickeyhashrmd160_uncompress = group_uncompress[j];
+					publickeyhashrmd160_endomorphism = group_endomorphism[j];
 					switch(FLAGMODE)	{
 						case MODE_RMD160:
 						case MODE_ADDRESS:
@@ -2759,11 +3003,23 @@ void *thread_process(void *vargp)	{
 										secp->GetHash160_fromX(P2PKH,0x02,&endomorphism_beta2[(j*4)].x,&endomorphism_beta2[(j*4)+1].x,&endomorphism_beta2[(j*4)+2].x,&endomorphism_beta2[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[4][0],(uint8_t*)publickeyhashrmd160_endomorphism[4][1],(uint8_t*)publickeyhashrmd160_endomorphism[4][2],(uint8_t*)publickeyhashrmd160_endomorphism[4][3]);
 										secp->GetHash160_fromX(P2PKH,0x03,&endomorphism_beta2[(j*4)].x,&endomorphism_beta2[(j*4)+1].x,&endomorphism_beta2[(j*4)+2].x,&endomorphism_beta2[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[5][0],(uint8_t*)publickeyhashrmd160_endomorphism[5][1],(uint8_t*)publickeyhashrmd160_endomorphism[5][2],(uint8_t*)publickeyhashrmd160_endomorphism[5][3]);
 									}
+									else if(FLAGCOMPRESSPARITY)	{
+										secp->GetHash160(P2PKH,true,pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_endomorphism[0][0],(uint8_t*)publickeyhashrmd160_endomorphism[0][1],(uint8_t*)publickeyhashrmd160_endomorphism[0][2],(uint8_t*)publickeyhashrmd160_endomorphism[0][3]);
+									}
+									else if(FLAGSEARCH == SEARCH_BOTH)	{
+										/* Y is known, only the prefix of its parity and the uncompressed hash in the same pass */
+										secp->GetHash160_both(pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_endomorphism[0],(uint8_t*)publickeyhashrmd160_uncompress);
+									}
 									else	{
 										secp->GetHash160_fromX(P2PKH,0x02,&pts[(j*4)].x,&pts[(j*4)+1].x,&pts[(j*4)+2].x,&pts[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[0][0],(uint8_t*)publickeyhashrmd160_endomorphism[0][1],(uint8_t*)publickeyhashrmd160_endomorphism[0][2],(uint8_t*)publickeyhashrmd160_endomorphism[0][3]);
 										secp->GetHash160_fromX(P2PKH,0x03,&pts[(j*4)].x,&pts[(j*4)+1].x,&pts[(j*4)+2].x,&pts[(j*4)+3].x,(uint8_t*)publickeyhashrmd160_endomorphism[1][0],(uint8_t*)publickeyhashrmd160_endomorphism[1][1],(uint8_t*)publickeyhashrmd160_endomorphism[1][2],(uint8_t*)publickeyhashrmd160_endomorphism[1][3]);
 									}
-									
+									if(group_p2sh != NULL)	{
+										/* P2SH-P2WPKH, second hash over the redeem script of every compressed hash */
+										for(l = 0; l < ADDRESS_COMPRESS_END; l++)	{
+											secp->GetHash160_P2SH((uint8_t*)publickeyhashrmd160_endomorphism[l][0],(uint8_t*)publickeyhashrmd160_endomorphism[l][1],(uint8_t*)publickeyhashrmd160_endomorphism[l][2],(uint8_t*)publickeyhashrmd160_endomorphism[l][3],(uint8_t*)group_p2sh[j][l][0],(uint8_t*)group_p2sh[j][l][1],(uint8_t*)group_p2sh[j][l][2],(uint8_t*)group_p2sh[j][l][3]);
+										}
+									}
 								}
 								if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH){
 									if(FLAGENDOMORPHISM)	{
@@ -2785,35 +3041,36 @@ void *thread_process(void *vargp)	{
 										secp->GetHash160(P2PKH,false, endomorphism_negeted_point[0], endomorphism_negeted_point[1],   endomorphism_negeted_point[2],endomorphism_negeted_point[3],(uint8_t*)publickeyhashrmd160_endomorphism[11][0],(uint8_t*)publickeyhashrmd160_endomorphism[11][1],(uint8_t*)publickeyhashrmd160_endomorphism[11][2],(uint8_t*)publickeyhashrmd160_endomorphism[11][3]);
 
 									}
-									else	{
+									else if(FLAGSEARCH == SEARCH_UNCOMPRESS)	{	/* With -l both it was made by GetHash160_both */
 										secp->GetHash160(P2PKH,false,pts[(j*4)],pts[(j*4)+1],pts[(j*4)+2],pts[(j*4)+3],(uint8_t*)publickeyhashrmd160_uncompress[0],(uint8_t*)publickeyhashrmd160_uncompress[1],(uint8_t*)publickeyhashrmd160_uncompress[2],(uint8_t*)publickeyhashrmd160_uncompress[3]);
 										
 									}
 								}
 							}
 							else if(FLAGCRYPTO == CRYPTO_ETH){
+								/* Already hashed by generate_binaddress_eth_group */
 								if(FLAGENDOMORPHISM)	{
-									for(k = 0; k < 4;k++)	{
-										endomorphism_negeted_point[k] = secp->Negation(pts[(j*4)+k]);
-										generate_binaddress_eth(pts[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[0][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[1][k]);
-										endomorphism_negeted_point[k] = secp->Negation(endomorphism_beta[(j*4)+k]);
-										generate_binaddress_eth(endomorphism_beta[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[2][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[3][k]);
-										endomorphism_negeted_point[k] = secp->Negation(endomorphism_beta2[(j*4)+k]);
-										generate_binaddress_eth(endomorphism_beta[(4*j)+k],(uint8_t*)publickeyhashrmd160_endomorphism[4][k]);
-										generate_binaddress_eth(endomorphism_negeted_point[k],(uint8_t*)publickeyhashrmd160_endomorphism[5][k]);
+									for(l = 0; l < 6; l++)	{
+										memcpy(publickeyhashrmd160_endomorphism[l],eth_addresses + ((uint64_t)l*CPU_GRP_SIZE + j*4) * 20,4 * 20);
 									}
 								}
 								else	{
-									for(k = 0; k < 4;k++)	{
-										generate_binaddress_eth(pts[(4*j)+k],(uint8_t*)publickeyhashrmd160_uncompress[k]);
-									}
+									memcpy(publickeyhashrmd160_uncompress,eth_addresses + (uint64_t)j * 4 * 20,4 * 20);
 								}
 								
 							}
 						break;
 					}
+				}
+				for(j = 0; j < ADDRESS_PREFETCH && j < CPU_GRP_SIZE/4; j++)	{
+					address_prefetch(j,pts,endomorphism_beta,endomorphism_beta2,group_endomorphism,group_uncompress,group_p2sh);
+				}
+				for(j = 0; j < CPU_GRP_SIZE/4;j++){
+					publickeyhashrmd160_uncompress = group_uncompress[j];
+					publickeyhashrmd160_endomorphism = group_endomorphism[j];
+					if(j + ADDRESS_PREFETCH < CPU_GRP_SIZE/4)	{
+						address_prefetch(j + ADDRESS_PREFETCH,pts,endomorphism_beta,endomorphism_beta2,group_endomorphism,group_uncompress,group_p2sh);
+					}
 					switch(FLAGMODE)	{
 						case MODE_RMD160:
 						case MODE_ADDRESS:
@@ -2821,85 +3078,35 @@ void *thread_process(void *vargp)	{
 								for(k = 0; k < 4;k++)	{
 									if(FLAGSEARCH == SEARCH_COMPRESS || FLAGSEARCH == SEARCH_BOTH){
 										if(FLAGENDOMORPHISM)	{
-											for(l = 0;l < 6; l++)	{
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											for(l = 0;l < ADDRESS_COMPRESS_END; l++)	{
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS) || (group_p2sh != NULL && bloom_address_check(group_p2sh[j][l][k],MAXLENGTHADDRESS));
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]) || (group_p2sh != NULL && searchaddress(group_p2sh[j][l][k]));
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
-														publickey = secp->ComputePublicKey(&keyfound);
-														switch(l)	{
-															case 0:	//Original point, prefix 02
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 1:	//Original point, prefix 03
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 03
-															break;
-															case 2:	//Beta point, prefix 02
-																keyfound.ModMulK1order(&lambda);
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 3:	//Beta point, prefix 03											
-																keyfound.ModMulK1order(&lambda);
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 4:	//Beta^2 point, prefix 02
-																keyfound.ModMulK1order(&lambda2);
-																if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-															case 5:	//Beta^2 point, prefix 03
-																keyfound.ModMulK1order(&lambda2);
-																if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-																// else we dont need to chage the current keyfound because it already have prefix 02
-															break;
-														}
-														writekey(true,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														/* Slot l is the prefix 02 + (l & 1) of the point, beta and beta^2 points for l / 2 */
+														hit_resolve(&keyfound,&publickey,l / 2,compress_prefixes && publickey.y.IsOdd() != (l & 1));
+														writekey_point(true,&keyfound,publickey);
 													}
 												}
 											}
 										}
 										else	{
-											for(l = 0;l < 2; l++)	{
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											for(l = 0;l < ADDRESS_COMPRESS_END; l++)	{
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS) || (group_p2sh != NULL && bloom_address_check(group_p2sh[j][l][k],MAXLENGTHADDRESS));
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]) || (group_p2sh != NULL && searchaddress(group_p2sh[j][l][k]));
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
 														
-														publickey = secp->ComputePublicKey(&keyfound);
-														secp->GetHash160(P2PKH,true,publickey,(uint8_t*)publickeyhashrmd160);
-														if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160,20) != 0)	{
-															keyfound.Neg();
-															keyfound.Add(&secp->order);
-														}
-														writekey(true,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														hit_resolve(&keyfound,&publickey,0,compress_prefixes && publickey.y.IsOdd() != (l & 1));
+														writekey_point(true,&keyfound,publickey);
 													}
 												}
 											}
@@ -2909,59 +3116,31 @@ void *thread_process(void *vargp)	{
 									if(FLAGSEARCH == SEARCH_UNCOMPRESS || FLAGSEARCH == SEARCH_BOTH)	{
 										if(FLAGENDOMORPHISM)	{
 											for(l = 6;l < 12; l++)	{	//We check the array from 6 to 12(excluded) because we save the uncompressed information there
-												r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);	//Check in Bloom filter
+												r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);	//Check in Bloom filter
 												if(r) {
-													r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);		//Check in Array using Binary search
+													r = searchaddress(publickeyhashrmd160_endomorphism[l][k]);		//Check in Array using Binary search
 													if(r) {
 														keyfound.SetInt32(k);
 														keyfound.Mult(&stride);
 														keyfound.Add(&key_mpz);
-														switch(l)	{
-															case 6:
-															case 7:
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-															case 8:
-															case 9:
-																keyfound.ModMulK1order(&lambda);
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-															case 10:
-															case 11:
-																keyfound.ModMulK1order(&lambda2);
-																publickey = secp->ComputePublicKey(&keyfound);
-																secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-																if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																	keyfound.Neg();
-																	keyfound.Add(&secp->order);
-																}
-															break;
-														}
-														writekey(false,&keyfound);
+														group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+														/* Slots 6 to 11 are the point, beta and beta^2 points, each one followed by its negation */
+														hit_resolve(&keyfound,&publickey,(l - 6) / 2,l & 1);
+														writekey_point(false,&keyfound,publickey);
 													}
 												}
 											}
 										}
 										else	{
-											r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
+											r = bloom_address_check(publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
 											if(r) {
-												r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+												r = searchaddress(publickeyhashrmd160_uncompress[k]);
 												if(r) {
 													keyfound.SetInt32(k);
 													keyfound.Mult(&stride);
 													keyfound.Add(&key_mpz);
-													
-													writekey(false,&keyfound);
+													group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+													writekey_point(false,&keyfound,publickey);
 													
 												}
 											}
@@ -2973,45 +3152,17 @@ void *thread_process(void *vargp)	{
 								if(FLAGENDOMORPHISM)	{
 									for(k = 0; k < 4;k++)	{
 										for(l = 0;l < 6; l++)	{
-											r = bloom_check(&bloom,publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
+											r = bloom_address_check(publickeyhashrmd160_endomorphism[l][k],MAXLENGTHADDRESS);
 											if(r) {
-												r = searchbinary(addressTable,publickeyhashrmd160_endomorphism[l][k],N);
+												r = searchaddress(publickeyhashrmd160_endomorphism[l][k]);
 												if(r) {												
 													keyfound.SetInt32(k);
 													keyfound.Mult(&stride);
 													keyfound.Add(&key_mpz);
-													switch(l)	{
-														case 0:
-														case 1:
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-														case 2:
-														case 3:
-															keyfound.ModMulK1order(&lambda);
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-														case 4:
-														case 5:
-															keyfound.ModMulK1order(&lambda2);
-															publickey = secp->ComputePublicKey(&keyfound);
-															generate_binaddress_eth(publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-															if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-																keyfound.Neg();
-																keyfound.Add(&secp->order);
-															}
-														break;
-													}
-													writekeyeth(&keyfound);											
+													group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+													/* The same slots of generate_binaddress_eth_group */
+													hit_resolve(&keyfound,&publickey,l / 2,l & 1);
+													writekeyeth_point(&keyfound,publickey);											
 												}
 											}
 										}
@@ -3019,14 +3170,15 @@ void *thread_process(void *vargp)	{
 								}
 								else	{
 									for(k = 0; k < 4;k++)	{
-										r = bloom_check(&bloom,publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
+										r = bloom_address_check(publickeyhashrmd160_uncompress[k],MAXLENGTHADDRESS);
 										if(r) {
-											r = searchbinary(addressTable,publickeyhashrmd160_uncompress[k],N);
+											r = searchaddress(publickeyhashrmd160_uncompress[k]);
 											if(r) {
 												keyfound.SetInt32(k);
 												keyfound.Mult(&stride);
 												keyfound.Add(&key_mpz);
-												writekeyeth(&keyfound);
+												group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+												writekeyeth_point(&keyfound,publickey);
 											}
 										}
 									}
@@ -3037,54 +3189,66 @@ void *thread_process(void *vargp)	{
 							for(k = 0; k < 4;k++)	{
 								if(FLAGENDOMORPHISM)	{
 									pts[(4*j)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 									endomorphism_beta[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											keyfound.ModMulK1order(&lambda);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 									
 									endomorphism_beta2[(j*4)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											keyfound.ModMulK1order(&lambda2);
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
 								}
 								else	{
 									pts[(4*j)+k].x.Get32Bytes((unsigned char *)rawvalue);
-									r = bloom_check(&bloom,rawvalue,MAXLENGTHADDRESS);
+									r = xpoint_check(rawvalue);
 									if(r) {
-										r = searchbinary(addressTable,rawvalue,N);
+										r = searchaddress(rawvalue);
 										if(r) {
 											keyfound.SetInt32(k);
 											keyfound.Mult(&stride);
 											keyfound.Add(&key_mpz);
 											
+											if(FLAGSUBTRACT)	{
+												subtract_xpoint_resolve(&keyfound);
+											}
 											writekey(false,&keyfound);
 										}
 									}
@@ -3100,25 +3264,14 @@ void *thread_process(void *vargp)	{
 
 				steps[thread_number]++;
 
-				// Next start point (startP + GRP_SIZE*G)
-				pp = startP;
-				dy.ModSub(&_2Gn.y,&pp.y);
-
-				_s.ModMulK1(&dy,&dx[i + 1]);
-				_p.ModSquareK1(&_s);
-
-				pp.x.ModNeg();
-				pp.x.ModAdd(&_p);
-				pp.x.ModSub(&_2Gn.x);
-
-				//The Y value for the next start point always need to be calculated
-				pp.y.ModSub(&_2Gn.x,&pp.x);
-				pp.y.ModMulK1(&_s);
-				pp.y.ModSub(&_2Gn.y);
-				startP = pp;
 			}while(count < N_SEQUENTIAL_MAX && continue_flag);
 		}
 	} while(continue_flag);
+	free(eth_publickeys);
+	free(eth_addresses);
+	free(group_uncompress);
+	free(group_endomorphism);
+	free(group_p2sh);
 	ends[thread_number] = 1;
 	return NULL;
 }
@@ -3141,20 +3294,13 @@ void *thread_process_vanity(void *vargp)	{
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
-	Point startP;
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
-	Point pp;	//point positive
-	Point pn;	//point negative
-	int i,hLength = (CPU_GRP_SIZE / 2 - 1);
-	int l,pp_offset,pn_offset;
+	Point startP,groupcenter;
+	int i;
+	int l;
 	uint64_t j,count;
 	Point R,temporal,publickey;
 	int thread_number,continue_flag = 1,k;
 	char *hextemp = NULL;
-	char publickeyhashrmd160[20];
 	char publickeyhashrmd160_uncompress[4][20];
 	char publickeyhashrmd160_endomorphism[12][4][20];
 	
@@ -3221,168 +3367,31 @@ void *thread_process_vanity(void *vargp)	{
 					THREADOUTPUT = 1;
 				}
 			}
+			temp_stride.SetInt32(CPU_GRP_SIZE / 2);
+			temp_stride.Mult(&stride);
+			key_mpz.Add(&temp_stride);
+			startP = secp->ComputePublicKey(&key_mpz);
+			key_mpz.Sub(&temp_stride);
 			do {
-				temp_stride.SetInt32(CPU_GRP_SIZE / 2);
-				temp_stride.Mult(&stride);
-				key_mpz.Add(&temp_stride);
-	 			startP = secp->ComputePublicKey(&key_mpz);
-				key_mpz.Sub(&temp_stride);
-
-				for(i = 0; i < hLength; i++) {
-					dx[i].ModSub(&Gn[i].x,&startP.x);
-				}
-			
-				dx[i].ModSub(&Gn[i].x,&startP.x);  // For the first point
-				dx[i + 1].ModSub(&_2Gn.x,&startP.x); // For the next center point
-				grp->ModInv();
-
-				pts[CPU_GRP_SIZE / 2] = startP;
-
-				for(i = 0; i<hLength; i++) {
-					pp = startP;
-					pn = startP;
-
-					// P = startP + i*G
-					dy.ModSub(&Gn[i].y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-					
-					if(calculate_y)	{
-						pp.y.ModSub(&Gn[i].x,&pp.x);
-						pp.y.ModMulK1(&_s);
-						pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-					}
-
-					// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-					dyn.Set(&Gn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-					_p.ModSquareK1(&_s);            // _p = pow2(s)
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-					if( calculate_y  )	{
-						pn.y.ModSub(&Gn[i].x,&pn.x);
-						pn.y.ModMulK1(&_s);
-						pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-					}
-					pp_offset = CPU_GRP_SIZE / 2 + (i + 1);
-					pn_offset = CPU_GRP_SIZE / 2 - (i + 1);
-
-					pts[pp_offset] = pp;
-					pts[pn_offset] = pn;
-					
-					if(FLAGENDOMORPHISM)	{
-						/*
-							Q = (x,y)
-							For any point Q
-							Q*lambda = (x*beta mod p ,y)
-							Q*lambda is a Scalar Multiplication
-							x*beta is just a Multiplication (Very fast)
-						*/
-						
-						if( calculate_y  )	{
-							endomorphism_beta[pp_offset].y.Set(&pp.y);
-							endomorphism_beta[pn_offset].y.Set(&pn.y);
-							endomorphism_beta2[pp_offset].y.Set(&pp.y);
-							endomorphism_beta2[pn_offset].y.Set(&pn.y);
-						}
-						endomorphism_beta[pp_offset].x.ModMulK1(&pp.x, &beta);
-						endomorphism_beta[pn_offset].x.ModMulK1(&pn.x, &beta);
-						endomorphism_beta2[pp_offset].x.ModMulK1(&pp.x, &beta2);
-						endomorphism_beta2[pn_offset].x.ModMulK1(&pn.x, &beta2);
-
-						/*
-						if(FLAGDEBUG)	{
-							hextemp = secp->GetPublicKeyHex(false,pp);
-							secp->GetHash160(P2PKH,false, pp,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-							printf("[D] pp[%i] = %s , %s y = %s\n",pp_offset,hextemp,address,pp.y.IsEven() ? "Even" : "Odd");
-							free(hextemp);		
-
-							hextemp = secp->GetPublicKeyHex(false,pn);
-							secp->GetHash160(P2PKH,false, pn,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-							printf("[D] pn[%i] = %s , %s y = %s\n",pn_offset,hextemp,address,pn.y.IsEven() ? "Even" : "Odd");
-							free(hextemp);								
-							
-							
-							hextemp = secp->GetPublicKeyHex(false,endomorphism_beta[pp_offset]);
-							secp->GetHash160(P2PKH,false, endomorphism_beta[pp_offset],(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-							printf("[D] endomorphism_beta[%i] = %s , %s y = %s\n",pp_offset,hextemp,address,endomorphism_beta[pp_offset].y.IsEven() ? "Even" : "Odd");
-							free(hextemp);
-							hextemp = secp->GetPublicKeyHex(false,endomorphism_beta[pn_offset]);
-							secp->GetHash160(P2PKH,false, endomorphism_beta[pn_offset],(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-
-							printf("[D] endomorphism_beta[%i] = %s , %s y = %s\n",pn_offset,hextemp,address,endomorphism_beta[pn_offset].y.IsEven() ? "Even" : "Odd");
-							free(hextemp);
-							hextemp = secp->GetPublicKeyHex(false,endomorphism_beta2[pp_offset]);
-							secp->GetHash160(P2PKH,false, endomorphism_beta2[pp_offset],(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-							printf("[D] endomorphism_beta2[%i] = %s , %s y = %s\n",pp_offset,hextemp,address,endomorphism_beta2[pp_offset].y.IsEven() ? "Even" : "Odd");
-							free(hextemp);
-							hextemp = secp->GetPublicKeyHex(false,endomorphism_beta2[pn_offset]);
-							secp->GetHash160(P2PKH,false, endomorphism_beta2[pn_offset],(uint8_t*)publickeyhashrmd160_uncompress[0]);
-							rmd160toaddress_dst(publickeyhashrmd160_uncompress[0],address);
-							printf("[D] endomorphism_beta2[%i] = %s , %s y = %s\n",pn_offset,hextemp,address,endomorphism_beta2[pn_offset].y.IsEven() ? "Even" : "Odd");
-							free(hextemp);
-						}
-						*/
-					}
-				}
-				/*
-					Half point for endomorphism because pts[CPU_GRP_SIZE / 2] was not calcualte in the previous cycle
-				*/
-				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-
-						endomorphism_beta[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
-						endomorphism_beta2[CPU_GRP_SIZE / 2].y.Set(&pts[CPU_GRP_SIZE / 2].y);
-					}
-					endomorphism_beta[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta);
-					endomorphism_beta2[CPU_GRP_SIZE / 2].x.ModMulK1(&pts[CPU_GRP_SIZE / 2].x, &beta2);
-				}
-				
-				// First point (startP - (GRP_SZIE/2)*G)
-				pn = startP;
-				dyn.Set(&Gn[i].y);
-				dyn.ModNeg();
-				dyn.ModSub(&pn.y);
-
-				_s.ModMulK1(&dyn,&dx[i]);
-				_p.ModSquareK1(&_s);
-
-				pn.x.ModNeg();
-				pn.x.ModAdd(&_p);
-				pn.x.ModSub(&Gn[i].x);
-				
-				if(calculate_y )	{
-					pn.y.ModSub(&Gn[i].x,&pn.x);
-					pn.y.ModMulK1(&_s);
-					pn.y.ModAdd(&Gn[i].y);
-				}
-				pts[0] = pn;
-				
-				/*
-					First point for endomorphism because pts[0] was not calcualte previously
-				*/
+				/* The center moves CPU_GRP_SIZE*stride every round, AddDirectBatch updates it */
+				groupcenter.Set(startP);		/* Center of this group for group_hit_point */
+				secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,calculate_y,grp,dx);
 				if(FLAGENDOMORPHISM)	{
-					if( calculate_y  )	{
-						endomorphism_beta[0].y.Set(&pn.y);
-						endomorphism_beta2[0].y.Set(&pn.y);
+					/*
+						Q = (x,y)
+						For any point Q
+						Q*lambda = (x*beta mod p ,y)
+						Q*lambda is a Scalar Multiplication
+						x*beta is just a Multiplication (Very fast)
+					*/
+					for(i = 0; i < CPU_GRP_SIZE; i++)	{
+						if(calculate_y)	{
+							endomorphism_beta[i].y.Set(&pts[i].y);
+							endomorphism_beta2[i].y.Set(&pts[i].y);
+						}
+						endomorphism_beta[i].x.ModMulK1(&pts[i].x, &beta);
+						endomorphism_beta2[i].x.ModMulK1(&pts[i].x, &beta2);
 					}
-					endomorphism_beta[0].x.ModMulK1(&pn.x, &beta);
-					endomorphism_beta2[0].x.ModMulK1(&pn.x, &beta2);
 				}
 				
 				
@@ -3439,78 +3448,10 @@ void *thread_process_vanity(void *vargp)	{
 										keyfound.SetInt32(k);
 										keyfound.Mult(&stride);
 										keyfound.Add(&key_mpz);
-										publickey = secp->ComputePublicKey(&keyfound);
-
-										/*
-										if(FLAGDEBUG) {
-											
-											rmd160toaddress_dst(publickeyhashrmd160_endomorphism[l][k],address);
-											
-											hextemp = tohex(publickeyhashrmd160_endomorphism[l][k],20);
-											printf("[D] hash found: %s : address %s\n",hextemp,address);
-											free(hextemp);
-											hextemp = keyfound.GetBase16();
-											printf("[D] key: %s\n",hextemp);
-											free(hextemp);
-											
-											hextemp = secp->GetPublicKeyHex(true,publickey);
-											printf("[D] GetPublicKeyHex: %s\n",hextemp);
-											free(hextemp);
-											
-											printf("[D] found something l = %i\n",l);
-
-										}
-										*/
-										
-										switch(l)	{
-											case 0:	//Original point, prefix 02
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 1:	//Original point, prefix 03
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 03
-											break;
-											case 2:	//Beta point, prefix 02
-												keyfound.ModMulK1order(&lambda);
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 3:	//Beta point, prefix 03											
-												keyfound.ModMulK1order(&lambda);
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 4:	//Beta^2 point, prefix 02
-												keyfound.ModMulK1order(&lambda2);
-												if(publickey.y.IsOdd())	{	//if the current publickey is odd that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-											case 5:	//Beta^2 point, prefix 03
-												keyfound.ModMulK1order(&lambda2);
-												if(publickey.y.IsEven())	{	//if the current publickey is even that means, we need to negate the keyfound to get the correct key
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-												// else we dont need to chage the current keyfound because it already have prefix 02
-											break;
-										}
-										writevanitykey(true,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										/* Slot l is the prefix 02 + (l & 1) of the point, beta and beta^2 points for l / 2 */
+										hit_resolve(&keyfound,&publickey,l / 2,publickey.y.IsOdd() != (l & 1));
+										writevanitykey_point(true,&keyfound,publickey);
 									}
 								}
 							}
@@ -3521,14 +3462,9 @@ void *thread_process_vanity(void *vargp)	{
 										keyfound.Mult(&stride);
 										keyfound.Add(&key_mpz);
 										
-										publickey = secp->ComputePublicKey(&keyfound);
-										secp->GetHash160(P2PKH,true,publickey,(uint8_t*)publickeyhashrmd160);
-										if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160,20) != 0){
-											keyfound.Neg();
-											keyfound.Add(&secp->order);
-											//if(FLAGDEBUG) printf("[D] Key need to be negated\n");
-										}
-										writevanitykey(true,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										hit_resolve(&keyfound,&publickey,0,publickey.y.IsOdd() != (l & 1));
+										writevanitykey_point(true,&keyfound,publickey);
 									}
 								}									
 							}
@@ -3567,38 +3503,10 @@ void *thread_process_vanity(void *vargp)	{
 										}
 										*/
 										
-										switch(l)	{
-											case 6:
-											case 7:
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-											case 8:
-											case 9:
-												keyfound.ModMulK1order(&lambda);
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-											case 10:
-											case 11:
-												keyfound.ModMulK1order(&lambda2);
-												publickey = secp->ComputePublicKey(&keyfound);
-												secp->GetHash160(P2PKH,false,publickey,(uint8_t*)publickeyhashrmd160_uncompress[0]);
-												if(memcmp(publickeyhashrmd160_endomorphism[l][k],publickeyhashrmd160_uncompress[0],20) != 0){
-													keyfound.Neg();
-													keyfound.Add(&secp->order);
-												}
-											break;
-										}
-										writevanitykey(false,&keyfound);
+										group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+										/* Slots 6 to 11 are the point, beta and beta^2 points, each one followed by its negation */
+										hit_resolve(&keyfound,&publickey,(l - 6) / 2,l & 1);
+										writevanitykey_point(false,&keyfound,publickey);
 									}
 								}
 
@@ -3608,7 +3516,8 @@ void *thread_process_vanity(void *vargp)	{
 									keyfound.SetInt32(k);
 									keyfound.Mult(&stride);
 									keyfound.Add(&key_mpz);
-									writevanitykey(false,&keyfound);
+									group_hit_point(pts,groupcenter,(j*4)+k,calculate_y,&publickey);
+									writevanitykey_point(false,&keyfound,publickey);
 								}
 							}
 						}
@@ -3622,22 +3531,6 @@ void *thread_process_vanity(void *vargp)	{
 				}
 				steps[thread_number]++;
 
-				// Next start point (startP + GRP_SIZE*G)
-				pp = startP;
-				dy.ModSub(&_2Gn.y,&pp.y);
-
-				_s.ModMulK1(&dy,&dx[i + 1]);
-				_p.ModSquareK1(&_s);
-
-				pp.x.ModNeg();
-				pp.x.ModAdd(&_p);
-				pp.x.ModSub(&_2Gn.x);
-				
-				//The Y value for the next start point always need to be calculated
-				pp.y.ModSub(&_2Gn.x,&pp.x);
-				pp.y.ModMulK1(&_s);
-				pp.y.ModSub(&_2Gn.y);
-				startP = pp;
 			}while(count < N_SEQUENTIAL_MAX && continue_flag);
 		}
 	} while(continue_flag);
@@ -3900,18 +3793,11 @@ void *thread_process_bsgs(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int i,hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 	
@@ -3988,88 +3874,7 @@ void *thread_process_bsgs(void *vargp)	{
 				j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
 					
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						#ifdef __APPLE__
@@ -4079,16 +3884,22 @@ pn.y.ModAdd(&GSn[i].y);
 #endif
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							if(FLAGDEBUG)	{
+						if(r || FLAGENDOMORPHISM) {
+							if(FLAGDEBUG && r)	{
 								hextemp = tohex(xpoint_raw,32);
 								aux_c = base_key.GetBase16();
 								printf("[D] %s pass the bloom filter check %4i %i, base %s\n",hextemp,i,j,aux_c);
 								free(hextemp);
 								free(aux_c);
 							}
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -4112,7 +3923,7 @@ pn.y.ModAdd(&GSn[i].y);
 #else
 				pthread_mutex_unlock(&write_keys);
 #endif
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -4126,22 +3937,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 				} //while all the aMP points
@@ -4172,18 +3967,11 @@ void *thread_process_bsgs_random(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 
@@ -4257,89 +4045,7 @@ void *thread_process_bsgs_random(void *vargp)	{
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
 				
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						#ifdef __APPLE__
@@ -4349,9 +4055,15 @@ pn.y.ModAdd(&GSn[i].y);
 #endif
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s    \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -4376,7 +4088,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -4390,22 +4102,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 					
@@ -4425,6 +4121,11 @@ pn.y.ModAdd(&GSn[i].y);
 	This funtion is made with the especific purpouse to USE a smaller bPtable in RAM.
 */
 int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey)	{
+	return bsgs_secondcheck_point(start_range,a,&OriginalPointsBSGS[k_index],privatekey);
+}
+
+/* The same second check for any target point, not only the publickeys of the file */
+int bsgs_secondcheck_point(Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
 	int i = 0,found = 0,r = 0;
 	Int base_key;
 	Point base_point,point_aux;
@@ -4444,7 +4145,7 @@ int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privateke
 				 Q is the target Key
 		base_key is the Start range + a*BSGS_M
 	*/
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	do {
 		BSGS_Q_AMP = secp->AddDirect(BSGS_Q,BSGS_AMP2[i]);
@@ -4452,14 +4153,14 @@ int bsgs_secondcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privateke
 		BSGS_S.x.Get32Bytes((unsigned char *) xpoint_raw);
 		r = bloom_check(&bloom_bPx2nd[(uint8_t) xpoint_raw[0]],xpoint_raw,32);
 		if(r)	{
-			found = bsgs_thirdcheck(&base_key,i,k_index,privatekey);
+			found = bsgs_thirdcheck(&base_key,i,target,privatekey);
 		}
 		i++;
 	}while(i < 32 && !found);
 	return found;
 }
 
-int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey)	{
+int bsgs_thirdcheck(Int *start_range,uint32_t a,Point *target,Int *privatekey)	{
 	uint64_t j = 0;
 	int i = 0,found = 0,r = 0;
 	Int base_key,calculatedkey;
@@ -4474,7 +4175,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 	base_point = secp->ComputePublicKey(&base_key);
 	point_aux = secp->Negation(base_point);
 	
-	BSGS_S = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+	BSGS_S = secp->AddDirect(*target,point_aux);
 	BSGS_Q.Set(BSGS_S);
 	
 	do {
@@ -4490,7 +4191,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 				privatekey->Add((uint64_t)(j+1));
 				privatekey->Add(&base_key);
 				point_aux = secp->ComputePublicKey(privatekey);
-				if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x))	{
+				if(point_aux.x.IsEqual(&target->x))	{
 					found = 1;
 				}
 				else	{
@@ -4499,7 +4200,7 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 					privatekey->Sub((uint64_t)(j+1));
 					privatekey->Add(&base_key);
 					point_aux = secp->ComputePublicKey(privatekey);
-					if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x))	{
+					if(point_aux.x.IsEqual(&target->x))	{
 						found = 1;
 					}
 				}
@@ -4524,6 +4225,53 @@ int bsgs_thirdcheck(Int *start_range,uint32_t a,uint32_t k_index,Int *privatekey
 }
 
 
+/*
+	-e in BSGS: lambda*P = (beta*x,y), so beta*X and beta^2*X of the giant step point P = Q - center*G are also
+	checked in the same baby step table. A hit is lambda^v*P = r*G with |r| <= M, r is solved with the second and
+	third checks over r*G + 3*M*G and then key(Q) = center + lambda^(3-v)*r. Those keys are out of the range
+*/
+int bsgs_endomorphism_check(Int *start_range,uint32_t a,uint32_t k_index,Int *x,Int *privatekey)	{
+	Int x_v,center,window,r;
+	Point point_aux,rotated;
+	char xpoint_raw[32];
+	int v;
+	for(v = 1; v <= 2; v++)	{
+		x_v.ModMulK1(x,v == 1 ? &beta : &beta2);
+		x_v.Get32Bytes((unsigned char*)xpoint_raw);
+		if(!bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32))	{
+			continue;
+		}
+		/* The giant step point again, now with its Y */
+		center.Set(&BSGS_M_double);
+		center.Mult((uint64_t)a);
+		center.Add(start_range);
+		center.Add(&BSGS_M);
+		point_aux = secp->ComputePublicKey(&center);
+		point_aux = secp->Negation(point_aux);
+		rotated = secp->AddDirect(OriginalPointsBSGS[k_index],point_aux);
+		rotated.x.Set(&x_v);
+		window.Set(&BSGS_M);
+		window.Mult((uint64_t)3);
+		point_aux = secp->ComputePublicKey(&window);
+		rotated = secp->AddDirect(rotated,point_aux);
+		if(bsgs_secondcheck_point(&BSGS_M_double,0,&rotated,&r))	{
+			r.Sub(&window);
+			if(r.IsNegative())	{
+				r.Add(&secp->order);
+			}
+			r.ModMulK1order(v == 1 ? &lambda2 : &lambda);
+			privatekey->Set(&center);
+			privatekey->Add(&r);
+			privatekey->Mod(&secp->order);
+			point_aux = secp->ComputePublicKey(privatekey);
+			if(point_aux.x.IsEqual(&OriginalPointsBSGS[k_index].x) && point_aux.y.IsEqual(&OriginalPointsBSGS[k_index].y))	{
+				return 1;
+			}
+		}
+	}
+	return 0;
+}
+
 void sleep_ms(int milliseconds)	{ // cross-platform sleep function
 #if defined(_WIN64) && !defined(__CYGWIN__)
     Sleep(milliseconds);
@@ -4605,9 +4353,9 @@ void *thread_pub2rmd(void *vargp)	{
 				pub.parity = 0x02;
 				sha256((uint8_t*)&pub, 33, (uint8_t*)digest256);
 				rmd160((const unsigned char*)digest256,32,(unsigned char*) digest160);
-				r = bloom_check(&bloom,digest160,MAXLENGTHADDRESS);
+				r = bloom_address_check(digest160,MAXLENGTHADDRESS);
 				if(r)  {
-					r = searchbinary(addressTable,digest160,N);
+					r = searchaddress(digest160);
 					if(r)	{
 						temphex = tohex((char*)&pub,33);
 						printf("\nHit: Publickey found %s\n",temphex);
@@ -4635,9 +4383,9 @@ void *thread_pub2rmd(void *vargp)	{
 				pub.parity = 0x03;
 				sha256((uint8_t*)&pub, 33,(uint8_t*) digest256);
 				rmd160((const unsigned char*)digest256,32,(unsigned char*) digest160);
-				r = bloom_check(&bloom,digest160,MAXLENGTHADDRESS);
+				r = bloom_address_check(digest160,MAXLENGTHADDRESS);
 				if(r)  {
-					r = searchbinary(addressTable,digest160,N);
+					r = searchaddress(digest160);
 					if(r)  {
 						temphex = tohex((char*)&pub,33);
 						printf("\nHit: Publickey found %s\n",temphex);
@@ -4689,6 +4437,209 @@ void init_generator()	{
 	_2Gn = secp->DoubleDirect(Gn[CPU_GRP_SIZE / 2 - 1]);
 }
 
+/*
+	pts[i] of a group of AddDirectBatch with its Y, for a hit. With calculate_y the group has it, else it is
+	one addition to the center of the group: pts[i] = center + (i - CPU_GRP_SIZE/2)*Gn[0]
+*/
+void group_hit_point(Point *pts,Point &center,int i,bool calculate_y,Point *publickey)	{
+	Point aux;
+	int d = i - CPU_GRP_SIZE / 2;
+	if(calculate_y)	{
+		publickey->Set(pts[i]);
+	}
+	else if(d == 0)	{
+		publickey->Set(center);
+	}
+	else if(d > 0)	{
+		*publickey = secp->AddDirect(center,Gn[d - 1]);
+	}
+	else	{
+		aux = secp->Negation(Gn[-d - 1]);
+		*publickey = secp->AddDirect(center,aux);
+	}
+	publickey->z.SetInt32(1);
+}
+
+/*
+	key and publickey of a hit from the ones of its point, without scalar multiplication or hash:
+	variant 1 and 2 are the beta and beta^2 points, lambda*key and lambda^2*key with the same Y,
+	negated is the point with -Y and the key n - key
+*/
+void hit_resolve(Int *key,Point *publickey,int variant,int negated)	{
+	switch(variant)	{
+		case 1:
+			key->ModMulK1order(&lambda);
+			publickey->x.ModMulK1(&beta);
+		break;
+		case 2:
+			key->ModMulK1order(&lambda2);
+			publickey->x.ModMulK1(&beta2);
+		break;
+	}
+	if(negated)	{
+		key->Neg();
+		key->Add(&secp->order);
+		*publickey = secp->Negation(*publickey);
+	}
+}
+
+/*
+	-x count:spacing, the targets of one publickey Q are T_i = Q - i*spacing*G for i from 0 to count - 1.
+	They are made by groups of CPU_GRP_SIZE around a center with one batched inversion like the threads:
+	table[j] = -(j+1)*spacing*G, so out[k] of AddDirectBatch is center - (k - CPU_GRP_SIZE/2)*spacing*G.
+	callback gets every target in order of i, a nonzero return stops
+*/
+void subtract_generate(Point &base,uint64_t count,int (*callback)(uint64_t i,Point &target,void *arg),void *arg)	{
+	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
+	Int dx[CPU_GRP_SIZE / 2 + 1];
+	Point *pts = new Point[CPU_GRP_SIZE];
+	Point *table = new Point[CPU_GRP_SIZE / 2];
+	Point S,center,next;
+	uint64_t i,k;
+	int stop = 0;
+	grp->Set(dx);
+	S = secp->ComputePublicKey(&subtract_spacing);
+	S = secp->Negation(S);
+	table[0] = S;
+	table[1] = secp->DoubleDirect(S);
+	for(k = 2; k < CPU_GRP_SIZE / 2; k++)	{
+		table[k] = secp->AddDirect(table[k - 1],S);
+	}
+	next = secp->DoubleDirect(table[CPU_GRP_SIZE / 2 - 1]);
+	center = secp->AddDirect(base,table[CPU_GRP_SIZE / 2 - 1]);
+	for(i = 0; i < count && !stop; i += CPU_GRP_SIZE)	{
+		secp->AddDirectBatch(center,table,&next,CPU_GRP_SIZE,pts,true,grp,dx);
+		for(k = 0; k < CPU_GRP_SIZE && i + k < count && !stop; k++)	{
+			pts[k].z.SetInt32(1);
+			stop = callback(i + k,pts[k],arg);
+		}
+	}
+	delete grp;
+	delete[] pts;
+	delete[] table;
+}
+
+int subtract_store_bsgs(uint64_t i,Point &target,void *arg)	{
+	OriginalPointsBSGS[i].Set(target);
+	OriginalPointsBSGScompressed[i] = subtract_compressed;
+	return 0;
+}
+
+int subtract_store_xpoint(uint64_t i,Point &target,void *arg)	{
+	uint8_t rawvalue[32];
+	target.x.Get32Bytes(rawvalue);
+	memcpy(addressTable[i].value,rawvalue,20);
+	bloom_address_add(rawvalue,20);
+	return 0;
+}
+
+struct subtract_search	{
+	Point point;
+	uint64_t index;
+	int found;
+	int negated;
+};
+
+int subtract_find(uint64_t i,Point &target,void *arg)	{
+	struct subtract_search *search = (struct subtract_search *)arg;
+	if(target.x.IsEqual(&search->point.x))	{
+		search->index = i;
+		search->found = 1;
+		search->negated = !target.y.IsEqual(&search->point.y);
+	}
+	return search->found;
+}
+
+/*
+	The targets file of xpoint mode with -x has only one publickey, the table and the bloom filters
+	are made in memory from it and they are never saved with -S
+*/
+bool subtract_load_xpoint(char *fileName)	{
+	FILE *fd;
+	char line[1024];
+	int found = 0;
+	fd = fopen(fileName,"r");
+	if(fd == NULL)	{
+		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
+		return false;
+	}
+	while(fgets(line,1024,fd) == line)	{
+		trim(line," \t\n\r");
+		line[strcspn(line," \t:")] = '\0';
+		if(strlen(line) == 66 || strlen(line) == 130)	{
+			if(found || !secp->ParsePublicKeyHex(line,subtract_base,subtract_compressed))	{
+				fprintf(stderr,"[E] -x needs only one valid publickey in the file\n");
+				fclose(fd);
+				return false;
+			}
+			found = 1;
+		}
+	}
+	fclose(fd);
+	if(!found)	{
+		fprintf(stderr,"[E] -x needs a publickey in the file, not only the X value\n");
+		return false;
+	}
+	MAXLENGTHADDRESS = 20;
+	N = subtract_count;
+	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",N,(double)(((double) sizeof(struct address_value)*N)/(double)1048576));
+	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*N + 1);
+	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
+	if(!initBloomAddress(N))	{
+		return false;
+	}
+	subtract_generate(subtract_base,N,subtract_store_xpoint,NULL);
+	_sort(addressTable,N);
+	printf("[+] %" PRIu64 " values were made from the publickey and sorted\n",N);
+	return true;
+}
+
+/*
+	privatekey is the key of a target with the X of T_i, the targets are made again until that X to know i.
+	It is once per hit so the cost is no problem. With the other Y the key is of -T_i
+*/
+void subtract_xpoint_resolve(Int *privatekey)	{
+	struct subtract_search search;
+	Int aux;
+	search.point = secp->ComputePublicKey(privatekey);
+	search.found = 0;
+	subtract_generate(subtract_base,subtract_count,subtract_find,&search);
+	if(!search.found)	{
+		return;
+	}
+	if(search.negated)	{
+		aux.Set(&secp->order);
+		aux.Sub(privatekey);
+		privatekey->Set(&aux);
+	}
+	aux.SetInt64(search.index);
+	aux.Mult(&subtract_spacing);
+	privatekey->Add(&aux);
+	privatekey->Mod(&secp->order);
+}
+
+/* key(Q) = key(T_i) + i*spacing, after the endomorphism the key is already the one of T_i */
+void subtract_bsgs_resolve(uint32_t k_index,Int *privatekey)	{
+	Int aux;
+	aux.SetInt64(k_index % bsgs_point_number);
+	aux.Mult(&subtract_spacing);
+	privatekey->Add(&aux);
+	privatekey->Mod(&secp->order);
+}
+
+/* Mark the publickey as found, with -x all the targets are the same publickey */
+void bsgs_setfound(uint32_t k_index)	{
+	uint32_t l;
+	if(FLAGSUBTRACT)	{
+		for(l = 0; l < bsgs_point_number; l++)	{
+			bsgs_found[l] = 1;
+		}
+	}
+	else	{
+		bsgs_found[k_index] = 1;
+	}
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_bPload(LPVOID vargp) {
 #else
@@ -4703,10 +4654,8 @@ void *thread_bPload(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
 	
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from + 1));
 	threadid = tt->threadid;
@@ -4726,82 +4675,7 @@ void *thread_bPload(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -4846,21 +4720,6 @@ void *thread_bPload(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 #if defined(_WIN64) && !defined(__CYGWIN__)
@@ -4888,9 +4747,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	Point startP;
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
-	Int dy,dyn,_s,_p;
-	Point pp,pn;
-	int i,bloom_bP_index,hLength = (CPU_GRP_SIZE / 2 - 1) ,threadid;
+	int bloom_bP_index,threadid;
 	tt = (struct bPload *)vargp;
 	Int km((uint64_t)(tt->from +1 ));
 	threadid = tt->threadid;
@@ -4908,82 +4765,7 @@ void *thread_bPload_2blooms(void *vargp)	{
 	startP = secp->ComputePublicKey(&km);
 	grp->Set(dx);
 	for(uint64_t s=0;s<nbStep;s++) {
-		for(i = 0; i < hLength; i++) {
-			dx[i].ModSub(&Gn[i].x,&startP.x);
-		}
-		dx[i].ModSub(&Gn[i].x,&startP.x); // For the first point
-		dx[i + 1].ModSub(&_2Gn.x,&startP.x);// For the next center point
-		// Grouped ModInv
-		grp->ModInv();
-
-		// We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-		// We compute key in the positive and negative way from the center of the group
-		// center point
-		
-		pts[CPU_GRP_SIZE / 2] = startP;	//Center point
-
-		for(i = 0; i<hLength; i++) {
-			pp = startP;
-			pn = startP;
-
-			// P = startP + i*G
-			dy.ModSub(&Gn[i].y,&pp.y);
-
-			_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pp.x.ModNeg();
-			pp.x.ModAdd(&_p);
-			pp.x.ModSub(&Gn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pp.y.ModSub(&Gn[i].x,&pp.x);
-			pp.y.ModMulK1(&_s);
-			pp.y.ModSub(&Gn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-			dyn.Set(&Gn[i].y);
-			dyn.ModNeg();
-			dyn.ModSub(&pn.y);
-
-			_s.ModMulK1(&dyn,&dx[i]);      // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-			_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-			pn.x.ModNeg();
-			pn.x.ModAdd(&_p);
-			pn.x.ModSub(&Gn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-			pn.y.ModSub(&Gn[i].x,&pn.x);
-			pn.y.ModMulK1(&_s);
-			pn.y.ModAdd(&Gn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);
-#endif
-
-			pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-			pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-		}
-
-		// First point (startP - (GRP_SZIE/2)*G)
-		pn = startP;
-		dyn.Set(&Gn[i].y);
-		dyn.ModNeg();
-		dyn.ModSub(&pn.y);
-
-		_s.ModMulK1(&dyn,&dx[i]);
-		_p.ModSquareK1(&_s);
-
-		pn.x.ModNeg();
-		pn.x.ModAdd(&_p);
-		pn.x.ModSub(&Gn[i].x);
-
-#if 0
-		pn.y.ModSub(&Gn[i].x,&pn.x);
-		pn.y.ModMulK1(&_s);
-		pn.y.ModAdd(&Gn[i].y);
-#endif
-
-		pts[0] = pn;
+		secp->AddDirectBatch(startP,&Gn[0],&_2Gn,CPU_GRP_SIZE,pts,false,grp,dx);
 		for(j=0;j<CPU_GRP_SIZE;j++)	{
 			pts[j].x.Get32Bytes((unsigned char*)rawvalue);
 			bloom_bP_index = (uint8_t)rawvalue[0];
@@ -5017,21 +4799,6 @@ void *thread_bPload_2blooms(void *vargp)	{
 			}
 			i_counter++;
 		}
-		// Next start point (startP + GRP_SIZE*G)
-		pp = startP;
-		dy.ModSub(&_2Gn.y,&pp.y);
-
-		_s.ModMulK1(&dy,&dx[i + 1]);
-		_p.ModSquareK1(&_s);
-
-		pp.x.ModNeg();
-		pp.x.ModAdd(&_p);
-		pp.x.ModSub(&_2Gn.x);
-
-		pp.y.ModSub(&_2Gn.x,&pp.x);
-		pp.y.ModMulK1(&_s);
-		pp.y.ModSub(&_2Gn.y);
-		startP = pp;
 	}
 	delete grp;
 #if defined(_WIN64) && !defined(__CYGWIN__)
@@ -5073,6 +4840,41 @@ void generate_binaddress_eth(Point &publickey,unsigned char *dst_address)	{
 	memcpy(dst_address,bin_publickey+12,20);	
 }
 
+/*
+	ETH addresses of a whole group with the lane parallel Keccak, dst_addresses[l*count + i] is the point i (l = 0),
+	its negation (l = 1) and with beta != NULL the beta (2, 3) and beta^2 (4, 5) points with the same Y.
+	bin_publickeys needs 64 bytes for every address
+*/
+void generate_binaddress_eth_group(Point *pts,Point *beta,Point *beta2,int count,unsigned char *bin_publickeys,unsigned char *dst_addresses)	{
+	Point negated;
+	unsigned char *bin;
+	int i,variants = (beta != NULL) ? 6 : 1;
+	for(i = 0; i < count; i++)	{
+		bin = bin_publickeys + (uint64_t)i * 64;
+		pts[i].x.Get32Bytes(bin);
+		pts[i].y.Get32Bytes(bin + 32);
+		if(beta != NULL)	{
+			negated = secp->Negation(pts[i]);
+			bin = bin_publickeys + (uint64_t)(count + i) * 64;
+			pts[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(2*count + i) * 64;
+			beta[i].x.Get32Bytes(bin);
+			pts[i].y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(3*count + i) * 64;
+			beta[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(4*count + i) * 64;
+			beta2[i].x.Get32Bytes(bin);
+			pts[i].y.Get32Bytes(bin + 32);
+			bin = bin_publickeys + (uint64_t)(5*count + i) * 64;
+			beta2[i].x.Get32Bytes(bin);
+			negated.y.Get32Bytes(bin + 32);
+		}
+	}
+	keccak256_eth_batch(bin_publickeys,variants * count,dst_addresses);
+}
+
 #if defined(_WIN64) && !defined(__CYGWIN__)
 DWORD WINAPI thread_process_bsgs_dance(LPVOID vargp) {
 #else
@@ -5092,18 +4894,11 @@ void *thread_process_bsgs_dance(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 	
@@ -5208,89 +5003,7 @@ void *thread_process_bsgs_dance(void *vargp)	{
 				startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						#ifdef __APPLE__
@@ -5300,9 +5013,15 @@ pn.y.ModAdd(&GSn[i].y);
 #endif
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -5327,7 +5046,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -5341,22 +5060,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 				}//while all the aMP points
@@ -5386,18 +5089,11 @@ void *thread_process_bsgs_backward(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 	
 	tt = (struct tothread *)vargp;
@@ -5474,101 +5170,25 @@ void *thread_process_bsgs_backward(void *vargp)	{
 				startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{	
-					int i;				
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
-					
-					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
-						#ifdef __APPLE__
-						if (i + 1 < CPU_GRP_SIZE) {
-							__builtin_prefetch(pts[i+1].x.num->_mp_d, 0, 3);
-						}
+					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
+						#ifdef __APPLE__
+						if (i + 1 < CPU_GRP_SIZE) {
+							__builtin_prefetch(pts[i+1].x.num->_mp_d, 0, 3);
+						}
 #endif
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -5593,7 +5213,7 @@ pn.y.ModAdd(&GSn[i].y);
 								pthread_mutex_unlock(&write_keys);
 #endif
 
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -5607,22 +5227,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					j++;
 				}//while all the aMP points
 			}// End if 
@@ -5652,18 +5256,11 @@ void *thread_process_bsgs_both(void *vargp)	{
 	IntGroup *grp = new IntGroup(CPU_GRP_SIZE / 2 + 1);
 	Point startP;
 	
-	int hLength = (CPU_GRP_SIZE / 2 - 1);
 	
 	Int dx[CPU_GRP_SIZE / 2 + 1];
 	Point pts[CPU_GRP_SIZE];
 
-	Int dy;
-	Int dyn;
-	Int _s;
-	Int _p;
 	Int km,intaux;
-	Point pp;
-	Point pn;
 	grp->Set(dx);
 
 	
@@ -5765,89 +5362,7 @@ void *thread_process_bsgs_both(void *vargp)	{
 				startP  = secp->AddDirect(OriginalPointsBSGS[k],point_aux);
 				uint32_t j = 0;
 				while( j < cycles && bsgs_found[k]== 0 )	{
-					int i;
-					for(i = 0; i < hLength; i++) {
-						dx[i].ModSub(&GSn[i].x,&startP.x);
-					}
-					dx[i].ModSub(&GSn[i].x,&startP.x);  // For the first point
-					dx[i+1].ModSub(&_2GSn.x,&startP.x); // For the next center point
-
-					// Grouped ModInv
-					grp->ModInv();
-					
-					/*
-					We use the fact that P + i*G and P - i*G has the same deltax, so the same inverse
-					We compute key in the positive and negative way from the center of the group
-					*/
-
-					// center point
-					pts[CPU_GRP_SIZE / 2] = startP;
-					
-					for(i = 0; i<hLength; i++) {
-
-						pp = startP;
-						pn = startP;
-
-						// P = startP + i*G
-						dy.ModSub(&GSn[i].y,&pp.y);
-
-						_s.ModMulK1(&dy,&dx[i]);        // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pp.x.ModNeg();
-						pp.x.ModAdd(&_p);
-						pp.x.ModSub(&GSn[i].x);           // rx = pow2(s) - p1.x - p2.x;
-						
-#if 0
-  pp.y.ModSub(&GSn[i].x,&pp.x);
-  pp.y.ModMulK1(&_s);
-  pp.y.ModSub(&GSn[i].y);           // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-						// P = startP - i*G  , if (x,y) = i*G then (x,-y) = -i*G
-						dyn.Set(&GSn[i].y);
-						dyn.ModNeg();
-						dyn.ModSub(&pn.y);
-
-						_s.ModMulK1(&dyn,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
-						_p.ModSquareK1(&_s);            // _p = pow2(s)
-
-						pn.x.ModNeg();
-						pn.x.ModAdd(&_p);
-						pn.x.ModSub(&GSn[i].x);          // rx = pow2(s) - p1.x - p2.x;
-
-#if 0
-  pn.y.ModSub(&GSn[i].x,&pn.x);
-  pn.y.ModMulK1(&_s);
-  pn.y.ModAdd(&GSn[i].y);          // ry = - p2.y - s*(ret.x-p2.x);  
-#endif
-
-
-						pts[CPU_GRP_SIZE / 2 + (i + 1)] = pp;
-						pts[CPU_GRP_SIZE / 2 - (i + 1)] = pn;
-
-					}
-
-					// First point (startP - (GRP_SZIE/2)*G)
-					pn = startP;
-					dyn.Set(&GSn[i].y);
-					dyn.ModNeg();
-					dyn.ModSub(&pn.y);
-
-					_s.ModMulK1(&dyn,&dx[i]);
-					_p.ModSquareK1(&_s);
-
-					pn.x.ModNeg();
-					pn.x.ModAdd(&_p);
-					pn.x.ModSub(&GSn[i].x);
-
-#if 0
-pn.y.ModSub(&GSn[i].x,&pn.x);
-pn.y.ModMulK1(&_s);
-pn.y.ModAdd(&GSn[i].y);
-#endif
-
-					pts[0] = pn;
+					secp->AddDirectBatch(startP,&GSn[0],&_2GSn,CPU_GRP_SIZE,pts,false,grp,dx);
 					
 					for(int i = 0; i<CPU_GRP_SIZE && bsgs_found[k]== 0; i++) {
 						#ifdef __APPLE__
@@ -5857,9 +5372,15 @@ pn.y.ModAdd(&GSn[i].y);
 #endif
 						pts[i].x.Get32Bytes((unsigned char*)xpoint_raw);
 						r = bloom_check(&bloom_bP[((unsigned char)xpoint_raw[0])],xpoint_raw,32);
-						if(r) {
-							r = bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+						if(r || FLAGENDOMORPHISM) {
+							r = r && bsgs_secondcheck(&base_key,((j*1024) + i),k,&keyfound);
+							if(!r && FLAGENDOMORPHISM)	{
+								r = bsgs_endomorphism_check(&base_key,((j*1024) + i),k,&pts[i].x,&keyfound);
+							}
 							if(r)	{
+								if(FLAGSUBTRACT)	{
+									subtract_bsgs_resolve(k,&keyfound);
+								}
 								hextemp = keyfound.GetBase16();
 								printf("[+] Thread Key found privkey %s   \n",hextemp);
 								point_found = secp->ComputePublicKey(&keyfound);
@@ -5885,7 +5406,7 @@ pn.y.ModAdd(&GSn[i].y);
 
 								free(hextemp);
 								free(aux_c);
-								bsgs_found[k] = 1;
+								bsgs_setfound(k);
 								salir = 1;
 								for(l = 0; l < bsgs_point_number && salir; l++)	{
 									salir &= bsgs_found[l];
@@ -5899,22 +5420,6 @@ pn.y.ModAdd(&GSn[i].y);
 						
 					}// For for pts variable
 					
-					// Next start point (startP += (bsSize*GRP_SIZE).G)
-					
-					pp = startP;
-					dy.ModSub(&_2GSn.y,&pp.y);
-
-					_s.ModMulK1(&dy,&dx[i + 1]);
-					_p.ModSquareK1(&_s);
-
-					pp.x.ModNeg();
-					pp.x.ModAdd(&_p);
-					pp.x.ModSub(&_2GSn.x);
-
-					pp.y.ModSub(&_2GSn.x,&pp.x);
-					pp.y.ModMulK1(&_s);
-					pp.y.ModSub(&_2GSn.y);
-					startP = pp;
 					
 					j++;
 				}//while all the aMP points
@@ -6056,11 +5561,13 @@ void menu() {
 	printf("-c crypto   Search for specific crypto. <btc, eth> valid only w/ -m address\n");
 	printf("-C mini     Set the minikey Base only 22 character minikeys, ex: SRPqx8QiwnW4WNWnTVa2W5\n");
 	printf("-8 alpha    Set the bas58 alphabet for minikeys\n");
-	printf("-e          Enable endomorphism search (Only for address, rmd160 and vanity)\n");
+	printf("-e          Enable endomorphism search (Only for address, rmd160, vanity and bsgs)\n");
+	printf("            With bsgs it is a lottery over the whole group, the keys found are out of the range and it is slower\n");
 	printf("-f file     Specify file name with addresses or xpoints or uncompressed public keys\n");
 	printf("-I stride   Stride for xpoint, rmd160 and address, this option don't work with bsgs\n");
 	printf("-k value    Use this only with bsgs mode, k value is factor for M, more speed but more RAM use wisely\n");
 	printf("-l look     What type of address/hash160 are you looking for <compress, uncompress, both> Only for rmd160 and address\n");
+	printf("-P          With -l compress and without -e, calculate Y and hash only the prefix of its parity (not the keys n - k)\n");
 	printf("-m mode     mode of search for cryptos. (bsgs, xpoint, rmd160, address, vanity) default: address\n");
 	printf("-M          Matrix screen, feel like a h4x0r, but performance will dropped\n");
 	printf("-n number   Check for N sequential numbers before the random chosen, this only works with -R option\n");
@@ -6072,6 +5579,7 @@ void menu() {
 	printf("-S          S is for SAVING in files BSGS data (Bloom filters and bPtable)\n");
 	printf("-t tn       Threads number, must be a positive integer\n");
 	printf("-v value    Search for vanity Address, only with -m address and rmd160\n");
+	printf("-x n[:s]    Only bsgs and xpoint, one publickey Q in the file: search Q - i*s*G for i < n, s default 1\n");
 	printf("-z value    Bloom size multiplier, only address,rmd160,vanity, xpoint, value >= 1\n");
 	printf("\nExample:\n\n");
 	printf("./keyhunt -m rmd160 -f tests/unsolvedpuzzles.rmd -b 66 -l compress -R -q -t 8\n\n");
@@ -6110,11 +5618,14 @@ bool vanityrmdmatch(unsigned char *rmdhash)	{
 }
 
 void writevanitykey(bool compressed,Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writevanitykey_point(compressed,key,publickey);
+}
+
+void writevanitykey_point(bool compressed,Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,*hexrmd,public_key_hex[131],address[50],rmdhash[20];
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	secp->GetPublicKeyHex(compressed,publickey,public_key_hex);
 	
 	secp->GetHash160(P2PKH,compressed,publickey,(uint8_t*)rmdhash);
@@ -6296,17 +5807,30 @@ void checkpointer(void *ptr,const char *file,const char *function,const  char *n
 }
 
 void writekey(bool compressed,Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writekey_point(compressed,key,publickey);
+}
+
+void writekey_point(bool compressed,Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,*hexrmd,public_key_hex[132],address[50],rmdhash[20];
+	char address_p2sh[50],address_bech32[BECH32_P2WPKH_LENGTH + 1],scripthash[20],segwit[160];
 	memset(address,0,50);
 	memset(public_key_hex,0,132);
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	secp->GetPublicKeyHex(compressed,publickey,public_key_hex);
 	secp->GetHash160(P2PKH,compressed,publickey,(uint8_t*)rmdhash);
 	hexrmd = tohex(rmdhash,20);
 	rmd160toaddress_dst(rmdhash,address);
+	segwit[0] = '\0';
+	if(compressed && (FLAGP2SH || FLAGBECH32))	{
+		/* The same key in the segwit addresses */
+		memset(address_p2sh,0,50);
+		secp->GetHash160(P2SH,true,publickey,(uint8_t*)scripthash);
+		hash160toaddress_dst(0x05,scripthash,address_p2sh);
+		bech32_encode_p2wpkh(address_bech32,(uint8_t*)rmdhash);
+		snprintf(segwit,sizeof(segwit),"Address P2SH-P2WPKH %s\nAddress Bech32 %s\n",address_p2sh,address_bech32);
+	}
 
 #if defined(_WIN64) && !defined(__CYGWIN__)
 	WaitForSingleObject(write_keys, INFINITE);
@@ -6315,10 +5839,10 @@ void writekey(bool compressed,Int *key)	{
 #endif
 	keys = fopen("KEYFOUNDKEYFOUND.txt","a+");
 	if(keys != NULL)	{
-		fprintf(keys,"Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n",hextemp,public_key_hex,address,hexrmd);
+		fprintf(keys,"Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n%s",hextemp,public_key_hex,address,hexrmd,segwit);
 		fclose(keys);
 	}
-	printf("\nHit! Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n",hextemp,public_key_hex,address,hexrmd);
+	printf("\nHit! Private Key: %s\npubkey: %s\nAddress %s\nrmd160 %s\n%s",hextemp,public_key_hex,address,hexrmd,segwit);
 	
 #if defined(_WIN64) && !defined(__CYGWIN__)
 	ReleaseMutex(write_keys);
@@ -6330,11 +5854,14 @@ void writekey(bool compressed,Int *key)	{
 }
 
 void writekeyeth(Int *key)	{
-	Point publickey;
+	Point publickey = secp->ComputePublicKey(key);
+	writekeyeth_point(key,publickey);
+}
+
+void writekeyeth_point(Int *key,Point &publickey)	{
 	FILE *keys;
 	char *hextemp,address[43],hash[20];
 	hextemp = key->GetBase16();
-	publickey = secp->ComputePublicKey(key);
 	generate_binaddress_eth(publickey,(unsigned char*)hash);
 	address[0] = '0';
 	address[1] = 'x';
@@ -6450,9 +5977,11 @@ bool readFileAddress(char *fileName)	{
 	FILE *fileDescriptor;
 	char fileBloomName[30];	/* Actually it is Bloom and Table but just to keep the variable name short*/
 	uint8_t checksum[32],hexPrefix[9];
-	char dataChecksum[32],bloomChecksum[32];
+	char dataChecksum[32],bloomChecksum[32],indexChecksum[32],bloomMagic[8];
 	size_t bytesRead;
-	uint64_t dataSize;
+	uint64_t dataSize,indexSize,bloomEntries = 0,bloomBytes = 0;
+	uint32_t targets;
+	int i;
 	/*
 		if the FLAGSAVEREADFILE is Set to 1 we need to the checksum and check if we have that information already saved
 	*/
@@ -6464,6 +5993,12 @@ bool readFileAddress(char *fileName)	{
 		tohex_dst((char*)checksum,4,(char*)hexPrefix); // we save the prefix (last fourt bytes) hexadecimal value
 		snprintf(fileBloomName,30,"data_%s.dat",hexPrefix);
 		fileDescriptor = fopen(fileBloomName,"rb");
+		if(fileDescriptor != NULL && (fread(bloomMagic,1,8,fileDescriptor) != 8 || memcmp(bloomMagic,BLOOM_ADDRESS_MAGIC,8) != 0))	{
+			/* Files made before the 256 bloom filters have only one, it is made again */
+			fprintf(stderr,"[W] The file %s is from an older version, it will be made again\n",fileBloomName);
+			fclose(fileDescriptor);
+			fileDescriptor = NULL;
+		}
 		if(fileDescriptor != NULL)	{
 			printf("[+] Reading file %s\n",fileBloomName);
 		
@@ -6479,51 +6014,57 @@ bool readFileAddress(char *fileName)	{
 			//compare the expected bloom checksum againts the current bloom checksum
 			
 
-			//read bloom checksum (expected value to be checked)
-			bytesRead = fread(bloomChecksum,1,32,fileDescriptor);
-			if(bytesRead != 32)	{
-				fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			
-			//read bloom filter structure
-			bytesRead = fread(&bloom,1,sizeof(struct bloom),fileDescriptor);
-			if(bytesRead != sizeof(struct bloom))	{
-				fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			
-			printf("[+] Bloom filter for %" PRIu64 " elements.\n",bloom.entries);
-			
-			bloom.bf = (uint8_t*) malloc(bloom.bytes);
-			if(bloom.bf == NULL)	{
+			bloom_address = (struct bloom*) calloc(256,sizeof(struct bloom));
+			if(bloom_address == NULL)	{
 				fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
 				fclose(fileDescriptor);
 				return false;
 			}
+			for(i = 0; i < 256; i++)	{
+				//read bloom checksum (expected value to be checked)
+				bytesRead = fread(bloomChecksum,1,32,fileDescriptor);
+				if(bytesRead != 32)	{
+					fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
+				}
 
-			//read bloom filter data
-			bytesRead = fread(bloom.bf,1,bloom.bytes,fileDescriptor);
-			if(bytesRead != bloom.bytes)	{
-				fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				return false;
-			}
-			if(FLAGSKIPCHECKSUM == 0){
-				
-				//calculate checksum of the current readed data
-				sha256((uint8_t*)bloom.bf,bloom.bytes,(uint8_t*)checksum);
-				
-				//Compare checksums
-				if(memcmp(checksum,bloomChecksum,32) != 0)	{
-					fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+				//read bloom filter structure
+				bytesRead = fread(&bloom_address[i],1,sizeof(struct bloom),fileDescriptor);
+				if(bytesRead != sizeof(struct bloom))	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
+				}
+
+				bloom_address[i].bf = (uint8_t*) malloc(bloom_address[i].bytes);
+				if(bloom_address[i].bf == NULL)	{
+					fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					return false;
+				}
+
+				//read bloom filter data
+				bytesRead = fread(bloom_address[i].bf,1,bloom_address[i].bytes,fileDescriptor);
+				if(bytesRead != bloom_address[i].bytes)	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
 					fclose(fileDescriptor);
 					return false;
 				}
+				if(FLAGSKIPCHECKSUM == 0){
+					//calculate checksum of the current readed data and compare it
+					sha256((uint8_t*)bloom_address[i].bf,bloom_address[i].bytes,(uint8_t*)checksum);
+					if(memcmp(checksum,bloomChecksum,32) != 0)	{
+						fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+				}
+				bloomEntries += bloom_address[i].entries;
+				bloomBytes += bloom_address[i].bytes;
 			}
-			
+			printf("[+] Bloom filter for %" PRIu64 " elements: %.2f MB\n",bloomEntries,(double)(((double) bloomBytes)/(double)1048576));
+
 			bytesRead = fread(dataChecksum,1,32,fileDescriptor);
 			if(bytesRead != 32)	{
 				fprintf(stderr,"[E] Errore reading file, code line %i\n",__LINE__ - 2);
@@ -6563,7 +6104,48 @@ bool readFileAddress(char *fileName)	{
 					return false;
 				}
 			}
-			//printf("[D] bloom.bf points to %p\n",bloom.bf);
+			/* Files made before the bucket index don't have it, it is made again */
+			bytesRead = fread(indexChecksum,1,32,fileDescriptor);
+			if(bytesRead != 32)	{
+				printf("[+] Making the bucket index\n");
+				address_index_build();
+			}
+			else	{
+				bytesRead = fread(&indexSize,1,sizeof(uint64_t),fileDescriptor);
+				bytesRead += fread(&address_index_bits,1,sizeof(uint32_t),fileDescriptor);
+				if(bytesRead != sizeof(uint64_t) + sizeof(uint32_t))	{
+					fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 3);
+					fclose(fileDescriptor);
+					return false;
+				}
+				if(indexSize > 0)	{
+					address_index = (uint32_t*) malloc(indexSize);
+					if(address_index == NULL)	{
+						fprintf(stderr,"[E] Error allocating memory, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+					bytesRead = fread(address_index,1,indexSize,fileDescriptor);
+					if(bytesRead != indexSize || indexSize != ((1ULL << address_index_bits) + 1) * sizeof(uint32_t))	{
+						fprintf(stderr,"[E] Error reading file, code line %i\n",__LINE__ - 2);
+						fclose(fileDescriptor);
+						return false;
+					}
+					if(FLAGSKIPCHECKSUM == 0)	{
+						sha256((uint8_t*)address_index,indexSize,(uint8_t*)checksum);
+						if(memcmp(checksum,indexChecksum,32) != 0)	{
+							fprintf(stderr,"[E] Error checksum mismatch, code line %i\n",__LINE__ - 2);
+							fclose(fileDescriptor);
+							return false;
+						}
+					}
+				}
+				/* Files made before the segwit targets don't have the kinds of targets */
+				if(fread(&targets,1,sizeof(uint32_t),fileDescriptor) == sizeof(uint32_t))	{
+					FLAGP2SH = (targets & TARGETS_P2SH) != 0;
+					FLAGBECH32 = (targets & TARGETS_BECH32) != 0;
+				}
+			}
 			FLAGREADEDFILE1 = 1;	/* We mark the file as readed*/
 			fclose(fileDescriptor);
 			MAXLENGTHADDRESS = sizeof(struct address_value);
@@ -6601,257 +6183,375 @@ bool readFileAddress(char *fileName)	{
 	return true;
 }
 
-bool forceReadFileAddress(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	bool validAddress;
-	uint64_t numberItems,i;
-	size_t r,raw_value_length;
-	uint8_t rawvalue[50];
-	char aux[100],*hextemp;
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
+/*
+	The targets file is split in one chunk per thread at line boundaries and read from memory:
+	1. every thread counts the lines of its chunk, that is the room of its items
+	2. every thread parses its lines, the items are counted by first byte
+	3. the items are copied to addressTable grouped by first byte, the first byte is also the bloom filter
+	4. every thread sorts, removes the duplicates and fills the bloom filters of its own first bytes,
+	   one bloom filter is never shared between threads so the bits are set without locks
+	At the end addressTable is sorted and only the gaps of the removed duplicates are closed
+*/
+bool readFileTargets(char *fileName,int (*parse)(char *line,uint8_t *value))	{
+	char *data;
+	uint64_t size,lines,items,duplicates,bucket,offset;
+	int i,b,s,finished;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	HANDLE *tid;
+	DWORD t;
+#else
+	pthread_t *tid;
+#endif
+	if(!target_file_map(fileName,&data,&size))	{
+		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 1);
 		return false;
 	}
-
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r > 20)	{ 
-				numberItems++;
-			}
-		}
+	target_load_threads = (struct target_load*) calloc(NTHREADS,sizeof(struct target_load));
+	checkpointer((void *)target_load_threads,__FILE__,"calloc","target_load_threads" ,__LINE__ -1 );
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	tid = (HANDLE*) calloc(NTHREADS,sizeof(HANDLE));
+#else
+	tid = (pthread_t*) calloc(NTHREADS,sizeof(pthread_t));
+#endif
+	checkpointer((void *)tid,__FILE__,"calloc","tid" ,__LINE__ -1 );
+	target_load_data = data;
+	target_load_parse = parse;
+	offset = 0;
+	for(i = 0; i < NTHREADS; i++)	{
+		target_load_threads[i].threadid = i;
+		target_load_threads[i].from = offset;
+		offset = (i == NTHREADS - 1) ? size : (size / NTHREADS) * (i + 1);
+		if(offset < target_load_threads[i].from)	{
+			offset = target_load_threads[i].from;
+		}
+		while(offset < size && offset > 0 && data[offset - 1] != '\n')	{
+			offset++;
+		}
+		target_load_threads[i].to = offset;
+		target_load_threads[i].byte_from = (i * 256) / NTHREADS;
+		target_load_threads[i].byte_to = ((i + 1) * 256) / NTHREADS;
 	}
-	fseek(fileDescriptor,0,SEEK_SET);
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
-		
-	if(!initBloomFilter(&bloom,numberItems))
-		return false;
 
-	i = 0;
-	while(i < numberItems)	{
-		validAddress = false;
-		memset(aux,0,100);
-		memset(addressTable[i].value,0,sizeof(struct address_value));
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");			
-		r = strlen(aux);
-		if(r > 0 && r <= 40)	{
-			if(r<40 && isValidBase58String(aux))	{	//Address
-				raw_value_length = 25;
-				b58tobin(rawvalue,&raw_value_length,aux,r);
-				if(raw_value_length == 25)	{
-					//hextemp = tohex((char*)rawvalue+1,20);
-					bloom_add(&bloom, rawvalue+1 ,sizeof(struct address_value));
-					memcpy(addressTable[i].value,rawvalue+1,sizeof(struct address_value));											
-					i++;
-					validAddress = true;
+	for(target_load_phase = TARGET_LOAD_COUNT; target_load_phase <= TARGET_LOAD_SORT; target_load_phase++)	{
+		switch(target_load_phase)	{
+			case TARGET_LOAD_PARSE:
+				lines = 0;
+				for(i = 0; i < NTHREADS; i++)	{
+					target_load_threads[i].start = lines;
+					lines += target_load_threads[i].lines;
+				}
+				printf("[+] Reading %" PRIu64 " lines of %s with %i threads\n",lines,fileName,NTHREADS);
+				target_load_parsed = (struct address_value*) malloc(lines * sizeof(struct address_value) + 1);
+				checkpointer((void *)target_load_parsed,__FILE__,"malloc","target_load_parsed" ,__LINE__ -1 );
+			break;
+			case TARGET_LOAD_SCATTER:
+				/* Position of the first item of every first byte and thread in addressTable */
+				items = 0;
+				for(b = 0; b < 256; b++)	{
+					target_load_bucket[b] = items;
+					for(i = 0; i < NTHREADS; i++)	{
+						target_load_threads[i].position[b] = items;
+						items += target_load_threads[i].histogram[b];
+					}
 				}
+				target_load_bucket[256] = items;
+				printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",items,(double)(((double) sizeof(struct address_value)*items)/(double)1048576));
+				addressTable = (struct address_value*) malloc(sizeof(struct address_value)*items + 1);
+				checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
+			break;
+			case TARGET_LOAD_SORT:
+				free(target_load_parsed);
+				target_load_parsed = NULL;
+				target_file_unmap(data,size);
+				if(!initBloomAddress(items))	{
+					return false;
+				}
+			break;
+		}
+		for(i = 0; i < NTHREADS; i++)	{
+			target_load_threads[i].finished = 0;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			tid[i] = CreateThread(NULL, 0, thread_target_load, (void*) &target_load_threads[i], 0, &t);
+			s = (tid[i] == NULL);
+#else
+			s = pthread_create(&tid[i],NULL,thread_target_load,(void*) &target_load_threads[i]);
+#endif
+			if(s != 0)	{
+				fprintf(stderr,"[E] thread_target_load\n");
+				exit(EXIT_FAILURE);
 			}
-			if(r == 40 && isValidHex(aux))	{	//RMD
-				hexs2bin(aux,rawvalue);				
-				bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-				memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-				i++;
-				validAddress = true;
+		}
+		if(target_load_phase == TARGET_LOAD_PARSE)	{
+			do	{
+				finished = 1;
+				if(FLAGQUIET == 0)	{
+					printf("\r[+] Parsing:");
+				}
+				for(i = 0; i < NTHREADS; i++)	{
+					finished &= target_load_threads[i].finished;
+					if(FLAGQUIET == 0)	{
+						printf(" %i%%",(target_load_threads[i].to > target_load_threads[i].from) ? (int)((target_load_threads[i].parsed * 100) / (target_load_threads[i].to - target_load_threads[i].from)) : 100);
+					}
+				}
+				fflush(stdout);
+				if(!finished)	{
+					sleep_ms(500);
+				}
+			}while(!finished);
+			if(FLAGQUIET == 0)	{
+				printf("\n");
 			}
 		}
-		if(!validAddress)	{
-			fprintf(stderr,"[I] Ommiting invalid line %s\n",aux);
-			numberItems--;
+		for(i = 0; i < NTHREADS; i++)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+			WaitForSingleObject(tid[i],INFINITE);
+			CloseHandle(tid[i]);
+#else
+			pthread_join(tid[i],NULL);
+#endif
 		}
 	}
-	N = numberItems;
-	return true;
-}
 
-bool forceReadFileAddressEth(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	bool validAddress;
-	uint64_t numberItems,i;
-	size_t r;
-	uint8_t rawvalue[50];
-	char aux[100],*hextemp;
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
-		return false;
-	}
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r >= 40)	{ 
-				numberItems++;
-			}
+	/* Close the gaps of the removed duplicates */
+	offset = 0;
+	duplicates = 0;
+	for(b = 0; b < 256; b++)	{
+		bucket = target_load_bucket[b];
+		if(offset != bucket && target_load_count[b] > 0)	{
+			memmove(&addressTable[offset],&addressTable[bucket],target_load_count[b] * sizeof(struct address_value));
 		}
+		offset += target_load_count[b];
+		duplicates += (target_load_bucket[b + 1] - bucket) - target_load_count[b];
 	}
-	fseek(fileDescriptor,0,SEEK_SET);
+	N = offset;
+	printf("[+] %" PRIu64 " values were loaded and sorted, %" PRIu64 " duplicates removed\n",N,duplicates);
+	free(target_load_threads);
+	target_load_threads = NULL;
+	free(tid);
+	return true;
+}
 
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	N = numberItems;
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ -1 );
-	
-	
-	if(!initBloomFilter(&bloom,N))
-		return false;
-	
-	i = 0;
-	while(i < numberItems)	{
-		validAddress = false;
-		memset(aux,0,100);
-		memset(addressTable[i].value,0,sizeof(struct address_value));
-		hextemp = fgets(aux,100,fileDescriptor);
-		trim(aux," \t\n\r");			
-		r = strlen(aux);
-		if(r >= 40 && r <= 42){
-			switch(r)		{
-				case 40:
-					if(isValidHex(aux)){
-						hexs2bin(aux,rawvalue);
-						bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-						memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-						i++;
-						validAddress = true;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+DWORD WINAPI thread_target_load(LPVOID vargp) {
+#else
+void *thread_target_load(void *vargp)	{
+#endif
+	struct target_load *tl = (struct target_load *)vargp;
+	struct address_value *item;
+	char line[1024],*p,*end,*to;
+	uint64_t length,i,j,from,count;
+	int b;
+	p = target_load_data + tl->from;
+	to = target_load_data + tl->to;
+	switch(target_load_phase)	{
+		case TARGET_LOAD_COUNT:
+			tl->lines = 0;
+			while(p < to)	{
+				end = (char*) memchr(p,'\n',to - p);
+				tl->lines++;
+				p = (end == NULL) ? to : end + 1;
+			}
+		break;
+		case TARGET_LOAD_PARSE:
+			item = target_load_parsed + tl->start;
+			while(p < to)	{
+				end = (char*) memchr(p,'\n',to - p);
+				if(end == NULL)	{
+					end = to;
+				}
+				length = end - p;
+				if(length < sizeof(line))	{
+					memcpy(line,p,length);
+					line[length] = '\0';
+					trim(line," \t\n\r");
+					if(line[0] != '\0')	{
+						if(target_load_parse(line,item->value))	{
+							tl->histogram[item->value[0]]++;
+							item++;
+						}
+						else	{
+							fprintf(stderr,"[I] Ommiting invalid line %s\n",line);
+						}
 					}
-				break;
-				case 42:
-					if(isValidHex(aux+2)){
-						hexs2bin(aux+2,rawvalue);
-						bloom_add(&bloom, rawvalue ,sizeof(struct address_value));
-						memcpy(addressTable[i].value,rawvalue,sizeof(struct address_value));											
-						i++;
-						validAddress = true;
+				}
+				else	{
+					fprintf(stderr,"[I] Ommiting line of %" PRIu64 " bytes\n",length);
+				}
+				p = end + 1;
+				tl->parsed = (p < to ? p : to) - (target_load_data + tl->from);
+			}
+			tl->count = item - (target_load_parsed + tl->start);
+		break;
+		case TARGET_LOAD_SCATTER:
+			item = target_load_parsed + tl->start;
+			for(i = 0; i < tl->count; i++)	{
+				memcpy(&addressTable[tl->position[item[i].value[0]]++],&item[i],sizeof(struct address_value));
+			}
+		break;
+		case TARGET_LOAD_SORT:
+			for(b = tl->byte_from; b < tl->byte_to; b++)	{
+				from = target_load_bucket[b];
+				count = target_load_bucket[b + 1] - from;
+				item = addressTable + from;
+				if(count > 1)	{
+					_sort(item,count);
+				}
+				j = 0;
+				for(i = 0; i < count; i++)	{
+					if(j == 0 || memcmp(item[j - 1].value,item[i].value,sizeof(struct address_value)) != 0)	{
+						if(j != i)	{
+							memcpy(&item[j],&item[i],sizeof(struct address_value));
+						}
+						bloom_add(&bloom_address[b],item[j].value,MAXLENGTHADDRESS);
+						j++;
 					}
-				break;
+				}
+				target_load_count[b] = j;
 			}
+		break;
+	}
+	tl->finished = 1;
+	return NULL;
+}
+
+/*
+	The whole file in memory: mapped where there is mmap, else read in a buffer
+*/
+bool target_file_map(char *fileName,char **data,uint64_t *size)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	FILE *fd;
+	fd = fopen(fileName,"rb");
+	if(fd == NULL)	{
+		return false;
+	}
+	_fseeki64(fd,0,SEEK_END);
+	*size = _ftelli64(fd);
+	_fseeki64(fd,0,SEEK_SET);
+	*data = (char*) malloc(*size + 1);
+	checkpointer((void *)*data,__FILE__,"malloc","data" ,__LINE__ -1 );
+	if(fread(*data,1,*size,fd) != *size)	{
+		fclose(fd);
+		free(*data);
+		return false;
+	}
+	fclose(fd);
+	return true;
+#else
+	struct stat st;
+	int fd;
+	fd = open(fileName,O_RDONLY);
+	if(fd < 0)	{
+		return false;
+	}
+	if(fstat(fd,&st) != 0)	{
+		close(fd);
+		return false;
+	}
+	*size = st.st_size;
+	*data = NULL;
+	if(*size > 0)	{
+		*data = (char*) mmap(NULL,*size,PROT_READ,MAP_PRIVATE,fd,0);
+		if(*data == MAP_FAILED)	{
+			close(fd);
+			return false;
 		}
-		if(!validAddress)	{
-			fprintf(stderr,"[I] Ommiting invalid line %s\n",aux);
-			numberItems--;
-		}
+		madvise(*data,*size,MADV_SEQUENTIAL);
 	}
-	
-	fclose(fileDescriptor);
+	close(fd);
 	return true;
+#endif
 }
 
+void target_file_unmap(char *data,uint64_t size)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	free(data);
+#else
+	if(size > 0)	{
+		munmap(data,size);
+	}
+#endif
+}
 
-
-bool forceReadFileXPoint(char *fileName)	{
-	/* Here we read the original file as usual */
-	FILE *fileDescriptor;
-	uint64_t numberItems,i;
-	size_t r,lenaux;
-	uint8_t rawvalue[100];
-	char aux[1000],*hextemp;
-	Tokenizer tokenizer_xpoint;	//tokenizer
-	fileDescriptor = fopen(fileName,"r");	
-	if(fileDescriptor == NULL)	{
-		fprintf(stderr,"[E] Error opening the file %s, line %i\n",fileName,__LINE__ - 2);
-		return false;
+/*
+	Parsers of one trimmed line of the targets file, they return 1 and the 20 bytes of the table for a valid line
+*/
+int parse_target_address(char *line,uint8_t *value)	{
+	uint8_t rawvalue[50];
+	size_t r,raw_value_length;
+	r = strlen(line);
+	if(r == BECH32_P2WPKH_LENGTH && bech32_decode_p2wpkh(value,line))	{	//Bech32, the hash160 of the compressed key
+		FLAGBECH32 = 1;
+		return 1;
 	}
-	/*Count lines in the file*/
-	numberItems = 0;
-	while(!feof(fileDescriptor))	{
-		hextemp = fgets(aux,1000,fileDescriptor);
-		trim(aux," \t\n\r");
-		if(hextemp == aux)	{			
-			r = strlen(aux);
-			if(r >= 40)	{ 
-				numberItems++;
+	if(r < 40 && isValidBase58String(line))	{	//Address
+		raw_value_length = 25;
+		b58tobin(rawvalue,&raw_value_length,line,r);
+		if(raw_value_length == 25)	{
+			if(rawvalue[0] == 0x05)	{	//P2SH, the hash160 of the redeem script
+				FLAGP2SH = 1;
 			}
+			memcpy(value,rawvalue+1,20);
+			return 1;
 		}
 	}
-	fseek(fileDescriptor,0,SEEK_SET);
+	if(r == 40 && isValidHex(line))	{	//RMD
+		hexs2bin(line,value);
+		return 1;
+	}
+	return 0;
+}
 
-	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
-	
-	printf("[+] Allocating memory for %" PRIu64 " elements: %.2f MB\n",numberItems,(double)(((double) sizeof(struct address_value)*numberItems)/(double)1048576));
-	addressTable = (struct address_value*) malloc(sizeof(struct address_value)*numberItems);
-	checkpointer((void *)addressTable,__FILE__,"malloc","addressTable" ,__LINE__ - 1);
-	
-	N = numberItems;
-	
-	if(!initBloomFilter(&bloom,N))
-		return false;
-	
-	i = 0;
-	while(i < N)	{
-		memset(aux,0,1000);
-		hextemp = fgets(aux,1000,fileDescriptor);
-		memset((void *)&addressTable[i],0,sizeof(struct address_value));
-		if(hextemp == aux)	{
-			trim(aux," \t\n\r");
-			stringtokenizer(aux,&tokenizer_xpoint);
-			hextemp = nextToken(&tokenizer_xpoint);
-			lenaux = strlen(hextemp);
-			if(isValidHex(hextemp)) {
-				switch(lenaux)	{
-					case 64:	/*X value*/
-						r = hexs2bin(aux,(uint8_t*) rawvalue);
-						if(r)	{
-							memcpy(addressTable[i].value,rawvalue,20);
-							bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
-						}
-						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
-						}
-					break;
-					case 66:	/*Compress publickey*/
-						r = hexs2bin(aux+2, (uint8_t*)rawvalue);
-						if(r)	{
-							memcpy(addressTable[i].value,rawvalue,20);
-							bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
-						}
-						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
-						}
-					break;
-					case 130:	/* Uncompress publickey length*/
-						r = hexs2bin(aux, (uint8_t*) rawvalue);
-						if(r)	{
-								memcpy(addressTable[i].value,rawvalue+2,20);
-								bloom_add(&bloom,rawvalue,MAXLENGTHADDRESS);
-						}
-						else	{
-							fprintf(stderr,"[E] error hexs2bin\n");
-						}
-					break;
-					default:
-						fprintf(stderr,"[E] Omiting line unknow length size %li: %s\n",lenaux,aux);
-					break;
-				}
-			}
-			else	{
-				fprintf(stderr,"[E] Ignoring invalid hexvalue %s\n",aux);
-			}
-			freetokenizer(&tokenizer_xpoint);
-		}
-		else	{
-			fprintf(stderr,"[E] Omiting line : %s\n",aux);
-			N--;
-		}
-		i++;
+int parse_target_eth(char *line,uint8_t *value)	{
+	size_t r = strlen(line);
+	if(r == 42)	{		//0x prefix
+		line += 2;
+		r -= 2;
 	}
-	fclose(fileDescriptor);
-	return true;
+	if(r == 40 && isValidHex(line))	{
+		hexs2bin(line,value);
+		return 1;
+	}
+	return 0;
+}
+
+int parse_target_xpoint(char *line,uint8_t *value)	{
+	uint8_t rawvalue[65];
+	size_t lenaux;
+	lenaux = strcspn(line," \t:");		/* Only the first token */
+	line[lenaux] = '\0';
+	if(!isValidHex(line))	{
+		return 0;
+	}
+	switch(lenaux)	{
+		case 64:	/*X value*/
+			hexs2bin(line,rawvalue);
+			memcpy(value,rawvalue,20);
+			return 1;
+		case 66:	/*Compress publickey*/
+			hexs2bin(line+2,rawvalue);
+			memcpy(value,rawvalue,20);
+			return 1;
+		case 130:	/* Uncompress publickey length*/
+			hexs2bin(line,rawvalue);
+			memcpy(value,rawvalue+1,20);
+			return 1;
+	}
+	return 0;
+}
+
+bool forceReadFileAddress(char *fileName)	{
+	MAXLENGTHADDRESS = 20;		/*20 bytes beacuase we only need the data in binary*/
+	return readFileTargets(fileName,parse_target_address);
+}
+
+bool forceReadFileAddressEth(char *fileName)	{
+	MAXLENGTHADDRESS = 20;
+	return readFileTargets(fileName,parse_target_eth);
+}
+
+bool forceReadFileXPoint(char *fileName)	{
+	MAXLENGTHADDRESS = 20;
+	return readFileTargets(fileName,parse_target_xpoint);
 }
 
 
@@ -6878,15 +6578,42 @@ bool initBloomFilter(struct bloom *bloom_arg,uint64_t items_bloom)	{
 	return r;
 }
 
+/*
+	The targets of address, rmd160 and xpoint modes are in 256 bloom filters like the BSGS ones. The values
+	are hashes or X values, random enough to give items_bloom/256 items to each filter
+*/
+bool initBloomAddress(uint64_t items_bloom)	{
+	uint64_t items_shard,bytes = 0;
+	int i;
+	printf("[+] Bloom filter for %" PRIu64 " elements.\n",items_bloom);
+	items_shard = FLAGBLOOMMULTIPLIER * (items_bloom / 256 + 1);
+	if(items_shard < 1000)	{
+		items_shard = 1000;		/* Minimum of bloom_init2 */
+	}
+	bloom_address = (struct bloom*) calloc(256,sizeof(struct bloom));
+	checkpointer((void *)bloom_address,__FILE__,"calloc","bloom_address" ,__LINE__ -1 );
+	for(i = 0; i < 256; i++)	{
+		if(bloom_init2(&bloom_address[i],items_shard,0.000001) == 1)	{
+			fprintf(stderr,"[E] error bloom_init for %" PRIu64 " elements.\n",items_shard);
+			return false;
+		}
+		bytes += bloom_address[i].bytes;
+	}
+	printf("[+] Loading data to the bloomfilter total: %.2f MB\n",(double)(((double) bytes)/(double)1048576));
+	return true;
+}
+
 void writeFileIfNeeded(const char *fileName)	{
 	//printf("[D] FLAGSAVEREADFILE %i, FLAGREADEDFILE1 %i\n",FLAGSAVEREADFILE,FLAGREADEDFILE1);
-	if(FLAGSAVEREADFILE && !FLAGREADEDFILE1)	{
+	if(FLAGSAVEREADFILE && !FLAGREADEDFILE1 && !FLAGSUBTRACT)	{
 		FILE *fileDescriptor;
 		char fileBloomName[30];
 		uint8_t checksum[32],hexPrefix[9];
-		char dataChecksum[32],bloomChecksum[32];
+		char dataChecksum[32],bloomChecksum[32],indexChecksum[32];
 		size_t bytesWrite;
-		uint64_t dataSize;
+		uint64_t dataSize,indexSize;
+		uint32_t targets;
+		int i;
 		if(!sha256_file((const char*)fileName,checksum)){
 			fprintf(stderr,"[E] sha256_file error line %i\n",__LINE__ - 1);
 			exit(EXIT_FAILURE);
@@ -6914,31 +6641,34 @@ void writeFileIfNeeded(const char *fileName)	{
 			
 			
 
-			sha256((uint8_t*)bloom.bf,bloom.bytes,(uint8_t*)bloomChecksum);
-			printf(".");
-			bytesWrite = fwrite(bloomChecksum,1,32,fileDescriptor);
-			if(bytesWrite != 32)	{
+			bytesWrite = fwrite(BLOOM_ADDRESS_MAGIC,1,8,fileDescriptor);
+			if(bytesWrite != 8)	{
 				fprintf(stderr,"[E] Errore writing file, code line %i\n",__LINE__ - 2);
 				exit(EXIT_FAILURE);
 			}
-			printf(".");
-			
-			bytesWrite = fwrite(&bloom,1,sizeof(struct bloom),fileDescriptor);
-			if(bytesWrite != sizeof(struct bloom))	{
-				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
-				exit(EXIT_FAILURE);
-			}
-			printf(".");
-			
-			bytesWrite = fwrite(bloom.bf,1,bloom.bytes,fileDescriptor);
-			if(bytesWrite != bloom.bytes)	{
-				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
-				fclose(fileDescriptor);
-				exit(EXIT_FAILURE);
+			for(i = 0; i < 256; i++)	{
+				sha256((uint8_t*)bloom_address[i].bf,bloom_address[i].bytes,(uint8_t*)bloomChecksum);
+				bytesWrite = fwrite(bloomChecksum,1,32,fileDescriptor);
+				if(bytesWrite != 32)	{
+					fprintf(stderr,"[E] Errore writing file, code line %i\n",__LINE__ - 2);
+					exit(EXIT_FAILURE);
+				}
+
+				bytesWrite = fwrite(&bloom_address[i],1,sizeof(struct bloom),fileDescriptor);
+				if(bytesWrite != sizeof(struct bloom))	{
+					fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+					exit(EXIT_FAILURE);
+				}
+
+				bytesWrite = fwrite(bloom_address[i].bf,1,bloom_address[i].bytes,fileDescriptor);
+				if(bytesWrite != bloom_address[i].bytes)	{
+					fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+					fclose(fileDescriptor);
+					exit(EXIT_FAILURE);
+				}
 			}
 			printf(".");
-						
-			
+
 			sha256((uint8_t*)addressTable,dataSize,(uint8_t*)dataChecksum);
 			printf(".");
 
@@ -6962,6 +6692,27 @@ void writeFileIfNeeded(const char *fileName)	{
 				exit(EXIT_FAILURE);
 			}
 			printf(".");
+
+			/* Bucket index, size 0 if there is no index */
+			indexSize = (address_index != NULL) ? ((1ULL << address_index_bits) + 1) * sizeof(uint32_t) : 0;
+			sha256((uint8_t*)address_index,indexSize,(uint8_t*)indexChecksum);
+			bytesWrite = fwrite(indexChecksum,1,32,fileDescriptor);
+			bytesWrite += fwrite(&indexSize,1,sizeof(uint64_t),fileDescriptor);
+			bytesWrite += fwrite(&address_index_bits,1,sizeof(uint32_t),fileDescriptor);
+			if(indexSize > 0)	{
+				bytesWrite += fwrite(address_index,1,indexSize,fileDescriptor);
+			}
+			if(bytesWrite != 32 + sizeof(uint64_t) + sizeof(uint32_t) + indexSize)	{
+				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 6);
+				exit(EXIT_FAILURE);
+			}
+			targets = (FLAGP2SH ? TARGETS_P2SH : 0) | (FLAGBECH32 ? TARGETS_BECH32 : 0);
+			bytesWrite = fwrite(&targets,1,sizeof(uint32_t),fileDescriptor);
+			if(bytesWrite != sizeof(uint32_t))	{
+				fprintf(stderr,"[E] Error writing file, code line %i\n",__LINE__ - 2);
+				exit(EXIT_FAILURE);
+			}
+			printf(".");
 			
 			FLAGREADEDFILE1 = 1;	
 			fclose(fileDescriptor);		
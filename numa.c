@@ -0,0 +1,211 @@
+#if defined(__linux__) && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if defined(_WIN64) && !defined(__CYGWIN__)
+#include <windows.h>
+#else
+#include <unistd.h>
+#include <sys/mman.h>
+#endif
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+
+#include "numa.h"
+
+#define NUMA_MPOL_BIND 2
+#define NUMA_MPOL_INTERLEAVE 3
+#define NUMA_MPOL_MF_MOVE 2
+
+static int nodes_count = 1;
+#if defined(__linux__)
+static int nodes_id[NUMA_MAX_NODES];
+static cpu_set_t nodes_cpus[NUMA_MAX_NODES];
+static unsigned long nodes_mask = 0;
+
+/*
+	cpulist of sysfs, like 0-15,32-47
+*/
+static int numa_cpulist(const char *str,cpu_set_t *set)	{
+	char *end;
+	long from,to,cpu;
+	int count = 0;
+	CPU_ZERO(set);
+	while(*str != '\0' && *str != '\n')	{
+		from = strtol(str,&end,10);
+		if(end == str)
+			break;
+		to = from;
+		if(*end == '-')	{
+			str = end + 1;
+			to = strtol(str,&end,10);
+		}
+		for(cpu = from; cpu <= to && cpu < CPU_SETSIZE; cpu++)	{
+			CPU_SET(cpu,set);
+			count++;
+		}
+		str = (*end == ',') ? end + 1 : end;
+	}
+	return count;
+}
+
+static long numa_mbind(void *ptr,uint64_t bytes,int mode,unsigned long mask)	{
+	uintptr_t page = (uintptr_t) sysconf(_SC_PAGESIZE);
+	uintptr_t from = ((uintptr_t)ptr + page - 1) & ~(page - 1);
+	uintptr_t to = ((uintptr_t)ptr + bytes) & ~(page - 1);
+	/* Only the whole pages inside of the range, the others can be shared with other data */
+	if(to <= from)
+		return 0;
+	return syscall(SYS_mbind,(void*)from,to - from,mode,&mask,NUMA_MAX_NODES + 1,NUMA_MPOL_MF_MOVE);
+}
+#endif
+
+/*
+	Nodes with CPUs, returns the number of them
+*/
+int numa_nodes_init()	{
+#if defined(__linux__)
+	char path[128],line[4096];
+	FILE *fd;
+	int id;
+	nodes_count = 0;
+	nodes_mask = 0;
+	for(id = 0; id < NUMA_MAX_NODES; id++)	{
+		snprintf(path,sizeof(path),"/sys/devices/system/node/node%i/cpulist",id);
+		fd = fopen(path,"r");
+		if(fd == NULL)
+			continue;
+		if(fgets(line,sizeof(line),fd) != NULL && numa_cpulist(line,&nodes_cpus[nodes_count]) > 0)	{
+			nodes_id[nodes_count] = id;
+			nodes_mask |= 1UL << id;
+			nodes_count++;
+		}
+		fclose(fd);
+	}
+	if(nodes_count == 0)	{
+		/* No sysfs, one node with everything */
+		nodes_count = 1;
+		nodes_id[0] = 0;
+		nodes_mask = 0;
+		CPU_ZERO(&nodes_cpus[0]);
+	}
+#endif
+	return nodes_count;
+}
+
+int numa_nodes_count()	{
+	return nodes_count;
+}
+
+/*
+	-1 if the mode is unknow
+*/
+int numa_mode_parse(const char *str)	{
+	if(strcmp(str,"none") == 0)
+		return NUMA_NONE;
+	if(strcmp(str,"interleave") == 0)
+		return NUMA_INTERLEAVE;
+	if(strcmp(str,"replicate") == 0)
+		return NUMA_REPLICATE;
+	return -1;
+}
+
+/*
+	Consecutive threads in the same node, so each node have its own pool of threads
+*/
+int numa_node_of_thread(int thread,int threads)	{
+	if(threads <= 0)
+		return 0;
+	return (int)(((int64_t)thread * nodes_count) / threads);
+}
+
+/*
+	Pin the calling thread to the CPUs of the node, or to the CPUs of all the nodes with node -1. 0 on success.
+	The threads created after it start in the same CPUs
+*/
+int numa_pin(int node)	{
+#if defined(__linux__)
+	cpu_set_t all;
+	int i;
+	if(node < 0)	{
+		CPU_ZERO(&all);
+		for(i = 0; i < nodes_count; i++)	{
+			CPU_OR(&all,&all,&nodes_cpus[i]);
+		}
+		if(CPU_COUNT(&all) == 0)
+			return -1;
+		return pthread_setaffinity_np(pthread_self(),sizeof(cpu_set_t),&all);
+	}
+	if(node >= nodes_count || CPU_COUNT(&nodes_cpus[node]) == 0)
+		return -1;
+	return pthread_setaffinity_np(pthread_self(),sizeof(cpu_set_t),&nodes_cpus[node]);
+#else
+	return -1;
+#endif
+}
+
+/*
+	The pages not touched yet are placed round robin over the nodes, the touched ones are moved
+*/
+void numa_interleave_range(void *ptr,uint64_t bytes)	{
+#if defined(__linux__)
+	if(nodes_mask != 0)	{
+		numa_mbind(ptr,bytes,NUMA_MPOL_INTERLEAVE,nodes_mask);
+	}
+#endif
+}
+
+/*
+	Memory of one node for the replicas, free it with numa_free_node
+*/
+void *numa_alloc_node(uint64_t bytes,int node)	{
+	void *ptr;
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	ptr = malloc(bytes);
+	if(ptr == NULL)
+		return NULL;
+#else
+	ptr = mmap(NULL,bytes,PROT_READ | PROT_WRITE,MAP_PRIVATE | MAP_ANONYMOUS,-1,0);
+	if(ptr == MAP_FAILED)
+		return NULL;
+#endif
+#if defined(__linux__)
+	if(nodes_mask != 0 && node >= 0 && node < nodes_count)	{
+		numa_mbind(ptr,bytes,NUMA_MPOL_BIND,1UL << nodes_id[node]);
+	}
+#endif
+	return ptr;
+}
+
+void numa_free_node(void *ptr,uint64_t bytes)	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	free(ptr);
+#else
+	munmap(ptr,bytes);
+#endif
+}
+
+/*
+	Free RAM right now, 0 if the system don't tell it
+*/
+uint64_t numa_available_bytes()	{
+#if defined(_WIN64) && !defined(__CYGWIN__)
+	MEMORYSTATUSEX status;
+	status.dwLength = sizeof(status);
+	if(GlobalMemoryStatusEx(&status))
+		return (uint64_t)status.ullAvailPhys;
+#elif defined(_SC_AVPHYS_PAGES)
+	long pages = sysconf(_SC_AVPHYS_PAGES);
+	long page = sysconf(_SC_PAGESIZE);
+	if(pages > 0 && page > 0)
+		return (uint64_t)pages * (uint64_t)page;
+#endif
+	return 0;
+}
@@ -0,0 +1,35 @@
+#ifndef CUSTOMNUMAH
+#define CUSTOMNUMAH
+
+/*
+	NUMA placement without libnuma: node CPUs from /sys/devices/system/node and memory policy with mbind.
+	On other systems or without /sys there is only one node and all of this do nothing
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define NUMA_NONE 0
+#define NUMA_INTERLEAVE 1		/* Pages of the tables spread over all the nodes */
+#define NUMA_REPLICATE 2		/* One copy of the 1st bloom filter in each node, the rest interleaved */
+
+#define NUMA_MAX_NODES 64
+
+int numa_nodes_init();
+int numa_nodes_count();
+int numa_mode_parse(const char *str);
+int numa_node_of_thread(int thread,int threads);
+int numa_pin(int node);
+void numa_interleave_range(void *ptr,uint64_t bytes);
+void *numa_alloc_node(uint64_t bytes,int node);
+void numa_free_node(void *ptr,uint64_t bytes);
+uint64_t numa_available_bytes();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -169,6 +169,27 @@ bool Secp256K1::ParsePublicKeyHex(char *str,Point &ret,bool &isCompressed) {
   return true;
 }
 
+// Binary form of GetPublicKeyRaw, silent: 33 bytes 02/03 and X or 65 bytes 04, X and Y
+bool Secp256K1::ParsePublicKeyRaw(unsigned char *data,Point &ret,bool &isCompressed) {
+  ret.Clear();
+  ret.x.Set32Bytes(data + 1);
+  switch (data[0]) {
+    case 0x02:
+    case 0x03:
+      ret.y = GetY(ret.x, data[0] == 0x02);
+      isCompressed = true;
+      break;
+    case 0x04:
+      ret.y.Set32Bytes(data + 33);
+      isCompressed = false;
+      break;
+    default:
+      return false;
+  }
+  ret.z.SetInt32(1);
+  return EC(ret);
+}
+
 char* Secp256K1::GetPublicKeyHex(bool compressed, Point &pubKey) {
   unsigned char publicKeyBytes[65];
   char *ret = NULL;
@@ -264,6 +285,95 @@ Point Secp256K1::AddDirect(Point &p1,Point &p2) {
   return r;
 }
 
+/*
+  out[k] = center + (k - size/2)*S for k = 0 .. size-1, table[i] = (i+1)*S for i < size/2.
+  center + i*S and center - i*S have the same delta x, so one batched inversion of
+  size/2 + 1 values covers all the points, grp must be an IntGroup(size/2 + 1) set on dx.
+  If next is not NULL the center is moved to center + next with the same inversion.
+  The Y of out is only calculated with calculate_y, the new center always has it.
+*/
+void Secp256K1::AddDirectBatch(Point &center,Point *table,Point *next,int size,Point *out,bool calculate_y,IntGroup *grp,Int *dx) {
+  Int _s;
+  Int _p;
+  Int dy;
+  Point *pp;
+  Point *pn;
+  int i;
+  int half = size / 2;
+
+  for(i = 0; i < half; i++) {
+    dx[i].ModSub(&table[i].x,&center.x);
+  }
+  if(next != NULL) {
+    dx[half].ModSub(&next->x,&center.x);
+  }
+  else {
+    dx[half].SetInt32(1);
+  }
+  grp->ModInv();
+
+  out[half] = center;
+  for(i = 0; i < half - 1; i++) {
+    pp = &out[half + i + 1];
+    pn = &out[half - i - 1];
+
+    // center + (i+1)*S
+    dy.ModSub(&table[i].y,&center.y);
+    _s.ModMulK1(&dy,&dx[i]);       // s = (p2.y-p1.y)*inverse(p2.x-p1.x);
+    _p.ModSquareK1(&_s);           // _p = pow2(s)
+
+    pp->x.ModSub(&_p,&center.x);
+    pp->x.ModSub(&table[i].x);     // rx = pow2(s) - p1.x - p2.x;
+    if(calculate_y) {
+      pp->y.ModSub(&table[i].x,&pp->x);
+      pp->y.ModMulK1(&_s);
+      pp->y.ModSub(&table[i].y);   // ry = - p2.y - s*(ret.x-p2.x);
+    }
+
+    // center - (i+1)*S, if (x,y) = i*S then (x,-y) = -i*S
+    dy.ModAdd(&table[i].y,&center.y);
+    dy.ModNeg();
+    _s.ModMulK1(&dy,&dx[i]);
+    _p.ModSquareK1(&_s);
+
+    pn->x.ModSub(&_p,&center.x);
+    pn->x.ModSub(&table[i].x);
+    if(calculate_y) {
+      pn->y.ModSub(&table[i].x,&pn->x);
+      pn->y.ModMulK1(&_s);
+      pn->y.ModAdd(&table[i].y);
+    }
+  }
+
+  // First point center - (size/2)*S
+  pn = &out[0];
+  dy.ModAdd(&table[i].y,&center.y);
+  dy.ModNeg();
+  _s.ModMulK1(&dy,&dx[i]);
+  _p.ModSquareK1(&_s);
+
+  pn->x.ModSub(&_p,&center.x);
+  pn->x.ModSub(&table[i].x);
+  if(calculate_y) {
+    pn->y.ModSub(&table[i].x,&pn->x);
+    pn->y.ModMulK1(&_s);
+    pn->y.ModAdd(&table[i].y);
+  }
+
+  if(next != NULL) {
+    dy.ModSub(&next->y,&center.y);
+    _s.ModMulK1(&dy,&dx[half]);
+    _p.ModSquareK1(&_s);
+
+    _p.ModSub(&center.x);
+    center.x.ModSub(&_p,&next->x);   // rx = pow2(s) - p1.x - p2.x;
+
+    center.y.ModSub(&next->x,&center.x);
+    center.y.ModMulK1(&_s);
+    center.y.ModSub(&next->y);       // ry = - p2.y - s*(ret.x-p2.x);
+  }
+}
+
 
 Point Secp256K1::Add2(Point &p1, Point &p2) {
   // P2.z = 1
@@ -489,6 +599,7 @@ bool Secp256K1::EC(Point &p) {
 Point Secp256K1::ScalarMultiplication(Point &P,Int *scalar)	{
 	Point R,Q,T;
 	int  no_of_bits, loop;
+	bool empty = true;	//R is still the point at infinity, Add can't take it
 	no_of_bits = scalar->GetBitLength();
 	R.Clear();
 	R.z.SetInt32(1);
@@ -496,13 +607,20 @@ Point Secp256K1::ScalarMultiplication(Point &P,Int *scalar)	{
 		Q.Set(P);
 		if(scalar->GetBit(0) == 1)	{
 			R.Set(P);
+			empty = false;
 		}
 		for(loop = 1; loop < no_of_bits; loop++) {
 			T = Double(Q);
 			Q.Set(T);
 			T.Set(R);
 			if(scalar->GetBit(loop)){
-				R = Add(T,Q);
+				if(empty)	{
+					R.Set(Q);
+					empty = false;
+				}
+				else	{
+					R = Add(T,Q);
+				}
 			}
 		}
 	}
@@ -647,25 +765,82 @@ void Secp256K1::GetHash160(int type,bool compressed,
     unsigned char kh3[20];
 
     GetHash160(P2PKH,compressed,k0,k1,k2,k3,kh0,kh1,kh2,kh3);
+    GetHash160_P2SH(kh0,kh1,kh2,kh3,h0,h1,h2,h3);
 
-    // Redeem Script (1 to 1 P2SH)
-    uint32_t b0[16];
-    uint32_t b1[16];
-    uint32_t b2[16];
-    uint32_t b3[16];
+  }
+  break;
+
+  }
+}
 
-    KEYBUFFSCRIPT(b0, kh0);
-    KEYBUFFSCRIPT(b1, kh1);
-    KEYBUFFSCRIPT(b2, kh2);
-    KEYBUFFSCRIPT(b3, kh3);
+// Compressed and uncompressed Hash160 of 4 keys with y already known: only the prefix of the
+// parity of y is hashed, and the X words are serialized once for both messages.
+// hc and hu get the 4 hashes of 20 bytes one after the other
+void Secp256K1::GetHash160_both(Point &k0,Point &k1,Point &k2,Point &k3,uint8_t *hc,uint8_t *hu) {
 
-    sha256sse_1B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
-    ripemd160sse_32(sh0, sh1, sh2, sh3, h0, h1, h2, h3);
+#ifdef WIN64
+  __declspec(align(16)) unsigned char sh0[64];
+  __declspec(align(16)) unsigned char sh1[64];
+  __declspec(align(16)) unsigned char sh2[64];
+  __declspec(align(16)) unsigned char sh3[64];
+#else
+  unsigned char sh0[64] __attribute__((aligned(16)));
+  unsigned char sh1[64] __attribute__((aligned(16)));
+  unsigned char sh2[64] __attribute__((aligned(16)));
+  unsigned char sh3[64] __attribute__((aligned(16)));
+#endif
 
+  uint32_t u[4][32];
+  uint32_t c[4][16];
+  Point *k[4] = {&k0,&k1,&k2,&k3};
+
+  for (int i = 0; i < 4; i++) {
+    KEYBUFFUNCOMP(u[i], *k[i]);
+    // Words 1 to 7 are the same X bytes, only the prefix and the last X byte change
+    c[i][0] = (u[i][0] & 0x00FFFFFF) | ((uint32_t)(0x2 + k[i]->y.IsOdd()) << 24);
+    memcpy(&c[i][1],&u[i][1],7 * sizeof(uint32_t));
+    c[i][8] = 0x00800000 | (u[i][8] & 0xFF000000);
+    memset(&c[i][9],0,6 * sizeof(uint32_t));
+    c[i][15] = 0x108;
   }
-  break;
 
-  }
+  sha256sse_1B(c[0], c[1], c[2], c[3], sh0, sh1, sh2, sh3);
+  ripemd160sse_32(sh0, sh1, sh2, sh3, hc, hc + 20, hc + 40, hc + 60);
+  sha256sse_2B(u[0], u[1], u[2], u[3], sh0, sh1, sh2, sh3);
+  ripemd160sse_32(sh0, sh1, sh2, sh3, hu, hu + 20, hu + 40, hu + 60);
+
+}
+
+// Hash160 of the P2SH-P2WPKH redeem script (OP_0 PUSH20 keyhash) of 4 keyhashes,
+// the P2SH address of a compressed key without the key
+void Secp256K1::GetHash160_P2SH(uint8_t *k0,uint8_t *k1,uint8_t *k2,uint8_t *k3,
+  uint8_t *h0,uint8_t *h1,uint8_t *h2,uint8_t *h3) {
+
+#ifdef WIN64
+  __declspec(align(16)) unsigned char sh0[64];
+  __declspec(align(16)) unsigned char sh1[64];
+  __declspec(align(16)) unsigned char sh2[64];
+  __declspec(align(16)) unsigned char sh3[64];
+#else
+  unsigned char sh0[64] __attribute__((aligned(16)));
+  unsigned char sh1[64] __attribute__((aligned(16)));
+  unsigned char sh2[64] __attribute__((aligned(16)));
+  unsigned char sh3[64] __attribute__((aligned(16)));
+#endif
+
+  uint32_t b0[16];
+  uint32_t b1[16];
+  uint32_t b2[16];
+  uint32_t b3[16];
+
+  KEYBUFFSCRIPT(b0, k0);
+  KEYBUFFSCRIPT(b1, k1);
+  KEYBUFFSCRIPT(b2, k2);
+  KEYBUFFSCRIPT(b3, k3);
+
+  sha256sse_1B(b0, b1, b2, b3, sh0, sh1, sh2, sh3);
+  ripemd160sse_32(sh0, sh1, sh2, sh3, h0, h1, h2, h3);
+
 }
 
 
@@ -780,8 +955,13 @@ void Secp256K1::GetHash160_fromX(int type,unsigned char prefix,
 
   case P2SH:
   {
-	fprintf(stderr,"[E] Fixme unsopported case");
-	exit(0);
+    unsigned char kh0[20];
+    unsigned char kh1[20];
+    unsigned char kh2[20];
+    unsigned char kh3[20];
+
+    GetHash160_fromX(P2PKH,prefix,k0,k1,k2,k3,kh0,kh1,kh2,kh3);
+    GetHash160_P2SH(kh0,kh1,kh2,kh3,h0,h1,h2,h3);
   }
   break;
 
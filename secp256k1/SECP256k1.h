@@ -19,6 +19,7 @@
 #define SECP256K1H
 
 #include "Point.h"
+#include "IntGroup.h"
 #include <vector>
 
 // Address type
@@ -47,6 +48,7 @@ public:
   void GetPublicKeyRaw(bool compressed, Point &pubKey,char *dst);
   
   bool ParsePublicKeyHex(char *str,Point &p,bool &isCompressed);
+  bool ParsePublicKeyRaw(unsigned char *data,Point &p,bool &isCompressed);
 
   void GetHash160(int type,bool compressed,
     Point &k0, Point &k1, Point &k2, Point &k3,
@@ -58,10 +60,16 @@ public:
   Int *k0,Int *k1,Int *k2,Int *k3,
   uint8_t *h0,uint8_t *h1,uint8_t *h2,uint8_t *h3);
 
+  void GetHash160_P2SH(uint8_t *k0,uint8_t *k1,uint8_t *k2,uint8_t *k3,
+  uint8_t *h0,uint8_t *h1,uint8_t *h2,uint8_t *h3);
+
+  void GetHash160_both(Point &k0,Point &k1,Point &k2,Point &k3,uint8_t *hc,uint8_t *hu);
+
 
   Point Add(Point &p1, Point &p2);
   Point Add2(Point &p1, Point &p2);
   Point AddDirect(Point &p1, Point &p2);
+  void AddDirectBatch(Point &center,Point *table,Point *next,int size,Point *out,bool calculate_y,IntGroup *grp,Int *dx);
   Point Double(Point &p);
   Point DoubleDirect(Point &p);
   Point Negation(Point &p);
@@ -0,0 +1,179 @@
+/*
+	Lane parallel Keccak-256 for ETH addresses, same rounds of keccak.c but every
+	uint64_t of the state is a vector with one lane per publickey.
+
+	The input is always 64 bytes, so there is only one block: words 0 to 7 are the
+	publickey, word 8 gets the 0x01 padding of Keccak (not SHA3) and word 16 the final 0x80
+	of the 136 bytes rate. The address is the bytes 12 to 31 of the hash.
+*/
+
+#include <string.h>
+
+#include "keccak.h"
+#include "keccak_batch.h"
+
+static inline uint64_t le64dec_batch(const uint8_t *p)	{
+	return (((uint64_t)p[0]) | ((uint64_t)p[1] << 8) | ((uint64_t)p[2] << 16) | ((uint64_t)p[3] << 24) |
+		((uint64_t)p[4] << 32) | ((uint64_t)p[5] << 40) | ((uint64_t)p[6] << 48) | ((uint64_t)p[7] << 56));
+}
+
+static inline void le64enc_batch(uint8_t *p,uint64_t v,int from)	{
+	int i;
+	for(i = 0; i < 8; i++)	{
+		if(i >= from)	{
+			p[i - from] = (uint8_t)(v >> (8*i));
+		}
+	}
+}
+
+#if defined(__GNUC__) || defined(__clang__)
+
+#if defined(__AVX512F__)
+#define KECCAK_LANES 8
+#elif defined(__AVX2__)
+#define KECCAK_LANES 4
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(__SSE2__)
+#define KECCAK_LANES 2
+#else
+#define KECCAK_LANES 4		/* No SIMD, the compiler makes scalar code with 4 independent states */
+#endif
+
+typedef uint64_t kvec __attribute__((vector_size(8 * KECCAK_LANES)));
+
+static const uint64_t RC[24] = {
+	0x0000000000000001ULL, 0x0000000000008082ULL, 0x800000000000808aULL, 0x8000000080008000ULL,
+	0x000000000000808bULL, 0x0000000080000001ULL, 0x8000000080008081ULL, 0x8000000000008009ULL,
+	0x000000000000008aULL, 0x0000000000000088ULL, 0x0000000080008009ULL, 0x000000008000000aULL,
+	0x000000008000808bULL, 0x800000000000008bULL, 0x8000000000008089ULL, 0x8000000000008003ULL,
+	0x8000000000008002ULL, 0x8000000000000080ULL, 0x000000000000800aULL, 0x800000008000000aULL,
+	0x8000000080008081ULL, 0x8000000000008080ULL, 0x0000000080000001ULL, 0x8000000080008008ULL
+};
+
+#define ROL(v,c) (((v) << (c)) | ((v) >> (64 - (c))))
+
+#define FOR5(X,STMT) do { (X) = 0; STMT; (X) = 1; STMT; (X) = 2; STMT; (X) = 3; STMT; (X) = 4; STMT; } while(0)
+
+static inline void keccakf1600_batch(kvec A[25])	{
+	kvec C0,C1,C2,C3,C4,B0,B1,B2,B3,B4,T,U;
+	unsigned i,y;
+	for(i = 0; i < 24; i++)	{
+		/* Theta */
+		C0 = A[0] ^ A[5] ^ A[10] ^ A[15] ^ A[20];
+		C1 = A[1] ^ A[6] ^ A[11] ^ A[16] ^ A[21];
+		C2 = A[2] ^ A[7] ^ A[12] ^ A[17] ^ A[22];
+		C3 = A[3] ^ A[8] ^ A[13] ^ A[18] ^ A[23];
+		C4 = A[4] ^ A[9] ^ A[14] ^ A[19] ^ A[24];
+		B0 = C4 ^ ROL(C1,1);
+		B1 = C0 ^ ROL(C2,1);
+		B2 = C1 ^ ROL(C3,1);
+		B3 = C2 ^ ROL(C4,1);
+		B4 = C3 ^ ROL(C0,1);
+		FOR5(y,{
+			A[0 + 5*y] ^= B0;
+			A[1 + 5*y] ^= B1;
+			A[2 + 5*y] ^= B2;
+			A[3 + 5*y] ^= B3;
+			A[4 + 5*y] ^= B4;
+		});
+		/* Rho and Pi, same order of keccak.c */
+		T = A[ 1];
+		U = A[10]; A[10] = ROL(T, 1); T = U;
+		U = A[ 7]; A[ 7] = ROL(T, 3); T = U;
+		U = A[11]; A[11] = ROL(T, 6); T = U;
+		U = A[17]; A[17] = ROL(T,10); T = U;
+		U = A[18]; A[18] = ROL(T,15); T = U;
+		U = A[ 3]; A[ 3] = ROL(T,21); T = U;
+		U = A[ 5]; A[ 5] = ROL(T,28); T = U;
+		U = A[16]; A[16] = ROL(T,36); T = U;
+		U = A[ 8]; A[ 8] = ROL(T,45); T = U;
+		U = A[21]; A[21] = ROL(T,55); T = U;
+		U = A[24]; A[24] = ROL(T, 2); T = U;
+		U = A[ 4]; A[ 4] = ROL(T,14); T = U;
+		U = A[15]; A[15] = ROL(T,27); T = U;
+		U = A[23]; A[23] = ROL(T,41); T = U;
+		U = A[19]; A[19] = ROL(T,56); T = U;
+		U = A[13]; A[13] = ROL(T, 8); T = U;
+		U = A[12]; A[12] = ROL(T,25); T = U;
+		U = A[ 2]; A[ 2] = ROL(T,43); T = U;
+		U = A[20]; A[20] = ROL(T,62); T = U;
+		U = A[14]; A[14] = ROL(T,18); T = U;
+		U = A[22]; A[22] = ROL(T,39); T = U;
+		U = A[ 9]; A[ 9] = ROL(T,61); T = U;
+		U = A[ 6]; A[ 6] = ROL(T,20); T = U;
+		A[ 1] = ROL(T,44);
+		/* Chi */
+		FOR5(y,{
+			B0 = A[0 + 5*y];
+			B1 = A[1 + 5*y];
+			B2 = A[2 + 5*y];
+			B3 = A[3 + 5*y];
+			B4 = A[4 + 5*y];
+			A[0 + 5*y] ^= ~B1 & B2;
+			A[1 + 5*y] ^= ~B2 & B3;
+			A[2 + 5*y] ^= ~B3 & B4;
+			A[3 + 5*y] ^= ~B4 & B0;
+			A[4 + 5*y] ^= ~B0 & B1;
+		});
+		/* Iota */
+		A[0] ^= RC[i];
+	}
+}
+
+void keccak256_eth_batch(const uint8_t *publickeys,int count,uint8_t *addresses)	{
+	kvec A[25];
+	int i,l,lanes;
+	for(i = 0; i < count; i += KECCAK_LANES)	{
+		lanes = (count - i < KECCAK_LANES) ? count - i : KECCAK_LANES;
+		memset(A,0,sizeof(A));
+		for(l = 0; l < lanes; l++)	{
+			const uint8_t *publickey = publickeys + (uint64_t)(i + l) * 64;
+			A[0][l] = le64dec_batch(publickey);
+			A[1][l] = le64dec_batch(publickey + 8);
+			A[2][l] = le64dec_batch(publickey + 16);
+			A[3][l] = le64dec_batch(publickey + 24);
+			A[4][l] = le64dec_batch(publickey + 32);
+			A[5][l] = le64dec_batch(publickey + 40);
+			A[6][l] = le64dec_batch(publickey + 48);
+			A[7][l] = le64dec_batch(publickey + 56);
+		}
+		A[8] ^= 0x01;
+		A[16] ^= 0x8000000000000000ULL;
+		keccakf1600_batch(A);
+		for(l = 0; l < lanes; l++)	{
+			uint8_t *address = addresses + (uint64_t)(i + l) * 20;
+			le64enc_batch(address,A[1][l],4);
+			le64enc_batch(address + 4,A[2][l],0);
+			le64enc_batch(address + 12,A[3][l],0);
+		}
+	}
+}
+
+int keccak_batch_lanes()	{
+	return KECCAK_LANES;
+}
+
+#else
+
+/* Without vector extensions it is the same keccakf1600 one by one */
+void keccak256_eth_batch(const uint8_t *publickeys,int count,uint8_t *addresses)	{
+	uint64_t A[25];
+	int i,w;
+	for(i = 0; i < count; i++)	{
+		memset(A,0,sizeof(A));
+		for(w = 0; w < 8; w++)	{
+			A[w] = le64dec_batch(publickeys + (uint64_t)i * 64 + 8*w);
+		}
+		A[8] ^= 0x01;
+		A[16] ^= 0x8000000000000000ULL;
+		keccakf1600(A);
+		le64enc_batch(addresses + (uint64_t)i * 20,A[1],4);
+		le64enc_batch(addresses + (uint64_t)i * 20 + 4,A[2],0);
+		le64enc_batch(addresses + (uint64_t)i * 20 + 12,A[3],0);
+	}
+}
+
+int keccak_batch_lanes()	{
+	return 1;
+}
+
+#endif
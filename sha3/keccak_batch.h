@@ -0,0 +1,25 @@
+#ifndef KECCAK_BATCH_H
+#define KECCAK_BATCH_H
+
+/*
+	Keccak-256 of many 64 bytes publickeys (X and Y, without the 04 prefix) at the same time,
+	one Keccak-f[1600] state per SIMD lane: 8 with AVX-512, 4 with AVX2, 2 with NEON or SSE2
+*/
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+	publickeys: count * 64 bytes, addresses: count * 20 bytes, the last 20 bytes of every hash (the ETH address)
+*/
+void keccak256_eth_batch(const uint8_t *publickeys,int count,uint8_t *addresses);
+int keccak_batch_lanes();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,66 @@
+/*
+	Test client of the bsgsd Unix domain socket: send stdin and print the replies as they come,
+	close the write side at the end of stdin and wait until bsgsd closes the connection.
+	Usage: bsgsd_send path/to/socket < queries
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+int main(int argc,char **argv)	{
+	struct sockaddr_un address;
+	struct pollfd fds[2];
+	char buffer[4096];
+	ssize_t n,sent,s;
+	int fd,input = 1;
+	if(argc != 2 || strlen(argv[1]) >= sizeof(address.sun_path))	{
+		fprintf(stderr,"usage: %s path/to/socket\n",argv[0]);
+		return 2;
+	}
+	fd = socket(AF_UNIX,SOCK_STREAM,0);
+	memset(&address,0,sizeof(address));
+	address.sun_family = AF_UNIX;
+	strcpy(address.sun_path,argv[1]);
+	if(fd < 0 || connect(fd,(struct sockaddr *)&address,sizeof(address)) != 0)	{
+		perror("connect");
+		return 1;
+	}
+	fds[0].events = POLLIN;
+	fds[1].fd = fd;
+	fds[1].events = POLLIN;
+	for(;;)	{
+		fds[0].fd = input ? STDIN_FILENO : -1;
+		if(poll(fds,2,-1) < 0)	{
+			perror("poll");
+			return 1;
+		}
+		if(input && fds[0].revents)	{
+			n = read(STDIN_FILENO,buffer,sizeof(buffer));
+			if(n <= 0)	{
+				shutdown(fd,SHUT_WR);
+				input = 0;
+			}
+			for(sent = 0; sent < n; sent += s)	{
+				s = write(fd,buffer + sent,n - sent);
+				if(s <= 0)	{
+					perror("write");
+					return 1;
+				}
+			}
+		}
+		if(fds[1].revents)	{
+			n = read(fd,buffer,sizeof(buffer));
+			if(n <= 0)	{
+				break;
+			}
+			fwrite(buffer,1,n,stdout);
+			fflush(stdout);
+		}
+	}
+	close(fd);
+	return 0;
+}
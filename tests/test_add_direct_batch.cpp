@@ -0,0 +1,137 @@
+/**
+ * @file test_add_direct_batch.cpp
+ * @brief Unit tests for Secp256K1::AddDirectBatch
+ *
+ * Built once per backend: secp256k1/ by default, gmp256k1/ with
+ * KEYHUNT_TEST_GMP256K1 defined.
+ */
+
+#ifdef KEYHUNT_TEST_GMP256K1
+#include "../gmp256k1/GMP256K1.h"
+#include "../gmp256k1/IntGroup.h"
+#else
+#include "../secp256k1/SECP256k1.h"
+#include "../secp256k1/IntGroup.h"
+#endif
+
+namespace {
+
+const int kBatchSize = 64;
+const uint64_t kCenterKey = 0x1234567890abcdefULL;
+
+Secp256K1& batch_secp() {
+    static Secp256K1* secp = nullptr;
+    if (secp == nullptr) {
+        secp = new Secp256K1();
+        secp->Init();
+    }
+    return *secp;
+}
+
+// k*G for k = center + offset*stride, offset may be negative
+Point batch_expected(int64_t offset, uint64_t stride) {
+    Int key;
+    Int step;
+    key.SetInt64(kCenterKey);
+    step.SetInt64(stride);
+    step.Mult((uint64_t)(offset < 0 ? -offset : offset));
+    if (offset < 0) {
+        key.Sub(&step);
+    } else {
+        key.Add(&step);
+    }
+    return batch_secp().ComputePublicKey(&key);
+}
+
+// table[i] = (i+1)*S with S = stride*G, like Gn in keyhunt
+void batch_table(Point* table, uint64_t stride) {
+    Int key;
+    for (int i = 0; i < kBatchSize / 2; i++) {
+        key.SetInt64((uint64_t)(i + 1) * stride);
+        table[i] = batch_secp().ComputePublicKey(&key);
+    }
+}
+
+bool batch_check(uint64_t stride, bool calculate_y, bool move_center) {
+    Secp256K1& secp = batch_secp();
+    Point table[kBatchSize / 2];
+    Point out[kBatchSize];
+    Point center;
+    Point next;
+    Int key;
+    Int dx[kBatchSize / 2 + 1];
+    IntGroup grp(kBatchSize / 2 + 1);
+    grp.Set(dx);
+
+    batch_table(table, stride);
+    key.SetInt64(kCenterKey);
+    center = secp.ComputePublicKey(&key);
+    key.SetInt64((uint64_t)kBatchSize * stride);
+    next = secp.ComputePublicKey(&key);
+
+    secp.AddDirectBatch(center, table, move_center ? &next : NULL,
+                        kBatchSize, out, calculate_y, &grp, dx);
+
+    for (int k = 0; k < kBatchSize; k++) {
+        Point expected = batch_expected(k - kBatchSize / 2, stride);
+        if (!out[k].x.IsEqual(&expected.x) ||
+            (calculate_y && !out[k].y.IsEqual(&expected.y))) {
+            std::cout << "  out[" << k << "] differs" << std::endl;
+            return false;
+        }
+    }
+
+    Point moved = batch_expected(move_center ? kBatchSize : 0, stride);
+    EXPECT_TRUE(center.x.IsEqual(&moved.x));
+    EXPECT_TRUE(center.y.IsEqual(&moved.y));
+    return true;
+}
+
+} // namespace
+
+TEST(AddDirectBatch, MatchesComputePublicKeyWithY) {
+    EXPECT_TRUE(batch_check(1, true, true));
+    EXPECT_TRUE(batch_check(0x10001, true, true));
+    return true;
+}
+
+TEST(AddDirectBatch, MatchesComputePublicKeyWithoutY) {
+    EXPECT_TRUE(batch_check(1, false, true));
+    EXPECT_TRUE(batch_check(0x10001, false, true));
+    return true;
+}
+
+TEST(AddDirectBatch, KeepsCenterWithoutNext) {
+    EXPECT_TRUE(batch_check(3, true, false));
+    EXPECT_TRUE(batch_check(3, false, false));
+    return true;
+}
+
+TEST(AddDirectBatch, MatchesAddDirect) {
+    Secp256K1& secp = batch_secp();
+    Point table[kBatchSize / 2];
+    Point out[kBatchSize];
+    Point center;
+    Point start;
+    Int key;
+    Int dx[kBatchSize / 2 + 1];
+    IntGroup grp(kBatchSize / 2 + 1);
+    grp.Set(dx);
+
+    batch_table(table, 5);
+    key.SetInt64(kCenterKey);
+    center = secp.ComputePublicKey(&key);
+    start = center;
+    secp.AddDirectBatch(center, table, NULL, kBatchSize, out, true, &grp, dx);
+
+    for (int i = 0; i < kBatchSize / 2 - 1; i++) {
+        Point plus = secp.AddDirect(start, table[i]);
+        Point negated = secp.Negation(table[i]);
+        Point minus = secp.AddDirect(start, negated);
+        EXPECT_TRUE(out[kBatchSize / 2 + i + 1].x.IsEqual(&plus.x));
+        EXPECT_TRUE(out[kBatchSize / 2 + i + 1].y.IsEqual(&plus.y));
+        EXPECT_TRUE(out[kBatchSize / 2 - i - 1].x.IsEqual(&minus.x));
+        EXPECT_TRUE(out[kBatchSize / 2 - i - 1].y.IsEqual(&minus.y));
+    }
+    return true;
+}
@@ -0,0 +1,38 @@
+#!/bin/sh
+# BSGS with -e: keys center + lambda^2*5 and center - lambda*7 of the first giant step (center = range from + M)
+# are found from beta*X and beta^2*X of that giant step, with -n 0x1000000 -k 1 M is 0x1000.
+# Usage: test_bsgs_endomorphism.sh path/to/keyhunt
+
+KEYHUNT="$1"
+if [ ! -x "$KEYHUNT" ]; then
+	echo "usage: $0 path/to/keyhunt"
+	exit 2
+fi
+KEYHUNT=$(cd "$(dirname "$KEYHUNT")" && pwd)/$(basename "$KEYHUNT")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+# 0x10000001000 + lambda^2*5 and 0x10000001000 - lambda*7 mod n
+echo "02f0c65bc47b80487cb6e58773d3f24ded0e76906773b4149dbbae037398c3d98f" > lambda.pub
+echo "025f7c281fea346400bcb40558ed7923c32a5547a0277935c74f6790d0bf5fa5cd" >> lambda.pub
+
+timeout 120 "$KEYHUNT" -m bsgs -f lambda.pub -r 10000000000:20000000000 -n 0x1000000 -k 1 -t 1 -e -q -s 0 > keyhunt.log 2>&1
+
+FAILED=0
+for key in 5f0d9d803e330b9cc64173f357a40a3b1a770b3abc0a401b2497cdad18b9df43 b84642e6bd7aa9db7bf53bee477f4185b0c9a24d2a5013652664ff41b2a8a5a5; do
+	if ! grep -q "privkey $key" keyhunt.log; then
+		echo "key not found: $key"
+		FAILED=1
+	fi
+done
+if ! grep -q "\[W\] -e with bsgs is a lottery over the whole group" keyhunt.log; then
+	echo "no warning about -e with bsgs"
+	FAILED=1
+fi
+if [ $FAILED -ne 0 ]; then
+	cat keyhunt.log
+else
+	echo "bsgs endomorphism: OK"
+fi
+exit $FAILED
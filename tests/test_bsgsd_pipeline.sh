@@ -0,0 +1,71 @@
+#!/bin/sh
+# bsgsd BSGSD/1 test: two pipelined queries in one connection, the long one with progress=1
+# is cancelled after the short one is answered. The short one is found, the long one sends
+# PROGRESS frames, then SCANNED and 499.
+# Usage: test_bsgsd_pipeline.sh path/to/bsgsd path/to/bsgsd_send
+
+BSGSD="$1"
+SEND="$2"
+if [ ! -x "$BSGSD" ] || [ ! -x "$SEND" ]; then
+	echo "usage: $0 path/to/bsgsd path/to/bsgsd_send"
+	exit 2
+fi
+BSGSD=$(cd "$(dirname "$BSGSD")" && pwd)/$(basename "$BSGSD")
+SEND=$(cd "$(dirname "$SEND")" && pwd)/$(basename "$SEND")
+WORK=$(mktemp -d)
+trap 'kill $PID 2>/dev/null; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+# 0x100000fffff
+SHORT="short 02143f223a3ddc89a1683f4492bf4e29c7f2388d123e56728179cc527a8839fcc4 10000000000:100000fffff"
+# 0x10000100000, under a range too big to finish
+LONG="long 02a452ff06860ff96309d396a5f1737efb4ff2e26b58ca4e0d9563c513a9125044 20000000000:ffffffffffffffffffffffff progress=1"
+
+# -a 2: both queries are active at the same time
+"$BSGSD" -t 1 -k 1 -n 0x1000000 -a 2 -u bsgsd.sock > bsgsd.log 2>&1 &
+PID=$!
+
+i=0
+while [ ! -S bsgsd.sock ]; do
+	i=$((i + 1))
+	if [ $i -gt 120 ] || ! kill -0 $PID 2>/dev/null; then
+		echo "bsgsd did not start"
+		cat bsgsd.log
+		exit 1
+	fi
+	sleep 1
+done
+
+# The CANCEL is sent after the short reply, then the connection is closed after the last reply
+{
+	printf 'BSGSD/1\n%s\n%s\n' "$LONG" "$SHORT"
+	i=0
+	while ! grep -q "^short " client.out 2>/dev/null && [ $i -lt 120 ]; do
+		i=$((i + 1))
+		sleep 1
+	done
+	sleep 2
+	printf 'CANCEL long\n'
+} | timeout 300 "$SEND" bsgsd.sock > client.out
+
+FAILED=0
+check() {
+	if ! grep -q "$1" client.out; then
+		echo "$2"
+		FAILED=1
+	fi
+}
+check "^BSGSD/1 OK" "no BSGSD/1 OK"
+check "^short 100000fffff$" "the short query was not found"
+check "^long PROGRESS " "no PROGRESS frame of the long query"
+check "^long SCANNED 20000000000:" "no SCANNED line of the cancelled query"
+check "^long 499$" "the long query was not cancelled"
+# The short reply comes before the end of the long query, and SCANNED before 499
+ORDER=$(grep -E "^short |^long (SCANNED|499)" client.out | cut -d ' ' -f 1-2 | tr '\n' ' ')
+case "$ORDER" in
+	"short 100000fffff long SCANNED long 499 ") ;;
+	*) echo "wrong order of the replies: $ORDER"; FAILED=1 ;;
+esac
+[ $FAILED -ne 0 ] && cat client.out
+[ $FAILED -eq 0 ] && echo "bsgsd pipeline: OK"
+exit $FAILED
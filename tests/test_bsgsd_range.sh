@@ -0,0 +1,46 @@
+#!/bin/sh
+# bsgsd protocol test: a key at <range to> is found, a key at <range to>+1 is 404.
+# The range is shorter than one block of giant steps, so the block goes past <range to>.
+# Usage: test_bsgsd_range.sh path/to/bsgsd
+
+BSGSD="$1"
+if [ ! -x "$BSGSD" ]; then
+	echo "usage: $0 path/to/bsgsd"
+	exit 2
+fi
+BSGSD=$(cd "$(dirname "$BSGSD")" && pwd)/$(basename "$BSGSD")
+WORK=$(mktemp -d)
+trap 'kill $PID 2>/dev/null; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+mkdir jobs
+
+# 0x100000fffff = <range to>
+echo "02143f223a3ddc89a1683f4492bf4e29c7f2388d123e56728179cc527a8839fcc4 10000000000:100000fffff" > jobs/end.job
+# 0x10000100000 = <range to> + 1
+echo "02a452ff06860ff96309d396a5f1737efb4ff2e26b58ca4e0d9563c513a9125044 10000000000:100000fffff" > jobs/after.job
+
+"$BSGSD" -6 -t 1 -k 1 -n 0x1000000 -d jobs > bsgsd.log 2>&1 &
+PID=$!
+
+i=0
+while [ ! -f jobs/done/end.done ] || [ ! -f jobs/done/after.done ]; do
+	i=$((i + 1))
+	if [ $i -gt 120 ] || ! kill -0 $PID 2>/dev/null; then
+		echo "bsgsd did not answer"
+		cat bsgsd.log
+		exit 1
+	fi
+	sleep 1
+done
+
+FAILED=0
+if [ "$(head -n 1 jobs/done/end.done)" != "end 100000fffff" ]; then
+	echo "key at range end: $(head -n 1 jobs/done/end.done)"
+	FAILED=1
+fi
+if [ "$(head -n 1 jobs/done/after.done)" != "after 404" ]; then
+	echo "key after range end: $(head -n 1 jobs/done/after.done)"
+	FAILED=1
+fi
+[ $FAILED -eq 0 ] && echo "bsgsd range end: OK"
+exit $FAILED
@@ -0,0 +1,66 @@
+#!/bin/sh
+# bsgsd RELOAD test: only the admin socket (-r) can RELOAD, a load that fails replies
+# RELOAD 500 and the tables in use still answer, the next RELOAD works.
+# Usage: test_bsgsd_reload.sh path/to/bsgsd path/to/bsgsd_send
+
+BSGSD="$1"
+SEND="$2"
+if [ ! -x "$BSGSD" ] || [ ! -x "$SEND" ]; then
+	echo "usage: $0 path/to/bsgsd path/to/bsgsd_send"
+	exit 2
+fi
+BSGSD=$(cd "$(dirname "$BSGSD")" && pwd)/$(basename "$BSGSD")
+SEND=$(cd "$(dirname "$SEND")" && pwd)/$(basename "$SEND")
+WORK=$(mktemp -d)
+trap 'kill $PID 2>/dev/null; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+# 0x100000fffff
+QUERY="end 02143f223a3ddc89a1683f4492bf4e29c7f2388d123e56728179cc527a8839fcc4 10000000000:100000fffff"
+
+"$BSGSD" -t 1 -k 1 -n 0x1000000 -u bsgsd.sock -r admin.sock > bsgsd.log 2>&1 &
+PID=$!
+
+i=0
+while [ ! -S admin.sock ] || [ ! -S bsgsd.sock ]; do
+	i=$((i + 1))
+	if [ $i -gt 120 ] || ! kill -0 $PID 2>/dev/null; then
+		echo "bsgsd did not start"
+		cat bsgsd.log
+		exit 1
+	fi
+	sleep 1
+done
+
+FAILED=0
+check() {
+	if ! grep -q "$2" "$1"; then
+		echo "$3"
+		cat "$1"
+		FAILED=1
+	fi
+}
+
+printf 'BSGSD/1\nRELOAD 0x4000000\n' | timeout 60 "$SEND" bsgsd.sock > client.out
+check client.out "^RELOAD 403 Forbidden" "RELOAD was accepted in the clients socket"
+
+# M = 0x2000 for N = 0x4000000, an empty bloom filter file can't be read
+: > keyhunt_bsgs_4_8192.blm
+printf 'BSGSD/1\nRELOAD 0x4000000\n' | timeout 60 "$SEND" admin.sock > failed.out
+check failed.out "^RELOAD 500" "the RELOAD with a bad file did not reply 500"
+if ! kill -0 $PID 2>/dev/null; then
+	echo "bsgsd exited after the failed RELOAD"
+	cat bsgsd.log
+	exit 1
+fi
+printf 'BSGSD/1\n%s\n' "$QUERY" | timeout 60 "$SEND" bsgsd.sock > query1.out
+check query1.out "^end 100000fffff" "the tables in use did not answer after the failed RELOAD"
+
+rm -f keyhunt_bsgs_4_8192.blm
+printf 'BSGSD/1\nRELOAD 0x4000000\n' | timeout 120 "$SEND" admin.sock > done.out
+check done.out "^RELOAD DONE 2 N=0x4000000 K=1" "the RELOAD after the failed one did not work"
+printf 'BSGSD/1\n%s\n' "$QUERY" | timeout 60 "$SEND" bsgsd.sock > query2.out
+check query2.out "^end 100000fffff" "the reloaded tables did not answer"
+
+[ $FAILED -eq 0 ] && echo "bsgsd reload: OK"
+exit $FAILED
@@ -0,0 +1,118 @@
+/*
+	Test client of the bsgsd shared memory (-s name): three slots are claimed and submitted
+	together, a key at the range end is found, a key after the range end is 404 and an empty
+	query is 400. Every slot is FREE again after bsgsd_release.
+	Usage: test_bsgsd_shm name
+*/
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../bsgsd_shm.h"
+
+/* 0x100000fffff, at the range end */
+#define KEY_END "02143f223a3ddc89a1683f4492bf4e29c7f2388d123e56728179cc527a8839fcc4"
+/* 0x10000100000, one after the range end */
+#define KEY_AFTER "02a452ff06860ff96309d396a5f1737efb4ff2e26b58ca4e0d9563c513a9125044"
+
+int failed = 0;
+
+void check(int condition,const char *message)	{
+	if(!condition)	{
+		printf("%s\n",message);
+		failed = 1;
+	}
+}
+
+void hex2bytes(const char *hex,uint8_t *out,int length)	{
+	int i;
+	unsigned int byte;
+	for(i = 0; i < length; i++)	{
+		sscanf(hex + i*2,"%2x",&byte);
+		out[i] = byte;
+	}
+}
+
+/* Big endian 32 bytes of a number of up to 64 bits */
+void u64bytes(uint64_t value,uint8_t *out)	{
+	int i;
+	memset(out,0,32);
+	for(i = 0; i < 8; i++)	{
+		out[31 - i] = (value >> (i*8)) & 0xff;
+	}
+}
+
+int query(struct bsgsd_shm *shm,const char *publickey,uint64_t tag)	{
+	int slot = bsgsd_claim(shm);
+	if(slot < 0)
+		return -1;
+	check(shm->slot[slot].state == BSGSD_SLOT_CLAIMED,"bsgsd_claim did not mark the slot CLAIMED");
+	shm->slot[slot].count = publickey != NULL ? 1 : 0;
+	shm->slot[slot].priority = 0;
+	shm->slot[slot].deadline = 0;
+	shm->slot[slot].tag = tag;
+	if(publickey != NULL)	{
+		hex2bytes(publickey,shm->slot[slot].publickeys[0],33);
+	}
+	u64bytes(0x10000000000ULL,shm->slot[slot].range_from);
+	u64bytes(0x100000fffffULL,shm->slot[slot].range_to);
+	bsgsd_submit(shm,slot);
+	return slot;
+}
+
+int main(int argc,char **argv)	{
+	struct bsgsd_shm *shm;
+	uint8_t expected[32];
+	int end,after,empty,i;
+	if(argc != 2)	{
+		fprintf(stderr,"usage: %s name\n",argv[0]);
+		return 2;
+	}
+	shm = bsgsd_open(argv[1]);
+	if(shm == NULL)	{
+		printf("bsgsd_open %s failed\n",argv[1]);
+		return 1;
+	}
+	end = query(shm,KEY_END,1);
+	after = query(shm,KEY_AFTER,2);
+	empty = query(shm,NULL,3);
+	if(end < 0 || after < 0 || empty < 0)	{
+		printf("bsgsd_claim failed\n");
+		return 1;
+	}
+	check(end != after && after != empty && end != empty,"bsgsd_claim gave the same slot twice");
+
+	check(bsgsd_wait(shm,end,120000),"no result for the key at the range end");
+	check(bsgsd_wait(shm,after,120000),"no result for the key after the range end");
+	check(bsgsd_wait(shm,empty,120000),"no result for the empty query");
+	if(failed)
+		return 1;
+
+	u64bytes(0x100000fffffULL,expected);
+	check(shm->slot[end].status == 200 && shm->slot[end].found == 1,"the key at the range end was not found");
+	check(memcmp(shm->slot[end].keys[0],expected,32) == 0,"wrong key at the range end");
+	check(shm->slot[after].status == 404 && shm->slot[after].found == 0,"the key after the range end was not 404");
+	check(shm->slot[empty].status == 400,"the empty query was not 400");
+	check(shm->slot[end].tag == 1 && shm->slot[after].tag == 2 && shm->slot[empty].tag == 3,"bsgsd changed the tag");
+
+	bsgsd_release(shm,end);
+	bsgsd_release(shm,after);
+	bsgsd_release(shm,empty);
+	check(shm->slot[end].state == BSGSD_SLOT_FREE && shm->slot[after].state == BSGSD_SLOT_FREE && shm->slot[empty].state == BSGSD_SLOT_FREE,"bsgsd_release did not free the slots");
+	check(!bsgsd_poll(shm,end),"a released slot is still DONE");
+
+	/* All the slots can be claimed again */
+	for(i = 0; i < BSGSD_SHM_SLOTS; i++)	{
+		if(bsgsd_claim(shm) < 0)	{
+			break;
+		}
+	}
+	check(i == BSGSD_SHM_SLOTS,"not all the slots are FREE");
+	check(bsgsd_claim(shm) == -1,"bsgsd_claim did not fail with all the slots in use");
+
+	bsgsd_close(shm);
+	if(!failed)
+		printf("bsgsd shared memory: OK\n");
+	return failed;
+}
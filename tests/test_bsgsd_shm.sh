@@ -0,0 +1,35 @@
+#!/bin/sh
+# bsgsd shared memory test: test_bsgsd_shm claims, submits, waits and releases slots of bsgsd -s.
+# Usage: test_bsgsd_shm.sh path/to/bsgsd path/to/test_bsgsd_shm
+
+BSGSD="$1"
+CLIENT="$2"
+if [ ! -x "$BSGSD" ] || [ ! -x "$CLIENT" ]; then
+	echo "usage: $0 path/to/bsgsd path/to/test_bsgsd_shm"
+	exit 2
+fi
+BSGSD=$(cd "$(dirname "$BSGSD")" && pwd)/$(basename "$BSGSD")
+CLIENT=$(cd "$(dirname "$CLIENT")" && pwd)/$(basename "$CLIENT")
+WORK=$(mktemp -d)
+trap 'kill $PID 2>/dev/null; rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+NAME="/keyhunt_test_$$"
+"$BSGSD" -t 1 -k 1 -n 0x1000000 -s "$NAME" > bsgsd.log 2>&1 &
+PID=$!
+
+i=0
+while ! grep -q "Shared memory" bsgsd.log; do
+	i=$((i + 1))
+	if [ $i -gt 120 ] || ! kill -0 $PID 2>/dev/null; then
+		echo "bsgsd did not start"
+		cat bsgsd.log
+		exit 1
+	fi
+	sleep 1
+done
+
+timeout 300 "$CLIENT" "$NAME"
+FAILED=$?
+[ $FAILED -ne 0 ] && cat bsgsd.log
+exit $FAILED
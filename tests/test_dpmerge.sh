@@ -0,0 +1,95 @@
+#!/bin/sh
+# dpmerge: two batch files of a -S run are merged in a new master file, and a tame and a
+# wild DP with the same X in two batches give the key.
+# Usage: test_dpmerge.sh path/to/keyhunt_secp256k1 path/to/keyhunt_kangaroo_save
+# The second one is built with KANGAROO_SAVE_SECONDS=2.
+
+KEYHUNT="$1"
+KEYHUNT_SAVE="$2"
+if [ ! -x "$KEYHUNT" ] || [ ! -x "$KEYHUNT_SAVE" ]; then
+	echo "usage: $0 path/to/keyhunt_secp256k1 path/to/keyhunt_kangaroo_save"
+	exit 2
+fi
+KEYHUNT=$(cd "$(dirname "$KEYHUNT")" && pwd)/$(basename "$KEYHUNT")
+KEYHUNT_SAVE=$(cd "$(dirname "$KEYHUNT_SAVE")" && pwd)/$(basename "$KEYHUNT_SAVE")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+LINEBUF=""
+command -v stdbuf > /dev/null && LINEBUF="stdbuf -oL"
+
+# Write the bytes of a hex string, printf only knows octal escapes everywhere
+hex2bin() {
+	printf "$(echo "$1" | awk '{
+		h = "0123456789abcdef"; s = ""
+		for(i = 1; i < length($0); i += 2)
+			s = s sprintf("\\%03o", (index(h, substr($0, i, 1)) - 1) * 16 + index(h, substr($0, i + 1, 1)) - 1)
+		print s
+	}')"
+}
+
+FAILED=0
+
+# 0x3d1f2a9b7c6 in a 80 bits range, one batch file is written every 2 seconds
+echo "02cd1ca6030593ba524ccbdb297b5145d029a4a43af348750616c266a23fec999b" > big.pub
+timeout 7 $LINEBUF "$KEYHUNT_SAVE" -m kangaroo -f big.pub -r 1:ffffffffffffffffffff -D 8 -S -t 1 -q -s 0 > save.log 2>&1
+BATCH1=$(ls kangaroo_*_*_*.dat 2> /dev/null | sed -n 1p)
+BATCH2=$(ls kangaroo_*_*_*.dat 2> /dev/null | sed -n 2p)
+if [ -z "$BATCH1" ] || [ -z "$BATCH2" ]; then
+	echo "there are not two batch files"
+	ls
+	cat save.log
+	exit 1
+fi
+"$KEYHUNT" -m dpmerge -f master.dat "$BATCH1" "$BATCH2" > merge.log 2>&1
+C1=$(sed -n "s/^\[+\] Batch $BATCH1: \([0-9]*\) distinguished points$/\1/p" merge.log)
+C2=$(sed -n "s/^\[+\] Batch $BATCH2: \([0-9]*\) distinguished points$/\1/p" merge.log)
+if [ -z "$C1" ] || [ -z "$C2" ] || [ "$C1" -eq 0 ] || [ "$C2" -eq 0 ]; then
+	echo "the batch files were not read"
+	cat merge.log
+	FAILED=1
+else
+	TOTAL=$((C1 + C2))
+	if ! grep -q "Master master.dat: $TOTAL distinguished points ($TOTAL new), 0 tame/wild collisions" merge.log; then
+		echo "master.dat does not have the $TOTAL distinguished points of the batches"
+		cat merge.log
+		FAILED=1
+	fi
+fi
+if [ ! -f "$BATCH1.merged" ] || [ ! -f "$BATCH2.merged" ] || [ -f "$BATCH1" ] || [ -f "$BATCH2" ]; then
+	echo "the batch files were not renamed to .merged"
+	ls
+	FAILED=1
+fi
+# The master is read again, the merged batches give nothing new
+if [ $FAILED -eq 0 ]; then
+	cp "$BATCH1.merged" again.dat
+	"$KEYHUNT" -m dpmerge -f master.dat again.dat > again.log 2>&1
+	if ! grep -q "Master master.dat: $TOTAL distinguished points (0 new)" again.log; then
+		echo "the batch merged again changed master.dat"
+		cat again.log
+		FAILED=1
+	fi
+fi
+
+# Two batches of 0x1a2b3c4d5 in the range 100000000:1ffffffff, one DP each with the same X.
+# KDP1 header: magic, dp_bits 8, count 1, target, range start and end, sorted | compressed
+HEADER=4b445031080000000100000000000000
+HEADER=${HEADER}03ef264a607a9b504a0bc5729ec783d7212e441b4539d015b85a589c2fd079cfe4
+HEADER=${HEADER}0000000000000000000000000000000000000000000000000000000100000000
+HEADER=${HEADER}00000000000000000000000000000000000000000000000000000001ffffffff
+HEADER=${HEADER}030000000000000000000000000000
+X=11223344556677880011223344556677
+# tame distance 0xa2b3c4d6 and wild distance 1, start + 0xa2b3c4d6 - 1 = 0x1a2b3c4d5
+hex2bin "${HEADER}${X}d6c4b3a20000000000000000000000000000000000000000" > tame.dat
+hex2bin "${HEADER}${X}010000000000000000000000000000000000000000000080" > wild.dat
+"$KEYHUNT" -m dpmerge -f collision.dat tame.dat wild.dat > collision.log 2>&1
+if ! grep -q "Private Key: 1a2b3c4d5" collision.log || ! grep -q "(1 new), 1 tame/wild collisions" collision.log; then
+	echo "the tame/wild collision did not solve 0x1a2b3c4d5"
+	cat collision.log
+	FAILED=1
+fi
+
+[ $FAILED -eq 0 ] && echo "dpmerge: OK"
+exit $FAILED
@@ -0,0 +1,195 @@
+/**
+ * @file test_hashes.cpp
+ * @brief Unit tests for the batched hashes, bech32 decoding and the address index
+ *
+ * Built once per backend like test_add_direct_batch.cpp. Every batched path is
+ * compared with its scalar version, the address index with tests/1to32.txt.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#include "../sha3/sha3.h"
+#include "../sha3/keccak_batch.h"
+#include "../bech32/bech32.h"
+#include "../base58/libbase58.h"
+#include "../util.h"
+
+namespace {
+
+// Hash160 of the compressed key 1, it is also the BIP173 P2WPKH vector
+const char* kKey1Hash160 = "751e76e8199196d454941c45d1b3a323f1433bd6";
+
+Secp256K1& hash_secp() {
+    static Secp256K1* secp = nullptr;
+    if (secp == nullptr) {
+        secp = new Secp256K1();
+        secp->Init();
+    }
+    return *secp;
+}
+
+Point hash_point(uint64_t k) {
+    Int key;
+    key.SetInt64(k);
+    return hash_secp().ComputePublicKey(&key);
+}
+
+bool hash_equal_hex(const uint8_t* bytes, const char* hex) {
+    char copy[41];
+    unsigned char expected[20];
+    snprintf(copy, sizeof(copy), "%s", hex);
+    return hexs2bin(copy, expected) && memcmp(bytes, expected, 20) == 0;
+}
+
+// Scalar Keccak-256 of the 64 bytes X and Y, the last 20 bytes like the ETH address
+void keccak_scalar(const uint8_t* publickey, uint8_t* address) {
+    SHA3_256_CTX ctx;
+    uint8_t digest[32];
+    KECCAK_256_Init(&ctx);
+    KECCAK_256_Update(&ctx, publickey, 64);
+    KECCAK_256_Final(digest, &ctx);
+    memcpy(address, digest + 12, 20);
+}
+
+int address_compare(const void* a, const void* b) {
+    return memcmp(a, b, 20);
+}
+
+} // namespace
+
+TEST(Keccak, BatchMatchesScalar) {
+    // Not a multiple of any lane count, the last batch is partial
+    const int count = 19;
+    std::vector<uint8_t> publickeys(count * 64);
+    std::vector<uint8_t> batch(count * 20);
+    uint8_t scalar[20];
+
+    for (int i = 0; i < count; i++) {
+        Point p = hash_point(0x10000 + (uint64_t)i * 0x1234567);
+        p.x.Get32Bytes(&publickeys[i * 64]);
+        p.y.Get32Bytes(&publickeys[i * 64 + 32]);
+    }
+    keccak256_eth_batch(publickeys.data(), count, batch.data());
+    for (int i = 0; i < count; i++) {
+        keccak_scalar(&publickeys[i * 64], scalar);
+        EXPECT_EQ(memcmp(&batch[i * 20], scalar, 20), 0);
+    }
+
+    // ETH address of the key 1
+    Point one = hash_point(1);
+    one.x.Get32Bytes(&publickeys[0]);
+    one.y.Get32Bytes(&publickeys[32]);
+    keccak256_eth_batch(publickeys.data(), 1, batch.data());
+    EXPECT_TRUE(hash_equal_hex(batch.data(), "7e5f4552091a69125d5dfcb7b8c2659029395bdf"));
+    return true;
+}
+
+TEST(Bech32, DecodesBip173Vector) {
+    uint8_t hash160[20];
+    char address[BECH32_P2WPKH_LENGTH + 1];
+
+    EXPECT_EQ(bech32_decode_p2wpkh(hash160, "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4"), 1);
+    EXPECT_TRUE(hash_equal_hex(hash160, kKey1Hash160));
+    EXPECT_EQ(bech32_decode_p2wpkh(hash160, "BC1QW508D6QEJXTDG4Y5R3ZARVARY0C5XW7KV8F3T4"), 1);
+    EXPECT_TRUE(hash_equal_hex(hash160, kKey1Hash160));
+
+    // Mixed case and a wrong checksum
+    EXPECT_EQ(bech32_decode_p2wpkh(hash160, "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7KV8F3T4"), 0);
+    EXPECT_EQ(bech32_decode_p2wpkh(hash160, "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t5"), 0);
+
+    hexs2bin((char*)kKey1Hash160, hash160);
+    bech32_encode_p2wpkh(address, hash160);
+    EXPECT_EQ(strcmp(address, "bc1qw508d6qejxtdg4y5r3zarvary0c5xw7kv8f3t4"), 0);
+    return true;
+}
+
+TEST(GetHash160, BothMatchesScalar) {
+    Secp256K1& secp = hash_secp();
+    const uint64_t keys[8] = {1, 2, 3, 4, 0x1a2b3c4d5ULL, 0xffffffffffffULL, 0x8000000000000001ULL, 12345};
+    uint8_t hc[80], hu[80];
+    uint8_t scalar[20];
+
+    for (int b = 0; b < 8; b += 4) {
+        Point p[4];
+        for (int i = 0; i < 4; i++) {
+            p[i] = hash_point(keys[b + i]);
+        }
+        secp.GetHash160_both(p[0], p[1], p[2], p[3], hc, hu);
+        for (int i = 0; i < 4; i++) {
+            secp.GetHash160(P2PKH, true, p[i], scalar);
+            EXPECT_EQ(memcmp(hc + i * 20, scalar, 20), 0);
+            secp.GetHash160(P2PKH, false, p[i], scalar);
+            EXPECT_EQ(memcmp(hu + i * 20, scalar, 20), 0);
+        }
+        if (b == 0) {
+            EXPECT_TRUE(hash_equal_hex(hc, kKey1Hash160));
+        }
+    }
+    return true;
+}
+
+TEST(GetHash160, P2SHMatchesScalar) {
+    Secp256K1& secp = hash_secp();
+    Point p[4];
+    uint8_t keyhash[4][20];
+    uint8_t h[4][20];
+    uint8_t scalar[20];
+
+    for (int i = 0; i < 4; i++) {
+        p[i] = hash_point(1 + (uint64_t)i * 0x100000001ULL);
+        secp.GetHash160(P2PKH, true, p[i], keyhash[i]);
+    }
+    secp.GetHash160_P2SH(keyhash[0], keyhash[1], keyhash[2], keyhash[3], h[0], h[1], h[2], h[3]);
+    for (int i = 0; i < 4; i++) {
+        secp.GetHash160(P2SH, true, p[i], scalar);
+        EXPECT_EQ(memcmp(h[i], scalar, 20), 0);
+    }
+    // 3JvL6Ymt8MVWiCNHC7oWU6nLeHNJKLZGLN, P2SH-P2WPKH of the key 1
+    EXPECT_TRUE(hash_equal_hex(h[0], "bcfeb728b584253d5f3f70bcb780e9ef218a68f4"));
+    return true;
+}
+
+TEST(AddressIndex, FindsPuzzleAddresses) {
+    FILE* fd = fopen(KEYHUNT_TEST_DATA "/1to32.txt", "r");
+    EXPECT_TRUE(fd != NULL);
+    std::vector<uint8_t> table;
+    char line[128];
+    while (fgets(line, sizeof(line), fd) != NULL) {
+        uint8_t raw[25];
+        size_t length = sizeof(raw);
+        trim(line, " \t\r\n");
+        if (line[0] == '\0') {
+            continue;
+        }
+        if (!b58tobin(raw, &length, line, strlen(line)) || length != 25) {
+            fclose(fd);
+            std::cout << "  can't decode " << line << std::endl;
+            return false;
+        }
+        table.insert(table.end(), raw + 1, raw + 21);
+    }
+    fclose(fd);
+    uint64_t n = table.size() / 20;
+    EXPECT_EQ(n, (uint64_t)32);
+    qsort(table.data(), n, 20, address_compare);
+
+    uint32_t bits = address_index_size_bits(n);
+    EXPECT_EQ(bits, (uint32_t)5);
+    std::vector<uint32_t> index(((size_t)1 << bits) + 1);
+    address_index_fill(index.data(), bits, table.data(), n);
+    EXPECT_EQ(index[0], (uint32_t)0);
+    EXPECT_EQ(index[(size_t)1 << bits], (uint32_t)n);
+
+    for (uint64_t i = 0; i < n; i++) {
+        char hash[20];
+        memcpy(hash, &table[i * 20], 20);
+        EXPECT_EQ(address_index_search(index.data(), bits, table.data(), hash), 1);
+        hash[19] ^= 1;
+        EXPECT_EQ(address_index_search(index.data(), bits, table.data(), hash), 0);
+    }
+    EXPECT_EQ(address_index_size_bits(0), (uint32_t)0);
+    EXPECT_EQ(address_index_size_bits(0xFFFFFFFFULL), (uint32_t)0);
+    return true;
+}
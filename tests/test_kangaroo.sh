@@ -0,0 +1,67 @@
+#!/bin/sh
+# kangaroo mode: a key of a 32 bits range is solved, and a -S save is loaded again on restart
+# and ignored if it is of other DP bits.
+# Usage: test_kangaroo.sh path/to/keyhunt_secp256k1 path/to/keyhunt_kangaroo_save
+# The second one is built with KANGAROO_SAVE_SECONDS=2.
+
+KEYHUNT="$1"
+KEYHUNT_SAVE="$2"
+if [ ! -x "$KEYHUNT" ] || [ ! -x "$KEYHUNT_SAVE" ]; then
+	echo "usage: $0 path/to/keyhunt_secp256k1 path/to/keyhunt_kangaroo_save"
+	exit 2
+fi
+KEYHUNT=$(cd "$(dirname "$KEYHUNT")" && pwd)/$(basename "$KEYHUNT")
+KEYHUNT_SAVE=$(cd "$(dirname "$KEYHUNT_SAVE")" && pwd)/$(basename "$KEYHUNT_SAVE")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+# keyhunt only flushes stdout on exit, the runs with -S are stopped by timeout
+LINEBUF=""
+command -v stdbuf > /dev/null && LINEBUF="stdbuf -oL"
+
+FAILED=0
+
+# 0x1a2b3c4d5
+echo "03ef264a607a9b504a0bc5729ec783d7212e441b4539d015b85a589c2fd079cfe4" > small.pub
+timeout 120 "$KEYHUNT" -m kangaroo -f small.pub -r 100000000:1ffffffff -t 1 -q -s 0 > solve.log 2>&1
+if ! grep -q "Private Key: 1a2b3c4d5" solve.log; then
+	echo "kangaroo did not solve 0x1a2b3c4d5"
+	cat solve.log
+	FAILED=1
+fi
+
+# 0x3d1f2a9b7c6 in a 80 bits range, it is not solved in a few seconds
+echo "02cd1ca6030593ba524ccbdb297b5145d029a4a43af348750616c266a23fec999b" > big.pub
+timeout 5 $LINEBUF "$KEYHUNT_SAVE" -m kangaroo -f big.pub -r 1:ffffffffffffffffffff -D 8 -S -t 1 -q -s 0 > save.log 2>&1
+SAVED=$(ls kangaroo_*.dat 2> /dev/null | grep -v '_.*_' | head -n 1)
+if [ -z "$SAVED" ]; then
+	echo "no kangaroo save file"
+	cat save.log
+	exit 1
+fi
+timeout 3 $LINEBUF "$KEYHUNT_SAVE" -m kangaroo -f big.pub -r 1:ffffffffffffffffffff -D 8 -S -t 1 -q -s 0 > load.log 2>&1
+if ! grep -q "Loaded [1-9][0-9]* distinguished points from $SAVED" load.log; then
+	echo "the save $SAVED was not loaded"
+	cat load.log
+	FAILED=1
+fi
+
+# Same target and range with -D 9 is another file, replaced by the save of -D 8
+timeout 5 $LINEBUF "$KEYHUNT_SAVE" -m kangaroo -f big.pub -r 1:ffffffffffffffffffff -D 9 -S -t 1 -q -s 0 > save9.log 2>&1
+OTHER=$(ls kangaroo_*.dat | grep -v '_.*_' | grep -v "$SAVED" | head -n 1)
+if [ -z "$OTHER" ]; then
+	echo "no kangaroo save file for -D 9"
+	cat save9.log
+	exit 1
+fi
+cp "$SAVED" "$OTHER"
+timeout 3 $LINEBUF "$KEYHUNT_SAVE" -m kangaroo -f big.pub -r 1:ffffffffffffffffffff -D 9 -S -t 1 -q -s 0 > mismatch.log 2>&1
+if ! grep -q "Ignoring file $OTHER, it is of another target, range or DP bits" mismatch.log || grep -q "Loaded .* from $OTHER" mismatch.log; then
+	echo "the save of -D 8 was not ignored with -D 9"
+	cat mismatch.log
+	FAILED=1
+fi
+
+[ $FAILED -eq 0 ] && echo "kangaroo: OK"
+exit $FAILED
@@ -182,10 +182,16 @@ struct TestRegistrar {
     } while (0)
 
 // Include actual tests
+#ifdef KEYHUNT_TEST_BACKEND
+// Elliptic curve backend tests, one executable per backend
+#include "test_add_direct_batch.cpp"
+#include "test_hashes.cpp"
+#else
 #include "test_types.cpp"
 #include "test_memory.cpp"
 #include "test_thread_pool.cpp"
 #include "test_bloom_filter.cpp"
+#endif
 
 int main(int argc, char** argv) {
     (void)argc;
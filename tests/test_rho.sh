@@ -0,0 +1,39 @@
+#!/bin/sh
+# rho mode: a 33 bits key is solved by the test build, that walks near G and Q and keeps
+# at most 65536 DPs. With -D 0 the table must stop at 65536 DPs and warn.
+# Usage: test_rho.sh path/to/keyhunt_rho_test
+# It is keyhunt.cpp built with RHO_TEST_BITS=40 and RHO_TABLE_MAX=65536.
+
+KEYHUNT="$1"
+if [ ! -x "$KEYHUNT" ]; then
+	echo "usage: $0 path/to/keyhunt_rho_test"
+	exit 2
+fi
+KEYHUNT=$(cd "$(dirname "$KEYHUNT")" && pwd)/$(basename "$KEYHUNT")
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+cd "$WORK" || exit 2
+
+FAILED=0
+
+# 0x1a2b3c4d5
+echo "03ef264a607a9b504a0bc5729ec783d7212e441b4539d015b85a589c2fd079cfe4" > small.pub
+timeout 120 "$KEYHUNT" -m rho -f small.pub -D 8 -t 1 -q -s 0 > solve.log 2>&1
+if ! grep -q "Private Key: 1a2b3c4d5" solve.log; then
+	echo "rho did not solve 0x1a2b3c4d5"
+	cat solve.log
+	FAILED=1
+fi
+
+# keyhunt only flushes stdout on exit, this run is stopped by timeout
+LINEBUF=""
+command -v stdbuf > /dev/null && LINEBUF="stdbuf -oL"
+timeout 10 $LINEBUF "$KEYHUNT" -m rho -f small.pub -D 0 -t 1 -q -s 0 > full.log 2>&1
+if ! grep -q "Rho table is full with 65536 distinguished points" full.log; then
+	echo "rho with -D 0 did not stop the table at 65536 DPs"
+	cat full.log
+	FAILED=1
+fi
+
+[ $FAILED -eq 0 ] && echo "rho: OK"
+exit $FAILED
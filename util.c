@@ -64,13 +64,20 @@ int hasMoreTokens(Tokenizer *t)	{
 	return (t->current < t->n);
 }
 
+/*
+	strtok_r because bsgsd tokenize the lines of several clients at the same time
+*/
+#if defined(_WIN64) && !defined(__CYGWIN__)
+#define strtok_r strtok_s
+#endif
+
 void stringtokenizer(char *data,Tokenizer *t)	{
-	char *token;
+	char *token,*saveptr;
 	t->tokens = NULL;
 	t->n = 0;
 	t->current = 0;
 	trim(data,"\t\n\r :");
-	token = strtok(data," \t:");
+	token = strtok_r(data," \t:",&saveptr);
 	while(token != NULL)	{
 		t->n++;
 		t->tokens = (char**) realloc(t->tokens,sizeof(char*)*t->n);
@@ -79,7 +86,7 @@ void stringtokenizer(char *data,Tokenizer *t)	{
 			exit(0);
 		}
 		t->tokens[t->n - 1] = token;
-		token = strtok(NULL," \t:");
+		token = strtok_r(NULL," \t:",&saveptr);
 	}
 }
 
@@ -176,3 +183,49 @@ int isValidHex(char *data)	{
 	}
 	return valid;
 }
+
+/*
+	Bucket index of a sorted table of n hashes of 20 bytes: the first bits of the hash select a bucket and
+	the items of the bucket b are index[b] to index[b+1] - 1, less than one per bucket.
+	The hashes are random so the buckets are even, and a lookup reads two offsets and one or two items
+	instead of the log2(n) steps of a binary search. The index has 2^bits + 1 offsets
+*/
+uint32_t address_index_size_bits(uint64_t n)	{
+	uint32_t bits;
+	if(n == 0 || n >= 0xFFFFFFFFULL)	{
+		return 0;	/* No index, the offsets are 32 bits */
+	}
+	bits = 1;
+	while(bits < 32 && (1ULL << bits) < n)	{
+		bits++;
+	}
+	return bits;
+}
+
+void address_index_fill(uint32_t *index,uint32_t bits,const uint8_t *table,uint64_t n)	{
+	uint64_t i,b,bucket,buckets;
+	buckets = 1ULL << bits;
+	b = 0;
+	for(i = 0; i < n; i++)	{
+		bucket = address_prefix((const char*)table + i*20) >> (64 - bits);
+		while(b <= bucket)	{
+			index[b++] = (uint32_t)i;
+		}
+	}
+	while(b <= buckets)	{
+		index[b++] = (uint32_t)n;
+	}
+}
+
+int address_index_search(const uint32_t *index,uint32_t bits,const uint8_t *table,const char *data)	{
+	uint64_t bucket;
+	uint32_t i,end;
+	bucket = address_prefix(data) >> (64 - bits);
+	end = index[bucket + 1];
+	for(i = index[bucket]; i < end; i++)	{
+		if(memcmp(data,table + (uint64_t)i*20,20) == 0)	{
+			return 1;
+		}
+	}
+	return 0;
+}
@@ -1,6 +1,8 @@
 #ifndef CUSTOMUTILH
 #define CUSTOMUTILH
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -34,6 +36,17 @@ int isValidHex(char *data);
 void freetokenizer(Tokenizer *t);
 void stringtokenizer(char *data,Tokenizer *t);
 
+/* First 8 bytes of a hash as a big endian number, its top bits are the bucket of the address index */
+static inline uint64_t address_prefix(const char *data)	{
+	const uint8_t *p = (const uint8_t *)data;
+	return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48) | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32) |
+		((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16) | ((uint64_t)p[6] << 8) | (uint64_t)p[7];
+}
+
+uint32_t address_index_size_bits(uint64_t n);
+void address_index_fill(uint32_t *index,uint32_t bits,const uint8_t *table,uint64_t n);
+int address_index_search(const uint32_t *index,uint32_t bits,const uint8_t *table,const char *data);
+
 #ifdef __cplusplus
 }
 #endif